@@ -45,6 +45,7 @@ public:
 	virtual void			CloseFile( fsHandle_t handle ) = 0;
 	virtual fsSize_t		ReadFile( void *buffer, fsSize_t length, fsHandle_t handle ) = 0;
 	virtual fsSize_t		WriteFile( const void *buffer, fsSize_t length, fsHandle_t handle ) = 0;
+	virtual fsSize_t		GetFileSize( fsHandle_t handle ) = 0;
 	virtual void			PrintFile( const char *string, fsHandle_t handle ) = 0;
 	virtual void			PrintFileFmt( fsHandle_t handle, const char *fmt, ... ) = 0;
 	virtual void			FlushFile( fsHandle_t handle ) = 0;
@@ -98,7 +98,7 @@ void Info_RemoveKey (char *s, const char *key)
 
 		if (!Q_strcmp (key, pkey) )
 		{
-			strcpy (start, s);	// remove this part
+			memmove (start, s, strlen (s) + 1);	// remove this part
 			return;
 		}
 
@@ -169,3 +169,240 @@ void Info_SetValueForKey (char *s, const char *key, const char *value)
 	}
 	*s = 0;
 }
+
+/*
+=======================================
+	Parsed info strings
+=======================================
+*/
+
+// only ascii values make it into an info string
+static int Info_CopyAscii( char *dest, const char *src )
+{
+	char *start = dest;
+	for ( ; *src; ++src )
+	{
+		int c = *src & 127;		// strip high bits
+		if ( c >= 32 && c < 127 ) {
+			*dest++ = c;
+		}
+	}
+	*dest = 0;
+	return (int)( dest - start );
+}
+
+void InfoMap::Clear()
+{
+	m_numPairs = 0;
+	m_length = 0;
+	m_textUsed = 0;
+	m_string[0] = 0;
+	m_stringValid = true;
+}
+
+// Same walk as Info_ValueForKey, a key without a value ends the string
+void InfoMap::Parse( const char *s )
+{
+	Clear();
+
+	if ( *s == '\\' ) {
+		s++;
+	}
+
+	while ( *s && m_numPairs < MAX_INFO_PAIRS )
+	{
+		const char *key = s;
+		while ( *s != '\\' )
+		{
+			if ( !*s ) {
+				return;
+			}
+			s++;
+		}
+		const int keyLength = (int)( s - key );
+		s++;
+
+		const char *value = s;
+		while ( *s != '\\' && *s ) {
+			s++;
+		}
+		const int valueLength = (int)( s - value );
+
+		if ( m_length + keyLength + valueLength + 2 > MAX_INFO_STRING ) {
+			return;
+		}
+
+		infoPair_t &pair = m_pairs[m_numPairs++];
+		pair.key = (uint16)AddText( key, keyLength );
+		pair.value = (uint16)AddText( value, valueLength );
+		pair.hash = HashString( m_text + pair.key );
+
+		m_length += keyLength + valueLength + 2;
+		m_stringValid = false;
+
+		if ( !*s ) {
+			return;
+		}
+		s++;
+	}
+}
+
+int InfoMap::AddText( const char *s, int length )
+{
+	const int offset = m_textUsed;
+	memcpy( m_text + offset, s, length );
+	m_text[offset + length] = 0;
+	m_textUsed += length + 1;
+	return offset;
+}
+
+// Removed pairs leave their text behind, squeeze it out once the buffer fills
+void InfoMap::CompactText()
+{
+	char text[sizeof( m_text )];
+	int used = 0;
+
+	for ( int i = 0; i < m_numPairs; ++i )
+	{
+		infoPair_t &pair = m_pairs[i];
+
+		const int keyLength = (int)strlen( m_text + pair.key ) + 1;
+		memcpy( text + used, m_text + pair.key, keyLength );
+		pair.key = (uint16)used;
+		used += keyLength;
+
+		const int valueLength = (int)strlen( m_text + pair.value ) + 1;
+		memcpy( text + used, m_text + pair.value, valueLength );
+		pair.value = (uint16)used;
+		used += valueLength;
+	}
+
+	memcpy( m_text, text, used );
+	m_textUsed = used;
+}
+
+int InfoMap::Find( const char *key ) const
+{
+	const uint32 hash = HashString( key );
+
+	for ( int i = 0; i < m_numPairs; ++i )
+	{
+		if ( m_pairs[i].hash == hash && Q_strcmp( m_text + m_pairs[i].key, key ) == 0 ) {
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+const char *InfoMap::Get( const char *key ) const
+{
+	const int i = Find( key );
+	return i >= 0 ? m_text + m_pairs[i].value : "";
+}
+
+void InfoMap::Remove( const char *key )
+{
+	if ( strstr( key, "\\" ) ) {
+		return;
+	}
+
+	const int i = Find( key );
+	if ( i < 0 ) {
+		return;
+	}
+
+	m_length -= (int)strlen( m_text + m_pairs[i].key ) + (int)strlen( m_text + m_pairs[i].value ) + 2;
+
+	// keep the order, the string form has to come out the same as Info_RemoveKey's
+	memmove( m_pairs + i, m_pairs + i + 1, ( m_numPairs - i - 1 ) * sizeof( infoPair_t ) );
+	--m_numPairs;
+	m_stringValid = false;
+}
+
+bool InfoMap::Set( const char *key, const char *value )
+{
+	if ( strstr( key, "\\" ) || strstr( value, "\\" ) )
+	{
+		Com_Printf( "Can't use keys or values with a \\\n" );
+		return false;
+	}
+
+	if ( strstr( key, ";" ) )
+	{
+		Com_Printf( "Can't use keys or values with a semicolon\n" );
+		return false;
+	}
+
+	if ( strstr( key, "\"" ) || strstr( value, "\"" ) )
+	{
+		Com_Printf( "Can't use keys or values with a \"\n" );
+		return false;
+	}
+
+	const int keyLength = (int)strlen( key );
+	const int valueLength = (int)strlen( value );
+
+	if ( keyLength > MAX_INFO_KEY - 1 || valueLength > MAX_INFO_VALUE - 1 )
+	{
+		Com_Printf( "Keys and values must be < 64 characters.\n" );
+		return false;
+	}
+
+	Remove( key );
+	if ( !valueLength ) {
+		return true;
+	}
+
+	if ( keyLength + valueLength + 2 + m_length > MAX_INFO_STRING )
+	{
+		Com_Printf( "Info string length exceeded\n" );
+		return false;
+	}
+
+	if ( m_numPairs == MAX_INFO_PAIRS ) {
+		return false;
+	}
+
+	if ( m_textUsed + keyLength + valueLength + 2 > (int)sizeof( m_text ) ) {
+		CompactText();
+	}
+
+	infoPair_t &pair = m_pairs[m_numPairs++];
+
+	pair.key = (uint16)m_textUsed;
+	m_textUsed += Info_CopyAscii( m_text + m_textUsed, key ) + 1;
+	pair.value = (uint16)m_textUsed;
+	m_textUsed += Info_CopyAscii( m_text + m_textUsed, value ) + 1;
+	pair.hash = HashString( m_text + pair.key );
+
+	m_length += (int)strlen( m_text + pair.key ) + (int)strlen( m_text + pair.value ) + 2;
+	m_stringValid = false;
+
+	return true;
+}
+
+const char *InfoMap::String() const
+{
+	if ( m_stringValid ) {
+		return m_string;
+	}
+
+	// m_length never goes over MAX_INFO_STRING so this always fits
+	char *o = m_string;
+	for ( int i = 0; i < m_numPairs; ++i )
+	{
+		*o++ = '\\';
+		for ( const char *k = m_text + m_pairs[i].key; *k; ) {
+			*o++ = *k++;
+		}
+		*o++ = '\\';
+		for ( const char *v = m_text + m_pairs[i].value; *v; ) {
+			*o++ = *v++;
+		}
+	}
+	*o = 0;
+
+	m_stringValid = true;
+	return m_string;
+}
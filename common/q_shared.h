@@ -60,6 +60,57 @@ void	Info_SetValueForKey (char *s, const char *key, const char *value);
 // can mess up the server's parsing
 bool	Info_Validate (const char *s);
 
+#define	MAX_INFO_PAIRS		( MAX_INFO_STRING / 4 )
+
+// An info string split into its keys and values. The keys are hashed on the way in so a lookup
+// doesn't walk the whole string, and the string form is only rebuilt when asked for after a
+// change. Everything lives in fixed buffers so it can sit on the stack or in a client_t.
+// Lookups, sets and removes behave like the Info_ functions above.
+class InfoMap
+{
+public:
+	InfoMap() { Clear(); }
+	explicit InfoMap( const char *s ) { Parse( s ); }
+
+	void		Clear();
+	void		Parse( const char *s );
+
+	// Returns the value for the key, or an empty string
+	const char *Get( const char *key ) const;
+	bool		Has( const char *key ) const { return Find( key ) >= 0; }
+
+	// An empty value removes the key, returns false if the pair was rejected
+	bool		Set( const char *key, const char *value );
+	void		Remove( const char *key );
+
+	int			Count() const { return m_numPairs; }
+	int			Length() const { return m_length; }
+
+	// The info string form, rebuilt here if anything changed since the last call
+	const char *String() const;
+
+private:
+	struct infoPair_t
+	{
+		uint32	hash;
+		uint16	key;		// offsets into m_text
+		uint16	value;
+	};
+
+	int			Find( const char *key ) const;
+	int			AddText( const char *s, int length );
+	void		CompactText();
+
+	infoPair_t	m_pairs[MAX_INFO_PAIRS];
+	int			m_numPairs;
+	int			m_length;					// length of the string form
+	char		m_text[MAX_INFO_STRING * 2];
+	int			m_textUsed;
+
+	mutable char m_string[MAX_INFO_STRING + 1];
+	mutable bool m_stringValid;
+};
+
 //-------------------------------------------------------------------------------------------------
 // Collision detection
 //-------------------------------------------------------------------------------------------------
@@ -53,9 +53,11 @@
 
 #include "memory.h"
 #include "math.h"			// blahhh, nasty filename?
+#include "math_simd.h"
 #include "byteswap.h"
 #include "stringtools.h"
 #include "threading.h"
+#include "jobsystem.h"
 #include "sys_misc.h"
 
 // classes
@@ -0,0 +1,214 @@
+/*
+===================================================================================================
+
+	Job system
+
+	Uses the standard library threading primitives so it works on both platforms,
+	the Sys_ thread functions are Windows only for now.
+
+===================================================================================================
+*/
+
+#include "core.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Jobs
+{
+
+struct jobRange_t
+{
+	jobFunction_t			function;
+	void *					params;
+	uint32					count;
+	std::atomic<uint32>		next;
+};
+
+static std::vector<std::thread>	s_workers;
+
+static std::mutex				s_submitMutex;		// held for the duration of a ParallelFor
+static std::mutex				s_mutex;			// guards everything below
+static std::condition_variable	s_wakeWorkers;
+static std::condition_variable	s_wakeSubmitter;
+
+static jobRange_t *				s_range;
+static uint64					s_generation;
+static uint32					s_rangeUsers;		// workers currently holding s_range
+static bool						s_quit;
+
+static thread_local bool		s_isWorker;
+
+/*
+========================
+RunRange
+========================
+*/
+static void RunRange( jobRange_t &range )
+{
+	uint32 index;
+	while ( ( index = range.next.fetch_add( 1, std::memory_order_relaxed ) ) < range.count )
+	{
+		range.function( range.params, index );
+	}
+}
+
+/*
+========================
+WorkerLoop
+========================
+*/
+static void WorkerLoop()
+{
+	s_isWorker = true;
+
+	uint64 seenGeneration = 0;
+
+	while ( true )
+	{
+		jobRange_t *range;
+
+		{
+			std::unique_lock<std::mutex> lock( s_mutex );
+			s_wakeWorkers.wait( lock, [&seenGeneration]() { return s_quit || s_generation != seenGeneration; } );
+
+			if ( s_quit ) {
+				return;
+			}
+
+			seenGeneration = s_generation;
+			range = s_range;
+			if ( !range ) {
+				// we woke up after the submitter already finished
+				continue;
+			}
+			++s_rangeUsers;
+		}
+
+		RunRange( *range );
+
+		{
+			std::lock_guard<std::mutex> lock( s_mutex );
+			--s_rangeUsers;
+		}
+		s_wakeSubmitter.notify_one();
+	}
+}
+
+/*
+========================
+Init
+========================
+*/
+void Init( uint32 numWorkers )
+{
+	if ( !s_workers.empty() ) {
+		return;
+	}
+
+	if ( numWorkers == 0 )
+	{
+		const uint32 hardwareThreads = std::thread::hardware_concurrency();
+		numWorkers = hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+	}
+
+	s_quit = false;
+	s_range = nullptr;
+
+	s_workers.reserve( numWorkers );
+	for ( uint32 i = 0; i < numWorkers; ++i )
+	{
+		s_workers.emplace_back( WorkerLoop );
+	}
+}
+
+/*
+========================
+Shutdown
+========================
+*/
+void Shutdown()
+{
+	{
+		std::lock_guard<std::mutex> lock( s_mutex );
+		s_quit = true;
+	}
+	s_wakeWorkers.notify_all();
+
+	for ( std::thread &worker : s_workers )
+	{
+		worker.join();
+	}
+
+	s_workers.clear();
+	s_workers.shrink_to_fit();
+}
+
+/*
+========================
+NumWorkers
+========================
+*/
+uint32 NumWorkers()
+{
+	return static_cast<uint32>( s_workers.size() );
+}
+
+/*
+========================
+IsWorkerThread
+========================
+*/
+bool IsWorkerThread()
+{
+	return s_isWorker;
+}
+
+/*
+========================
+ParallelFor
+========================
+*/
+void ParallelFor( uint32 count, jobFunction_t function, void *params )
+{
+	if ( count == 0 ) {
+		return;
+	}
+
+	std::unique_lock<std::mutex> submitLock( s_submitMutex, std::defer_lock );
+
+	if ( count == 1 || s_workers.empty() || s_isWorker || !submitLock.try_lock() )
+	{
+		for ( uint32 i = 0; i < count; ++i )
+		{
+			function( params, i );
+		}
+		return;
+	}
+
+	jobRange_t range;
+	range.function = function;
+	range.params = params;
+	range.count = count;
+	range.next.store( 0, std::memory_order_relaxed );
+
+	{
+		std::lock_guard<std::mutex> lock( s_mutex );
+		s_range = &range;
+		++s_generation;
+	}
+	s_wakeWorkers.notify_all();
+
+	// help out
+	RunRange( range );
+
+	// the range is exhausted, wait for the stragglers to finish their last index
+	std::unique_lock<std::mutex> lock( s_mutex );
+	s_wakeSubmitter.wait( lock, []() { return s_rangeUsers == 0; } );
+	s_range = nullptr;
+}
+
+}
@@ -0,0 +1,38 @@
+/*
+===================================================================================================
+
+	Job system
+
+	A tiny fork/join worker pool. Work is submitted as a range of indices, the worker threads
+	and the submitting thread pull indices off the range until it's exhausted, then the submit
+	call returns. Only one range is in flight at a time, nested or concurrent submissions just
+	run serially on the calling thread.
+
+	Each module that links core has its own pool, so the game and the engine must each call
+	Init and Shutdown. If the pool was never initialised everything runs serially.
+
+===================================================================================================
+*/
+
+#pragma once
+
+#include "sys_types.h"
+
+// index is in the range [0, count)
+using jobFunction_t = void ( * )( void *params, uint32 index );
+
+namespace Jobs
+{
+	// Spawns the worker threads, 0 picks one less than the number of hardware threads
+	void	Init( uint32 numWorkers = 0 );
+	void	Shutdown();
+
+	// Number of worker threads, not counting the submitting thread
+	uint32	NumWorkers();
+
+	// Returns true if the calling thread is one of the pool's workers
+	bool	IsWorkerThread();
+
+	// Runs function for every index in [0, count), blocks until all of them have completed
+	void	ParallelFor( uint32 count, jobFunction_t function, void *params );
+}
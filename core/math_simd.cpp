@@ -0,0 +1,290 @@
+/*
+===================================================================================================
+
+	Batched math
+
+	The kernels are written once against the small set of wrappers below and built for both
+	__m128 and __m256. Arrays of vec3_t are loaded a block at a time and shuffled into one
+	register per component, AVX2 does the same shuffles in both 128 bit halves so a block of
+	eight is two blocks of four side by side.
+
+===================================================================================================
+*/
+
+#include "core.h"
+
+#include "math_simd.h"
+
+#if defined __SSE2__ || defined _M_X64
+#define MATH_SIMD
+#include <immintrin.h>
+#endif
+
+#ifdef MATH_SIMD
+
+//=================================================================================================
+
+inline __m128 Simd_Set1( __m128, float f )					{ return _mm_set1_ps( f ); }
+inline __m128 Simd_Add( __m128 a, __m128 b )				{ return _mm_add_ps( a, b ); }
+inline __m128 Simd_Mul( __m128 a, __m128 b )				{ return _mm_mul_ps( a, b ); }
+inline __m128 Simd_Div( __m128 a, __m128 b )				{ return _mm_div_ps( a, b ); }
+inline __m128 Simd_Sqrt( __m128 a )							{ return _mm_sqrt_ps( a ); }
+inline __m128 Simd_And( __m128 a, __m128 b )				{ return _mm_and_ps( a, b ); }
+inline __m128 Simd_Select( __m128 mask, __m128 a, __m128 b ){ return _mm_or_ps( _mm_and_ps( mask, a ), _mm_andnot_ps( mask, b ) ); }
+inline __m128 Simd_CmpGE( __m128 a, __m128 b )				{ return _mm_cmpge_ps( a, b ); }
+inline __m128 Simd_CmpLT( __m128 a, __m128 b )				{ return _mm_cmplt_ps( a, b ); }
+inline __m128 Simd_CmpLE( __m128 a, __m128 b )				{ return _mm_cmple_ps( a, b ); }
+inline void Simd_Store( float *out, __m128 a )				{ _mm_storeu_ps( out, a ); }
+inline void Simd_StoreInt( int *out, __m128 a )				{ _mm_storeu_si128( (__m128i *)out, _mm_cvttps_epi32( a ) ); }
+
+template< int imm >
+inline __m128 Simd_Shuffle( __m128 a, __m128 b )			{ return _mm_shuffle_ps( a, b, imm ); }
+
+// the three registers that hold a block of vec3_t, four of them in each 128 bits
+inline void Simd_LoadBlock( const float *p, __m128 &a, __m128 &b, __m128 &c )
+{
+	a = _mm_loadu_ps( p );
+	b = _mm_loadu_ps( p + 4 );
+	c = _mm_loadu_ps( p + 8 );
+}
+
+inline void Simd_StoreBlock( float *p, __m128 a, __m128 b, __m128 c )
+{
+	_mm_storeu_ps( p, a );
+	_mm_storeu_ps( p + 4, b );
+	_mm_storeu_ps( p + 8, c );
+}
+
+#ifdef __AVX2__
+
+inline __m256 Simd_Set1( __m256, float f )					{ return _mm256_set1_ps( f ); }
+inline __m256 Simd_Add( __m256 a, __m256 b )				{ return _mm256_add_ps( a, b ); }
+inline __m256 Simd_Mul( __m256 a, __m256 b )				{ return _mm256_mul_ps( a, b ); }
+inline __m256 Simd_Div( __m256 a, __m256 b )				{ return _mm256_div_ps( a, b ); }
+inline __m256 Simd_Sqrt( __m256 a )							{ return _mm256_sqrt_ps( a ); }
+inline __m256 Simd_And( __m256 a, __m256 b )				{ return _mm256_and_ps( a, b ); }
+inline __m256 Simd_Select( __m256 mask, __m256 a, __m256 b ){ return _mm256_blendv_ps( b, a, mask ); }
+inline __m256 Simd_CmpGE( __m256 a, __m256 b )				{ return _mm256_cmp_ps( a, b, _CMP_GE_OQ ); }
+inline __m256 Simd_CmpLT( __m256 a, __m256 b )				{ return _mm256_cmp_ps( a, b, _CMP_LT_OQ ); }
+inline __m256 Simd_CmpLE( __m256 a, __m256 b )				{ return _mm256_cmp_ps( a, b, _CMP_LE_OQ ); }
+inline void Simd_Store( float *out, __m256 a )				{ _mm256_storeu_ps( out, a ); }
+inline void Simd_StoreInt( int *out, __m256 a )				{ _mm256_storeu_si256( (__m256i *)out, _mm256_cvttps_epi32( a ) ); }
+
+template< int imm >
+inline __m256 Simd_Shuffle( __m256 a, __m256 b )			{ return _mm256_shuffle_ps( a, b, imm ); }
+
+inline __m256 Simd_LoadHalves( const float *lo, const float *hi )
+{
+	return _mm256_insertf128_ps( _mm256_castps128_ps256( _mm_loadu_ps( lo ) ), _mm_loadu_ps( hi ), 1 );
+}
+
+inline void Simd_StoreHalves( float *lo, float *hi, __m256 a )
+{
+	_mm_storeu_ps( lo, _mm256_castps256_ps128( a ) );
+	_mm_storeu_ps( hi, _mm256_extractf128_ps( a, 1 ) );
+}
+
+// the first four vectors go in the low halves and the next four in the high halves
+inline void Simd_LoadBlock( const float *p, __m256 &a, __m256 &b, __m256 &c )
+{
+	a = Simd_LoadHalves( p, p + 12 );
+	b = Simd_LoadHalves( p + 4, p + 16 );
+	c = Simd_LoadHalves( p + 8, p + 20 );
+}
+
+inline void Simd_StoreBlock( float *p, __m256 a, __m256 b, __m256 c )
+{
+	Simd_StoreHalves( p, p + 12, a );
+	Simd_StoreHalves( p + 4, p + 16, b );
+	Simd_StoreHalves( p + 8, p + 20, c );
+}
+
+#endif
+
+/*
+========================
+Simd_LoadVec3
+
+x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3 becomes x0 x1 x2 x3 | y0 y1 y2 y3 | z0 z1 z2 z3
+========================
+*/
+template< typename V >
+inline void Simd_LoadVec3( const float *p, V &x, V &y, V &z )
+{
+	V a, b, c;
+	Simd_LoadBlock( p, a, b, c );
+
+	x = Simd_Shuffle<_MM_SHUFFLE( 2, 0, 2, 0 )>( Simd_Shuffle<_MM_SHUFFLE( 3, 3, 0, 0 )>( a, a ), Simd_Shuffle<_MM_SHUFFLE( 1, 1, 2, 2 )>( b, c ) );
+	y = Simd_Shuffle<_MM_SHUFFLE( 2, 0, 2, 0 )>( Simd_Shuffle<_MM_SHUFFLE( 0, 0, 1, 1 )>( a, b ), Simd_Shuffle<_MM_SHUFFLE( 2, 2, 3, 3 )>( b, c ) );
+	z = Simd_Shuffle<_MM_SHUFFLE( 2, 0, 2, 0 )>( Simd_Shuffle<_MM_SHUFFLE( 1, 1, 2, 2 )>( a, b ), Simd_Shuffle<_MM_SHUFFLE( 3, 3, 0, 0 )>( c, c ) );
+}
+
+// the other way around
+template< typename V >
+inline void Simd_StoreVec3( float *p, V x, V y, V z )
+{
+	const V a = Simd_Shuffle<_MM_SHUFFLE( 2, 0, 2, 0 )>( Simd_Shuffle<_MM_SHUFFLE( 0, 0, 0, 0 )>( x, y ), Simd_Shuffle<_MM_SHUFFLE( 1, 1, 0, 0 )>( z, x ) );
+	const V b = Simd_Shuffle<_MM_SHUFFLE( 2, 0, 2, 0 )>( Simd_Shuffle<_MM_SHUFFLE( 1, 1, 1, 1 )>( y, z ), Simd_Shuffle<_MM_SHUFFLE( 2, 2, 2, 2 )>( x, y ) );
+	const V c = Simd_Shuffle<_MM_SHUFFLE( 2, 0, 2, 0 )>( Simd_Shuffle<_MM_SHUFFLE( 3, 3, 2, 2 )>( z, x ), Simd_Shuffle<_MM_SHUFFLE( 3, 3, 3, 3 )>( y, z ) );
+
+	Simd_StoreBlock( p, a, b, c );
+}
+
+//=================================================================================================
+
+template< typename V >
+static void NormalizeBlock( float *v, float *lengths )
+{
+	V x, y, z;
+	Simd_LoadVec3( v, x, y, z );
+
+	const V length = Simd_Sqrt( Simd_Add( Simd_Add( Simd_Mul( x, x ), Simd_Mul( y, y ) ), Simd_Mul( z, z ) ) );
+
+	// prevent divide by zero
+	const V ilength = Simd_Div( Simd_Set1( length, 1.0f ), Simd_Add( length, Simd_Set1( length, FLT_EPSILON ) ) );
+
+	Simd_StoreVec3( v, Simd_Mul( x, ilength ), Simd_Mul( y, ilength ), Simd_Mul( z, ilength ) );
+
+	if ( lengths ) {
+		Simd_Store( lengths, length );
+	}
+}
+
+template< typename V >
+static void BoxesOnPlaneSideBlock( const float *mins, const float *maxs, const cplane_t *p, int *sides )
+{
+	V minX, minY, minZ;
+	V maxX, maxY, maxZ;
+	Simd_LoadVec3( mins, minX, minY, minZ );
+	Simd_LoadVec3( maxs, maxX, maxY, maxZ );
+
+	const V dist = Simd_Set1( minX, p->dist );
+	const V one = Simd_Set1( minX, 1.0f );
+	const V two = Simd_Set1( minX, 2.0f );
+
+	// fast axial cases
+	if ( p->type < 3 )
+	{
+		const V emin = p->type == 0 ? minX : p->type == 1 ? minY : minZ;
+		const V emax = p->type == 0 ? maxX : p->type == 1 ? maxY : maxZ;
+
+		V result = Simd_Select( Simd_CmpGE( dist, emax ), two, Simd_Set1( minX, 3.0f ) );
+		result = Simd_Select( Simd_CmpLE( dist, emin ), one, result );
+		Simd_StoreInt( sides, result );
+		return;
+	}
+
+	// general case, the corner furthest along the normal and the one furthest back
+	const V nearX = ( p->signbits & 1 ) ? minX : maxX;
+	const V nearY = ( p->signbits & 2 ) ? minY : maxY;
+	const V nearZ = ( p->signbits & 4 ) ? minZ : maxZ;
+	const V farX = ( p->signbits & 1 ) ? maxX : minX;
+	const V farY = ( p->signbits & 2 ) ? maxY : minY;
+	const V farZ = ( p->signbits & 4 ) ? maxZ : minZ;
+
+	const V nx = Simd_Set1( minX, p->normal[0] );
+	const V ny = Simd_Set1( minX, p->normal[1] );
+	const V nz = Simd_Set1( minX, p->normal[2] );
+
+	const V dist1 = Simd_Add( Simd_Add( Simd_Mul( nx, nearX ), Simd_Mul( ny, nearY ) ), Simd_Mul( nz, nearZ ) );
+	const V dist2 = Simd_Add( Simd_Add( Simd_Mul( nx, farX ), Simd_Mul( ny, farY ) ), Simd_Mul( nz, farZ ) );
+
+	Simd_StoreInt( sides, Simd_Add( Simd_And( Simd_CmpGE( dist1, dist ), one ), Simd_And( Simd_CmpLT( dist2, dist ), two ) ) );
+}
+
+template< typename V >
+static void TransformBlock( const float *in, float *out, const float matrix[3][4] )
+{
+	V x, y, z;
+	Simd_LoadVec3( in, x, y, z );
+
+	V result[3];
+	for ( int i = 0; i < 3; i++ )
+	{
+		const V dot = Simd_Add( Simd_Add( Simd_Mul( x, Simd_Set1( x, matrix[i][0] ) ), Simd_Mul( y, Simd_Set1( x, matrix[i][1] ) ) ), Simd_Mul( z, Simd_Set1( x, matrix[i][2] ) ) );
+		result[i] = Simd_Add( dot, Simd_Set1( x, matrix[i][3] ) );
+	}
+
+	Simd_StoreVec3( out, result[0], result[1], result[2] );
+}
+
+#endif // MATH_SIMD
+
+/*
+===================================================================================================
+
+	Entry points
+
+	Each one takes eight at a time with AVX2, then four with SSE, and finishes off with the
+	scalar routine.
+
+===================================================================================================
+*/
+
+void VectorNormalizeMany( vec3_t *v, int count, float *lengths )
+{
+	int i = 0;
+
+#ifdef MATH_SIMD
+#ifdef __AVX2__
+	for ( ; i + 8 <= count; i += 8 ) {
+		NormalizeBlock<__m256>( v[i], lengths ? lengths + i : nullptr );
+	}
+#endif
+	for ( ; i + 4 <= count; i += 4 ) {
+		NormalizeBlock<__m128>( v[i], lengths ? lengths + i : nullptr );
+	}
+#endif
+
+	for ( ; i < count; i++ )
+	{
+		const float length = VectorNormalize( v[i] );
+		if ( lengths ) {
+			lengths[i] = length;
+		}
+	}
+}
+
+void BoxesOnPlaneSide( const vec3_t *mins, const vec3_t *maxs, int count, const cplane_t *plane, int *sides )
+{
+	int i = 0;
+
+#ifdef MATH_SIMD
+#ifdef __AVX2__
+	for ( ; i + 8 <= count; i += 8 ) {
+		BoxesOnPlaneSideBlock<__m256>( mins[i], maxs[i], plane, sides + i );
+	}
+#endif
+	for ( ; i + 4 <= count; i += 4 ) {
+		BoxesOnPlaneSideBlock<__m128>( mins[i], maxs[i], plane, sides + i );
+	}
+#endif
+
+	for ( ; i < count; i++ ) {
+		sides[i] = BoxOnPlaneSide( mins[i], maxs[i], plane );
+	}
+}
+
+void TransformPoints( const vec3_t *in, vec3_t *out, int count, const float matrix[3][4] )
+{
+	int i = 0;
+
+#ifdef MATH_SIMD
+#ifdef __AVX2__
+	for ( ; i + 8 <= count; i += 8 ) {
+		TransformBlock<__m256>( in[i], out[i], matrix );
+	}
+#endif
+	for ( ; i + 4 <= count; i += 4 ) {
+		TransformBlock<__m128>( in[i], out[i], matrix );
+	}
+#endif
+
+	for ( ; i < count; i++ )
+	{
+		// VectorTransform would read in as it writes out
+		vec3_t point;
+		VectorCopy( in[i], point );
+		VectorTransform( point, matrix, out[i] );
+	}
+}
@@ -0,0 +1,24 @@
+/*
+===================================================================================================
+
+	Batched math
+
+	Versions of the hot core/math routines that work on whole arrays, four or eight items at a
+	time with SSE or AVX2, and a loop over the scalar routines where neither is available. They
+	do the same sums in the same order as the routines they stand in for.
+
+===================================================================================================
+*/
+
+#pragma once
+
+#include "math.h"
+
+// Normalizes every vector like VectorNormalize, lengths can be null
+void VectorNormalizeMany( vec3_t *v, int count, float *lengths = nullptr );
+
+// BoxOnPlaneSide for each box against the same plane
+void BoxesOnPlaneSide( const vec3_t *mins, const vec3_t *maxs, int count, const cplane_t *plane, int *sides );
+
+// VectorTransform for each point, in and out can be the same array
+void TransformPoints( const vec3_t *in, vec3_t *out, int count, const float matrix[3][4] );
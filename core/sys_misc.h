@@ -28,6 +28,8 @@ size_t	Hunk_End();
 bool	Sys_FileExists( const char *filename );					// Returns true on directories too
 void	Sys_CopyFile( const char *src, const char *dst );
 void	Sys_DeleteFile( const char *filename );
+bool	Sys_RenameFile( const char *src, const char *dst );		// Replaces dst if it exists
+bool	Sys_FileInfo( const char *filename, int64 &size, int64 &modified );	// modified is in seconds since 1970
 void	Sys_CreateDirectory( const char *path );
 void	Sys_GetWorkingDirectory( char *path, uint length );
 void	Sys_OutputDebugString( const char *msg );
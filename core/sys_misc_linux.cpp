@@ -103,6 +103,22 @@ void Sys_CopyFile( const char *src, const char *dst )
 	close(srcfile);
 }
 
+bool Sys_RenameFile( const char *src, const char *dst )
+{
+	return rename(src, dst) == 0;
+}
+
+bool Sys_FileInfo( const char *filename, int64 &size, int64 &modified )
+{
+	struct stat info;
+	if (stat(filename, &info) != 0)
+		return false;
+
+	size = info.st_size;
+	modified = info.st_mtime;
+	return true;
+}
+
 void Sys_CreateDirectory( const char *path )
 {
 	mkdir(path, 0777);
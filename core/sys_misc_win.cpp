@@ -116,6 +116,26 @@ void Sys_DeleteFile( const char *filename )
 	DeleteFileA( filename );
 }
 
+bool Sys_RenameFile( const char *src, const char *dst )
+{
+	return MoveFileExA( src, dst, MOVEFILE_REPLACE_EXISTING ) != FALSE;
+}
+
+bool Sys_FileInfo( const char *filename, int64 &size, int64 &modified )
+{
+	WIN32_FILE_ATTRIBUTE_DATA data;
+	if ( !GetFileAttributesExA( filename, GetFileExInfoStandard, &data ) ) {
+		return false;
+	}
+
+	size = ( static_cast<int64>( data.nFileSizeHigh ) << 32 ) | data.nFileSizeLow;
+
+	// FILETIME counts 100ns intervals from 1601
+	const int64 fileTime = ( static_cast<int64>( data.ftLastWriteTime.dwHighDateTime ) << 32 ) | data.ftLastWriteTime.dwLowDateTime;
+	modified = ( fileTime - 116444736000000000ll ) / 10000000;
+	return true;
+}
+
 void Sys_CreateDirectory( const char *path )
 {
 	CreateDirectoryA( path, nullptr );
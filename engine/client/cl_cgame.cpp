@@ -110,6 +110,7 @@ void CL_InitCGame()
 
 	cgi.AddEntity = V_AddEntity;
 	cgi.AddParticle = V_AddParticle;
+	cgi.AddParticles = V_AddParticles;
 	cgi.AddLight = V_AddDLight;
 	cgi.AddLightStyle = V_AddLightStyle;
 
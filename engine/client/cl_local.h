@@ -53,6 +53,14 @@ struct clientinfo_t
 extern char cl_weaponmodels[MAX_CLIENTWEAPONMODELS][MAX_QPATH];
 extern int num_cl_weaponmodels;
 
+// What CL_PredictMovement got from running one command
+struct predictedMove_t
+{
+	pmove_state_t	s;
+	vec3_t			viewangles;
+	bool			onGround;
+};
+
 struct clientActive_t
 {
 	int			timeoutcount;
@@ -78,6 +86,13 @@ struct clientActive_t
 	vec3_t			predAngles;
 	vec3_t			predError;
 
+	// the result of every command predicted since predAck, while the server state for predAck
+	// matches predBase only the commands after predLast have to run
+	predictedMove_t	predMoves[CMD_BACKUP];
+	pmove_state_t	predBase;
+	int				predAck;
+	int				predLast;		// 0 if nothing is cached
+
 	clSnapshot_t	frame;				// received from server
 	int				surpressCount;		// number of messages rate supressed
 	clSnapshot_t	frames[UPDATE_BACKUP];
@@ -199,6 +214,7 @@ struct clientStatic_t
 	int			downloadnumber;
 	dltype_t	downloadtype;
 	int			downloadpercent;
+	bulkReceiver_t	downloadBulk;	// window for svc_bulkdownload transfers
 
 // demo recording info must be here, so it isn't cleared on level change
 	fsHandle_t	demofile;
@@ -221,6 +237,7 @@ extern entity_state_t cl_parse_entities[MAX_PARSE_ENTITIES];
 //
 extern cvar_t	*cl_drawviewmodel;
 extern cvar_t	*cl_predict;
+extern cvar_t	*cl_predictCache;
 extern cvar_t	*cl_footsteps;
 extern cvar_t	*cl_noskins;
 extern cvar_t	*cl_autoskins;
@@ -238,6 +255,7 @@ extern cvar_t	*cl_anglespeedkey;
 
 extern cvar_t	*cl_shownet;
 extern cvar_t	*cl_showmiss;
+extern cvar_t	*cl_showpredict;
 extern cvar_t	*cl_showclamp;
 
 extern cvar_t	*sensitivity;
@@ -251,6 +269,7 @@ extern cvar_t	*cl_lightlevel;	// FIXME HACK
 
 extern cvar_t	*cl_paused;
 extern cvar_t	*cl_timedemo;
+extern cvar_t	*cl_downloadRate;
 
 extern cvar_t	*cl_vwep;
 
@@ -299,6 +318,28 @@ void CL_ReadPackets();
 // demos
 void CL_WriteDemoMessage();
 
+//
+// cl_timedemo
+//
+enum timedemoPhase_t
+{
+	TD_PARSE,
+	TD_PREDICT,
+	TD_SCENE,
+	TD_RENDER,
+	TD_SOUND,
+	TD_CGAME,
+	TD_OTHER,
+	TD_NUM_PHASES
+};
+
+bool CL_TimedemoActive();
+bool CL_TimedemoSkipRender();
+void CL_TimedemoBeginFrame();
+void CL_TimedemoAddTime( timedemoPhase_t phase, int64 start );
+void CL_TimedemoEndFrame();
+void CL_TimedemoReport();
+
 void CL_Quit_f();
 
 //
@@ -359,6 +400,8 @@ void CL_LoadClientinfo( clientinfo_t *ci, char *s );
 void SHOWNET( const char *s );
 void CL_ParseClientinfo( int player );
 void CL_Download_f();
+void CL_BulkPacket();
+void CL_SendBulkAck();
 
 bool CL_CheckOrDownloadFile( const char *filename );
 void CL_RegisterSounds();
@@ -411,6 +454,7 @@ void CL_PrepRefresh();
 
 void V_AddEntity( entity_t *ent );
 void V_AddParticle( vec3_t org, int color, float alpha );
+void V_AddParticles( const particle_t *particles, int count );
 void V_AddDLight( vec3_t org, float intensity, float r, float g, float b );
 void V_AddLightStyle( int style, float r, float g, float b );
 
@@ -20,16 +20,19 @@ cvar_t	*cl_autoskins;
 cvar_t	*cl_footsteps;
 cvar_t	*cl_timeout;
 cvar_t	*cl_predict;
+cvar_t	*cl_predictCache;
 //cvar_t	*cl_minfps;
 cvar_t	*cl_maxfps;
 cvar_t	*cl_drawviewmodel;
 
 cvar_t	*cl_shownet;
 cvar_t	*cl_showmiss;
+cvar_t	*cl_showpredict;
 cvar_t	*cl_showclamp;
 
 cvar_t	*cl_paused;
 cvar_t	*cl_timedemo;
+cvar_t	*cl_downloadRate;
 
 cvar_t	*sensitivity;
 
@@ -326,6 +329,9 @@ void CL_Drop (void)
 	if (cls.state == ca_disconnected)
 		return;
 
+	// if the error came in the middle of loading a map
+	R_AbortRegistration ();
+
 	CL_Disconnect ();
 
 	// drop loading plaque unless this is the initial game start
@@ -552,6 +558,8 @@ void CL_Disconnect (void)
 		if (time > 0)
 			Com_Printf ("%i frames, %3.1f seconds: %3.1f fps\n", cl.timedemo_frames,
 			time/1000.0, cl.timedemo_frames*1000.0 / time);
+
+		CL_TimedemoReport ();
 	}
 
 	VectorClear (cl.refdef.blend);
@@ -581,6 +589,7 @@ void CL_Disconnect (void)
 		FileSystem::CloseFile(cls.download);
 		cls.download = NULL;
 	}
+	cls.downloadBulk.active = false;
 
 	cls.state = ca_disconnected;
 }
@@ -944,11 +953,22 @@ void CL_ReadPackets (void)
 				,NET_NetadrToString(net_from));
 			continue;
 		}
+
+		if (*(int *)net_message.data == BULK_HEADER)
+		{
+			CL_BulkPacket ();
+			continue;
+		}
+
 		if (!Netchan_Process(&cls.netchan, &net_message))
 			continue;		// wasn't accepted for some reason
 		CL_ParseServerMessage ();
 	}
 
+	// one ack for everything that came in this frame
+	if (cls.downloadBulk.ackPending)
+		CL_SendBulkAck ();
+
 	//
 	// check timeout
 	//
@@ -1292,8 +1312,10 @@ void CL_RequestNextDownload (void)
 	}
 
 //ZOID
+	Asset_BeginLoad ();
 	CL_RegisterSounds ();
 	CL_PrepRefresh ();
+	Asset_EndLoad ();
 
 	MSG_WriteByte (&cls.netchan.message, clc_stringcmd);
 	MSG_WriteString (&cls.netchan.message, va("begin %i\n", precache_spawncount) );
@@ -1315,8 +1337,10 @@ void CL_Precache_f (void)
 		unsigned	map_checksum;		// for detecting cheater maps
 
 		CM_LoadMap (cl.configstrings[CS_MODELS+1], true, &map_checksum);
+		Asset_BeginLoad ();
 		CL_RegisterSounds ();
 		CL_PrepRefresh ();
+		Asset_EndLoad ();
 		return;
 	}
 
@@ -1359,6 +1383,7 @@ void CL_InitLocal (void)
 	cl_noskins = Cvar_Get ("cl_noskins", "0", 0);
 	cl_autoskins = Cvar_Get ("cl_autoskins", "0", 0);
 	cl_predict = Cvar_Get ("cl_predict", "1", 0);
+	cl_predictCache = Cvar_Get ("cl_predictCache", "1", 0, "Only predict the new commands while the server agrees with the earlier predictions.");
 //	cl_minfps = Cvar_Get ("cl_minfps", "5", 0);
 	cl_maxfps = Cvar_Get ("cl_maxfps", "90", 0);
 
@@ -1379,10 +1404,12 @@ void CL_InitLocal (void)
 
 	cl_shownet = Cvar_Get ("cl_shownet", "0", 0);
 	cl_showmiss = Cvar_Get ("cl_showmiss", "0", 0);
+	cl_showpredict = Cvar_Get ("cl_showpredict", "0", 0, "Print how many commands and traces prediction ran each frame.");
 	cl_showclamp = Cvar_Get ("showclamp", "0", 0);
 	cl_timeout = Cvar_Get ("cl_timeout", "120", 0);
 	cl_paused = Cvar_Get ("paused", "0", 0);
 	cl_timedemo = Cvar_Get ("timedemo", "0", 0);
+	cl_downloadRate = Cvar_Get ("cl_downloadRate", "4096", CVAR_ARCHIVE, "KB/s to ask the server to send downloads at, 0 = old style downloads through the netchan.");
 
 	rcon_client_password = Cvar_Get ("rcon_password", "", 0);
 	rcon_address = Cvar_Get ("rcon_address", "", 0);
@@ -1632,21 +1659,27 @@ void CL_Frame( int msec )
 		cls.netchan.last_received = Sys_Milliseconds();
 	}
 
+	CL_TimedemoBeginFrame ();
+
 	// fetch results from server
+	int64 start = Time_Microseconds ();
 	CL_ReadPackets ();
+	CL_TimedemoAddTime (TD_PARSE, start);
 
 	// send a new command message to the server
 	CL_SendCommand ();
 
 	// predict all unacknowledged movements
+	start = Time_Microseconds ();
 	CL_PredictMovement ();
+	CL_TimedemoAddTime (TD_PREDICT, start);
 
 	// allow rendering DLL change
 	if ( !cl.refresh_prepped && cls.state == ca_active ) {
 		CL_PrepRefresh();
 	}
 
-	// update the screen
+	// update the screen, V_RenderView splits this into scene and render
 	if (com_speeds->GetBool())
 		time_before_ref = Sys_Milliseconds ();
 	SCR_UpdateScreen ();
@@ -1654,17 +1687,23 @@ void CL_Frame( int msec )
 		time_after_ref = Sys_Milliseconds ();
 
 	// update audio
+	start = Time_Microseconds ();
 	S_Update (cl.refdef.vieworg, cl.v_forward, cl.v_right, cl.v_up);
 	
 	CDAudio_Update();
+	CL_TimedemoAddTime (TD_SOUND, start);
 
 	// advance local effects for next frame
+	start = Time_Microseconds ();
 	cge->Frame();
+	CL_TimedemoAddTime (TD_CGAME, start);
 
 	SCR_RunCinematic ();
 
 //	Com_Printf( "Time:  %d %d %f\n", cl.time, cls.realtime, cls.frametime );
 
+	CL_TimedemoEndFrame ();
+
 	cls.framecount++;
 
 	if ( com_logStats->GetBool() )
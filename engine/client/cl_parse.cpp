@@ -26,7 +26,8 @@ const char *svc_strings[256] =
 	"svc_playerinfo",
 	"svc_packetentities",
 	"svc_deltapacketentities",
-	"svc_frame"
+	"svc_frame",
+	"svc_bulkdownload"
 };
 
 //=============================================================================
@@ -36,6 +37,81 @@ void CL_DownloadFileName(char *dest, int destlen, const char *fn)
 	Q_strcpy_s( dest, destlen, fn );
 }
 
+/*
+===============
+CL_RequestDownload
+
+Servers that don't know about bulk downloads ignore the rate
+===============
+*/
+static void CL_RequestDownload (int offset)
+{
+	MSG_WriteByte (&cls.netchan.message, clc_stringcmd);
+	if (cl_downloadRate->GetInt() > 0)
+		MSG_WriteString (&cls.netchan.message,
+			va("download %s %i %i", cls.downloadname, offset, cl_downloadRate->GetInt()));
+	else if (offset)
+		MSG_WriteString (&cls.netchan.message,
+			va("download %s %i", cls.downloadname, offset));
+	else
+		MSG_WriteString (&cls.netchan.message,
+			va("download %s", cls.downloadname));
+}
+
+/*
+===============
+CL_OpenDownloadFile
+===============
+*/
+static bool CL_OpenDownloadFile (void)
+{
+	char	name[MAX_OSPATH];
+
+	if (cls.download)
+		return true;
+
+	CL_DownloadFileName(name, sizeof(name), cls.downloadtempname);
+
+	FileSystem::CreatePath (name);
+
+	cls.download = FileSystem::OpenFileWrite( name );
+	if (!cls.download)
+	{
+		Com_Printf ("Failed to open %s\n", cls.downloadtempname);
+		return false;
+	}
+
+	return true;
+}
+
+/*
+===============
+CL_FinishDownload
+
+Renames the temp file to its real name and moves on to the next download
+===============
+*/
+static void CL_FinishDownload (void)
+{
+	char	oldn[MAX_OSPATH];
+	char	newn[MAX_OSPATH];
+
+	FileSystem::CloseFile (cls.download);
+
+	// rename the temp file to it's final name
+	CL_DownloadFileName(oldn, sizeof(oldn), cls.downloadtempname);
+	CL_DownloadFileName(newn, sizeof(newn), cls.downloadname);
+	if (rename (oldn, newn))
+		Com_Printf ("failed to rename.\n");
+
+	cls.download = NULL;
+	cls.downloadpercent = 0;
+
+	// get another file if needed
+
+	CL_RequestNextDownload ();
+}
+
 /*
 ===============
 CL_CheckOrDownloadFile
@@ -83,14 +159,10 @@ bool CL_CheckOrDownloadFile (const char *filename)
 
 		// give the server an offset to start the download
 		Com_Printf ("Resuming %s\n", cls.downloadname);
-		MSG_WriteByte (&cls.netchan.message, clc_stringcmd);
-		MSG_WriteString (&cls.netchan.message,
-			va("download %s %i", cls.downloadname, len));
+		CL_RequestDownload (len);
 	} else {
 		Com_Printf ("Downloading %s\n", cls.downloadname);
-		MSG_WriteByte (&cls.netchan.message, clc_stringcmd);
-		MSG_WriteString (&cls.netchan.message,
-			va("download %s", cls.downloadname));
+		CL_RequestDownload (0);
 	}
 
 	cls.downloadnumber++;
@@ -138,9 +210,7 @@ void	CL_Download_f (void)
 	COM_StripExtension (cls.downloadname, cls.downloadtempname);
 	strcat (cls.downloadtempname, ".tmp");
 
-	MSG_WriteByte (&cls.netchan.message, clc_stringcmd);
-	MSG_WriteString (&cls.netchan.message,
-		va("download %s", cls.downloadname));
+	CL_RequestDownload (0);
 
 	cls.downloadnumber++;
 }
@@ -176,8 +246,6 @@ A download message has been received from the server
 void CL_ParseDownload (void)
 {
 	int		size, percent;
-	char	name[MAX_OSPATH];
-	int		r;
 
 	// read the data
 	size = MSG_ReadShort (&net_message);
@@ -196,20 +264,11 @@ void CL_ParseDownload (void)
 	}
 
 	// open the file if not opened yet
-	if (!cls.download)
+	if (!CL_OpenDownloadFile ())
 	{
-		CL_DownloadFileName(name, sizeof(name), cls.downloadtempname);
-
-		FileSystem::CreatePath (name);
-
-		cls.download = FileSystem::OpenFileWrite( name );
-		if (!cls.download)
-		{
-			net_message.readcount += size;
-			Com_Printf ("Failed to open %s\n", cls.downloadtempname);
-			CL_RequestNextDownload ();
-			return;
-		}
+		net_message.readcount += size;
+		CL_RequestNextDownload ();
+		return;
 	}
 
 	FileSystem::WriteFile (net_message.data + net_message.readcount, size, cls.download);
@@ -234,29 +293,99 @@ void CL_ParseDownload (void)
 	}
 	else
 	{
-		char	oldn[MAX_OSPATH];
-		char	newn[MAX_OSPATH];
-
 //		Com_Printf ("100%%\n");
 
-		FileSystem::CloseFile (cls.download);
-
-		// rename the temp file to it's final name
-		CL_DownloadFileName(oldn, sizeof(oldn), cls.downloadtempname);
-		CL_DownloadFileName(newn, sizeof(newn), cls.downloadname);
-		r = rename (oldn, newn);
-		if (r)
-			Com_Printf ("failed to rename.\n");
+		CL_FinishDownload ();
+	}
+}
 
-		cls.download = NULL;
-		cls.downloadpercent = 0;
+/*
+=====================
+CL_ParseBulkDownload
 
-		// get another file if needed
+The server is about to send a file as bulk fragments
+=====================
+*/
+static void CL_ParseBulkDownload (void)
+{
+	const int id = MSG_ReadLong (&net_message);
+	const int size = MSG_ReadLong (&net_message);
+	const int offset = MSG_ReadLong (&net_message);
 
+	if (!CL_OpenDownloadFile ())
+	{
+		// the server gives up when the acks stop
+		cls.downloadBulk.active = false;
 		CL_RequestNextDownload ();
+		return;
+	}
+
+	Bulk_BeginReceive (&cls.downloadBulk, id, size, offset);
+
+	if (Bulk_ReceiveComplete (&cls.downloadBulk))
+	{
+		// we already had all of it
+		cls.downloadBulk.active = false;
+		cls.downloadBulk.ackPending = true;
+		CL_FinishDownload ();
 	}
 }
 
+static void CL_WriteBulkData (void *params, const byte *data, int length)
+{
+	const bulkReceiver_t *r = &cls.downloadBulk;
+
+	FileSystem::WriteFile (data, length, cls.download);
+	cls.downloadpercent = r->numFragments ? (r->base + 1) * 100 / r->numFragments : 100;
+}
+
+/*
+=====================
+CL_BulkPacket
+
+A fragment of a bulk download, sent outside the netchan
+=====================
+*/
+void CL_BulkPacket (void)
+{
+	MSG_BeginReading (&net_message);
+	MSG_ReadLong (&net_message);		// BULK_HEADER
+	if (MSG_ReadByte (&net_message) != bulk_fragment)
+		return;
+
+	if (!cls.downloadBulk.active)
+	{
+		// finished, but keep acking in case the server missed the last one
+		if (cls.downloadBulk.id)
+			Bulk_ReadFragment (&cls.downloadBulk, &net_message, CL_WriteBulkData, NULL);
+		return;
+	}
+
+	if (!Bulk_ReadFragment (&cls.downloadBulk, &net_message, CL_WriteBulkData, NULL))
+		return;
+
+	if (Bulk_ReceiveComplete (&cls.downloadBulk))
+	{
+		cls.downloadBulk.active = false;
+		CL_FinishDownload ();
+	}
+}
+
+/*
+=====================
+CL_SendBulkAck
+=====================
+*/
+void CL_SendBulkAck (void)
+{
+	byte		buffer[64];
+	sizebuf_t	msg;
+
+	SZ_Init (&msg, buffer, sizeof(buffer));
+	Bulk_WriteAck (&cls.downloadBulk, &msg, cls.netchan.qport);
+	NET_SendPacket (NS_CLIENT, msg.cursize, msg.data, cls.netchan.remote_address);
+}
+
 
 /*
 =====================================================================
@@ -744,6 +873,10 @@ void CL_ParseServerMessage (void)
 			CL_ParseDownload ();
 			break;
 
+		case svc_bulkdownload:
+			CL_ParseBulkDownload ();
+			break;
+
 		case svc_frame:
 			CL_ParseFrame ();
 			break;
@@ -148,10 +148,16 @@ static void CL_ClipMoveToEntities ( vec3_t start, vec3_t mins, vec3_t maxs, vec3
 	}
 }
 
+// Counted for cl_showpredict
+static int s_predCommands;
+static int s_predTraces;
+
 static trace_t CL_PMTrace( vec3_t start, vec3_t mins, vec3_t maxs, vec3_t end )
 {
 	trace_t	t;
 
+	++s_predTraces;
+
 	// check against world
 	t = CM_BoxTrace( start, end, mins, maxs, 0, MASK_PLAYERSOLID );
 	if ( t.fraction < 1.0f )
@@ -200,6 +206,48 @@ static void CL_PMPlaySound( const char *sample, float volume )
 {
 }
 
+/*
+========================
+CL_PmoveStatesMatch
+
+Only compares what the server sends, the footstep and swim timers never reach the client
+========================
+*/
+static bool CL_PmoveStatesMatch( const pmove_state_t &a, const pmove_state_t &b )
+{
+	return a.pm_type == b.pm_type
+		&& VectorCompare( a.origin, b.origin )
+		&& VectorCompare( a.velocity, b.velocity )
+		&& a.pm_flags == b.pm_flags
+		&& a.pm_time == b.pm_time
+		&& a.gravity == b.gravity
+		&& VectorCompare( a.delta_angles, b.delta_angles );
+}
+
+/*
+========================
+CL_CachedPredictions
+
+Returns the last command whose cached result can be kept, or ack if everything has to be run
+again. The cache holds on while the server ends up where we predicted it would, either it
+hasn't acknowledged anything new or the newly acknowledged command came out the same.
+========================
+*/
+static int CL_CachedPredictions( int ack )
+{
+	if ( !cl_predictCache->GetBool() || cl.predLast == 0 || ack < cl.predAck || ack > cl.predLast ) {
+		return ack;
+	}
+
+	const pmove_state_t &expected = ( ack == cl.predAck ) ? cl.predBase : cl.predMoves[ack & ( CMD_BACKUP - 1 )].s;
+
+	if ( !CL_PmoveStatesMatch( cl.frame.playerstate.pmove, expected ) ) {
+		return ack;
+	}
+
+	return cl.predLast;
+}
+
 /*
 ========================
 CL_PredictMovement
@@ -222,6 +270,8 @@ void CL_PredictMovement()
 
 	if ( !cl_predict->GetBool() || ( cl.frame.playerstate.pmove.pm_flags & PMF_NO_PREDICTION ) )
 	{
+		cl.predLast = 0;
+
 		// just set angles
 		for ( int i = 0; i < 3; ++i )
 		{
@@ -236,6 +286,8 @@ void CL_PredictMovement()
 	// if we are too far out of date, just freeze
 	if ( current - ack >= CMD_BACKUP )
 	{
+		cl.predLast = 0;
+
 		if ( cl_showmiss->GetBool() )
 		{
 			Com_Print( "exceeded CMD_BACKUP\n" );
@@ -253,36 +305,68 @@ void CL_PredictMovement()
 	// copy current state to pmove
 	pm.s = cl.frame.playerstate.pmove;
 
+	// carry on from the cached predictions if they still hold
+	const int cached = CL_CachedPredictions( ack );
+	const predictedMove_t *last = nullptr;
+
+	if ( cached != ack )
+	{
+		last = &cl.predMoves[cached & ( CMD_BACKUP - 1 )];
+		pm.s = last->s;
+	}
+
+	s_predCommands = 0;
+	s_predTraces = 0;
+
 //	SCR_DebugGraph (current - ack - 1, colorBlack);
 
 	// run frames
-	while ( ++ack < current )
+	for ( int sequence = cached + 1; sequence < current; ++sequence )
 	{
-		int frame = ack & ( CMD_BACKUP - 1 );
+		int frame = sequence & ( CMD_BACKUP - 1 );
 
 		// copy over the cmd
 		pm.cmd = cl.cmds[frame];
 
 		// perform the move!
 		cge->Pmove( &pm );
+		++s_predCommands;
+
+		predictedMove_t &move = cl.predMoves[frame];
+		move.s = pm.s;
+		VectorCopy( pm.viewangles, move.viewangles );
+		move.onGround = pm.groundentity != nullptr;
+		last = &move;
 
 		// save for debug checking
 		VectorCopy( pm.s.origin, cl.predicted_origins[frame] );
 	}
 
+	if ( cl_showpredict->GetBool() && s_predCommands > 0 )
+	{
+		Com_Printf( "predict %s: %d cmds, %d traces\n", cached != ack ? "incremental" : "full", s_predCommands, s_predTraces );
+	}
+
+	cl.predAck = ack;
+	cl.predBase = cl.frame.playerstate.pmove;
+	cl.predLast = last ? current - 1 : 0;
+
+	// with nothing to run the server state is used as it is
+	const pmove_state_t &result = last ? last->s : pm.s;
+
 	// calc data for smoothing stair ups
-	int oldframe = ( ack - 2 ) & ( CMD_BACKUP - 1 );
+	int oldframe = ( current - 2 ) & ( CMD_BACKUP - 1 );
 	float oldz = cl.predicted_origins[oldframe][2];
-	float step = pm.s.origin[2] - oldz;
+	float step = result.origin[2] - oldz;
 	float stepFabs = fabs( step );
-	if ( pm.groundentity && stepFabs > 1.0f && stepFabs < 18.0f ) // STEPSIZE
+	if ( last && last->onGround && stepFabs > 1.0f && stepFabs < 18.0f ) // STEPSIZE
 	{
 		cl.predicted_step = step;
 		cl.predicted_step_time = cls.realtime - ( cls.frametime * 100.0f );
 	}
 
-	cl.predMove = pm.s;
+	cl.predMove = result;
 
 	// copy results out for rendering
-	VectorCopy( pm.viewangles, cl.predAngles );
+	VectorCopy( last ? last->viewangles : pm.viewangles, cl.predAngles );
 }
@@ -1247,7 +1247,16 @@ void SCR_UpdateScreen()
 		return;
 	}
 
+	// timedemos without rendering only want the scene built
+	if ( CL_TimedemoSkipRender() && cl.cinematictime <= 0 )
+	{
+		V_RenderView();
+		return;
+	}
+
+	const int64 beginStart = Time_Microseconds();
 	R_BeginFrame( true );
+	CL_TimedemoAddTime( TD_RENDER, beginStart );
 
 	if ( scr.drawLoading == 2 )
 	{
@@ -1314,5 +1323,7 @@ void SCR_UpdateScreen()
 		SCR_DrawLoading();
 	}
 
+	const int64 endStart = Time_Microseconds();
 	R_EndFrame( true );
+	CL_TimedemoAddTime( TD_RENDER, endStart );
 }
@@ -0,0 +1,236 @@
+/*
+===================================================================================================
+
+	Timedemo profiling
+
+	While timedemo is set every client frame is timed, split up into the parts of CL_Frame that
+	matter for a demo. When the demo ends a summary with percentiles, a histogram and the cost of
+	each part is printed, cl_timedemoLog appends it to a file so builds can be compared.
+
+	cl_timedemoRender 0 still builds the scene every frame but skips everything that talks to GL,
+	so the client side cost can be measured without the driver in the way.
+
+===================================================================================================
+*/
+
+#include "cl_local.h"
+
+#include <algorithm>
+#include <vector>
+
+static StaticCvar cl_timedemoRender( "cl_timedemoRender", "1", 0, "If false, timedemos build the scene but don't submit anything to GL." );
+static StaticCvar cl_timedemoLog( "cl_timedemoLog", "", 0, "File that timedemo summaries are appended to." );
+
+static const char *s_phaseNames[TD_NUM_PHASES]
+{
+	"parse",
+	"predict",
+	"scene",
+	"render",
+	"sound",
+	"cgame",
+	"other"
+};
+
+struct timedemoFrame_t
+{
+	int32		total;					// usec
+	int32		phases[TD_NUM_PHASES];
+};
+
+static std::vector<timedemoFrame_t>	s_frames;
+static timedemoFrame_t				s_frame;
+static int64						s_frameStart;
+static bool							s_inFrame;
+
+/*
+========================
+CL_TimedemoActive
+========================
+*/
+bool CL_TimedemoActive()
+{
+	return cl_timedemo->GetBool() && cls.state == ca_active && cl.refresh_prepped;
+}
+
+/*
+========================
+CL_TimedemoSkipRender
+========================
+*/
+bool CL_TimedemoSkipRender()
+{
+	return cl_timedemo->GetBool() && !cl_timedemoRender.GetBool();
+}
+
+/*
+========================
+CL_TimedemoBeginFrame
+========================
+*/
+void CL_TimedemoBeginFrame()
+{
+	if ( !CL_TimedemoActive() ) {
+		s_inFrame = false;
+		return;
+	}
+
+	memset( &s_frame, 0, sizeof( s_frame ) );
+	s_frameStart = Time_Microseconds();
+	s_inFrame = true;
+}
+
+/*
+========================
+CL_TimedemoAddTime
+
+Charges the time since start to a phase
+========================
+*/
+void CL_TimedemoAddTime( timedemoPhase_t phase, int64 start )
+{
+	if ( s_inFrame ) {
+		s_frame.phases[phase] += static_cast<int32>( Time_Microseconds() - start );
+	}
+}
+
+/*
+========================
+CL_TimedemoEndFrame
+========================
+*/
+void CL_TimedemoEndFrame()
+{
+	if ( !s_inFrame ) {
+		return;
+	}
+	s_inFrame = false;
+
+	s_frame.total = static_cast<int32>( Time_Microseconds() - s_frameStart );
+
+	int32 accounted = 0;
+	for ( int i = 0; i < TD_OTHER; ++i )
+	{
+		accounted += s_frame.phases[i];
+	}
+	s_frame.phases[TD_OTHER] = Max( 0, s_frame.total - accounted );
+
+	s_frames.push_back( s_frame );
+}
+
+static double CL_Percentile( std::vector<int32> &values, double fraction )
+{
+	const size_t n = Min( values.size() - 1, static_cast<size_t>( fraction * values.size() ) );
+	std::nth_element( values.begin(), values.begin() + n, values.end() );
+	return values[n] * 0.001;
+}
+
+static void CL_TimedemoPrint( fsHandle_t log, _Printf_format_string_ const char *fmt, ... )
+{
+	char buffer[256];
+	va_list args;
+
+	va_start( args, fmt );
+	Q_vsprintf_s( buffer, fmt, args );
+	va_end( args );
+
+	Com_Print( buffer );
+	if ( log ) {
+		FileSystem::PrintFile( buffer, log );
+	}
+}
+
+/*
+========================
+CL_TimedemoReport
+
+Prints the summary for the frames since the last report and starts over
+========================
+*/
+void CL_TimedemoReport()
+{
+	static const int bucketLimits[] = { 1, 2, 4, 8, 12, 16, 25, 33, 50, 100 };		// msec
+	constexpr int numBuckets = countof( bucketLimits ) + 1;
+
+	if ( s_frames.empty() ) {
+		return;
+	}
+
+	fsHandle_t log = nullptr;
+	if ( cl_timedemoLog.GetString()[0] ) {
+		log = FileSystem::OpenFileAppend( cl_timedemoLog.GetString() );
+	}
+
+	const int numFrames = static_cast<int>( s_frames.size() );
+	std::vector<int32> values( numFrames );
+
+	int64 totalTime = 0;
+	int buckets[numBuckets]{};
+	for ( int i = 0; i < numFrames; ++i )
+	{
+		const int32 usec = s_frames[i].total;
+		values[i] = usec;
+		totalTime += usec;
+
+		int bucket = 0;
+		while ( bucket < numBuckets - 1 && usec >= bucketLimits[bucket] * 1000 ) {
+			++bucket;
+		}
+		buckets[bucket]++;
+	}
+
+	const double seconds = totalTime * 0.000001;
+	const double avg = totalTime * 0.001 / numFrames;
+	const double p50 = CL_Percentile( values, 0.50 );
+	const double p95 = CL_Percentile( values, 0.95 );
+	const double p99 = CL_Percentile( values, 0.99 );
+	const double worst = *std::max_element( values.begin(), values.end() ) * 0.001;
+
+	CL_TimedemoPrint( log, "timedemo: %d frames, %.2f seconds, %.1f fps%s\n", numFrames, seconds,
+		seconds > 0.0 ? numFrames / seconds : 0.0, CL_TimedemoSkipRender() ? " (no render)" : "" );
+	CL_TimedemoPrint( log, "frame msec: avg %.2f  p50 %.2f  p95 %.2f  p99 %.2f  max %.2f\n", avg, p50, p95, p99, worst );
+
+	CL_TimedemoPrint( log, "%-8s %8s %8s %6s\n", "", "avg", "p99", "share" );
+	for ( int phase = 0; phase < TD_NUM_PHASES; ++phase )
+	{
+		int64 phaseTime = 0;
+		for ( int i = 0; i < numFrames; ++i )
+		{
+			values[i] = s_frames[i].phases[phase];
+			phaseTime += values[i];
+		}
+
+		CL_TimedemoPrint( log, "%-8s %8.3f %8.3f %5.1f%%\n", s_phaseNames[phase], phaseTime * 0.001 / numFrames,
+			CL_Percentile( values, 0.99 ), totalTime ? 100.0 * phaseTime / totalTime : 0.0 );
+	}
+
+	int mostInBucket = 1;
+	for ( int count : buckets )
+	{
+		mostInBucket = Max( mostInBucket, count );
+	}
+
+	for ( int bucket = 0; bucket < numBuckets; ++bucket )
+	{
+		char label[16];
+		if ( bucket < numBuckets - 1 ) {
+			Q_sprintf_s( label, "<%d", bucketLimits[bucket] );
+		} else {
+			Q_sprintf_s( label, ">=%d", bucketLimits[bucket - 1] );
+		}
+
+		char bar[41];
+		const int length = buckets[bucket] * ( sizeof( bar ) - 1 ) / mostInBucket;
+		memset( bar, '#', length );
+		bar[length] = '\0';
+
+		CL_TimedemoPrint( log, "%5s ms %6d %s\n", label, buckets[bucket], bar );
+	}
+
+	if ( log ) {
+		FileSystem::PrintFile( "\n", log );
+		FileSystem::CloseFile( log );
+	}
+
+	s_frames.clear();
+}
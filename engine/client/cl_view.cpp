@@ -84,6 +84,17 @@ void V_AddParticle( vec3_t org, int color, float alpha )
 	p.alpha = alpha;
 }
 
+void V_AddParticles( const particle_t *particles, int count )
+{
+	count = Min( count, MAX_PARTICLES - clView.numParticles );
+	if ( count <= 0 ) {
+		return;
+	}
+
+	memcpy( clView.particles + clView.numParticles, particles, count * sizeof( particle_t ) );
+	clView.numParticles += count;
+}
+
 void V_AddLightStyle( int style, float r, float g, float b )
 {
 	if ( style < 0 || style >= MAX_LIGHTSTYLES ) {
@@ -242,6 +253,20 @@ void CL_PrepRefresh()
 
 	// precache models
 
+	// read the model files on the job workers while the loop below sets them up
+	const char *modelNames[MAX_MODELS];
+	uint32 numModelNames = 0;
+
+	for ( int i = 1; i < MAX_MODELS && cl.configstrings[CS_MODELS + i][0]; i++ )
+	{
+		const char *modelName = cl.configstrings[CS_MODELS + i];
+		if ( modelName[0] != '*' && modelName[0] != '#' ) {
+			modelNames[numModelNames++] = modelName;
+		}
+	}
+
+	Asset_Prefetch( modelNames, numModelNames );
+
 	for ( int i = 1; i < MAX_MODELS && cl.configstrings[CS_MODELS + i][0]; i++ )
 	{
 		const char *modelName = cl.configstrings[CS_MODELS + i];
@@ -430,6 +455,8 @@ void V_RenderView()
 		cl.timedemo_frames++;
 	}
 
+	int64 start = Time_Microseconds();
+
 	// an invalid frame will just use the exact previous refdef
 	// we can't use the old frame if the video mode has changed, though...
 	if ( cl.frame.valid && ( cl.force_refdef || !cl_paused->GetBool() ) )
@@ -506,7 +533,14 @@ void V_RenderView()
 		qsort( clView.entities, clView.numEntities, sizeof( entity_t ), ( int ( * )( const void *, const void * ) )entitycmpfnc );
 	}
 
-	R_RenderFrame( &cl.refdef );
+	CL_TimedemoAddTime( TD_SCENE, start );
+
+	if ( !CL_TimedemoSkipRender() )
+	{
+		start = Time_Microseconds();
+		R_RenderFrame( &cl.refdef );
+		CL_TimedemoAddTime( TD_RENDER, start );
+	}
 
 	if ( v_stats->GetBool() ) {
 		Com_Printf( "ent:%i  lt:%i  part:%i\n", clView.numEntities, clView.numDLights, clView.numParticles );
@@ -2,6 +2,8 @@
 
 #include "snd_local.h"
 
+#include <algorithm>
+
 void S_Play(void);
 void S_SoundList(void);
 void S_Update_();
@@ -57,6 +59,12 @@ cvar_t		*s_khz;
 cvar_t		*s_show;
 cvar_t		*s_mixahead;
 cvar_t		*s_primary;
+cvar_t		*s_mixjobs;
+cvar_t		*s_resample;
+cvar_t		*s_cachesize;
+cvar_t		*s_streamsize;
+
+sampleCacheStats_t	s_sampleCache;
 
 
 int		s_rawend;
@@ -109,11 +117,17 @@ void S_Init (void)
 		s_show = Cvar_Get ("s_show", "0", 0);
 		s_testsound = Cvar_Get ("s_testsound", "0", 0);
 		s_primary = Cvar_Get ("s_primary", "0", CVAR_ARCHIVE);	// win32 specific
+		s_mixjobs = Cvar_Get ("s_mixjobs", "1", CVAR_ARCHIVE, "Mix groups of channels on the job system when lots are playing.");
+		s_resample = Cvar_Get ("s_resample", "1", CVAR_ARCHIVE, "Resampler used when loading sounds, 0 = nearest sample, 1 = band-limited polyphase.");
+		s_cachesize = Cvar_Get ("s_cachesize", "64", CVAR_ARCHIVE, "Megabytes of samples kept loaded before the least recently used are evicted, 0 = no limit.");
+		s_streamsize = Cvar_Get ("s_streamsize", "2048", CVAR_ARCHIVE, "Sounds bigger than this many kilobytes decoded are streamed instead, 0 = never stream.");
 
 		Cmd_AddCommand("play", S_Play);
 		Cmd_AddCommand("stopsound", S_StopAllSounds);
 		Cmd_AddCommand("soundlist", S_SoundList);
 		Cmd_AddCommand("soundinfo", S_SoundInfo_f);
+		Cmd_AddCommand("soundmixstats", S_MixStats_f);
+		Cmd_AddCommand("soundtestmix", S_TestMix_f);
 
 		if (!SNDDMA_Init())
 			return;
@@ -122,6 +136,9 @@ void S_Init (void)
 
 		sound_started = 1;
 		num_sfx = 0;
+		memset( &s_sampleCache, 0, sizeof( s_sampleCache ) );
+
+		S_InitStreaming();
 
 		soundtime = 0;
 		paintedtime = 0;
@@ -155,20 +172,22 @@ void S_Shutdown(void)
 	Cmd_RemoveCommand("stopsound");
 	Cmd_RemoveCommand("soundlist");
 	Cmd_RemoveCommand("soundinfo");
+	Cmd_RemoveCommand("soundmixstats");
 
 	// free all sounds
 	for (i=0, sfx=known_sfx ; i < num_sfx ; i++,sfx++)
 	{
 		if (!sfx->name[0])
 			continue;
-		if (sfx->cache)
-			Mem_Free (sfx->cache);
+		S_FreeSfxCache (sfx);
 		if (sfx->truename)
 			Mem_Free(sfx->truename);
 		memset (sfx, 0, sizeof(*sfx));
 	}
 
 	num_sfx = 0;
+
+	S_ShutdownStreaming();
 }
 
 // =======================================================================
@@ -323,8 +342,8 @@ void S_EndRegistration (void)
 			continue;
 		if (sfx->registration_sequence != s_registration_sequence)
 		{	// don't need this sound
-			if (sfx->cache)	// it is possible to have a leftover
-				Mem_Free (sfx->cache);	// from a server that didn't finish loading
+			// it is possible to have a leftover from a server that didn't finish loading
+			S_FreeSfxCache (sfx);
 			memset (sfx, 0, sizeof(*sfx));
 		}
 #if 0
@@ -341,16 +360,70 @@ void S_EndRegistration (void)
 	}
 
 	// load everything in
+	std::vector<sfx_t *> sounds;
+	sounds.reserve (num_sfx);
 	for (i=0, sfx=known_sfx ; i < num_sfx ; i++,sfx++)
 	{
 		if (!sfx->name[0])
 			continue;
-		S_LoadSound (sfx);
+		sounds.push_back (sfx);
 	}
+	S_LoadSounds (sounds.data(), (int)sounds.size());
 
 	s_registering = false;
 }
 
+/*
+=====================
+S_TrimSampleCache
+
+=====================
+*/
+void S_TrimSampleCache (sfx_t *keep)
+{
+	const size_t budget = static_cast<size_t>( Max( s_cachesize->GetInt(), 0 ) ) * 1024 * 1024;
+	if (!budget)
+		return;
+
+	if (s_sampleCache.residentBytes <= budget)
+		return;
+
+	// anything playing or waiting to be played would only be loaded again straight away
+	static bool inUse[MAX_SFX];
+	memset (inUse, 0, sizeof(inUse));
+
+	for (int i = 0; i < MAX_CHANNELS; i++)
+	{
+		if (channels[i].sfx)
+			inUse[channels[i].sfx - known_sfx] = true;
+	}
+	for (playsound_t *ps = s_pendingplays.next; ps != &s_pendingplays; ps = ps->next)
+	{
+		if (ps->sfx)
+			inUse[ps->sfx - known_sfx] = true;
+	}
+
+	std::vector<sfx_t *> victims;
+	for (int i = 0; i < num_sfx; i++)
+	{
+		sfx_t *sfx = &known_sfx[i];
+		if (sfx->cache && sfx != keep && !inUse[i])
+			victims.push_back (sfx);
+	}
+
+	std::sort (victims.begin(), victims.end(), [](const sfx_t *a, const sfx_t *b) { return a->lastUsed < b->lastUsed; });
+
+	// if everything left is in use, let it go over
+	for (sfx_t *victim : victims)
+	{
+		if (s_sampleCache.residentBytes <= budget)
+			break;
+
+		S_FreeSfxCache (victim);
+		s_sampleCache.evictions++;
+	}
+}
+
 
 //=============================================================================
 
@@ -836,7 +909,7 @@ void S_AddLoopSounds (void)
 		sfx = cl.sound_precache[sounds[i]];
 		if (!sfx)
 			continue;		// bad sound effect
-		sc = sfx->cache;
+		sc = S_LoadSound (sfx);	// may have been evicted
 		if (!sc)
 			continue;
 
@@ -1167,7 +1240,7 @@ void S_SoundList(void)
 	int		i;
 	sfx_t	*sfx;
 	sfxcache_t	*sc;
-	int		size, total;
+	size_t	total;
 
 	total = 0;
 	for (sfx=known_sfx, i=0 ; i<num_sfx ; i++, sfx++)
@@ -1177,13 +1250,16 @@ void S_SoundList(void)
 		sc = sfx->cache;
 		if (sc)
 		{
-			size = sc->length*sc->width*(sc->stereo+1);
-			total += size;
+			if (!sc->stream)
+				total += sfx->cacheSize;
 			if (sc->loopstart >= 0)
 				Com_Printf ("L");
 			else
 				Com_Printf (" ");
-			Com_Printf("(%2db) %6i : %s\n",sc->width*8,  size, sfx->name);
+			if (sc->stream)
+				Com_Printf("(str) %8zu : %s (%u underruns)\n", sfx->cacheSize, sfx->name, S_StreamUnderruns(sc->stream));
+			else
+				Com_Printf("(%2db) %8zu : %s\n", sc->width*8, sfx->cacheSize, sfx->name);
 		}
 		else
 		{
@@ -1193,6 +1269,8 @@ void S_SoundList(void)
 				Com_Printf("  not loaded  : %s\n", sfx->name);
 		}
 	}
-	Com_Printf ("Total resident: %i\n", total);
+	Com_Printf ("Total resident: %zu, streamed: %zu\n", total, s_sampleCache.residentBytes - total);
+	Com_Printf ("Cache: %zu KB peak, %d KB budget, %u hits, %u loads, %u evictions, %u streams opened\n",
+		s_sampleCache.peakBytes / 1024, s_cachesize->GetInt() * 1024,
+		s_sampleCache.hits, s_sampleCache.loads, s_sampleCache.evictions, s_sampleCache.streams);
 }
-
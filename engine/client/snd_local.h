@@ -10,6 +10,8 @@ struct portable_samplepair_t
 	int			right;
 };
 
+struct sndStream_t;
+
 struct sfxcache_t
 {
 	int 		length;
@@ -17,6 +19,7 @@ struct sfxcache_t
 	int 		speed;			// not needed, because converted on load?
 	int 		width;
 	int 		stereo;
+	sndStream_t	*stream;		// if set, data is empty and samples come from S_ReadStream
 	byte		data[1];		// variable sized
 };
 
@@ -26,6 +29,20 @@ struct sfx_t
 	int			registration_sequence;
 	sfxcache_t	*cache;
 	char 		*truename;
+	uint64		lastUsed;		// S_LoadSound clock, for eviction
+	size_t		cacheSize;		// bytes held by cache
+};
+
+// sample cache accounting, printed by soundlist
+struct sampleCacheStats_t
+{
+	uint64		clock;
+	size_t		residentBytes;
+	size_t		peakBytes;
+	uint32		hits;
+	uint32		loads;
+	uint32		evictions;
+	uint32		streams;
 };
 
 // a playsound_t will be generated by each call to S_StartSound,
@@ -129,8 +146,34 @@ extern cvar_t *s_show;
 extern cvar_t *s_mixahead;
 extern cvar_t *s_testsound;
 extern cvar_t *s_primary;
+extern cvar_t *s_mixjobs;
+extern cvar_t *s_resample;
+extern cvar_t *s_cachesize;
+extern cvar_t *s_streamsize;
+
+extern sampleCacheStats_t s_sampleCache;
+
+#define RESAMPLE_TAPS		16		// filter length in source samples
+#define RESAMPLE_PHASES		64		// fractional positions the filter is tabulated at
+
+struct resampleFilter_t
+{
+	float	taps[RESAMPLE_PHASES + 1][RESAMPLE_TAPS];
+};
+
+// the polyphase filter for converting at stepscale source samples per output sample
+void			S_BuildResampleFilter( resampleFilter_t &filter, double stepscale );
+// output sample at source position pos, in holds source samples [first, first + count),
+// anything outside that is silence
+float			S_ResampleAt( const resampleFilter_t &filter, const float *in, int first, int count, double pos );
 
 sfxcache_t *	S_LoadSound (sfx_t *s);
+void			S_LoadSounds( sfx_t **sounds, int count );
+void			S_FreeSfxCache( sfx_t *s );
+
+// evicts least recently used samples until the cache fits in s_cachesize, never touches keep,
+// anything a channel is playing or anything waiting to be played
+void			S_TrimSampleCache( sfx_t *keep );
 
 void			S_IssuePlaysound (playsound_t *ps);
 
@@ -145,3 +188,15 @@ void			S_Spatialize(channel_t *ch);
 // snd_mix
 
 void			S_InitScaletable();
+void			S_MixStats_f();
+void			S_TestMix_f();
+
+// snd_stream
+
+void			S_InitStreaming();
+void			S_ShutdownStreaming();
+sndStream_t *	S_OpenStream( const char *name, byte *file, fsSize_t size, const wavinfo_t *wav, sfxcache_t *sc );
+void			S_CloseStream( sndStream_t *stream );
+void			S_ReadStream( sndStream_t *stream, int pos, int count, int16 *out );
+size_t			S_StreamMemory( const sndStream_t *stream );
+uint32			S_StreamUnderruns( const sndStream_t *stream );
@@ -2,31 +2,139 @@
 
 #include "snd_local.h"
 
+#include <vector>
+
 #define STB_VORBIS_NO_STDIO
 #define STB_VORBIS_NO_PUSHDATA_API
 #include "../../thirdparty/stb/stb_vorbis.c"
 
+/*
+========================
+S_BuildResampleFilter
+
+Band-limited resampling with a Blackman windowed sinc. When decimating the cutoff
+drops to the output Nyquist frequency so the high end doesn't alias.
+========================
+*/
+void S_BuildResampleFilter( resampleFilter_t &filter, double stepscale )
+{
+	auto &filters = filter.taps;
+
+	// relative to the input Nyquist frequency
+	const double cutoff = stepscale > 1.0 ? 1.0 / stepscale : 1.0;
+	constexpr int halfTaps = RESAMPLE_TAPS / 2;
+
+	for ( int phase = 0; phase <= RESAMPLE_PHASES; ++phase )
+	{
+		const double frac = (double)phase / RESAMPLE_PHASES;
+		double sum = 0.0;
+
+		for ( int k = 0; k < RESAMPLE_TAPS; ++k )
+		{
+			// distance from the output position to source sample (center - halfTaps + 1 + k)
+			const double x = ( k - ( halfTaps - 1 ) ) - frac;
+			const double t = x / halfTaps;
+
+			double h = 0.0;
+			if ( t > -1.0 && t < 1.0 )
+			{
+				const double window = 0.42 + 0.5 * cos( M_PI * t ) + 0.08 * cos( 2.0 * M_PI * t );
+				const double arg = M_PI * cutoff * x;
+				const double sinc = fabs( arg ) < 1e-9 ? 1.0 : sin( arg ) / arg;
+				h = cutoff * sinc * window;
+			}
+
+			filters[phase][k] = static_cast<float>( h );
+			sum += h;
+		}
+
+		// unity gain at DC for every phase
+		for ( int k = 0; k < RESAMPLE_TAPS; ++k )
+		{
+			filters[phase][k] = static_cast<float>( filters[phase][k] / sum );
+		}
+	}
+}
+
+/*
+========================
+S_ResampleAt
+========================
+*/
+float S_ResampleAt( const resampleFilter_t &filter, const float *in, int first, int count, double pos )
+{
+	constexpr int halfTaps = RESAMPLE_TAPS / 2;
+
+	const int center = static_cast<int>( pos );
+	const int phase = static_cast<int>( ( pos - center ) * RESAMPLE_PHASES + 0.5 );
+
+	const float *taps = filter.taps[phase];
+	const int start = center - ( halfTaps - 1 ) - first;
+
+	float acc = 0.0f;
+	if ( start >= 0 && start + RESAMPLE_TAPS <= count )
+	{
+		const float *src = in + start;
+		for ( int k = 0; k < RESAMPLE_TAPS; ++k )
+		{
+			acc += src[k] * taps[k];
+		}
+	}
+	else
+	{
+		// silence past either end
+		for ( int k = 0; k < RESAMPLE_TAPS; ++k )
+		{
+			const int j = start + k;
+			if ( j >= 0 && j < count ) {
+				acc += in[j] * taps[k];
+			}
+		}
+	}
+
+	return acc;
+}
+
+/*
+========================
+ResampleSfx_Polyphase
+========================
+*/
+static void ResampleSfx_Polyphase( const float *in, int incount, double stepscale, int outcount, sfxcache_t *sc )
+{
+	// rebuilt for every sound, decodes run on the job workers
+	resampleFilter_t filter;
+	S_BuildResampleFilter( filter, stepscale );
+
+	for ( int i = 0; i < outcount; ++i )
+	{
+		const float acc = S_ResampleAt( filter, in, 0, incount, i * stepscale );
+		const int sample = static_cast<int>( Clamp( acc, -32768.0f, 32767.0f ) );
+
+		if ( sc->width == 2 ) {
+			( (short *)sc->data )[i] = sample;
+		} else {
+			( (signed char *)sc->data )[i] = sample >> 8;
+		}
+	}
+}
+
 /*
 ========================
 ResampleSfx
 ========================
 */
-static void ResampleSfx( sfx_t *sfx, int inrate, int inwidth, byte *data )
+static void ResampleSfx( sfxcache_t *sc, int inrate, int inwidth, byte *data )
 {
 	int		outcount;
 	int		srcsample;
 	float	stepscale;
 	int		i;
 	int		sample, samplefrac, fracstep; // samplefrac has a tendency to overflow int32 with -huge- audio files
-	sfxcache_t	*sc;
-
-	sc = sfx->cache;
-	if ( !sc ) {
-		return;
-	}
 
 	stepscale = (float)inrate / dma.speed; // this is usually 0.5, 1, or 2
 
+	const int incount = sc->length;
 	outcount = sc->length / stepscale;
 	sc->length = outcount;
 	if ( sc->loopstart != -1 )
@@ -46,6 +154,21 @@ static void ResampleSfx( sfx_t *sfx, int inrate, int inwidth, byte *data )
 			( (signed char *)sc->data )[i] = (int)( (unsigned char)( data[i] ) - 128 );
 		}
 	}
+	else if ( stepscale != 1 && s_resample->GetBool() )
+	{
+		std::vector<float> samples( incount );
+
+		for ( i = 0; i < incount; i++ )
+		{
+			if ( inwidth == 2 ) {
+				samples[i] = LittleShort( ( (short *)data )[i] );
+			} else {
+				samples[i] = (int)( (unsigned char)( data[i] ) - 128 ) << 8;
+			}
+		}
+
+		ResampleSfx_Polyphase( samples.data(), incount, (double)inrate / dma.speed, outcount, sc );
+	}
 	else
 	{
 		// general case
@@ -87,66 +210,70 @@ WAV loading
 ===============================================================================
 */
 
-byte	*data_p;
-byte 	*iff_end;
-byte 	*last_chunk;
-byte 	*iff_data;
-int 	iff_chunk_len;
-
-static short GetLittleShort()
+// parser state, one per file so sounds can be loaded on several threads
+struct iffParser_t
+{
+	byte *	data_p;
+	byte *	iff_end;
+	byte *	last_chunk;
+	byte *	iff_data;
+	int		iff_chunk_len;
+};
+
+static short GetLittleShort( iffParser_t &iff )
 {
 	short val = 0;
-	val = *data_p;
-	val = val + ( *( data_p + 1 ) << 8 );
-	data_p += 2;
+	val = *iff.data_p;
+	val = val + ( *( iff.data_p + 1 ) << 8 );
+	iff.data_p += 2;
 	return val;
 }
 
-static int GetLittleLong()
+static int GetLittleLong( iffParser_t &iff )
 {
 	int val = 0;
-	val = *data_p;
-	val = val + ( *( data_p + 1 ) << 8 );
-	val = val + ( *( data_p + 2 ) << 16 );
-	val = val + ( *( data_p + 3 ) << 24 );
-	data_p += 4;
+	val = *iff.data_p;
+	val = val + ( *( iff.data_p + 1 ) << 8 );
+	val = val + ( *( iff.data_p + 2 ) << 16 );
+	val = val + ( *( iff.data_p + 3 ) << 24 );
+	iff.data_p += 4;
 	return val;
 }
 
-static void FindNextChunk( const char *name )
+static void FindNextChunk( iffParser_t &iff, const char *name )
 {
 	while ( 1 )
 	{
-		data_p = last_chunk;
+		iff.data_p = iff.last_chunk;
 
-		if ( data_p >= iff_end )
+		if ( iff.data_p >= iff.iff_end )
 		{
 			// didn't find the chunk
-			data_p = nullptr;
+			iff.data_p = nullptr;
 			return;
 		}
 
-		data_p += 4;
-		iff_chunk_len = GetLittleLong();
-		if ( iff_chunk_len < 0 )
+		iff.data_p += 4;
+		iff.iff_chunk_len = GetLittleLong( iff );
+		if ( iff.iff_chunk_len < 0 )
 		{
-			data_p = nullptr;
+			iff.data_p = nullptr;
 			return;
 		}
 
-		data_p -= 8;
-		last_chunk = data_p + 8 + ( ( iff_chunk_len + 1 ) & ~1 );
-		if ( Q_strncmp( (char*)data_p, name, 4 ) == 0 )
+		iff.data_p -= 8;
+		iff.last_chunk = iff.data_p + 8 + ( ( iff.iff_chunk_len + 1 ) & ~1 );
+		if ( Q_strncmp( (char*)iff.data_p, name, 4 ) == 0 )
 		{
 			return;
 		}
 	}
 }
 
-static void FindChunk( const char *name )
+static void FindChunk( iffParser_t &iff, const char *name )
 {
-	last_chunk = iff_data;
-	FindNextChunk( name );
+	iff.last_chunk = iff.iff_data;
+	FindNextChunk( iff, name );
 }
 
 /*
@@ -160,6 +287,7 @@ static wavinfo_t GetWavinfo( const char *name, byte *wav, int wavlength )
 	int     i;
 	int     format;
 	int		samples;
+	iffParser_t	iff;
 
 	memset( &info, 0, sizeof( info ) );
 
@@ -167,55 +295,55 @@ static wavinfo_t GetWavinfo( const char *name, byte *wav, int wavlength )
 		return info;
 	}
 
-	iff_data = wav;
-	iff_end = wav + wavlength;
+	iff.iff_data = wav;
+	iff.iff_end = wav + wavlength;
 
 	// find "RIFF" chunk
-	FindChunk( "RIFF" );
-	if ( !( data_p && !Q_strncmp( (char*)( data_p + 8 ), "WAVE", 4 ) ) )
+	FindChunk( iff, "RIFF" );
+	if ( !( iff.data_p && !Q_strncmp( (char*)( iff.data_p + 8 ), "WAVE", 4 ) ) )
 	{
 		Com_Printf( "Missing RIFF/WAVE chunks\n" );
 		return info;
 	}
 
 	// get "fmt " chunk
-	iff_data = data_p + 12;
+	iff.iff_data = iff.data_p + 12;
 
-	FindChunk( "fmt " );
-	if ( !data_p )
+	FindChunk( iff, "fmt " );
+	if ( !iff.data_p )
 	{
 		Com_Printf( "Missing fmt chunk\n" );
 		return info;
 	}
-	data_p += 8;
-	format = GetLittleShort();
+	iff.data_p += 8;
+	format = GetLittleShort( iff );
 	if ( format != 1 )
 	{
 		Com_Printf( "Microsoft PCM format only\n" );
 		return info;
 	}
 
-	info.channels = GetLittleShort();
-	info.rate = GetLittleLong();
-	data_p += 4 + 2;
-	info.width = GetLittleShort() / 8;
+	info.channels = GetLittleShort( iff );
+	info.rate = GetLittleLong( iff );
+	iff.data_p += 4 + 2;
+	info.width = GetLittleShort( iff ) / 8;
 
 // get cue chunk
-	FindChunk( "cue " );
-	if ( data_p )
+	FindChunk( iff, "cue " );
+	if ( iff.data_p )
 	{
-		data_p += 32;
-		info.loopstart = GetLittleLong();
+		iff.data_p += 32;
+		info.loopstart = GetLittleLong( iff );
 //		Com_Printf("loopstart=%d\n", sfx->loopstart);
 
 		// if the next chunk is a LIST chunk, look for a cue length marker
-		FindNextChunk( "LIST" );
-		if ( data_p )
+		FindNextChunk( iff, "LIST" );
+		if ( iff.data_p )
 		{
-			if ( !Q_strncmp( (char*)data_p + 28, "mark", 4 ) )
+			if ( !Q_strncmp( (char*)iff.data_p + 28, "mark", 4 ) )
 			{	// this is not a proper parse, but it works with cooledit...
-				data_p += 24;
-				i = GetLittleLong();	// samples in loop
+				iff.data_p += 24;
+				i = GetLittleLong( iff );	// samples in loop
 				info.samples = info.loopstart + i;
 //				Com_Printf("looped length: %i\n", i);
 			}
@@ -225,25 +353,29 @@ static wavinfo_t GetWavinfo( const char *name, byte *wav, int wavlength )
 		info.loopstart = -1;
 
 // find data chunk
-	FindChunk( "data" );
-	if ( !data_p )
+	FindChunk( iff, "data" );
+	if ( !iff.data_p )
 	{
 		Com_Printf( "Missing data chunk\n" );
 		return info;
 	}
 
-	data_p += 4;
-	samples = GetLittleLong() / info.width;
+	iff.data_p += 4;
+	samples = GetLittleLong( iff ) / info.width;
 
 	if ( info.samples )
 	{
 		if ( samples < info.samples )
-			Com_Errorf( "Sound %s has a bad loop length", name );
+		{
+			Com_Printf( "Sound %s has a bad loop length\n", name );
+			memset( &info, 0, sizeof( info ) );
+			return info;
+		}
 	}
 	else
 		info.samples = samples;
 
-	info.dataofs = data_p - wav;
+	info.dataofs = iff.data_p - wav;
 
 	return info;
 }
@@ -252,60 +384,148 @@ static wavinfo_t GetWavinfo( const char *name, byte *wav, int wavlength )
 
 /*
 ========================
-S_LoadSound
+S_StreamThreshold
+
+Decoded size in bytes above which sounds are streamed, 0 if streaming is off
 ========================
 */
-sfxcache_t *S_LoadSound( sfx_t *s )
+static size_t S_StreamThreshold()
 {
-	char	namebuffer[MAX_QPATH];
-	byte	*data;
-	int		len;
-	float	stepscale;
-	sfxcache_t	*sc;
-	char	*name;
+	return static_cast<size_t>( Max( s_streamsize->GetInt(), 0 ) ) * 1024;
+}
 
-	if ( s->name[0] == '*' ) {
-		return NULL;
-	}
+/*
+========================
+S_CacheLoaded
 
-	// see if still in memory
-	sc = s->cache;
-	if ( sc ) {
-		return sc;
+Accounts for a freshly loaded sample and makes room for it
+========================
+*/
+static void S_CacheLoaded( sfx_t *s, size_t bytes )
+{
+	s->cacheSize = bytes;
+	s->lastUsed = ++s_sampleCache.clock;
+
+	s_sampleCache.residentBytes += bytes;
+	s_sampleCache.peakBytes = Max( s_sampleCache.peakBytes, s_sampleCache.residentBytes );
+	++s_sampleCache.loads;
+
+	S_TrimSampleCache( s );
+}
+
+/*
+========================
+S_StreamSound
+========================
+*/
+static sfxcache_t *S_StreamSound( sfx_t *s, const char *name, byte *data, fsSize_t size, const wavinfo_t *wav )
+{
+	sfxcache_t *sc = (sfxcache_t *)Mem_Alloc( sizeof( sfxcache_t ) );
+	if ( !sc )
+	{
+		FileSystem::FreeFile( data );
+		return nullptr;
 	}
 
-	// load it in
-	if ( s->truename ) {
-		name = s->truename;
-	} else {
-		name = s->name;
+	sc->stream = S_OpenStream( name, data, size, wav, sc );
+	if ( !sc->stream )
+	{
+		Mem_Free( sc );
+		FileSystem::FreeFile( data );
+		return nullptr;
 	}
 
+	s->cache = sc;
+	++s_sampleCache.streams;
+	S_CacheLoaded( s, sizeof( sfxcache_t ) + S_StreamMemory( sc->stream ) );
+
+	return sc;
+}
+
+/*
+===============================================================================
+
+Loading
+
+A sound is read and decoded by S_DecodeSound, which only touches the load and
+can run on the job workers, then S_FinishSound hands it to the cache on the
+main thread.
+
+===============================================================================
+*/
+
+struct soundLoad_t
+{
+	sfx_t *		sfx;
+	char		name[MAX_QPATH];	// path in the filesystem
+	byte *		data;				// the file, kept if it's streamed
+	fsSize_t	size;
+	wavinfo_t	info;
+	bool		isWav;
+	bool		stream;
+	sfxcache_t *sc;					// decoded sound
+	size_t		bytes;				// size of sc
+	int64		readTime;
+	int64		decodeTime;
+};
+
+/*
+========================
+S_SetupSoundLoad
+========================
+*/
+static void S_SetupSoundLoad( sfx_t *s, soundLoad_t &load )
+{
+	memset( &load, 0, sizeof( load ) );
+	load.sfx = s;
+
+	const char *name = s->truename ? s->truename : s->name;
+
 	if ( name[0] == '#' ) {
-		Q_strcpy_s( namebuffer, name + 1 );
+		Q_strcpy_s( load.name, name + 1 );
 	} else {
-		Q_sprintf_s( namebuffer, "sound/%s", name );
+		Q_sprintf_s( load.name, "sound/%s", name );
 	}
+}
+
+/*
+========================
+S_DecodeSound
+========================
+*/
+static void S_DecodeSound( soundLoad_t &load )
+{
+	byte	*data;
+	int		len;
+	float	stepscale;
+	sfxcache_t	*sc;
+
+	//Com_Printf ("loading %s\n",load.name);
 
-	//Com_Printf ("loading %s\n",namebuffer);
+	int64 start = Time_Microseconds();
 
-	fsSize_t size = FileSystem::LoadFile (namebuffer, (void **)&data);
+	fsSize_t size = FileSystem::LoadFile( load.name, (void **)&data );
 	if ( !data )
 	{
-		Com_Printf( "Couldn't load %s\n", namebuffer );
-		return nullptr;
+		Com_Printf( "Couldn't load %s\n", load.name );
+		return;
 	}
 
+	load.readTime = Time_Microseconds() - start;
+	start = Time_Microseconds();
+
+	const size_t streamThreshold = S_StreamThreshold();
+
 	if ( IsWav( data ) )
 	{
 		wavinfo_t info;
 
-		info = GetWavinfo( s->name, data, size );
+		info = GetWavinfo( load.sfx->name, data, size );
 		if ( info.channels != 1 )
 		{
 			FileSystem::FreeFile( data );
-			Com_Printf( "%s is a stereo sample\n", s->name );
-			return nullptr;
+			Com_Printf( "%s is a stereo sample\n", load.sfx->name );
+			return;
 		}
 
 		stepscale = (float)info.rate / dma.speed;
@@ -313,11 +533,23 @@ sfxcache_t *S_LoadSound( sfx_t *s )
 
 		len = len * info.width * info.channels;
 
-		sc = s->cache = (sfxcache_t *)Mem_Alloc( len + sizeof( sfxcache_t ) );
+		if ( streamThreshold && (size_t)len > streamThreshold )
+		{
+			// the file is kept, so it's no bigger than decoding it all
+			load.data = data;
+			load.size = size;
+			load.info = info;
+			load.isWav = true;
+			load.stream = true;
+			load.decodeTime = Time_Microseconds() - start;
+			return;
+		}
+
+		sc = (sfxcache_t *)Mem_Alloc( len + sizeof( sfxcache_t ) );
 		if ( !sc )
 		{
 			FileSystem::FreeFile( data );
-			return nullptr;
+			return;
 		}
 
 		sc->length = info.samples;
@@ -325,28 +557,52 @@ sfxcache_t *S_LoadSound( sfx_t *s )
 		sc->speed = info.rate;
 		sc->width = info.width;
 		sc->stereo = info.channels;
+		sc->stream = nullptr;
 
-		ResampleSfx( s, sc->speed, sc->width, data + info.dataofs );
+		ResampleSfx( sc, sc->speed, sc->width, data + info.dataofs );
 
 		FileSystem::FreeFile( data );
 	}
 	else if ( IsOgg( data ) )
 	{
+		if ( streamThreshold )
+		{
+			// peek at the header to see how big it would be decoded
+			int error;
+			stb_vorbis *vorbis = stb_vorbis_open_memory( data, size, &error, nullptr );
+			if ( vorbis )
+			{
+				const stb_vorbis_info info = stb_vorbis_get_info( vorbis );
+				const size_t frames = stb_vorbis_stream_length_in_samples( vorbis );
+				stb_vorbis_close( vorbis );
+
+				const size_t decoded = static_cast<size_t>( frames * ( (double)dma.speed / info.sample_rate ) ) * sizeof( short );
+				if ( decoded > streamThreshold )
+				{
+					load.data = data;
+					load.size = size;
+					load.stream = true;
+					load.decodeTime = Time_Microseconds() - start;
+					return;
+				}
+			}
+		}
+
 		int channels, samplerate, samples;
 		short *output;
 		samples = stb_vorbis_decode_memory( data, size, &channels, &samplerate, &output );
 		FileSystem::FreeFile( data );
 		if ( samples == -1 )
 		{
-			Com_Printf( "Couldn't load %s\n", namebuffer );
-			return nullptr;
+			Com_Printf( "Couldn't load %s\n", load.name );
+			return;
 		}
 		if ( channels != 1 )
 		{
 			// SlartTodo: Implement channel downmixing
-			Com_Printf( "%s is a stereo sample\n", s->name );
+			Com_Printf( "%s is a stereo sample\n", load.sfx->name );
 			Mem_Free( output );
-			return nullptr;
+			return;
 		}
 
 		stepscale = (float)samplerate / dma.speed;
@@ -354,11 +610,11 @@ sfxcache_t *S_LoadSound( sfx_t *s )
 
 		len *= sizeof( short ) * channels;
 
-		sc = s->cache = (sfxcache_t *)Mem_Alloc( len + sizeof( sfxcache_t ) );
+		sc = (sfxcache_t *)Mem_Alloc( len + sizeof( sfxcache_t ) );
 		if ( !sc )
 		{
 			Mem_Free( output );
-			return nullptr;
+			return;
 		}
 
 		sc->length = samples;
@@ -366,17 +622,149 @@ sfxcache_t *S_LoadSound( sfx_t *s )
 		sc->speed = samplerate;
 		sc->width = sizeof( short );
 		sc->stereo = channels;
+		sc->stream = nullptr;
 
-		ResampleSfx( s, sc->speed, sc->width, (byte *)output );
+		ResampleSfx( sc, sc->speed, sc->width, (byte *)output );
 
 		Mem_Free( output );
 	}
 	else
 	{
 		FileSystem::FreeFile( data );
-		Com_Printf( "%s is neither WAV or OGG data\n", namebuffer );
+		Com_Printf( "%s is neither WAV or OGG data\n", load.name );
+		return;
+	}
+
+	load.sc = sc;
+	load.bytes = sizeof( sfxcache_t ) + len;
+	load.decodeTime = Time_Microseconds() - start;
+}
+
+/*
+========================
+S_FinishSound
+
+Main thread only
+========================
+*/
+static sfxcache_t *S_FinishSound( soundLoad_t &load )
+{
+	sfx_t *s = load.sfx;
+
+	if ( load.stream ) {
+		return S_StreamSound( s, load.name, load.data, load.size, load.isWav ? &load.info : nullptr );
+	}
+
+	if ( !load.sc ) {
 		return nullptr;
 	}
 
-	return sc;
+	s->cache = load.sc;
+	S_CacheLoaded( s, load.bytes );
+
+	return load.sc;
+}
+
+/*
+========================
+S_LoadSound
+========================
+*/
+sfxcache_t *S_LoadSound( sfx_t *s )
+{
+	sfxcache_t	*sc;
+
+	if ( s->name[0] == '*' ) {
+		return NULL;
+	}
+
+	// see if still in memory
+	sc = s->cache;
+	if ( sc ) {
+		s->lastUsed = ++s_sampleCache.clock;
+		++s_sampleCache.hits;
+		return sc;
+	}
+
+	// load it in
+	soundLoad_t load;
+	S_SetupSoundLoad( s, load );
+	S_DecodeSound( load );
+
+	return S_FinishSound( load );
+}
+
+static void S_DecodeSoundJob( void *params, uint32 index )
+{
+	S_DecodeSound( static_cast<soundLoad_t *>( params )[index] );
+}
+
+/*
+========================
+S_LoadSounds
+
+Loads everything that isn't cached yet, decoding ASSET_BATCH_SIZE at a time
+on the job workers
+========================
+*/
+void S_LoadSounds( sfx_t **sounds, int count )
+{
+	std::vector<soundLoad_t> loads;
+	loads.reserve( count );
+
+	for ( int i = 0; i < count; ++i )
+	{
+		sfx_t *s = sounds[i];
+		if ( s->name[0] == '*' || s->cache ) {
+			continue;
+		}
+
+		S_SetupSoundLoad( s, loads.emplace_back() );
+	}
+
+	for ( size_t first = 0; first < loads.size(); first += ASSET_BATCH_SIZE )
+	{
+		const uint32 batchCount = static_cast<uint32>( Min<size_t>( ASSET_BATCH_SIZE, loads.size() - first ) );
+		soundLoad_t *batch = loads.data() + first;
+
+		if ( Asset_Parallel() )
+		{
+			Jobs::ParallelFor( batchCount, S_DecodeSoundJob, batch );
+		}
+		else
+		{
+			for ( uint32 i = 0; i < batchCount; ++i ) {
+				S_DecodeSound( batch[i] );
+			}
+		}
+
+		for ( uint32 i = 0; i < batchCount; ++i )
+		{
+			const int64 start = Time_Microseconds();
+			S_FinishSound( batch[i] );
+			Asset_Record( ASSET_SOUND, batch[i].name, batch[i].readTime, batch[i].decodeTime, Time_Microseconds() - start );
+		}
+	}
+}
+
+/*
+========================
+S_FreeSfxCache
+========================
+*/
+void S_FreeSfxCache( sfx_t *s )
+{
+	sfxcache_t *sc = s->cache;
+	if ( !sc ) {
+		return;
+	}
+
+	if ( sc->stream ) {
+		S_CloseStream( sc->stream );
+	}
+	Mem_Free( sc );
+
+	s->cache = nullptr;
+	s_sampleCache.residentBytes -= s->cacheSize;
+	s->cacheSize = 0;
 }
@@ -2,45 +2,81 @@
 
 #include "snd_local.h"
 
+#if defined __SSE2__ || defined _M_X64
+#define SND_MIX_SIMD
+#include <immintrin.h>
+#endif
+
 #define	PAINTBUFFER_SIZE 2048
-static portable_samplepair_t paintbuffer[PAINTBUFFER_SIZE];
 
-static int		snd_scaletable[32][256];
-static int *	snd_p;
-static int		snd_linear_count, snd_vol;
-static short *	snd_out;
+// Channels are split into this many groups when mixing on the job system
+#define MAX_MIX_GROUPS			4
+// Don't bother with the job system below this many active channels
+#define MIX_JOB_MIN_CHANNELS	8
+
+// The paint buffer is interleaved left / right floats in the range of a 16 bit sample,
+// group 0 is the final mix, the others are only used when mixing in parallel
+alignas( 32 ) static float	paintbuffers[MAX_MIX_GROUPS][PAINTBUFFER_SIZE * 2];
+static float *const			paintbuffer = paintbuffers[0];
+
+static float				snd_volume;
 
-static void S_WriteLinearBlastStereo16()
+struct mixStats_t
 {
-	int		i;
-	int		val;
+	int64		mixUsec;			// time spent in S_PaintChannels
+	uint64		channelSamples;		// sample pairs mixed across all channels
+	uint64		outputSamples;		// sample pairs sent to the device
+	uint32		channelPaints;		// a channel mixed into one paint buffer
+	uint32		paints;				// paint buffers mixed
+	uint32		parallelPaints;		// of which went through the job system
+	int			peakChannels;
+};
+
+static mixStats_t s_mixStats;
+
+/*
+===================================================================================================
+
+	Output
 
-	for (i=0 ; i<snd_linear_count ; i+=2)
+===================================================================================================
+*/
+
+static short S_ClampSample( float sample )
+{
+	return static_cast<short>( Clamp( sample, -32768.0f, 32767.0f ) );
+}
+
+static void S_WriteLinearBlastStereo16( short *out, const float *in, int count )
+{
+	int i = 0;
+
+#ifdef SND_MIX_SIMD
+	// clamp first and truncate like the scalar loop, so every CPU gets the same samples
+	const __m128 low = _mm_set1_ps( -32768.0f );
+	const __m128 high = _mm_set1_ps( 32767.0f );
+	for ( ; i + 8 <= count; i += 8 )
 	{
-		val = snd_p[i]>>8;
-		if (val > 0x7fff)
-			snd_out[i] = 0x7fff;
-		else if (val < (short)0x8000)
-			snd_out[i] = (short)0x8000;
-		else
-			snd_out[i] = val;
+		const __m128i lo = _mm_cvttps_epi32( _mm_min_ps( _mm_max_ps( _mm_loadu_ps( in + i ), low ), high ) );
+		const __m128i hi = _mm_cvttps_epi32( _mm_min_ps( _mm_max_ps( _mm_loadu_ps( in + i + 4 ), low ), high ) );
+		_mm_storeu_si128( (__m128i *)( out + i ), _mm_packs_epi32( lo, hi ) );
+	}
+#endif
 
-		val = snd_p[i+1]>>8;
-		if (val > 0x7fff)
-			snd_out[i+1] = 0x7fff;
-		else if (val < (short)0x8000)
-			snd_out[i+1] = (short)0x8000;
-		else
-			snd_out[i+1] = val;
+	for ( ; i < count; ++i )
+	{
+		out[i] = S_ClampSample( in[i] );
 	}
 }
 
-static void S_TransferStereo16 (unsigned long *pbuf, int endtime)
+static void S_TransferStereo16( unsigned long *pbuf, int endtime )
 {
 	int		lpos;
 	int		lpaintedtime;
-	
-	snd_p = (int *) paintbuffer;
+	int		linearCount;
+	const float *p;
+
+	p = paintbuffer;
 	lpaintedtime = paintedtime;
 
 	while (lpaintedtime < endtime)
@@ -48,19 +84,19 @@ static void S_TransferStereo16 (unsigned long *pbuf, int endtime)
 	// handle recirculating buffer issues
 		lpos = lpaintedtime & ((dma.samples>>1)-1);
 
-		snd_out = (short *) pbuf + (lpos<<1);
+		short *out = (short *) pbuf + (lpos<<1);
 
-		snd_linear_count = (dma.samples>>1) - lpos;
-		if (lpaintedtime + snd_linear_count > endtime)
-			snd_linear_count = endtime - lpaintedtime;
+		linearCount = (dma.samples>>1) - lpos;
+		if (lpaintedtime + linearCount > endtime)
+			linearCount = endtime - lpaintedtime;
 
-		snd_linear_count <<= 1;
+		linearCount <<= 1;
 
 	// write a linear blast of samples
-		S_WriteLinearBlastStereo16 ();
+		S_WriteLinearBlastStereo16( out, p, linearCount );
 
-		snd_p += snd_linear_count;
-		lpaintedtime += (snd_linear_count>>1);
+		p += linearCount;
+		lpaintedtime += (linearCount>>1);
 	}
 }
 
@@ -75,7 +111,7 @@ static void S_TransferPaintBuffer(int endtime)
 	int 	out_idx;
 	int 	count;
 	int 	out_mask;
-	int 	*p;
+	const float *p;
 	int 	step;
 	int		val;
 	unsigned long *pbuf;
@@ -90,7 +126,7 @@ static void S_TransferPaintBuffer(int endtime)
 		// write a fixed sine wave
 		count = (endtime - paintedtime);
 		for (i=0 ; i<count ; i++)
-			paintbuffer[i].left = paintbuffer[i].right = sinf((paintedtime+i)*0.1f)*20000*256;
+			paintbuffer[i*2] = paintbuffer[i*2+1] = sinf((paintedtime+i)*0.1f)*20000;
 	}
 
 	if (dma.samplebits == 16 && dma.channels == 2)
@@ -99,9 +135,9 @@ static void S_TransferPaintBuffer(int endtime)
 	}
 	else
 	{	// general case
-		p = (int *) paintbuffer;
+		p = paintbuffer;
 		count = (endtime - paintedtime) * dma.channels;
-		out_mask = dma.samples - 1; 
+		out_mask = dma.samples - 1;
 		out_idx = paintedtime * dma.channels & out_mask;
 		step = 3 - dma.channels;
 
@@ -110,12 +146,8 @@ static void S_TransferPaintBuffer(int endtime)
 			short *out = (short *) pbuf;
 			while (count--)
 			{
-				val = *p >> 8;
+				val = static_cast<int>( Clamp( *p, -32768.0f, 32767.0f ) );
 				p+= step;
-				if (val > 0x7fff)
-					val = 0x7fff;
-				else if (val < (short)0x8000)
-					val = (short)0x8000;
 				out[out_idx] = val;
 				out_idx = (out_idx + 1) & out_mask;
 			}
@@ -125,17 +157,15 @@ static void S_TransferPaintBuffer(int endtime)
 			unsigned char *out = (unsigned char *) pbuf;
 			while (count--)
 			{
-				val = *p >> 8;
+				val = static_cast<int>( Clamp( *p, -32768.0f, 32767.0f ) );
 				p+= step;
-				if (val > 0x7fff)
-					val = 0x7fff;
-				else if (val < (short)0x8000)
-					val = (short)0x8000;
 				out[out_idx] = (val>>8) + 128;
 				out_idx = (out_idx + 1) & out_mask;
 			}
 		}
 	}
+
+	s_mixStats.outputSamples += endtime - paintedtime;
 }
 
 /*
@@ -143,63 +173,232 @@ static void S_TransferPaintBuffer(int endtime)
 
 	Channel mixing
 
+	Sources are mono, each sample is scaled by the left and right gains and accumulated into
+	the interleaved paint buffer. The SIMD paths widen 4 (SSE2) or 8 (AVX2) samples to floats
+	and duplicate them into left / right pairs.
+
 ===================================================================================================
 */
 
-static void S_PaintChannelFrom8( channel_t *ch, sfxcache_t *sc, int count, int offset )
+static void S_MixMono16( float *out, const int16 *in, int count, float leftGain, float rightGain )
+{
+	int i = 0;
+
+#ifdef SND_MIX_SIMD
+#ifdef __AVX2__
+	const __m256 gains8 = _mm256_setr_ps( leftGain, rightGain, leftGain, rightGain, leftGain, rightGain, leftGain, rightGain );
+
+	for ( ; i + 8 <= count; i += 8 )
+	{
+		const __m256 s = _mm256_cvtepi32_ps( _mm256_cvtepi16_epi32( _mm_loadu_si128( (const __m128i *)( in + i ) ) ) );
+
+		// s0 s0 s1 s1 | s4 s4 s5 s5 and s2 s2 s3 s3 | s6 s6 s7 s7, then fix up the lanes
+		const __m256 lo = _mm256_unpacklo_ps( s, s );
+		const __m256 hi = _mm256_unpackhi_ps( s, s );
+
+		float *o = out + i * 2;
+		_mm256_storeu_ps( o + 0, _mm256_add_ps( _mm256_loadu_ps( o + 0 ), _mm256_mul_ps( _mm256_permute2f128_ps( lo, hi, 0x20 ), gains8 ) ) );
+		_mm256_storeu_ps( o + 8, _mm256_add_ps( _mm256_loadu_ps( o + 8 ), _mm256_mul_ps( _mm256_permute2f128_ps( lo, hi, 0x31 ), gains8 ) ) );
+	}
+#endif
+
+	const __m128 gains = _mm_setr_ps( leftGain, rightGain, leftGain, rightGain );
+
+	for ( ; i + 4 <= count; i += 4 )
+	{
+		const __m128i packed = _mm_loadl_epi64( (const __m128i *)( in + i ) );
+		const __m128 s = _mm_cvtepi32_ps( _mm_srai_epi32( _mm_unpacklo_epi16( packed, packed ), 16 ) );
+
+		float *o = out + i * 2;
+		_mm_storeu_ps( o + 0, _mm_add_ps( _mm_loadu_ps( o + 0 ), _mm_mul_ps( _mm_unpacklo_ps( s, s ), gains ) ) );
+		_mm_storeu_ps( o + 4, _mm_add_ps( _mm_loadu_ps( o + 4 ), _mm_mul_ps( _mm_unpackhi_ps( s, s ), gains ) ) );
+	}
+#endif
+
+	for ( ; i < count; ++i )
+	{
+		const float s = in[i];
+		out[i * 2 + 0] += s * leftGain;
+		out[i * 2 + 1] += s * rightGain;
+	}
+}
+
+static void S_MixMono8( float *out, const int8 *in, int count, float leftGain, float rightGain )
+{
+	// 8 bit samples are scaled up to the 16 bit range
+	leftGain *= 256.0f;
+	rightGain *= 256.0f;
+
+	int i = 0;
+
+#ifdef SND_MIX_SIMD
+#ifdef __AVX2__
+	const __m256 gains8 = _mm256_setr_ps( leftGain, rightGain, leftGain, rightGain, leftGain, rightGain, leftGain, rightGain );
+
+	for ( ; i + 8 <= count; i += 8 )
+	{
+		const __m256 s = _mm256_cvtepi32_ps( _mm256_cvtepi8_epi32( _mm_loadl_epi64( (const __m128i *)( in + i ) ) ) );
+
+		const __m256 lo = _mm256_unpacklo_ps( s, s );
+		const __m256 hi = _mm256_unpackhi_ps( s, s );
+
+		float *o = out + i * 2;
+		_mm256_storeu_ps( o + 0, _mm256_add_ps( _mm256_loadu_ps( o + 0 ), _mm256_mul_ps( _mm256_permute2f128_ps( lo, hi, 0x20 ), gains8 ) ) );
+		_mm256_storeu_ps( o + 8, _mm256_add_ps( _mm256_loadu_ps( o + 8 ), _mm256_mul_ps( _mm256_permute2f128_ps( lo, hi, 0x31 ), gains8 ) ) );
+	}
+#endif
+
+	const __m128 gains = _mm_setr_ps( leftGain, rightGain, leftGain, rightGain );
+
+	for ( ; i + 4 <= count; i += 4 )
+	{
+		int32 packed32;
+		memcpy( &packed32, in + i, sizeof( packed32 ) );
+
+		// put each byte at the top of a 32 bit lane, then shift it back down with sign extension
+		__m128i packed = _mm_cvtsi32_si128( packed32 );
+		packed = _mm_unpacklo_epi8( packed, packed );
+		packed = _mm_unpacklo_epi16( packed, packed );
+		const __m128 s = _mm_cvtepi32_ps( _mm_srai_epi32( packed, 24 ) );
+
+		float *o = out + i * 2;
+		_mm_storeu_ps( o + 0, _mm_add_ps( _mm_loadu_ps( o + 0 ), _mm_mul_ps( _mm_unpacklo_ps( s, s ), gains ) ) );
+		_mm_storeu_ps( o + 4, _mm_add_ps( _mm_loadu_ps( o + 4 ), _mm_mul_ps( _mm_unpackhi_ps( s, s ), gains ) ) );
+	}
+#endif
+
+	for ( ; i < count; ++i )
+	{
+		const float s = in[i];
+		out[i * 2 + 0] += s * leftGain;
+		out[i * 2 + 1] += s * rightGain;
+	}
+}
+
+static void S_AccumulatePaintBuffer( float *out, const float *in, int count )
 {
-	int 	data;
-	int		*lscale, *rscale;
-	unsigned char *sfx;
-	int		i;
-	portable_samplepair_t *samp;
+	int i = 0;
 
-	// TODO: leftvol and rightvol should never be higher than 255 anyway. Right?
-	ch->leftvol = Min( ch->leftvol, 255 );
-	ch->rightvol = Min( ch->rightvol, 255 );
+#ifdef SND_MIX_SIMD
+	for ( ; i + 4 <= count; i += 4 )
+	{
+		_mm_store_ps( out + i, _mm_add_ps( _mm_load_ps( out + i ), _mm_load_ps( in + i ) ) );
+	}
+#endif
+
+	for ( ; i < count; ++i )
+	{
+		out[i] += in[i];
+	}
+}
 
-	//ZOID-- >>11 has been changed to >>3, >>11 didn't make much sense
-	//as it would always be zero.
-	lscale = snd_scaletable[ch->leftvol >> 3];
-	rscale = snd_scaletable[ch->rightvol >> 3];
-	sfx = (unsigned char *)sc->data + ch->pos;
+/*
+========================
+S_PaintChannel
 
-	samp = &paintbuffer[offset];
+Mixes a channel into buffer, which starts at paintedtime, up to end.
+The channel's sfx must already be loaded. Returns the number of sample pairs mixed.
+========================
+*/
+static int S_PaintChannel( channel_t *ch, float *buffer, int end )
+{
+	int ltime = paintedtime;
+	int mixed = 0;
 
-	for ( i = 0; i < count; i++, samp++ )
+	while ( ltime < end )
 	{
-		data = sfx[i];
-		samp->left += lscale[data];
-		samp->right += rscale[data];
+		if ( !ch->sfx || ( !ch->leftvol && !ch->rightvol ) )
+			break;
+
+		// max painting is to the end of the buffer
+		int count = end - ltime;
+
+		// might be stopped by running out of data
+		if ( ch->end - ltime < count )
+			count = ch->end - ltime;
+
+		const sfxcache_t *sc = ch->sfx->cache;
+		if ( !sc )
+			break;
+
+		if ( count > 0 )
+		{
+			// TODO: leftvol and rightvol should never be higher than 255 anyway. Right?
+			ch->leftvol = Min( ch->leftvol, 255 );
+			ch->rightvol = Min( ch->rightvol, 255 );
+
+			const float leftGain = ch->leftvol * snd_volume * ( 1.0f / 256.0f );
+			const float rightGain = ch->rightvol * snd_volume * ( 1.0f / 256.0f );
+			float *out = buffer + ( ltime - paintedtime ) * 2;
+
+			if ( sc->stream )
+			{
+				// count never exceeds the paint buffer
+				alignas( 16 ) int16 streamed[PAINTBUFFER_SIZE];
+				S_ReadStream( sc->stream, ch->pos, count, streamed );
+				S_MixMono16( out, streamed, count, leftGain, rightGain );
+			}
+			else if ( sc->width == 1 )
+				S_MixMono8( out, (const int8 *)sc->data + ch->pos, count, leftGain, rightGain );
+			else
+				S_MixMono16( out, (const int16 *)sc->data + ch->pos, count, leftGain, rightGain );
+
+			ch->pos += count;
+			ltime += count;
+			mixed += count;
+		}
+
+		// if at end of loop, restart
+		if ( ltime >= ch->end )
+		{
+			if ( ch->autosound )
+			{	// autolooping sounds always go back to start
+				ch->pos = 0;
+				ch->end = ltime + sc->length;
+			}
+			else if ( sc->loopstart >= 0 )
+			{
+				ch->pos = sc->loopstart;
+				ch->end = ltime + sc->length - ch->pos;
+			}
+			else
+			{	// channel just stopped
+				ch->sfx = nullptr;
+			}
+		}
 	}
 
-	ch->pos += count;
+	return mixed;
 }
 
-static void S_PaintChannelFrom16( channel_t *ch, sfxcache_t *sc, int count, int offset )
+struct mixGroupParms_t
 {
-	int data;
-	int left, right;
-	int leftvol, rightvol;
-	signed short *sfx;
-	int	i;
-	portable_samplepair_t *samp;
-
-	leftvol = ch->leftvol * snd_vol;
-	rightvol = ch->rightvol * snd_vol;
-	sfx = (signed short *)sc->data + ch->pos;
-
-	samp = &paintbuffer[offset];
-	for ( i = 0; i < count; i++, samp++ )
+	channel_t **	channels;
+	int				numChannels;
+	int				numGroups;
+	int				end;
+	int				mixed[MAX_MIX_GROUPS];
+};
+
+static void S_MixGroupJob( void *params, uint32 group )
+{
+	mixGroupParms_t *parms = (mixGroupParms_t *)params;
+
+	float *buffer = paintbuffers[group];
+
+	// group 0 paints over the raw samples already in the final buffer
+	if ( group != 0 )
+	{
+		memset( buffer, 0, ( parms->end - paintedtime ) * 2 * sizeof( float ) );
+	}
+
+	int mixed = 0;
+	for ( int i = group; i < parms->numChannels; i += parms->numGroups )
 	{
-		data = sfx[i];
-		left = ( data * leftvol ) >> 8;
-		right = ( data * rightvol ) >> 8;
-		samp->left += left;
-		samp->right += right;
+		mixed += S_PaintChannel( parms->channels[i], buffer, parms->end );
 	}
 
-	ch->pos += count;
+	parms->mixed[group] = mixed;
 }
 
 void S_PaintChannels(int endtime)
@@ -207,11 +406,11 @@ void S_PaintChannels(int endtime)
 	int 	i;
 	int 	end;
 	channel_t *ch;
-	sfxcache_t	*sc;
-	int		ltime, count;
 	playsound_t	*ps;
 
-	snd_vol = static_cast<int>( s_volume->GetFloat() * 256.0f );
+	const int64 startTime = Time_Microseconds();
+
+	snd_volume = s_volume->GetFloat();
 
 //Com_Printf ("%i to %i\n", paintedtime, endtime);
 	while (paintedtime < endtime)
@@ -242,7 +441,7 @@ void S_PaintChannels(int endtime)
 		if (s_rawend < paintedtime)
 		{
 //			Com_Printf ("clear\n");
-			memset(paintbuffer, 0, (end - paintedtime) * sizeof(portable_samplepair_t));
+			memset(paintbuffer, 0, (end - paintedtime) * 2 * sizeof(float));
 		}
 		else
 		{	// copy from the streaming sound source
@@ -254,7 +453,8 @@ void S_PaintChannels(int endtime)
 			for (i=paintedtime ; i<stop ; i++)
 			{
 				s = i&(MAX_RAW_SAMPLES-1);
-				paintbuffer[i-paintedtime] = s_rawsamples[s];
+				paintbuffer[(i-paintedtime)*2+0] = s_rawsamples[s].left * ( 1.0f / 256.0f );
+				paintbuffer[(i-paintedtime)*2+1] = s_rawsamples[s].right * ( 1.0f / 256.0f );
 			}
 //		if (i != end)
 //			Com_Printf ("partial stream\n");
@@ -262,84 +462,158 @@ void S_PaintChannels(int endtime)
 //			Com_Printf ("full stream\n");
 			for ( ; i<end ; i++)
 			{
-				paintbuffer[i-paintedtime].left =
-				paintbuffer[i-paintedtime].right = 0;
+				paintbuffer[(i-paintedtime)*2+0] =
+				paintbuffer[(i-paintedtime)*2+1] = 0;
 			}
 		}
 
+	// gather the channels that will make a sound, loading happens here on the main thread
+		channel_t *active[MAX_CHANNELS];
+		int numActive = 0;
 
-	// paint in the channels.
 		ch = channels;
 		for (i=0; i<MAX_CHANNELS ; i++, ch++)
 		{
-			ltime = paintedtime;
-		
-			while (ltime < end)
+			if (!ch->sfx || (!ch->leftvol && !ch->rightvol) )
+				continue;
+			if (!S_LoadSound (ch->sfx))
+				continue;
+			active[numActive++] = ch;
+		}
+
+	// paint in the channels.
+		mixGroupParms_t parms;
+		parms.channels = active;
+		parms.numChannels = numActive;
+		parms.end = end;
+		parms.numGroups = 1;
+
+		if ( s_mixjobs->GetBool() && numActive >= MIX_JOB_MIN_CHANNELS )
+		{
+			parms.numGroups = Min( Min( MAX_MIX_GROUPS, (int)Jobs::NumWorkers() + 1 ), numActive / ( MIX_JOB_MIN_CHANNELS / 2 ) );
+		}
+
+		if ( parms.numGroups > 1 )
+		{
+			Jobs::ParallelFor( parms.numGroups, S_MixGroupJob, &parms );
+
+			for ( int group = 1; group < parms.numGroups; ++group )
 			{
-				if (!ch->sfx || (!ch->leftvol && !ch->rightvol) )
-					break;
-
-				// max painting is to the end of the buffer
-				count = end - ltime;
-
-				// might be stopped by running out of data
-				if (ch->end - ltime < count)
-					count = ch->end - ltime;
-		
-				sc = S_LoadSound (ch->sfx);
-				if (!sc)
-					break;
-
-				if (count > 0 && ch->sfx)
-				{	
-					if (sc->width == 1)// FIXME; 8 bit asm is wrong now
-						S_PaintChannelFrom8(ch, sc, count,  ltime - paintedtime);
-					else
-						S_PaintChannelFrom16(ch, sc, count, ltime - paintedtime);
-	
-					ltime += count;
-				}
-
-			// if at end of loop, restart
-				if (ltime >= ch->end)
-				{
-					if (ch->autosound)
-					{	// autolooping sounds always go back to start
-						ch->pos = 0;
-						ch->end = ltime + sc->length;
-					}
-					else if (sc->loopstart >= 0)
-					{
-						ch->pos = sc->loopstart;
-						ch->end = ltime + sc->length - ch->pos;
-					}
-					else				
-					{	// channel just stopped
-						ch->sfx = NULL;
-					}
-				}
+				S_AccumulatePaintBuffer( paintbuffer, paintbuffers[group], ( end - paintedtime ) * 2 );
 			}
-															  
+
+			++s_mixStats.parallelPaints;
+		}
+		else
+		{
+			S_MixGroupJob( &parms, 0 );
 		}
 
+		for ( int group = 0; group < parms.numGroups; ++group )
+		{
+			s_mixStats.channelSamples += parms.mixed[group];
+		}
+		s_mixStats.channelPaints += numActive;
+		s_mixStats.peakChannels = Max( s_mixStats.peakChannels, numActive );
+		++s_mixStats.paints;
+
 	// transfer out according to DMA format
 		S_TransferPaintBuffer(end);
 		paintedtime = end;
 	}
+
+	s_mixStats.mixUsec += Time_Microseconds() - startTime;
 }
 
 void S_InitScaletable()
 {
 	s_volume->ClearModified();
 
-	const float volume = s_volume->GetFloat();
+	snd_volume = s_volume->GetFloat();
+}
+
+/*
+========================
+S_MixStats_f
+
+Reports what the mixer has cost since the last call
+========================
+*/
+void S_MixStats_f()
+{
+	const mixStats_t &stats = s_mixStats;
+
+	if ( stats.paints == 0 )
+	{
+		Com_Print( "Nothing has been mixed\n" );
+		return;
+	}
+
+	const double mixMsec = stats.mixUsec / 1000.0;
+	const double audioMsec = dma.speed ? stats.outputSamples * 1000.0 / dma.speed : 0.0;
+
+	Com_Printf( "%u paints (%u in parallel), %.1f channels on average, %d at peak of %d\n",
+		stats.paints, stats.parallelPaints, (double)stats.channelPaints / stats.paints, stats.peakChannels, MAX_CHANNELS );
+	Com_Printf( "%.2f ms mixing %.2f ms of audio (%.2f%% of realtime)\n",
+		mixMsec, audioMsec, audioMsec > 0.0 ? mixMsec * 100.0 / audioMsec : 0.0 );
+
+	if ( stats.channelSamples )
+	{
+		Com_Printf( "%.2f ns per channel sample, %.2f us per channel per paint\n",
+			stats.mixUsec * 1000.0 / stats.channelSamples,
+			stats.channelPaints ? (double)stats.mixUsec / stats.channelPaints : 0.0 );
+	}
+
+	s_mixStats = {};
+}
+
+/*
+========================
+S_TestMix_f
+
+Checks the output conversion gives the same samples as the plain clamp, over
+values in range, out of range and on every kind of fraction
+========================
+*/
+void S_TestMix_f()
+{
+	constexpr int count = PAINTBUFFER_SIZE * 2;
+
+	alignas( 32 ) static float	in[count];
+	static short				out[count];
 
-	for ( int i = 0; i < 32; ++i )
+	uint32 seed = 1;
+	for ( int i = 0; i < count; ++i )
 	{
-		const int scale = i * 8 * 256 * volume;
-		for ( int j = 0; j < 256; ++j )
+		seed = seed * 1664525 + 1013904223;
+		const float random = ( ( seed >> 8 ) / 16777216.0f ) * 2.0f - 1.0f;
+
+		switch ( i & 3 )
 		{
-			snd_scaletable[i][j] = ( (char)j ) * scale;
+		case 0: in[i] = random * 32768.0f; break;							// in range
+		case 1: in[i] = random * 65536.0f; break;							// clipping
+		case 2: in[i] = floorf( random * 32768.0f ) + 0.5f; break;			// halfway
+		case 3: in[i] = random * 2.0f; break;								// around zero
 		}
 	}
+	in[0] = -32768.0f;
+	in[1] = 32767.0f;
+	in[2] = -32768.5f;
+	in[3] = 32767.5f;
+
+	// odd length so the scalar tail gets a go as well
+	S_WriteLinearBlastStereo16( out, in, count - 3 );
+
+	int mismatches = 0;
+	for ( int i = 0; i < count - 3; ++i )
+	{
+		if ( out[i] != S_ClampSample( in[i] ) )
+		{
+			if ( mismatches++ < 8 ) {
+				Com_Printf( S_COLOR_RED "%f came out as %d instead of %d\n", in[i], out[i], S_ClampSample( in[i] ) );
+			}
+		}
+	}
+
+	Com_Printf( "%d of %d samples mismatched\n", mismatches, count - 3 );
 }
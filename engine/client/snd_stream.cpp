@@ -0,0 +1,447 @@
+/*
+===================================================================================================
+
+	Sound streaming
+
+	Long sounds aren't decoded at registration. The file stays in memory as it was loaded and a
+	background thread decodes it in fixed size chunks into two buffers, the mixer copies out of
+	whichever one holds the play position and asks for the next chunk while the current one plays.
+	If the thread falls behind the chunk is decoded on the spot and counted as an underrun.
+
+===================================================================================================
+*/
+
+#include "snd_local.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#define STB_VORBIS_NO_STDIO
+#define STB_VORBIS_NO_PUSHDATA_API
+#define STB_VORBIS_HEADER_ONLY
+#include "../../thirdparty/stb/stb_vorbis.c"
+
+#define STREAM_CHUNK_SAMPLES	16384		// output samples per chunk, ~0.4s at 44KHz
+#define STREAM_NUM_CHUNKS		2
+
+struct streamChunk_t
+{
+	int				index;					// -1 if empty
+	int				count;
+	uint32			lastRead;
+	int16			samples[STREAM_CHUNK_SAMPLES];
+};
+
+struct sndStream_t
+{
+	std::mutex		mutex;					// guards the chunks and pending
+	std::mutex		decodeMutex;			// guards the decoder
+
+	byte *			file;					// owned, loaded with FileSystem::LoadFile
+	fsSize_t		fileSize;
+
+	stb_vorbis *	vorbis;					// null for wav
+	const byte *	wavData;
+	int				wavWidth;
+
+	int				srcChannels;
+	int				srcLength;				// in frames
+	int				srcPos;					// where the vorbis decoder is
+	double			step;					// source frames per output sample
+	resampleFilter_t	filter;				// for step, the same one the cached sounds use
+
+	int				length;					// in output samples
+
+	streamChunk_t	chunks[STREAM_NUM_CHUNKS];
+	int				pending;				// chunk the thread has been asked for, -1 if none
+	uint32			readCount;
+
+	uint32			underruns;
+
+	std::vector<int16>	decodeFrames;		// scratch, under decodeMutex
+	std::vector<int16>	decodeMono;
+	std::vector<float>	decodeSource;
+	int16			decodeChunk[STREAM_CHUNK_SAMPLES];
+};
+
+static std::thread					s_streamThread;
+static std::mutex					s_streamQueueMutex;
+static std::condition_variable		s_streamQueueCond;
+static std::vector<sndStream_t *>	s_streamQueue;
+static sndStream_t *				s_streamBusy;		// the one the thread is decoding
+static bool							s_streamQuit;
+
+/*
+========================
+S_DecodeStreamChunk
+
+Decodes a chunk to mono 16 bit at the output rate, must hold decodeMutex
+========================
+*/
+static int S_DecodeStreamChunk( sndStream_t *stream, int chunk, int16 *out )
+{
+	const int start = chunk * STREAM_CHUNK_SAMPLES;
+	const int count = Min( STREAM_CHUNK_SAMPLES, stream->length - start );
+	if ( count <= 0 ) {
+		return 0;
+	}
+
+	// the filter reaches back and ahead of the frames the samples land on
+	const bool filtered = stream->step != 1.0 && s_resample->GetBool();
+	const int before = filtered ? RESAMPLE_TAPS / 2 - 1 : 0;
+	const int after = filtered ? RESAMPLE_TAPS / 2 : 0;
+
+	const int first = Clamp( static_cast<int>( start * stream->step ) - before, 0, stream->srcLength - 1 );
+	const int last = Min( static_cast<int>( ( start + count - 1 ) * stream->step ) + after, stream->srcLength - 1 );
+	const int numFrames = last - first + 1;
+
+	stream->decodeMono.assign( numFrames, 0 );
+	int16 *mono = stream->decodeMono.data();
+
+	if ( stream->vorbis )
+	{
+		if ( stream->srcPos != first )
+		{
+			stb_vorbis_seek( stream->vorbis, first );
+			stream->srcPos = first;
+		}
+
+		const int channels = stream->srcChannels;
+		stream->decodeFrames.resize( numFrames * channels );
+
+		int decoded = 0;
+		while ( decoded < numFrames )
+		{
+			const int frames = stb_vorbis_get_samples_short_interleaved( stream->vorbis, channels,
+				stream->decodeFrames.data() + decoded * channels, ( numFrames - decoded ) * channels );
+			if ( frames <= 0 ) {
+				break;
+			}
+			decoded += frames;
+		}
+		stream->srcPos += decoded;
+
+		// downmix
+		for ( int i = 0; i < decoded; ++i )
+		{
+			int sum = 0;
+			for ( int c = 0; c < channels; ++c )
+			{
+				sum += stream->decodeFrames[i * channels + c];
+			}
+			mono[i] = static_cast<int16>( sum / channels );
+		}
+	}
+	else
+	{
+		for ( int i = 0; i < numFrames; ++i )
+		{
+			if ( stream->wavWidth == 2 ) {
+				mono[i] = LittleShort( ( (const short *)stream->wavData )[first + i] );
+			} else {
+				mono[i] = static_cast<int16>( ( (int)stream->wavData[first + i] - 128 ) << 8 );
+			}
+		}
+	}
+
+	if ( filtered )
+	{
+		stream->decodeSource.assign( mono, mono + numFrames );
+
+		for ( int i = 0; i < count; ++i )
+		{
+			const float acc = S_ResampleAt( stream->filter, stream->decodeSource.data(), first, numFrames, ( start + i ) * stream->step );
+			out[i] = static_cast<int16>( Clamp( acc, -32768.0f, 32767.0f ) );
+		}
+	}
+	else
+	{
+		// nearest sample, like ResampleSfx with s_resample 0
+		for ( int i = 0; i < count; ++i )
+		{
+			const int frame = Min( static_cast<int>( ( start + i ) * stream->step ) - first, numFrames - 1 );
+			out[i] = mono[frame];
+		}
+	}
+
+	return count;
+}
+
+/*
+========================
+S_StoreStreamChunk
+
+Puts a decoded chunk in the least recently read buffer, must hold mutex
+========================
+*/
+static void S_StoreStreamChunk( sndStream_t *stream, int chunk, const int16 *samples, int count )
+{
+	streamChunk_t *victim = &stream->chunks[0];
+	for ( streamChunk_t &c : stream->chunks )
+	{
+		if ( c.index == chunk ) {
+			return;
+		}
+		if ( c.lastRead < victim->lastRead ) {
+			victim = &c;
+		}
+	}
+
+	victim->index = chunk;
+	victim->count = count;
+	victim->lastRead = stream->readCount;
+	memcpy( victim->samples, samples, count * sizeof( int16 ) );
+}
+
+static void S_StreamThread()
+{
+	while ( true )
+	{
+		sndStream_t *stream;
+
+		{
+			std::unique_lock<std::mutex> lock( s_streamQueueMutex );
+			s_streamBusy = nullptr;
+			s_streamQueueCond.notify_all();
+
+			s_streamQueueCond.wait( lock, []() { return s_streamQuit || !s_streamQueue.empty(); } );
+			if ( s_streamQuit ) {
+				return;
+			}
+
+			stream = s_streamQueue.front();
+			s_streamQueue.erase( s_streamQueue.begin() );
+			s_streamBusy = stream;
+		}
+
+		int chunk;
+		{
+			std::lock_guard<std::mutex> lock( stream->mutex );
+			chunk = stream->pending;
+		}
+		if ( chunk < 0 ) {
+			continue;
+		}
+
+		std::lock_guard<std::mutex> decodeLock( stream->decodeMutex );
+		const int count = S_DecodeStreamChunk( stream, chunk, stream->decodeChunk );
+
+		std::lock_guard<std::mutex> lock( stream->mutex );
+		S_StoreStreamChunk( stream, chunk, stream->decodeChunk, count );
+		stream->pending = -1;
+	}
+}
+
+static void S_RequestStreamChunk( sndStream_t *stream, int chunk )
+{
+	// must hold stream->mutex
+	if ( stream->pending != -1 ) {
+		return;
+	}
+	for ( const streamChunk_t &c : stream->chunks )
+	{
+		if ( c.index == chunk ) {
+			return;
+		}
+	}
+
+	stream->pending = chunk;
+
+	std::lock_guard<std::mutex> lock( s_streamQueueMutex );
+	s_streamQueue.push_back( stream );
+	s_streamQueueCond.notify_all();
+}
+
+/*
+========================
+S_ReadStream
+
+Copies count samples starting at pos into out
+========================
+*/
+void S_ReadStream( sndStream_t *stream, int pos, int count, int16 *out )
+{
+	const int numChunks = ( stream->length + STREAM_CHUNK_SAMPLES - 1 ) / STREAM_CHUNK_SAMPLES;
+
+	while ( count > 0 )
+	{
+		if ( pos >= stream->length )
+		{
+			// callers stop at the end of the sound, but don't read garbage if they don't
+			memset( out, 0, count * sizeof( int16 ) );
+			return;
+		}
+
+		const int chunk = pos / STREAM_CHUNK_SAMPLES;
+		const int offset = pos - chunk * STREAM_CHUNK_SAMPLES;
+
+		{
+			std::lock_guard<std::mutex> lock( stream->mutex );
+
+			streamChunk_t *found = nullptr;
+			for ( streamChunk_t &c : stream->chunks )
+			{
+				if ( c.index == chunk ) {
+					found = &c;
+					break;
+				}
+			}
+
+			if ( found )
+			{
+				const int n = Min( count, found->count - offset );
+				memcpy( out, found->samples + offset, n * sizeof( int16 ) );
+				found->lastRead = ++stream->readCount;
+
+				// get the next one going while this one plays
+				S_RequestStreamChunk( stream, ( chunk + 1 ) % numChunks );
+
+				pos += n;
+				out += n;
+				count -= n;
+				continue;
+			}
+		}
+
+		// the thread hasn't got to it, decode it here
+		std::lock_guard<std::mutex> decodeLock( stream->decodeMutex );
+		const int decoded = S_DecodeStreamChunk( stream, chunk, stream->decodeChunk );
+
+		std::lock_guard<std::mutex> lock( stream->mutex );
+		S_StoreStreamChunk( stream, chunk, stream->decodeChunk, decoded );
+		++stream->underruns;
+	}
+}
+
+/*
+========================
+S_OpenStream
+
+Takes ownership of file on success, wav is null for Ogg Vorbis.
+Fills in the cache header for the output rate.
+========================
+*/
+sndStream_t *S_OpenStream( const char *name, byte *file, fsSize_t size, const wavinfo_t *wav, sfxcache_t *sc )
+{
+	sndStream_t *stream = new sndStream_t;
+
+	stream->file = file;
+	stream->fileSize = size;
+	stream->vorbis = nullptr;
+	stream->wavData = nullptr;
+	stream->wavWidth = 0;
+	stream->srcPos = 0;
+	stream->pending = -1;
+	stream->readCount = 0;
+	stream->underruns = 0;
+
+	for ( streamChunk_t &c : stream->chunks )
+	{
+		c.index = -1;
+		c.count = 0;
+		c.lastRead = 0;
+	}
+
+	int rate;
+	int loopstart = -1;
+
+	if ( wav )
+	{
+		rate = wav->rate;
+		loopstart = wav->loopstart;
+		stream->srcChannels = 1;
+		stream->srcLength = wav->samples;
+		stream->wavData = file + wav->dataofs;
+		stream->wavWidth = wav->width;
+	}
+	else
+	{
+		int error;
+		stream->vorbis = stb_vorbis_open_memory( file, static_cast<int>( size ), &error, nullptr );
+		if ( !stream->vorbis )
+		{
+			Com_Printf( "Couldn't open %s for streaming (%d)\n", name, error );
+			delete stream;
+			return nullptr;
+		}
+
+		const stb_vorbis_info info = stb_vorbis_get_info( stream->vorbis );
+		rate = info.sample_rate;
+		stream->srcChannels = info.channels;
+		stream->srcLength = static_cast<int>( stb_vorbis_stream_length_in_samples( stream->vorbis ) );
+		if ( stream->srcLength <= 0 )
+		{
+			Com_Printf( "%s has no samples\n", name );
+			stb_vorbis_close( stream->vorbis );
+			delete stream;
+			return nullptr;
+		}
+	}
+
+	stream->step = (double)rate / dma.speed;
+	stream->length = static_cast<int>( stream->srcLength / stream->step );
+	S_BuildResampleFilter( stream->filter, stream->step );
+
+	sc->length = stream->length;
+	sc->loopstart = loopstart >= 0 ? static_cast<int>( loopstart / stream->step ) : -1;
+	sc->speed = dma.speed;
+	sc->width = sizeof( int16 );
+	sc->stereo = 0;
+
+	// have the start ready by the time it's played
+	std::lock_guard<std::mutex> lock( stream->mutex );
+	S_RequestStreamChunk( stream, 0 );
+
+	return stream;
+}
+
+void S_CloseStream( sndStream_t *stream )
+{
+	{
+		std::unique_lock<std::mutex> lock( s_streamQueueMutex );
+
+		std::erase( s_streamQueue, stream );
+		s_streamQueueCond.wait( lock, [stream]() { return s_streamBusy != stream; } );
+	}
+
+	if ( stream->vorbis ) {
+		stb_vorbis_close( stream->vorbis );
+	}
+	FileSystem::FreeFile( stream->file );
+
+	delete stream;
+}
+
+size_t S_StreamMemory( const sndStream_t *stream )
+{
+	return sizeof( *stream ) + stream->fileSize;
+}
+
+uint32 S_StreamUnderruns( const sndStream_t *stream )
+{
+	return stream->underruns;
+}
+
+void S_InitStreaming()
+{
+	s_streamQuit = false;
+	s_streamThread = std::thread( S_StreamThread );
+}
+
+void S_ShutdownStreaming()
+{
+	if ( !s_streamThread.joinable() ) {
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock( s_streamQueueMutex );
+		s_streamQuit = true;
+		s_streamQueue.clear();
+	}
+	s_streamQueueCond.notify_all();
+
+	s_streamThread.join();
+}
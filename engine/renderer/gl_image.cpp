@@ -11,6 +11,8 @@
 #include "gl_local.h"
 #include "../shared/imgtools.h"
 
+#include <algorithm>
+
 #if 0
 #define STB_IMAGE_RESIZE_IMPLEMENTATION
 #define STBIR_MAX_CHANNELS 32
@@ -38,6 +40,14 @@ unsigned	d_8to24table[256];
 // Are we initialised?
 static bool g_imagesInitialised;
 
+static StaticCvar r_streamTextures( "r_streamTextures", "1", 0, "Upload the small mips of compressed images first and the rest over the following frames." );
+static StaticCvar r_streamMipSize( "r_streamMipSize", "128", 0, "The largest mip a streamed image starts with." );
+static StaticCvar r_streamBudget( "r_streamBudget", "2048", 0, "How many KB of streamed mips are uploaded each frame." );
+
+static ResourceHash<image_t, 1024>		s_imageHash;
+static ResourceHash<material_t, 1024>	s_materialHash;
+static TouchList<material_t>			s_materialTouches;
+
 //-------------------------------------------------------------------------------------------------
 
 //-------------------------------------------------------------------------------------------------
@@ -193,9 +203,82 @@ static void GL_ApplyTextureParameters( imageFlags_t flags )
 	}
 }
 
+//-------------------------------------------------------------------------------------------------
+// Compressed images
+//
+// A DDS with a mip chain only has its smaller mips uploaded at first, up to r_streamMipSize, and
+// GL_TEXTURE_BASE_LEVEL keeps the texture complete with what's there. The image holds on to the
+// file and GL_StreamImages uploads the larger mips over the next frames, within r_streamBudget.
+//-------------------------------------------------------------------------------------------------
+
+static std::vector<image_t *>	s_streamingImages;
+
+static bool GL_CompressedFormat( const byte *pBuffer, GLenum &format, int &blockSize )
+{
+	const img::DDS_HEADER_DXT10 *pHeader2 = (const img::DDS_HEADER_DXT10 *)( pBuffer + sizeof( img::DDS_HEADER ) );
+
+	switch ( pHeader2->dxgiFormat )
+	{
+		// Classic DXT1
+	case DXGI_FORMAT_BC1_UNORM:
+		format = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+		blockSize = 8;
+		return true;
+		// DXT5, what the texture cache uses for anything with alpha
+	case DXGI_FORMAT_BC3_UNORM:
+		format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+		blockSize = 16;
+		return true;
+		// New BC4 and BC5
+	case DXGI_FORMAT_BC4_UNORM:
+		format = GL_COMPRESSED_RED_RGTC1;
+		blockSize = 8;
+		return true;
+	case DXGI_FORMAT_BC5_UNORM:
+		format = GL_COMPRESSED_RG_RGTC2;
+		blockSize = 16;
+		return true;
+		// Super mega new (10 years old) BC6 and BC7
+	case DXGI_FORMAT_BC7_UNORM:
+		format = GL_COMPRESSED_RGBA_BPTC_UNORM_ARB;
+		blockSize = 16;
+		return true;
+	default:
+		return false;
+	}
+}
+
+// uploads a single mip of the DDS in pBuffer to the bound texture, returns its size
+static GLsizei GL_UploadCompressedLevel( const byte *pBuffer, GLint level, GLenum format, int blockSize )
+{
+	const img::DDS_HEADER *pHeader = (const img::DDS_HEADER *)pBuffer;
+
+	GLsizei width = (GLsizei)pHeader->width;
+	GLsizei height = (GLsizei)pHeader->height;
+
+	// mip 0
+	const byte *pMip = pBuffer + sizeof( img::DDS_HEADER ) + sizeof( img::DDS_HEADER_DXT10 );
+	GLsizei mipSize = Max( 1, ( ( width + 3 ) / 4 ) ) * Max( 1, ( ( height + 3 ) / 4 ) ) * blockSize;
+
+	for ( GLint i = 0; i < level; ++i )
+	{
+		// add the size of the mip to get the offset to the next mip
+		pMip += mipSize;
+
+		width = Max( 1, width / 2 );
+		height = Max( 1, height / 2 );
+		mipSize = Max( 1, ( ( width + 3 ) / 4 ) ) * Max( 1, ( ( height + 3 ) / 4 ) ) * blockSize;
+	}
+
+	glCompressedTexImage2D( GL_TEXTURE_2D, level, format, width, height, 0, mipSize, pMip );
+
+	return mipSize;
+}
+
 // for compressed images, pData is the whole file
 // this function is not allowed to fail under any circumstances
-static GLuint GL_UploadCompressed( const byte *pBuffer, imageFlags_t flags )
+// if the image keeps pBuffer to stream from, image->streamData is set
+static GLuint GL_UploadCompressed( image_t *image, byte *pBuffer )
 {
 	GLuint id;
 
@@ -218,60 +301,99 @@ static GLuint GL_UploadCompressed( const byte *pBuffer, imageFlags_t flags )
 		// no mips?
 	}
 
-	GLsizei width = (GLsizei)pHeader->width;
-	GLsizei height = (GLsizei)pHeader->height;
-
 	GLenum format;
 	int blockSize;
 
-	const img::DDS_HEADER_DXT10 *pHeader2 = (const img::DDS_HEADER_DXT10 *)( pBuffer + sizeof( img::DDS_HEADER ) );
-
-	switch ( pHeader2->dxgiFormat )
+	if ( !GL_CompressedFormat( pBuffer, format, blockSize ) )
 	{
-		// Classic DXT1
-	case DXGI_FORMAT_BC1_UNORM:
-		format = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
-		blockSize = 8;
-		break;
-		// New BC4 and BC5
-	case DXGI_FORMAT_BC4_UNORM:
-		format = GL_COMPRESSED_RED_RGTC1;
-		blockSize = 8;
-		break;
-	case DXGI_FORMAT_BC5_UNORM:
-		format = GL_COMPRESSED_RG_RGTC2;
-		blockSize = 16;
-		break;
-		// Super mega new (10 years old) BC6 and BC7
-	case DXGI_FORMAT_BC7_UNORM:
-		format = GL_COMPRESSED_RGBA_BPTC_UNORM_ARB;
-		blockSize = 16;
-		break;
-	default:
 		Com_FatalError( "A DDS file was present with a compression type not yet supported.\nSorry for crashing but I don't want to refactor the code just yet.\n" );
 	}
 
-	// mip 0
-	const byte *pMip = pBuffer + sizeof( img::DDS_HEADER ) + sizeof( img::DDS_HEADER_DXT10 );
+	// the largest mip that goes up now
+	GLint firstLevel = 0;
+	if ( r_streamTextures.GetBool() && !( image->flags & IF_NOMIPS ) )
+	{
+		const int streamSize = Max( r_streamMipSize.GetInt(), 1 );
+		for ( int size = Max( image->width, image->height ); size > streamSize && firstLevel < mipCount - 1; size /= 2 ) {
+			++firstLevel;
+		}
+	}
 
-	for ( GLint level = 0; level < mipCount; ++level )
+	// smallest first
+	for ( GLint level = mipCount - 1; level >= firstLevel; --level )
 	{
-		GLsizei mipSize = Max( 1, ( ( width + 3 ) / 4 ) ) * Max( 1, ( ( height + 3 ) / 4 ) ) * blockSize;
+		GL_UploadCompressedLevel( pBuffer, level, format, blockSize );
+	}
 
-		glCompressedTexImage2D( GL_TEXTURE_2D, level, format, width, height, 0, mipSize, pMip );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, firstLevel );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, mipCount - 1 );
 
-		width = Max( 1, width / 2 );
-		height = Max( 1, height / 2 );
+	GL_ApplyTextureParameters( image->flags );
 
-		// add the size of the mip to get the offset to the next mip
-		pMip += mipSize;
+	if ( firstLevel > 0 )
+	{
+		image->streamData = pBuffer;
+		image->streamLevel = firstLevel;
+		s_streamingImages.push_back( image );
 	}
 
-	GL_ApplyTextureParameters( flags );
-
 	return id;
 }
 
+static void GL_StopStreaming( image_t *image )
+{
+	const auto it = std::find( s_streamingImages.begin(), s_streamingImages.end(), image );
+	if ( it != s_streamingImages.end() )
+	{
+		*it = s_streamingImages.back();
+		s_streamingImages.pop_back();
+	}
+
+	Mem_Free( image->streamData );
+	image->streamData = nullptr;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Each pass goes up one mip on every streaming image so they all sharpen together, a pass stops
+// early once this frame's budget is gone
+//-------------------------------------------------------------------------------------------------
+void GL_StreamImages()
+{
+	if ( s_streamingImages.empty() ) {
+		return;
+	}
+
+	// everything at once if streaming was turned off
+	int64 budget = r_streamTextures.GetBool() ? Max( r_streamBudget.GetInt(), 1 ) * 1024ll : INT64_MAX;
+
+	while ( budget > 0 && !s_streamingImages.empty() )
+	{
+		for ( size_t i = 0; i < s_streamingImages.size() && budget > 0; )
+		{
+			image_t *image = s_streamingImages[i];
+
+			GLenum format;
+			int blockSize;
+			GL_CompressedFormat( image->streamData, format, blockSize );
+
+			--image->streamLevel;
+
+			GL_BindTexture( image->texnum );
+			budget -= GL_UploadCompressedLevel( image->streamData, image->streamLevel, format, blockSize );
+			glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, image->streamLevel );
+
+			if ( image->streamLevel == 0 )
+			{
+				// swaps the last one into i
+				GL_StopStreaming( image );
+				continue;
+			}
+
+			++i;
+		}
+	}
+}
+
 // uploads a 32-bit, uncompressed texture pointed to by pData
 static GLuint GL_Upload( const byte *pData, int width, int height, imageFlags_t flags )
 {
@@ -297,9 +419,10 @@ static GLuint GL_Upload( const byte *pData, int width, int height, imageFlags_t
 }
 
 //-------------------------------------------------------------------------------------------------
-// This is the only function that can create image_t's
+// Finds a free image_t, images waiting on a deferred upload don't have a texnum yet so the name
+// decides whether a slot is in use
 //-------------------------------------------------------------------------------------------------
-static image_t *GL_CreateImage( const char *name, byte *pic, int width, int height, imageFlags_t flags, bool compressed )
+static image_t *GL_AllocImage( const char *name, int width, int height, imageFlags_t flags )
 {
 	int			i;
 	image_t *	image;
@@ -307,7 +430,7 @@ static image_t *GL_CreateImage( const char *name, byte *pic, int width, int heig
 	// find a free image_t
 	for ( i = 0, image = gltextures; i < numgltextures; i++, image++ )
 	{
-		if ( !image->texnum ) {
+		if ( !image->name[0] ) {
 			break;
 		}
 	}
@@ -326,20 +449,42 @@ static image_t *GL_CreateImage( const char *name, byte *pic, int width, int heig
 	image->width = width;
 	image->height = height;
 	image->flags = flags;
+	image->texnum = 0;
+	image->streamData = nullptr;
+	image->streamLevel = 0;
 
+	image->sl = 0;
+	image->sh = 1;
+	image->tl = 0;
+	image->th = 1;
+
+	s_imageHash.Insert( image );
+
+	return image;
+}
+
+// A compressed image can keep pic to stream its larger mips from, image->streamData is then pic
+// and it's freed along with the image
+static void GL_UploadImage( image_t *image, byte *pic, int width, int height, bool compressed )
+{
 	if ( compressed )
 	{
-		image->texnum = GL_UploadCompressed( pic, flags );
+		image->texnum = GL_UploadCompressed( image, pic );
 	}
 	else
 	{
-		image->texnum = GL_Upload( pic, width, height, flags );
+		image->texnum = GL_Upload( pic, width, height, image->flags );
 	}
+}
 
-	image->sl = 0;
-	image->sh = 1;
-	image->tl = 0;
-	image->th = 1;
+//-------------------------------------------------------------------------------------------------
+// This is the only function that can create image_t's
+//-------------------------------------------------------------------------------------------------
+static image_t *GL_CreateImage( const char *name, byte *pic, int width, int height, imageFlags_t flags, bool compressed )
+{
+	image_t *image = GL_AllocImage( name, width, height, flags );
+
+	GL_UploadImage( image, pic, width, height, compressed );
 
 	return image;
 }
@@ -379,71 +524,266 @@ static bool GL_CategorizeDDS( const char *pName, const byte *pBuffer, int bufLen
 }
 
 //-------------------------------------------------------------------------------------------------
-// Loads any of the supported image types into a cannonical 32 bit format.
+// Turns a file into a cannonical 32 bit image, or leaves it as it is for DDS. PNGs and TGAs come
+// back as a cooked DDS instead when the texture cache takes them. Takes ownership of pBuffer, the
+// result is freed with Mem_Free. Safe to call from the job workers.
 //-------------------------------------------------------------------------------------------------
-static bool GL_LoadImage( const char *pName, int &width, int &height, byte *&pPic )
+static byte *GL_DecodeImage( const char *pName, byte *pBuffer, fsSize_t nBufLen, imageFlags_t flags, int &width, int &height, bool &compressed )
 {
-	byte *pBuffer;
-	fsSize_t nBufLen = FileSystem::LoadFile( pName, (void **)&pBuffer );
-	if ( !pBuffer )
-	{
-		return false;
-	}
+	byte *pPic;
 
 	assert( nBufLen > 32 ); // Sanity check
 
-	if ( img::TestPNG( pBuffer ) )
-	{
-		pPic = img::LoadPNG( pBuffer, width, height );
+	compressed = false;
 
-		FileSystem::FreeFile( pBuffer );
-		return false;
-	}
-	else if ( img::TestDDS( pBuffer ) )
+	if ( img::TestDDS( pBuffer ) )
 	{
 		// if we're a dds, pPic becomes the file buffer
 
 		if ( !GL_CategorizeDDS( pName, pBuffer, nBufLen ) ) {
-			return false;
+			FileSystem::FreeFile( pBuffer );
+			return nullptr;
 		}
 
-		pPic = pBuffer;
+		const img::DDS_HEADER *pHeader = (const img::DDS_HEADER *)pBuffer;
+		width = (int)pHeader->width;
+		height = (int)pHeader->height;
 
-		return true;
+		compressed = true;
+		return pBuffer;
+	}
+
+	// the UI doesn't want compression artifacts, normal maps would need the shaders to rebuild Z
+	const bool cache = TexCache_Enabled() && !( flags & ( IF_NOMIPS | IF_NORMALMAP ) );
+	const int64 start = Time_Microseconds();
+	uint64 hash = 0;
+
+	if ( cache )
+	{
+		hash = TexCache_HashSource( pBuffer, nBufLen );
+
+		fsSize_t cookedLen;
+		pPic = TexCache_Find( hash, cookedLen );
+		if ( pPic )
+		{
+			FileSystem::FreeFile( pBuffer );
+
+			const img::DDS_HEADER *pHeader = (const img::DDS_HEADER *)pPic;
+			width = (int)pHeader->width;
+			height = (int)pHeader->height;
+
+			TexCache_RecordLoad( false, Time_Microseconds() - start, width, height, cookedLen );
+
+			compressed = true;
+			return pPic;
+		}
+	}
+
+	if ( img::TestPNG( pBuffer ) )
+	{
+		pPic = img::LoadPNG( pBuffer, width, height );
 	}
 	else
 	{
 		// There is no real test for TGA
 		pPic = img::LoadTGA( pBuffer, nBufLen, width, height );
+	}
 
-		FileSystem::FreeFile( pBuffer );
+	FileSystem::FreeFile( pBuffer );
+
+	if ( cache && pPic )
+	{
+		fsSize_t cookedLen;
+		byte *pCooked = TexCache_Cook( pPic, width, height, cookedLen );
+		Mem_Free( pPic );
+
+		TexCache_Store( hash, pCooked, cookedLen );
+		TexCache_RecordLoad( true, Time_Microseconds() - start, width, height, cookedLen );
+
+		compressed = true;
+		return pCooked;
+	}
+
+	return pPic;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Loads any of the supported image types into a cannonical 32 bit format.
+//-------------------------------------------------------------------------------------------------
+static bool GL_LoadImage( const char *pName, imageFlags_t flags, int &width, int &height, byte *&pPic )
+{
+	byte *pBuffer;
+	fsSize_t nBufLen = FileSystem::LoadFile( pName, (void **)&pBuffer );
+	if ( !pBuffer )
+	{
+		pPic = nullptr;
 		return false;
 	}
 
-	// TODO: Unreachable? This function kinda sucks
-	
-	Com_Printf( "GL_LoadImage - %s is an unsupported image format!", pName );
-	return false;
+	bool compressed;
+	pPic = GL_DecodeImage( pName, pBuffer, nBufLen, flags, width, height, compressed );
+
+	return compressed;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Deferred images
+//
+// During registration images are only read when they're asked for, their size comes from the
+// header so surfaces can still be built. GL_EndImageBatch decodes them on the job pool
+// ASSET_BATCH_SIZE at a time and uploads each batch on the main thread. The loading screen is
+// drawn in the middle of registration, so GL_FlushImageBatch uploads whatever is waiting before
+// every frame.
+//-------------------------------------------------------------------------------------------------
+
+struct pendingImage_t
+{
+	image_t *	image;
+	byte *		buffer;			// the file, then the decoded image
+	fsSize_t	length;
+	int			width, height;
+	bool		compressed;
+	int64		readTime;
+	int64		decodeTime;
+};
+
+static std::vector<pendingImage_t>	s_pendingImages;
+static bool							s_batchingImages;
+
+static void GL_DecodeImageJob( void *params, uint32 index )
+{
+	pendingImage_t &pending = static_cast<pendingImage_t *>( params )[index];
+
+	const int64 start = Time_Microseconds();
+	pending.buffer = GL_DecodeImage( pending.image->name, pending.buffer, pending.length, pending.image->flags, pending.width, pending.height, pending.compressed );
+	pending.decodeTime = Time_Microseconds() - start;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Reads an image and queues it for decoding, returns null if it has to be loaded straight away
+//-------------------------------------------------------------------------------------------------
+static image_t *GL_DeferImage( const char *name, imageFlags_t flags )
+{
+	pendingImage_t pending;
+
+	pending.length = Asset_LoadFile( name, (void **)&pending.buffer, &pending.readTime );
+	if ( !pending.buffer ) {
+		return nullptr;
+	}
+
+	if ( pending.length <= 32 || !img::GetImageSize( pending.buffer, pending.length, pending.width, pending.height ) )
+	{
+		FileSystem::FreeFile( pending.buffer );
+		return nullptr;
+	}
+
+	pending.image = GL_AllocImage( name, pending.width, pending.height, flags );
+	pending.compressed = false;
+	pending.decodeTime = 0;
+
+	s_pendingImages.push_back( pending );
+
+	return pending.image;
+}
+
+void GL_BeginImageBatch()
+{
+	// a registration that was cut short might have left some behind
+	if ( !s_pendingImages.empty() ) {
+		GL_EndImageBatch();
+	}
+
+	s_batchingImages = true;
+}
+
+void GL_FlushImageBatch()
+{
+	// a missing texture rather than nothing, if a file that looked fine doesn't decode
+	static byte failedPic[2 * 2 * 4]
+	{
+		255, 0, 255, 255,	0, 0, 0, 255,
+		0, 0, 0, 255,		255, 0, 255, 255
+	};
+
+	for ( size_t first = 0; first < s_pendingImages.size(); first += ASSET_BATCH_SIZE )
+	{
+		const uint32 count = static_cast<uint32>( Min<size_t>( ASSET_BATCH_SIZE, s_pendingImages.size() - first ) );
+		pendingImage_t *batch = s_pendingImages.data() + first;
+
+		if ( Asset_Parallel() )
+		{
+			Jobs::ParallelFor( count, GL_DecodeImageJob, batch );
+		}
+		else
+		{
+			for ( uint32 i = 0; i < count; ++i ) {
+				GL_DecodeImageJob( batch, i );
+			}
+		}
+
+		TexCache_PrintMessages();
+
+		for ( uint32 i = 0; i < count; ++i )
+		{
+			pendingImage_t &pending = batch[i];
+
+			const int64 start = Time_Microseconds();
+
+			if ( pending.buffer )
+			{
+				GL_UploadImage( pending.image, pending.buffer, pending.width, pending.height, pending.compressed );
+				if ( pending.image->streamData != pending.buffer ) {
+					Mem_Free( pending.buffer );
+				}
+			}
+			else
+			{
+				Com_Printf( "Couldn't decode %s\n", pending.image->name );
+				GL_UploadImage( pending.image, failedPic, 2, 2, false );
+			}
+
+			Asset_Record( ASSET_IMAGE, pending.image->name, pending.readTime, pending.decodeTime, Time_Microseconds() - start );
+		}
+	}
+
+	s_pendingImages.clear();
+}
+
+void GL_EndImageBatch()
+{
+	s_batchingImages = false;
+
+	GL_FlushImageBatch();
 }
 
 //-------------------------------------------------------------------------------------------------
 // Finds or loads the given image
 //
-// THIS CHOKES ON TEXTURES WITH THE SAME NAME, STUDIOMODELS CAN HAVE IDENTICAL TEXTURE NAMES THAT ARE
-// DIFFERENT!!! THIS IS BAD!
+// Images are keyed by their path and flags, the same file asked for with different sampling gets
+// its own texture
 //-------------------------------------------------------------------------------------------------
-static image_t *GL_FindImage( const char *name, imageFlags_t flags )
+static image_t *GL_FindImage( const char *pathName, imageFlags_t flags )
 {
-	int i;
 	image_t *image;
 	int width, height;
+	char name[MAX_QPATH];
+
+	assert( pathName && pathName[0] );
 
-	assert( name && name[0] );
+	R_NormalizePath( pathName, name );
 
 	// look for it
-	for ( i = 0, image = gltextures; i < numgltextures; ++i, ++image )
+	image = s_imageHash.Find( name, [flags]( const image_t *other ) { return other->flags == flags; } );
+	if ( image )
 	{
-		if ( Q_strcmp( name, image->name ) == 0 )
+		++image->refcount;
+		return image;
+	}
+
+	if ( s_batchingImages )
+	{
+		image = GL_DeferImage( name, flags );
+		if ( image )
 		{
 			++image->refcount;
 			return image;
@@ -451,11 +791,15 @@ static image_t *GL_FindImage( const char *name, imageFlags_t flags )
 	}
 
 	//
-	// load the pic from disk
+	// load the pic from disk, outside a batch an image that isn't in the texture cache yet is
+	// cooked right here, which is what the batches and cooktextures are there to avoid
 	//
+	const int64 start = Time_Microseconds();
+
 	byte *pic = nullptr;
 
-	bool compressed = GL_LoadImage( name, width, height, pic );
+	bool compressed = GL_LoadImage( name, flags, width, height, pic );
+	TexCache_PrintMessages();
 	if ( !pic ) {
 		defaultMaterial->image->IncrementRefCount();
 		return defaultMaterial->image;
@@ -463,11 +807,12 @@ static image_t *GL_FindImage( const char *name, imageFlags_t flags )
 
 	image = GL_CreateImage( name, pic, width, height, flags, compressed );
 
-	// HACK: this is weird
-	if ( compressed ) {
+	if ( image->streamData != pic ) {
 		Mem_Free( pic );
-	} else {
-		FileSystem::FreeFile( pic );
+	}
+
+	if ( s_batchingImages ) {
+		Asset_Record( ASSET_IMAGE, name, 0, 0, Time_Microseconds() - start );
 	}
 
 	++image->refcount;
@@ -616,7 +961,7 @@ bool ParseMaterial( char *data, material_t *material )
 
 	if ( normTexture[0] )
 	{
-		material->normImage = GL_FindImage( normTexture, flags );
+		material->normImage = GL_FindImage( normTexture, flags | IF_NORMALMAP );
 	}
 	else
 	{
@@ -673,6 +1018,8 @@ static material_t *GL_CreateMaterialFromData( const char *name, image_t *image,
 
 	material->registration_sequence = -1; // Data materials are always managed
 
+	s_materialHash.Insert( material );
+
 	return material;
 }
 
@@ -729,14 +1076,17 @@ static material_t *GL_CreateMaterial( const char *name )
 	}
 
 	FileSystem::FreeFile( pBuffer );
+
+	s_materialHash.Insert( material );
+
 	return material;
 }
 
 material_t *GL_FindMaterial( const char *name, bool managed /*= false*/ )
 {
-	int i;
 	material_t *material;
 	char newname[MAX_QPATH];
+	char pathname[MAX_QPATH];
 
 	if ( strstr( name, "players/" ) )
 	{
@@ -755,22 +1105,59 @@ material_t *GL_FindMaterial( const char *name, bool managed /*= false*/ )
 		Q_strcpy_s( newname, name );
 	}
 
+	R_NormalizePath( newname, pathname );
+
 	// look for it
-	for ( i = 0, material = glmaterials; i < numglmaterials; ++i, ++material )
+	material = s_materialHash.Find( pathname );
+	if ( !material ) {
+		material = GL_CreateMaterial( pathname );
+	}
+
+	GL_TouchMaterial( material, managed );
+
+	return material;
+}
+
+//-------------------------------------------------------------------------------------------------
+// Managed materials stay managed, that includes the generated ones like the default material
+//-------------------------------------------------------------------------------------------------
+void GL_TouchMaterial( material_t *material, bool managed /*= false*/ )
+{
+	if ( material->registration_sequence == -1 ) {
+		return;
+	}
+
+	if ( managed )
 	{
-		if ( Q_strcmp( newname, material->name ) == 0 )
-		{
-			material->registration_sequence = managed ? -1 : tr.registrationSequence;
-			return material;
-		}
+		s_materialTouches.Remove( material );
+		material->registration_sequence = -1;
+		return;
 	}
 
-	// TODO: Managed materials get their registration sequence melted here
+	s_materialTouches.Touch( material, tr.registrationSequence );
+}
+
+//-------------------------------------------------------------------------------------------------
+//-------------------------------------------------------------------------------------------------
+void GL_UnlinkImage( image_t *image )
+{
+	if ( image->name[0] ) {
+		s_imageHash.Remove( image );
+	}
 
-	material = GL_CreateMaterial( newname );
-	material->registration_sequence = managed ? -1 : tr.registrationSequence;
+	if ( image->streamData ) {
+		GL_StopStreaming( image );
+	}
+}
 
-	return material;
+//-------------------------------------------------------------------------------------------------
+//-------------------------------------------------------------------------------------------------
+void GL_UnlinkMaterial( material_t *material )
+{
+	if ( material->name[0] ) {
+		s_materialHash.Remove( material );
+		s_materialTouches.Remove( material );
+	}
 }
 
 //-------------------------------------------------------------------------------------------------
@@ -805,20 +1192,17 @@ void GL_FreeUnusedImages( void )
 #endif
 
 //-------------------------------------------------------------------------------------------------
-// Any image that was not touched on this registration sequence
-// will be freed.
+// Any material that was not touched on this registration sequence
+// will be freed. They're all at the end of the touch list.
 //-------------------------------------------------------------------------------------------------
 void GL_FreeUnusedMaterials( void )
 {
-	int i;
 	material_t *material;
 
-	for ( i = 0, material = glmaterials; i < numglmaterials; i++, material++ )
+	while ( ( material = s_materialTouches.Oldest() ) != nullptr )
 	{
 		if ( material->registration_sequence == tr.registrationSequence )
-			continue;		// used this sequence
-		if ( material->registration_sequence <= 0 )
-			continue;		// free slot or managed
+			break;		// used this sequence, so is everything after it
 
 		Com_DPrintf( "Clearing %s\n", material->name );
 
@@ -1011,6 +1395,18 @@ void GL_ShutdownImages( void )
 		material->Delete();
 	}
 
+	// anything still waiting to be decoded goes with its image
+	for ( pendingImage_t &pending : s_pendingImages )
+	{
+		FileSystem::FreeFile( pending.buffer );
+	}
+	s_pendingImages.clear();
+	s_batchingImages = false;
+
+	s_materialHash.Clear();
+	s_materialTouches.Clear();
+	s_imageHash.Clear();
+
 	// Images are dereferenced by the material when their refcount reaches 0
 	// Go through every single image for security
 #ifdef Q_DEBUG
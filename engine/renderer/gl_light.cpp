@@ -1,6 +1,11 @@
 
 #include "gl_local.h"
 
+#if defined __SSE2__ || defined _M_X64
+#define LIGHTMAP_SIMD
+#include <immintrin.h>
+#endif
+
 static int r_dlightframecount;
 
 #define	DLIGHT_CUTOFF	64
@@ -340,6 +345,51 @@ void R_AddDynamicLights (msurface_t *surf)
 }
 
 
+/*
+===============
+R_AccumulateLightmap
+
+Adds a style layer of rgb luxels to the float block, bl += lightmap * scale
+===============
+*/
+static void R_AccumulateLightmap( float *bl, const byte *lightmap, int size, const float *scale )
+{
+	int i = 0;
+
+#ifdef LIGHTMAP_SIMD
+	// rgb repeats every 3 lanes, so 4 luxels are 3 registers with the scale rotated to match
+	const __m128 scale0 = _mm_setr_ps( scale[0], scale[1], scale[2], scale[0] );
+	const __m128 scale1 = _mm_setr_ps( scale[1], scale[2], scale[0], scale[1] );
+	const __m128 scale2 = _mm_setr_ps( scale[2], scale[0], scale[1], scale[2] );
+	const __m128i zero = _mm_setzero_si128();
+
+	for ( ; i + 4 <= size; i += 4, bl += 12, lightmap += 12 )
+	{
+		int32 packed[4]{};
+		memcpy( packed, lightmap, 12 );
+
+		const __m128i bytes = _mm_loadu_si128( (const __m128i *)packed );
+		const __m128i lo16 = _mm_unpacklo_epi8( bytes, zero );
+		const __m128i hi16 = _mm_unpackhi_epi8( bytes, zero );
+
+		const __m128 l0 = _mm_cvtepi32_ps( _mm_unpacklo_epi16( lo16, zero ) );
+		const __m128 l1 = _mm_cvtepi32_ps( _mm_unpackhi_epi16( lo16, zero ) );
+		const __m128 l2 = _mm_cvtepi32_ps( _mm_unpacklo_epi16( hi16, zero ) );
+
+		_mm_storeu_ps( bl + 0, _mm_add_ps( _mm_loadu_ps( bl + 0 ), _mm_mul_ps( l0, scale0 ) ) );
+		_mm_storeu_ps( bl + 4, _mm_add_ps( _mm_loadu_ps( bl + 4 ), _mm_mul_ps( l1, scale1 ) ) );
+		_mm_storeu_ps( bl + 8, _mm_add_ps( _mm_loadu_ps( bl + 8 ), _mm_mul_ps( l2, scale2 ) ) );
+	}
+#endif
+
+	for ( ; i < size; i++, bl += 3, lightmap += 3 )
+	{
+		bl[0] += lightmap[0] * scale[0];
+		bl[1] += lightmap[1] * scale[1];
+		bl[2] += lightmap[2] * scale[2];
+	}
+}
+
 /*
 ** R_SetCacheState
 */
@@ -404,77 +454,19 @@ void R_BuildLightMap(msurface_t *surf, byte *dest, int stride)
 	lightmap = surf->samples;
 
 	// add all the lightmaps
-	if (nummaps == 1)
-	{
-		int maps;
+	memset(s_blocklights, 0, sizeof(s_blocklights[0]) * size * 3);
 
-		for (maps = 0; maps < MAXLIGHTMAPS && surf->styles[maps] != 255;
-			maps++)
-		{
-			bl = s_blocklights;
-
-			for (i = 0; i < 3; i++)
-				scale[i] = r_modulate->GetFloat() * tr.refdef.lightstyles[surf->styles[maps]].rgb[i];
-
-			if (scale[0] == 1.0F &&
-				scale[1] == 1.0F &&
-				scale[2] == 1.0F)
-			{
-				for (i = 0; i < size; i++, bl += 3)
-				{
-					bl[0] = lightmap[i * 3 + 0];
-					bl[1] = lightmap[i * 3 + 1];
-					bl[2] = lightmap[i * 3 + 2];
-				}
-			}
-			else
-			{
-				for (i = 0; i < size; i++, bl += 3)
-				{
-					bl[0] = lightmap[i * 3 + 0] * scale[0];
-					bl[1] = lightmap[i * 3 + 1] * scale[1];
-					bl[2] = lightmap[i * 3 + 2] * scale[2];
-				}
-			}
-			lightmap += size * 3;		// skip to next lightmap
-		}
-	}
-	else
+	for (i = 0; i < nummaps; i++)
 	{
-		int maps;
-
-		memset(s_blocklights, 0, sizeof(s_blocklights[0]) * size * 3);
+		style = &tr.refdef.lightstyles[surf->styles[i]];
 
-		for (maps = 0; maps < MAXLIGHTMAPS && surf->styles[maps] != 255;
-			maps++)
-		{
-			bl = s_blocklights;
+		scale[0] = r_modulate->GetFloat() * style->rgb[0];
+		scale[1] = r_modulate->GetFloat() * style->rgb[1];
+		scale[2] = r_modulate->GetFloat() * style->rgb[2];
 
-			for (i = 0; i < 3; i++)
-				scale[i] = r_modulate->GetFloat() * tr.refdef.lightstyles[surf->styles[maps]].rgb[i];
+		R_AccumulateLightmap(s_blocklights, lightmap, size, scale);
 
-			if (scale[0] == 1.0F &&
-				scale[1] == 1.0F &&
-				scale[2] == 1.0F)
-			{
-				for (i = 0; i < size; i++, bl += 3)
-				{
-					bl[0] += lightmap[i * 3 + 0];
-					bl[1] += lightmap[i * 3 + 1];
-					bl[2] += lightmap[i * 3 + 2];
-				}
-			}
-			else
-			{
-				for (i = 0; i < size; i++, bl += 3)
-				{
-					bl[0] += lightmap[i * 3 + 0] * scale[0];
-					bl[1] += lightmap[i * 3 + 1] * scale[1];
-					bl[2] += lightmap[i * 3 + 2] * scale[2];
-				}
-			}
-			lightmap += size * 3;		// skip to next lightmap
-		}
+		lightmap += size * 3;		// skip to next lightmap
 	}
 
 	// add all the dynamic lights
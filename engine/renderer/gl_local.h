@@ -39,6 +39,7 @@ static_assert( DIRECTX_MATH_VERSION >= 317 );
 
 //=============================================================================
 
+#include "gl_registry.h"
 #include "gl_model.h"
 #include "gl_jaffamodel.h"
 #include "gl_iqm.h"
@@ -102,12 +103,22 @@ struct perfCounters_t
 	uint32		worldPolys;
 	uint32		worldDrawCalls;
 	uint32		aliasPolys;
+	uint32		lightmapSurfaces;
+	uint32		lightmapLuxels;
+	uint32		lightmapUploads;
+	uint32		visCacheMisses;
+	uint32		worldListsReused;
 
 	void Reset()
 	{
 		worldPolys = 0;
 		worldDrawCalls = 0;
 		aliasPolys = 0;
+		lightmapSurfaces = 0;
+		lightmapLuxels = 0;
+		lightmapUploads = 0;
+		visCacheMisses = 0;
+		worldListsReused = 0;
 	}
 };
 
@@ -262,6 +273,21 @@ material_t	*GL_FindMaterial( const char *name, bool managed = false );
 
 void		GL_FreeUnusedMaterials();
 
+// Marks a material as used by this registration sequence, managed materials are never freed
+void		GL_TouchMaterial( material_t *material, bool managed = false );
+
+// Takes a resource out of the registries before its slot is cleared
+void		GL_UnlinkImage( image_t *image );
+void		GL_UnlinkMaterial( material_t *material );
+
+// Images found between these are decoded on the job pool and uploaded at the end
+void		GL_BeginImageBatch();
+void		GL_EndImageBatch();
+void		GL_FlushImageBatch();
+
+// Uploads the next mips of the compressed images that were loaded with only their small ones
+void		GL_StreamImages();
+
 void		GL_InitImages();
 void		GL_ShutdownImages();
 
@@ -287,6 +313,7 @@ using imageFlags_t = uint8;
 #define IF_CLAMPS		8	// Clamp to edge (S)
 #define IF_CLAMPT		16	// Clamp to edge (T)
 #define IF_SRGB			32	// Upload as SRGB
+#define IF_NORMALMAP	64	// Holds normals, these aren't block compressed by the texture cache
 
 struct image_t
 {
@@ -298,6 +325,12 @@ struct image_t
 	float				sl, tl, sh, th;				// 0,0 - 1,1 unless part of the scrap
 	bool				scrap;						// true if this is part of a larger sheet
 
+	byte *				streamData;					// the DDS the larger mips are still to come from
+	int					streamLevel;				// the largest mip uploaded so far
+
+	uint32				hashKey;
+	image_t *			hashNext;
+
 	void IncrementRefCount()
 	{
 		assert( refcount >= 0 );
@@ -312,6 +345,7 @@ struct image_t
 
 	void Delete()
 	{
+		GL_UnlinkImage( this );
 		glDeleteTextures( 1, &texnum );
 		memset( this, 0, sizeof( *this ) );
 	}
@@ -328,6 +362,11 @@ struct material_t
 	uint32				alpha;						// alpha transparency, in range 0 - 255
 	int32				registration_sequence;		// 0 = free, -1 = managed
 
+	uint32				hashKey;
+	material_t *		hashNext;
+	material_t *		touchPrev;					// in registration order, unmanaged only
+	material_t *		touchNext;
+
 	// Returns true if this material is the missing texture
 	bool IsMissing() const { return this == defaultMaterial; }
 
@@ -339,7 +378,7 @@ struct material_t
 
 	void Register() {
 		if ( IsOkay() ) {
-			registration_sequence = tr.registrationSequence;
+			GL_TouchMaterial( this );
 		}
 	}
 
@@ -369,6 +408,7 @@ struct material_t
 
 	// Deference the referenced image and clear this struct
 	void Delete() {
+		GL_UnlinkMaterial( this );
 		image->DecrementRefCount();
 		if ( image->refcount == 0 ) {
 			// Save time in FreeUnusedImages
@@ -466,6 +506,7 @@ void	BspExt_Save( const model_t *worldModel, uint32 flags );
 ===============================================================================
 */
 
+void	R_PrepareAliasModels();
 void	R_DrawAliasModel( entity_t *e );
 void	R_DrawStaticMeshFile( entity_t *e );
 
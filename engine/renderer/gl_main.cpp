@@ -348,6 +348,9 @@ static void R_DrawEntities()
 		return;
 	}
 
+	// lerp all the alias models in one go
+	R_PrepareAliasModels();
+
 	// draw non-transparent first
 
 	for ( int i = 0; i < tr.refdef.num_entities; ++i )
@@ -766,9 +769,13 @@ static void R_RenderView( refdef_t *fd )
 	{
 		Com_Printf(
 			"%4i wpoly %4i epoly\n"
-			"%4i world draw calls\n",
+			"%4i world draw calls\n"
+			"%4i lightmap surfs %6i luxels %2i uploads\n"
+			"%i vis cache misses %i world lists reused\n",
 			tr.pc.worldPolys, tr.pc.aliasPolys,
-			tr.pc.worldDrawCalls
+			tr.pc.worldDrawCalls,
+			tr.pc.lightmapSurfaces, tr.pc.lightmapLuxels, tr.pc.lightmapUploads,
+			tr.pc.visCacheMisses, tr.pc.worldListsReused
 		);
 	}
 }
@@ -862,6 +869,11 @@ void R_BeginFrame( bool imgui, int frameBuffer )
 		R_BindFBO( frameBuffer );
 	}
 
+	GL_StreamImages();
+
+	// nothing gets drawn with an image that hasn't been uploaded yet
+	GL_FlushImageBatch();
+
 	// tell imgui we're starting a new frame
 	if ( imgui )
 	{
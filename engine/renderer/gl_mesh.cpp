@@ -134,8 +134,6 @@ static const float r_avertexnormals[NUMVERTEXNORMALS][3]{
 #include "anorms.inl"
 };
 
-static vec4_t s_lerped[MAX_VERTS];
-
 static vec3_t shadevector;
 static vec3_t shadelight;
 
@@ -145,64 +143,188 @@ static const float r_avertexnormal_dots[SHADEDOT_QUANT][256]{
 #include "anormtab.inl"
 };
 
-static const float *shadedots = r_avertexnormal_dots[0];
+/*
+===================================================================================================
+
+	Vertex lerping
+
+	Alias frames are stored as bytes that have to be scaled, offset and blended between two
+	frames before they can be drawn. The lerped position goes in xyz and the lerped shade term
+	(the vertex normal dotted against the quantized light direction) goes in w, so the draw
+	pass never has to look at the frame data again.
+
+===================================================================================================
+*/
 
-static void GL_LerpVerts(
-	int numVerts, const dtrivertx_t *verts, const dtrivertx_t *oldVerts,
-	const vec3_t move, const vec3_t frontv, const vec3_t backv,
-	vec4_t lerp )
+#if defined __SSE2__ || defined _M_X64
+#define ALIAS_LERP_SIMD
+#include <immintrin.h>
+#endif
+
+struct alignas( 16 ) aliasVert_t
 {
-	for ( int i = 0; i < numVerts; ++i, ++verts, ++oldVerts, lerp += 4 )
+	float		xyz[3];
+	float		shade;
+};
+
+static_assert( sizeof( aliasVert_t ) == sizeof( vec4_t ) );
+
+struct aliasLerp_t
+{
+	alignas( 16 ) vec4_t	move;			// w must be zero, so the normal index lane cancels out
+	alignas( 16 ) vec4_t	frontv;
+	alignas( 16 ) vec4_t	backv;
+
+	const dtrivertx_t *		verts;
+	const dtrivertx_t *		oldVerts;
+	const float *			shadedots;
+	float					frontlerp;
+	uint32					numVerts;
+	uint32					firstVert;		// into s_aliasVerts
+};
+
+// fallback for entities that didn't go through R_PrepareAliasModels
+static aliasVert_t s_lerped[MAX_VERTS];
+
+/*
+========================
+GL_LerpVertsScalar
+
+Reference implementation
+========================
+*/
+static void GL_LerpVertsScalar( const aliasLerp_t &lerp, aliasVert_t *out )
+{
+	const dtrivertx_t *verts = lerp.verts;
+	const dtrivertx_t *oldVerts = lerp.oldVerts;
+	const float backlerp = 1.0f - lerp.frontlerp;
+
+	for ( uint32 i = 0; i < lerp.numVerts; ++i )
 	{
-		lerp[0] = move[0] + oldVerts->v[0]*backv[0] + verts->v[0]*frontv[0];
-		lerp[1] = move[1] + oldVerts->v[1]*backv[1] + verts->v[1]*frontv[1];
-		lerp[2] = move[2] + oldVerts->v[2]*backv[2] + verts->v[2]*frontv[2];
+		out[i].xyz[0] = lerp.move[0] + oldVerts[i].v[0] * lerp.backv[0] + verts[i].v[0] * lerp.frontv[0];
+		out[i].xyz[1] = lerp.move[1] + oldVerts[i].v[1] * lerp.backv[1] + verts[i].v[1] * lerp.frontv[1];
+		out[i].xyz[2] = lerp.move[2] + oldVerts[i].v[2] * lerp.backv[2] + verts[i].v[2] * lerp.frontv[2];
+		out[i].shade = lerp.shadedots[oldVerts[i].lightnormalindex] * backlerp
+			+ lerp.shadedots[verts[i].lightnormalindex] * lerp.frontlerp;
 	}
 }
 
-//
-// interpolates between two frames and origins
-// FIXME: batch lerp all vertexes
-//
-static void GL_DrawAliasFrameLerp( const dmdl_t *paliashdr, float backlerp )
+/*
+========================
+GL_LerpVerts
+
+A dtrivertx_t is four bytes, which widen to exactly one float4 lane per vertex,
+the normal index byte is multiplied by zero and overwritten with the shade term
+========================
+*/
+static void GL_LerpVerts( const aliasLerp_t &lerp, aliasVert_t *out )
 {
-	float 	l;
-	daliasframe_t	*frame, *oldframe;
-	dtrivertx_t	*ov, *verts;
-	int		*order;
-	int		count;
-	float	frontlerp;
-	float	alpha;
-	vec3_t	move, delta, vectors[3];
-	vec3_t	frontv, backv;
-	int		i;
-	int		index_xyz;
-	float	*lerp;
+#ifdef ALIAS_LERP_SIMD
+	const dtrivertx_t *verts = lerp.verts;
+	const dtrivertx_t *oldVerts = lerp.oldVerts;
+	const uint32 numVerts = lerp.numVerts;
 
-	frame = (daliasframe_t *)((byte *)paliashdr + paliashdr->ofs_frames 
-		+ currententity->frame * paliashdr->framesize);
-	verts = frame->verts;
+	uint32 i = 0;
 
-	oldframe = (daliasframe_t *)((byte *)paliashdr + paliashdr->ofs_frames 
-		+ currententity->oldframe * paliashdr->framesize);
-	ov = oldframe->verts;
+#ifdef __AVX2__
+	const __m256 move = _mm256_broadcast_ps( (const __m128 *)lerp.move );
+	const __m256 frontv = _mm256_broadcast_ps( (const __m128 *)lerp.frontv );
+	const __m256 backv = _mm256_broadcast_ps( (const __m128 *)lerp.backv );
 
-	order = (int *)((byte *)paliashdr + paliashdr->ofs_glcmds);
+	for ( ; i + 4 <= numVerts; i += 4 )
+	{
+		const __m128i cur8 = _mm_loadu_si128( (const __m128i *)( verts + i ) );
+		const __m128i old8 = _mm_loadu_si128( (const __m128i *)( oldVerts + i ) );
 
-	if ( currententity->flags & RF_TRANSLUCENT )
+		const __m256 cur01 = _mm256_cvtepi32_ps( _mm256_cvtepu8_epi32( cur8 ) );
+		const __m256 cur23 = _mm256_cvtepi32_ps( _mm256_cvtepu8_epi32( _mm_srli_si128( cur8, 8 ) ) );
+		const __m256 old01 = _mm256_cvtepi32_ps( _mm256_cvtepu8_epi32( old8 ) );
+		const __m256 old23 = _mm256_cvtepi32_ps( _mm256_cvtepu8_epi32( _mm_srli_si128( old8, 8 ) ) );
+
+		_mm256_storeu_ps( out[i + 0].xyz, _mm256_add_ps( move, _mm256_add_ps( _mm256_mul_ps( old01, backv ), _mm256_mul_ps( cur01, frontv ) ) ) );
+		_mm256_storeu_ps( out[i + 2].xyz, _mm256_add_ps( move, _mm256_add_ps( _mm256_mul_ps( old23, backv ), _mm256_mul_ps( cur23, frontv ) ) ) );
+	}
+#else
+	const __m128 move = _mm_load_ps( lerp.move );
+	const __m128 frontv = _mm_load_ps( lerp.frontv );
+	const __m128 backv = _mm_load_ps( lerp.backv );
+	const __m128i zero = _mm_setzero_si128();
+
+	for ( ; i + 4 <= numVerts; i += 4 )
 	{
-		alpha = currententity->alpha;
+		const __m128i cur8 = _mm_loadu_si128( (const __m128i *)( verts + i ) );
+		const __m128i old8 = _mm_loadu_si128( (const __m128i *)( oldVerts + i ) );
+
+		const __m128i cur16lo = _mm_unpacklo_epi8( cur8, zero );
+		const __m128i cur16hi = _mm_unpackhi_epi8( cur8, zero );
+		const __m128i old16lo = _mm_unpacklo_epi8( old8, zero );
+		const __m128i old16hi = _mm_unpackhi_epi8( old8, zero );
+
+		const __m128 cur[4]{
+			_mm_cvtepi32_ps( _mm_unpacklo_epi16( cur16lo, zero ) ),
+			_mm_cvtepi32_ps( _mm_unpackhi_epi16( cur16lo, zero ) ),
+			_mm_cvtepi32_ps( _mm_unpacklo_epi16( cur16hi, zero ) ),
+			_mm_cvtepi32_ps( _mm_unpackhi_epi16( cur16hi, zero ) )
+		};
+		const __m128 old[4]{
+			_mm_cvtepi32_ps( _mm_unpacklo_epi16( old16lo, zero ) ),
+			_mm_cvtepi32_ps( _mm_unpackhi_epi16( old16lo, zero ) ),
+			_mm_cvtepi32_ps( _mm_unpacklo_epi16( old16hi, zero ) ),
+			_mm_cvtepi32_ps( _mm_unpackhi_epi16( old16hi, zero ) )
+		};
+
+		for ( uint32 j = 0; j < 4; ++j )
+		{
+			_mm_storeu_ps( out[i + j].xyz, _mm_add_ps( move, _mm_add_ps( _mm_mul_ps( old[j], backv ), _mm_mul_ps( cur[j], frontv ) ) ) );
+		}
 	}
-	else
+#endif
+
+	// leftovers
+	for ( ; i < numVerts; ++i )
 	{
-		alpha = 1.0f;
+		out[i].xyz[0] = lerp.move[0] + oldVerts[i].v[0] * lerp.backv[0] + verts[i].v[0] * lerp.frontv[0];
+		out[i].xyz[1] = lerp.move[1] + oldVerts[i].v[1] * lerp.backv[1] + verts[i].v[1] * lerp.frontv[1];
+		out[i].xyz[2] = lerp.move[2] + oldVerts[i].v[2] * lerp.backv[2] + verts[i].v[2] * lerp.frontv[2];
 	}
 
-	frontlerp = 1.0f - backlerp;
+	// the shade term is a table lookup, no point vectorising it
+	const float *shadedots = lerp.shadedots;
+	const float frontlerp = lerp.frontlerp;
+	const float backlerp = 1.0f - frontlerp;
+
+	for ( i = 0; i < numVerts; ++i )
+	{
+		out[i].shade = shadedots[oldVerts[i].lightnormalindex] * backlerp + shadedots[verts[i].lightnormalindex] * frontlerp;
+	}
+#else
+	GL_LerpVertsScalar( lerp, out );
+#endif
+}
+
+/*
+========================
+GL_SetupAliasLerp
+
+Works out the interpolation parameters for an entity,
+the entity's frames must already be valid
+========================
+*/
+static void GL_SetupAliasLerp( const entity_t *e, const dmdl_t *paliashdr, aliasLerp_t &lerp )
+{
+	const daliasframe_t *frame = (const daliasframe_t *)( (const byte *)paliashdr + paliashdr->ofs_frames
+		+ e->frame * paliashdr->framesize );
+	const daliasframe_t *oldframe = (const daliasframe_t *)( (const byte *)paliashdr + paliashdr->ofs_frames
+		+ e->oldframe * paliashdr->framesize );
+
+	const float backlerp = e->backlerp;
+	const float frontlerp = 1.0f - backlerp;
+
+	vec3_t move, delta, vectors[3];
 
 	// move should be the delta back to the previous frame * backlerp
-	VectorSubtract( currententity->oldorigin, currententity->origin, delta );
-	AngleVectors( currententity->angles, vectors[0], vectors[1], vectors[2] );
+	VectorSubtract( e->oldorigin, e->origin, delta );
+	AngleVectors( e->angles, vectors[0], vectors[1], vectors[2] );
 
 	move[0] = DotProduct( delta, vectors[0] );		// forward
 	move[1] = -DotProduct( delta, vectors[1] );		// left
@@ -210,27 +332,53 @@ static void GL_DrawAliasFrameLerp( const dmdl_t *paliashdr, float backlerp )
 
 	VectorAdd( move, oldframe->translate, move );
 
-	for ( i = 0; i < 3; i++ )
+	for ( int i = 0; i < 3; i++ )
 	{
-		move[i] = backlerp * move[i] + frontlerp * frame->translate[i];
+		lerp.move[i] = backlerp * move[i] + frontlerp * frame->translate[i];
+		lerp.frontv[i] = frontlerp * frame->scale[i];
+		lerp.backv[i] = backlerp * oldframe->scale[i];
 	}
 
-	for ( i = 0; i < 3; i++ )
-	{
-		frontv[i] = frontlerp * frame->scale[i];
-		backv[i] = backlerp * oldframe->scale[i];
-	}
+	lerp.move[3] = 0.0f;
+	lerp.frontv[3] = 0.0f;
+	lerp.backv[3] = 0.0f;
 
-	lerp = s_lerped[0];
+	lerp.verts = frame->verts;
+	lerp.oldVerts = oldframe->verts;
+	lerp.shadedots = r_avertexnormal_dots[( (int)( e->angles[1] * ( SHADEDOT_QUANT / 360.0f ) ) ) & ( SHADEDOT_QUANT - 1 )];
+	lerp.frontlerp = frontlerp;
+	lerp.numVerts = static_cast<uint32>( paliashdr->num_xyz );
+	lerp.firstVert = 0;
+}
 
-	GL_LerpVerts( paliashdr->num_xyz, verts, ov, move, frontv, backv, lerp );
+//
+// draws pre-lerped vertices with the current shade light
+//
+static void GL_DrawAliasFrameLerp( const dmdl_t *paliashdr, const aliasVert_t *lerped )
+{
+	int		*order;
+	int		count;
+	float	alpha;
+	int		i;
+	int		index_xyz;
+
+	order = (int *)((byte *)paliashdr + paliashdr->ofs_glcmds);
+
+	if ( currententity->flags & RF_TRANSLUCENT )
+	{
+		alpha = currententity->alpha;
+	}
+	else
+	{
+		alpha = 1.0f;
+	}
 
 	if ( r_vertex_arrays->GetBool() )
 	{
 		static float colorArray[MAX_VERTS * 4];
 
 		glEnableClientState( GL_VERTEX_ARRAY );
-		glVertexPointer( 3, GL_FLOAT, 16, s_lerped );	// padded for SIMD
+		glVertexPointer( 3, GL_FLOAT, sizeof( aliasVert_t ), lerped );	// padded for SIMD
 
 		glEnableClientState( GL_COLOR_ARRAY );
 		glColorPointer( 3, GL_FLOAT, 0, colorArray );
@@ -240,7 +388,7 @@ static void GL_DrawAliasFrameLerp( const dmdl_t *paliashdr, float backlerp )
 		//
 		for ( i = 0; i < paliashdr->num_xyz; i++ )
 		{
-			float l = shadedots[verts[i].lightnormalindex];
+			float l = lerped[i].shade;
 
 			colorArray[i * 3 + 0] = l * shadelight[0];
 			colorArray[i * 3 + 1] = l * shadelight[1];
@@ -280,10 +428,6 @@ static void GL_DrawAliasFrameLerp( const dmdl_t *paliashdr, float backlerp )
 
 				order += 3;
 
-				// normals and vertexes come from the frame list
-				//l = shadedots[verts[index_xyz].lightnormalindex];
-
-				//glColor4f (l* shadelight[0], l*shadelight[1], l*shadelight[2], alpha);
 				glArrayElement( index_xyz );
 
 			} while ( --count );
@@ -325,11 +469,10 @@ static void GL_DrawAliasFrameLerp( const dmdl_t *paliashdr, float backlerp )
 				index_xyz = order[2];
 				order += 3;
 
-				// normals and vertexes come from the frame list
-				l = shadedots[verts[index_xyz].lightnormalindex];
+				const aliasVert_t &vert = lerped[index_xyz];
 
-				glColor4f( l * shadelight[0], l * shadelight[1], l * shadelight[2], alpha );
-				glVertex3fv( s_lerped[index_xyz] );
+				glColor4f( vert.shade * shadelight[0], vert.shade * shadelight[1], vert.shade * shadelight[2], alpha );
+				glVertex3fv( vert.xyz );
 			} while ( --count );
 
 			glEnd();
@@ -480,6 +623,289 @@ static bool R_CullAliasModel( vec3_t mins, vec3_t maxs, entity_t *e )
 	}
 }
 
+/*
+========================
+R_ValidateAliasFrames
+========================
+*/
+static void R_ValidateAliasFrames( entity_t *e, const model_t *model )
+{
+	const dmdl_t *paliashdr = (const dmdl_t *)model->extradata;
+
+	if ( ( e->frame >= paliashdr->num_frames ) || ( e->frame < 0 ) )
+	{
+		Com_Printf( "R_DrawAliasModel %s: no such frame %d\n",
+			model->name, e->frame );
+		e->frame = 0;
+		e->oldframe = 0;
+	}
+
+	if ( ( e->oldframe >= paliashdr->num_frames ) || ( e->oldframe < 0 ) )
+	{
+		Com_Printf( "R_DrawAliasModel %s: no such oldframe %d\n",
+			model->name, e->oldframe );
+		e->frame = 0;
+		e->oldframe = 0;
+	}
+
+	if ( !r_lerpmodels->GetBool() ) {
+		e->backlerp = 0;
+	}
+}
+
+/*
+===================================================================================================
+
+	Batched lerping
+
+	Every alias entity in the refdef is culled and lerped up front, into one vertex buffer
+	that persists across frames and grows to fit the busiest one. When there's enough work
+	the entities are spread across the job system.
+
+===================================================================================================
+*/
+
+static StaticCvar r_lerpBatch( "r_lerpBatch", "1", 0, "If true, md2 vertices are lerped for all entities before drawing." );
+static StaticCvar r_lerpJobs( "r_lerpJobs", "1", 0, "If true, batched md2 lerping is spread across the job system." );
+
+// below this it isn't worth waking the workers
+static constexpr uint32 LERP_JOB_MIN_VERTS = 8192;
+
+static constexpr int32 LERP_NONE = -1;		// not prepared, lerp on the spot
+static constexpr int32 LERP_CULLED = -2;
+
+static std::vector<aliasVert_t>	s_aliasVerts;
+static std::vector<aliasLerp_t>	s_aliasLerps;
+static int32					s_entityLerps[MAX_ENTITIES];	// index into s_aliasLerps
+static int						s_lerpFrameCount = -1;
+
+/*
+========================
+GL_LerpJob
+========================
+*/
+static void GL_LerpJob( void *params, uint32 index )
+{
+	const aliasLerp_t *lerps = (const aliasLerp_t *)params;
+
+	GL_LerpVerts( lerps[index], s_aliasVerts.data() + lerps[index].firstVert );
+}
+
+/*
+========================
+R_PrepareAliasModels
+
+Must be called before any alias entities are drawn this frame
+========================
+*/
+void R_PrepareAliasModels()
+{
+	ZoneScoped
+
+	s_aliasLerps.clear();
+	s_lerpFrameCount = tr.frameCount;
+
+	const int numEntities = Min( tr.refdef.num_entities, MAX_ENTITIES );
+	uint32 numVerts = 0;
+
+	for ( int i = 0; i < numEntities; ++i )
+	{
+		entity_t *e = tr.refdef.entities + i;
+
+		s_entityLerps[i] = LERP_NONE;
+
+		if ( !r_lerpBatch.GetBool() || ( e->flags & RF_BEAM ) || !e->model || e->model->type != mod_alias ) {
+			continue;
+		}
+
+		// R_CullAliasModel wants these
+		currententity = e;
+		currentmodel = e->model;
+
+		if ( !( e->flags & RF_WEAPONMODEL ) )
+		{
+			vec3_t mins, maxs;
+			if ( R_CullAliasModel( mins, maxs, e ) )
+			{
+				s_entityLerps[i] = LERP_CULLED;
+				continue;
+			}
+		}
+
+		R_ValidateAliasFrames( e, e->model );
+
+		aliasLerp_t &lerp = s_aliasLerps.emplace_back();
+		GL_SetupAliasLerp( e, (const dmdl_t *)e->model->extradata, lerp );
+		lerp.firstVert = numVerts;
+		numVerts += lerp.numVerts;
+
+		s_entityLerps[i] = static_cast<int32>( s_aliasLerps.size() - 1 );
+	}
+
+	if ( s_aliasLerps.empty() ) {
+		return;
+	}
+
+	if ( s_aliasVerts.size() < numVerts ) {
+		s_aliasVerts.resize( numVerts );
+	}
+
+	if ( r_lerpJobs.GetBool() && numVerts >= LERP_JOB_MIN_VERTS )
+	{
+		Jobs::ParallelFor( static_cast<uint32>( s_aliasLerps.size() ), GL_LerpJob, s_aliasLerps.data() );
+	}
+	else
+	{
+		for ( const aliasLerp_t &lerp : s_aliasLerps )
+		{
+			GL_LerpVerts( lerp, s_aliasVerts.data() + lerp.firstVert );
+		}
+	}
+}
+
+/*
+========================
+R_EntityLerp
+
+Returns the batch slot for an entity, or LERP_NONE if it wasn't prepared this frame
+========================
+*/
+static int32 R_EntityLerp( const entity_t *e )
+{
+	if ( s_lerpFrameCount != tr.frameCount ) {
+		return LERP_NONE;
+	}
+
+	const ptrdiff_t index = e - tr.refdef.entities;
+	if ( index < 0 || index >= Min( tr.refdef.num_entities, MAX_ENTITIES ) ) {
+		return LERP_NONE;
+	}
+
+	return s_entityLerps[index];
+}
+
+/*
+========================
+r_benchAliasLerp
+
+Lerps between every pair of consecutive frames of the loaded alias models,
+or the ones given, and times the scalar, SIMD and job paths against each other.
+Doesn't touch GL so it doesn't need a world or a view
+========================
+*/
+CON_COMMAND( r_benchAliasLerp, "Benchmarks md2 vertex lerping. Usage: r_benchAliasLerp [iterations] [models...]", 0 )
+{
+	const int iterations = Cmd_Argc() > 1 ? Max( Q_atoi( Cmd_Argv( 1 ) ), 1 ) : 100;
+
+	std::vector<const model_t *> models;
+
+	if ( Cmd_Argc() > 2 )
+	{
+		for ( int i = 2; i < Cmd_Argc(); ++i )
+		{
+			const model_t *model = Mod_ForName( Cmd_Argv( i ), false );
+			if ( model && model->type == mod_alias ) {
+				models.push_back( model );
+			} else {
+				Com_Printf( "%s is not an alias model\n", Cmd_Argv( i ) );
+			}
+		}
+	}
+	else
+	{
+		for ( int i = 0; i < Mod_NumKnown(); ++i )
+		{
+			const model_t *model = Mod_KnownForIndex( i );
+			if ( model->name[0] && model->type == mod_alias ) {
+				models.push_back( model );
+			}
+		}
+	}
+
+	// one lerp per frame pair, like a crowd of monsters all in different frames
+	std::vector<aliasLerp_t> lerps;
+	uint32 numVerts = 0;
+
+	for ( const model_t *model : models )
+	{
+		const dmdl_t *paliashdr = (const dmdl_t *)model->extradata;
+
+		entity_t e{};
+		e.model = const_cast<model_t *>( model );
+		e.backlerp = 0.5f;
+
+		for ( int frame = 0; frame < paliashdr->num_frames; ++frame )
+		{
+			e.frame = frame;
+			e.oldframe = ( frame + 1 ) % paliashdr->num_frames;
+			e.angles[YAW] = static_cast<float>( frame * 15 % 360 );
+
+			aliasLerp_t &lerp = lerps.emplace_back();
+			GL_SetupAliasLerp( &e, paliashdr, lerp );
+			lerp.firstVert = numVerts;
+			numVerts += lerp.numVerts;
+		}
+	}
+
+	if ( lerps.empty() )
+	{
+		Com_Print( "No alias models to benchmark\n" );
+		return;
+	}
+
+	std::vector<aliasVert_t> reference( numVerts );
+	if ( s_aliasVerts.size() < numVerts ) {
+		s_aliasVerts.resize( numVerts );
+	}
+
+	double start, scalarTime, simdTime, jobTime;
+
+	start = Time_FloatMilliseconds();
+	for ( int it = 0; it < iterations; ++it )
+	{
+		for ( const aliasLerp_t &lerp : lerps ) {
+			GL_LerpVertsScalar( lerp, reference.data() + lerp.firstVert );
+		}
+	}
+	scalarTime = ( Time_FloatMilliseconds() - start ) / iterations;
+
+	start = Time_FloatMilliseconds();
+	for ( int it = 0; it < iterations; ++it )
+	{
+		for ( const aliasLerp_t &lerp : lerps ) {
+			GL_LerpVerts( lerp, s_aliasVerts.data() + lerp.firstVert );
+		}
+	}
+	simdTime = ( Time_FloatMilliseconds() - start ) / iterations;
+
+	start = Time_FloatMilliseconds();
+	for ( int it = 0; it < iterations; ++it )
+	{
+		Jobs::ParallelFor( static_cast<uint32>( lerps.size() ), GL_LerpJob, lerps.data() );
+	}
+	jobTime = ( Time_FloatMilliseconds() - start ) / iterations;
+
+	float maxError = 0.0f;
+	for ( uint32 i = 0; i < numVerts; ++i )
+	{
+		for ( int j = 0; j < 3; ++j ) {
+			maxError = Max( maxError, fabsf( reference[i].xyz[j] - s_aliasVerts[i].xyz[j] ) );
+		}
+		maxError = Max( maxError, fabsf( reference[i].shade - s_aliasVerts[i].shade ) );
+	}
+
+	const double mverts = numVerts / 1000.0;
+
+	Com_Printf( "%d models, %d frame pairs, %u verts, %d iterations\n", (int)models.size(), (int)lerps.size(), numVerts, iterations );
+	Com_Printf( "scalar : %8.3f ms %8.1f Mverts/s\n", scalarTime, mverts / scalarTime );
+	Com_Printf( "simd   : %8.3f ms %8.1f Mverts/s\n", simdTime, mverts / simdTime );
+	Com_Printf( "jobs   : %8.3f ms %8.1f Mverts/s (%u workers)\n", jobTime, mverts / jobTime, Jobs::NumWorkers() );
+	Com_Printf( "max error vs scalar: %g\n", maxError );
+
+	// the batch is stale now
+	s_lerpFrameCount = -1;
+}
+
 void R_DrawAliasModel( entity_t *e )
 {
 	int				i;
@@ -488,8 +914,14 @@ void R_DrawAliasModel( entity_t *e )
 	vec3_t			mins, maxs;
 	material_t *	skin;
 
+	const int32 lerpIndex = R_EntityLerp( e );
+
+	if ( lerpIndex == LERP_CULLED ) {
+		return;
+	}
+
 	// Can we be culled away?
-	if ( !( e->flags & RF_WEAPONMODEL ) )
+	if ( lerpIndex == LERP_NONE && !( e->flags & RF_WEAPONMODEL ) )
 	{
 		if ( R_CullAliasModel( mins, maxs, e ) ) {
 			return;
@@ -612,8 +1044,6 @@ void R_DrawAliasModel( entity_t *e )
 // PGM	
 // =================
 
-	shadedots = r_avertexnormal_dots[((int)(currententity->angles[1] * (SHADEDOT_QUANT / 360.0f))) & (SHADEDOT_QUANT - 1)];
-	
 	an = RAD2DEG( currententity->angles[1] );
 	shadevector[0] = cos(-an);
 	shadevector[1] = sin(-an);
@@ -641,24 +1071,20 @@ void R_DrawAliasModel( entity_t *e )
 		glEnable( GL_BLEND );
 	}
 
-	if ( ( currententity->frame >= paliashdr->num_frames ) || ( currententity->frame < 0 ) )
-	{
-		Com_Printf( "R_DrawAliasModel %s: no such frame %d\n",
-			currentmodel->name, currententity->frame );
-		currententity->frame = 0;
-		currententity->oldframe = 0;
-	}
+	const aliasVert_t *lerped;
 
-	if ( ( currententity->oldframe >= paliashdr->num_frames ) || ( currententity->oldframe < 0 ) )
+	if ( lerpIndex == LERP_NONE )
 	{
-		Com_Printf( "R_DrawAliasModel %s: no such oldframe %d\n",
-			currentmodel->name, currententity->oldframe );
-		currententity->frame = 0;
-		currententity->oldframe = 0;
-	}
+		R_ValidateAliasFrames( currententity, currentmodel );
 
-	if ( !r_lerpmodels->GetBool() ) {
-		currententity->backlerp = 0;
+		aliasLerp_t lerp;
+		GL_SetupAliasLerp( currententity, paliashdr, lerp );
+		GL_LerpVerts( lerp, s_lerped );
+		lerped = s_lerped;
+	}
+	else
+	{
+		lerped = s_aliasVerts.data() + s_aliasLerps[lerpIndex].firstVert;
 	}
 
 	// select skin
@@ -692,7 +1118,7 @@ void R_DrawAliasModel( entity_t *e )
 	GL_UseProgram( 0 );
 	glEnable( GL_TEXTURE_2D );
 
-	GL_DrawAliasFrameLerp( paliashdr, currententity->backlerp );
+	GL_DrawAliasFrameLerp( paliashdr, lerped );
 
 	glDisable( GL_TEXTURE_2D );
 
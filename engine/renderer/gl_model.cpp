@@ -32,6 +32,9 @@ static byte		mod_novis[MAX_MAP_LEAFS/8];
 static model_t	mod_known[MAX_MOD_KNOWN];
 static int		mod_numknown;
 
+static ResourceHash<model_t, 512>	mod_hash;
+static TouchList<model_t>			mod_touches;
+
 // the inline * models from the current map are kept seperate
 static model_t	mod_inline[MAX_MOD_KNOWN];
 
@@ -155,6 +158,29 @@ void Mod_Modellist_f()
 	Com_Printf( "Total resident: %i\n", total );
 }
 
+/*
+========================
+Mod_NumKnown
+========================
+*/
+int Mod_NumKnown()
+{
+	return mod_numknown;
+}
+
+/*
+========================
+Mod_KnownForIndex
+
+Slots can be empty, check the name
+========================
+*/
+model_t *Mod_KnownForIndex( int index )
+{
+	assert( index >= 0 && index < mod_numknown );
+	return &mod_known[index];
+}
+
 /*
 ========================
 Mod_Init
@@ -172,39 +198,37 @@ Mod_ForName
 Loads in a model for the given name
 ========================
 */
-model_t *Mod_ForName( const char *name, bool crash )
+model_t *Mod_ForName( const char *pathName, bool crash )
 {
 	model_t *	pMod;
 	void *		pBuffer;
 	int			i;
+	char		name[MAX_QPATH];
 
-	if ( !name[0] ) {
+	if ( !pathName[0] ) {
 		Com_Error( "Mod_ForName: NULL name" );
 	}
 
 	//
 	// inline models are grabbed only from worldmodel
 	//
-	if ( name[0] == '*' )
+	if ( pathName[0] == '*' )
 	{
-		i = Q_atoi( name + 1 );
+		i = Q_atoi( pathName + 1 );
 		if ( i < 1 || !r_worldmodel || i >= r_worldmodel->numsubmodels ) {
 			Com_Error( "bad inline model number" );
 		}
 		return &mod_inline[i];
 	}
 
+	R_NormalizePath( pathName, name );
+
 	//
 	// search the currently loaded models
 	//
-	for ( i = 0, pMod = mod_known; i < mod_numknown; i++, pMod++ )
-	{
-		if ( !pMod->name[0] ) {
-			continue;
-		}
-		if ( !Q_strcmp( pMod->name, name ) ) {
-			return pMod;
-		}
+	pMod = mod_hash.Find( name );
+	if ( pMod ) {
+		return pMod;
 	}
 
 	//
@@ -230,7 +254,8 @@ model_t *Mod_ForName( const char *name, bool crash )
 	//
 	// load the file
 	//
-	fsSize_t bufferLength = FileSystem::LoadFile( pMod->name, (void **)&pBuffer );
+	int64 readTime;
+	fsSize_t bufferLength = Asset_LoadFile( pMod->name, (void **)&pBuffer, &readTime );
 	if ( !pBuffer )
 	{
 		if ( crash ) {
@@ -242,6 +267,8 @@ model_t *Mod_ForName( const char *name, bool crash )
 
 	loadmodel = pMod;
 
+	const int64 finishStart = Time_Microseconds();
+
 	//
 	// fill it in
 	//
@@ -286,6 +313,12 @@ model_t *Mod_ForName( const char *name, bool crash )
 
 	FileSystem::FreeFile( pBuffer );
 
+	// not registered yet, if nothing does it goes at the end of this sequence
+	mod_hash.Insert( pMod );
+	mod_touches.AddOldest( pMod );
+
+	Asset_Record( ASSET_MODEL, pMod->name, readTime, 0, Time_Microseconds() - finishStart );
+
 	return pMod;
 }
 
@@ -1346,6 +1379,9 @@ Mod_Free
 */
 void Mod_Free( model_t *pModel )
 {
+	mod_hash.Remove( pModel );
+	mod_touches.Remove( pModel );
+
 	Hunk_Free( pModel->extradata );
 	memset( pModel, 0, sizeof( *pModel ) );
 }
@@ -1392,6 +1428,9 @@ void R_BeginRegistration( const char *model )
 	if ( Q_strcmp( mod_known[0].name, model ) || flushmap->GetBool() ) {
 		Mod_Free( &mod_known[0] );
 	}
+
+	GL_BeginImageBatch();
+
 	r_worldmodel = Mod_ForName( model, true );
 
 	r_viewcluster = -1;
@@ -1414,7 +1453,12 @@ model_t *R_RegisterModel( const char *name )
 	pModel = Mod_ForName( name, false );
 	if ( pModel )
 	{
-		pModel->registration_sequence = tr.registrationSequence;
+		if ( name[0] == '*' ) {
+			// inline models aren't kept in mod_known
+			pModel->registration_sequence = tr.registrationSequence;
+		} else {
+			mod_touches.Touch( pModel, tr.registrationSequence );
+		}
 
 		switch ( pModel->type )
 		{
@@ -1452,7 +1496,7 @@ model_t *R_RegisterModel( const char *name )
 		case mod_brush:
 			for ( i = 0; i < pModel->numtexinfo; i++ )
 			{
-				pModel->texinfo[i].material->registration_sequence = tr.registrationSequence;
+				GL_TouchMaterial( pModel->texinfo[i].material );
 			}
 			break;
 
@@ -1465,6 +1509,19 @@ model_t *R_RegisterModel( const char *name )
 	return pModel;
 }
 
+/*
+========================
+R_AbortRegistration
+
+Uploads the images the registration deferred and stops deferring them, the models it had got to
+are kept until the next registration decides what's needed
+========================
+*/
+void R_AbortRegistration()
+{
+	GL_EndImageBatch();
+}
+
 /*
 ========================
 R_EndRegistration
@@ -1472,18 +1529,18 @@ R_EndRegistration
 */
 void R_EndRegistration()
 {
-	int i;
 	model_t *pMod;
 
-	for ( i = 0, pMod = mod_known; i < mod_numknown; i++, pMod++ )
+	GL_EndImageBatch();
+
+	// everything this sequence didn't register is at the end
+	while ( ( pMod = mod_touches.Oldest() ) != nullptr )
 	{
-		if ( !pMod->name[0] ) {
-			continue;
-		}
-		if ( pMod->registration_sequence != tr.registrationSequence ) {
-			// don't need this model
-			Mod_Free( pMod );
+		if ( pMod->registration_sequence == tr.registrationSequence ) {
+			break;
 		}
+		// don't need this model
+		Mod_Free( pMod );
 	}
 
 	GL_FreeUnusedMaterials();
@@ -32,7 +32,8 @@ struct mmodel_t
 
 enum surfFlags_t
 {
-	MSURF_PLANEBACK		= BIT(0)
+	MSURF_PLANEBACK		= BIT(0),
+	MSURF_LIGHTDIRTY	= BIT(1)	// a lightstyle changed, the lightmap needs rebuilding when next visible
 };
 
 struct medge_t
@@ -167,6 +168,11 @@ struct model_t
 
 	int32		registration_sequence;
 
+	uint32		hashKey;
+	model_t		*hashNext;
+	model_t		*touchPrev;		// in registration order
+	model_t		*touchNext;
+
 	modType_t	type;
 	int32		numframes;
 	
@@ -244,5 +250,8 @@ byte *		Mod_ClusterPVS( int cluster, model_t *model );
 
 void		Mod_Modellist_f();
 
+int			Mod_NumKnown();
+model_t *	Mod_KnownForIndex( int index );
+
 void		Mod_Free( model_t *pModel );
 void		Mod_FreeAll();
@@ -0,0 +1,203 @@
+#pragma once
+
+/*
+===================================================================================================
+
+	Resource registries
+
+	Models, images and materials live in fixed arrays. ResourceHash indexes one of them by name so
+	finding a resource doesn't compare against every slot, TouchList keeps them ordered by when
+	they were last registered so the ones a level didn't use can be found without a full sweep.
+
+	A hashed type needs:
+		char		name[MAX_QPATH];
+		uint32		hashKey;
+		T *			hashNext;
+
+	A touched type needs:
+		int32		registration_sequence;
+		T *			touchPrev;
+		T *			touchNext;
+
+	Both are cleared by the memsets that free a slot, so unlink before that.
+
+===================================================================================================
+*/
+
+//-------------------------------------------------------------------------------------------------
+// Turns a game path into the form it's registered under. Backslashes become forward slashes,
+// repeated slashes are collapsed and "./" segments are dropped. The case is left alone, names
+// are compared exactly like the linear searches these replaced did.
+//-------------------------------------------------------------------------------------------------
+inline void R_NormalizePath( const char *in, char *out, strlen_t outSize )
+{
+	assert( outSize > 0 );
+
+	strlen_t length = 0;
+
+	for ( ; *in && length < outSize - 1; ++in )
+	{
+		char c = *in == '\\' ? '/' : *in;
+		const bool segmentStart = length == 0 || out[length - 1] == '/';
+
+		if ( c == '/' && length > 0 && out[length - 1] == '/' ) {
+			continue;
+		}
+		if ( c == '.' && segmentStart && ( in[1] == '/' || in[1] == '\\' ) ) {
+			// the slash after the dot goes too
+			++in;
+			continue;
+		}
+		out[length++] = c;
+	}
+
+	out[length] = '\0';
+}
+
+template< strlen_t outSize >
+inline void R_NormalizePath( const char *in, char( &out )[outSize] )
+{
+	R_NormalizePath( in, out, outSize );
+}
+
+template< typename T, uint32 NumBuckets >
+class ResourceHash
+{
+public:
+	static_assert( ( NumBuckets & ( NumBuckets - 1 ) ) == 0, "NumBuckets must be a power of two" );
+
+	// match can reject an entry with the same name, images are also keyed by their flags
+	template< typename Match >
+	T *Find( const char *name, Match &&match ) const
+	{
+		const uint32 key = HashString( name );
+
+		for ( T *item = m_buckets[key & ( NumBuckets - 1 )]; item; item = item->hashNext )
+		{
+			if ( item->hashKey == key && Q_strcmp( item->name, name ) == 0 && match( item ) ) {
+				return item;
+			}
+		}
+
+		return nullptr;
+	}
+
+	T *Find( const char *name ) const
+	{
+		return Find( name, []( const T * ) { return true; } );
+	}
+
+	// item->name must already be set
+	void Insert( T *item )
+	{
+		item->hashKey = HashString( item->name );
+
+		T *&bucket = m_buckets[item->hashKey & ( NumBuckets - 1 )];
+		item->hashNext = bucket;
+		bucket = item;
+	}
+
+	void Remove( T *item )
+	{
+		for ( T **link = &m_buckets[item->hashKey & ( NumBuckets - 1 )]; *link; link = &( *link )->hashNext )
+		{
+			if ( *link == item )
+			{
+				*link = item->hashNext;
+				item->hashNext = nullptr;
+				return;
+			}
+		}
+	}
+
+	void Clear()
+	{
+		memset( m_buckets, 0, sizeof( m_buckets ) );
+	}
+
+private:
+	T *m_buckets[NumBuckets]{};
+};
+
+template< typename T >
+class TouchList
+{
+public:
+	// Marks item as used by this sequence, the most recent are kept at the head so everything that
+	// missed the current sequence ends up at the tail
+	void Touch( T *item, int32 sequence )
+	{
+		item->registration_sequence = sequence;
+
+		if ( m_head == item ) {
+			return;
+		}
+
+		Remove( item );
+
+		item->touchNext = m_head;
+		if ( m_head ) {
+			m_head->touchPrev = item;
+		} else {
+			m_tail = item;
+		}
+		m_head = item;
+	}
+
+	// Links item in as the least recently touched, without changing its sequence
+	void AddOldest( T *item )
+	{
+		Remove( item );
+
+		item->touchPrev = m_tail;
+		if ( m_tail ) {
+			m_tail->touchNext = item;
+		} else {
+			m_head = item;
+		}
+		m_tail = item;
+	}
+
+	void Remove( T *item )
+	{
+		if ( !IsLinked( item ) ) {
+			return;
+		}
+
+		if ( item->touchPrev ) {
+			item->touchPrev->touchNext = item->touchNext;
+		} else {
+			m_head = item->touchNext;
+		}
+
+		if ( item->touchNext ) {
+			item->touchNext->touchPrev = item->touchPrev;
+		} else {
+			m_tail = item->touchPrev;
+		}
+
+		item->touchPrev = nullptr;
+		item->touchNext = nullptr;
+	}
+
+	bool IsLinked( const T *item ) const
+	{
+		return item->touchPrev || item->touchNext || m_head == item;
+	}
+
+	// The least recently touched item
+	T *Oldest() const
+	{
+		return m_tail;
+	}
+
+	void Clear()
+	{
+		m_head = nullptr;
+		m_tail = nullptr;
+	}
+
+private:
+	T *m_head = nullptr;
+	T *m_tail = nullptr;
+};
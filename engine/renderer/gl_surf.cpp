@@ -61,11 +61,13 @@ struct worldLists_t
 {
 	std::vector<worldIndex_t>	finalIndices;		// Indices into the render data used to draw the PVS
 	std::vector<worldMesh_t>	opaqueMeshes;		// Each worldMesh_t is a draw call
+	std::vector<const msurface_t *>	skySurfaces;	// So reused lists can feed the sky box again
 
 	void ClearAllLists()
 	{
 		finalIndices.clear();
 		opaqueMeshes.clear();
+		skySurfaces.clear();
 	}
 };
 
@@ -87,11 +89,47 @@ struct gllightmapstate_t
 
 static gllightmapstate_t gl_lms;
 
+struct lightmapRect_t
+{
+	int				mins[2];
+	int				maxs[2];		// exclusive
+
+	bool IsEmpty() const { return mins[0] >= maxs[0]; }
+};
+
+//
+// Lightstyle animation. The built atlases are kept in main memory so a style change only rebuilds
+// the surfaces that use it, then one sub rectangle covering them is uploaded per atlas.
+//
+struct lightmapUpdateState_t
+{
+	byte *				pages[MAX_LIGHTMAPS];		// copies of what was uploaded for each atlas
+	lightmapRect_t		dirtyRects[MAX_LIGHTMAPS];
+
+	float				styleColors[MAX_LIGHTSTYLES][3];	// rgb the lightmaps were last built with
+	std::vector<uint32>	styleSurfaces[MAX_LIGHTSTYLES];		// indices into r_worldmodel->surfaces
+	std::vector<uint32>	pendingSurfaces;					// dirty, waiting to become visible
+
+	uint32				firstWorldSurface, numWorldSurfaces;
+
+	// the surface lists are built on the first update, submodel surfaces are sorted after load
+	int					generation;
+	int					builtGeneration;
+};
+
+static lightmapUpdateState_t s_lmUpdate;
+
 // gl_light
 void R_SetCacheState(msurface_t *surf);
 void R_BuildLightMap(msurface_t *surf, byte *dest, int stride);
 
+static void R_UpdateLightmaps();
+
 static StaticCvar r_fastProfile( "r_fastProfile", "0", 0 );
+static StaticCvar r_visCache( "r_visCache", "1", 0, "Cache the visible world surfaces for each view cluster and area set." );
+static StaticCvar r_visCacheSize( "r_visCacheSize", "8", 0, "How many view clusters the visibility cache remembers." );
+static StaticCvar r_persistentIndices( "r_persistentIndices", "1", 0, "Stream world indices through a persistently mapped ring buffer, applies on map load." );
+static StaticCvar r_animateLightmaps( "r_animateLightmaps", "1", 0, "Rebuild lightmaps when their lightstyles change." );
 
 /*
 ===================================================================================================
@@ -339,6 +377,9 @@ struct worldNodeWork_t
 	std::vector<worldMaterialSet_t> materialSets;
 };
 
+// False when the visibility cache was used last, the node marks are stale
+static bool s_leavesMarked;
+
 // Mark the leaves and nodes that are in the PVS for the current cluster
 static void R_MarkLeaves()
 {
@@ -351,7 +392,7 @@ static void R_MarkLeaves()
 	mleaf_t *	leaf;
 	int			cluster;
 
-	if ( r_oldviewcluster == r_viewcluster && r_oldviewcluster2 == r_viewcluster2 && !r_novis->GetBool() && r_viewcluster != -1 )
+	if ( s_leavesMarked && r_oldviewcluster == r_viewcluster && r_oldviewcluster2 == r_viewcluster2 && !r_novis->GetBool() && r_viewcluster != -1 )
 	{
 		return;
 	}
@@ -366,6 +407,7 @@ static void R_MarkLeaves()
 	++tr.visCount;
 	r_oldviewcluster = r_viewcluster;
 	r_oldviewcluster2 = r_viewcluster2;
+	s_leavesMarked = true;
 
 	if ( r_novis->GetBool() || r_viewcluster == -1 || !r_worldmodel->vis )
 	{
@@ -608,15 +650,10 @@ static void R_RecursiveWorldNode( worldNodeWork_t &work, const mnode_t *node )
 //
 // Squashes our index lists into the final index buffer, builds the world lists
 //
-static void R_SquashAndUploadIndices( worldLists_t &worldLists, const worldNodeWork_t &work )
+static void R_SquashIndices( worldLists_t &worldLists, const worldNodeWork_t &work )
 {
 	ZoneScoped
 
-	if ( work.materialSets.empty() )
-	{
-		return;
-	}
-
 	for ( const worldMaterialSet_t &materialSet : work.materialSets )
 	{
 		// Create a new mesh
@@ -635,22 +672,550 @@ static void R_SquashAndUploadIndices( worldLists_t &worldLists, const worldNodeW
 		opaqueMesh.firstIndex = firstIndex;
 		opaqueMesh.numIndices = materialSet.indices.size();
 	}
+}
+
+/*
+===================================================================================================
+
+	World index ring
+
+	The visible world indices are streamed into a persistently mapped buffer split into segments,
+	each frame writes the next segment and fences it once the draws are submitted, so we never
+	have to ask the driver to orphan a buffer. Falls back to glBufferData without
+	ARB_buffer_storage.
+
+===================================================================================================
+*/
+
+#define WORLD_INDEX_SEGMENTS	3
+
+struct worldIndexRing_t
+{
+	worldIndex_t *	mapped;						// null if we're not using buffer storage
+	uint32			segmentSize;				// in indices, enough for every world surface
+	uint32			segment;					// the one the current lists live in
+	GLsync			fences[WORLD_INDEX_SEGMENTS];
+};
+
+static worldIndexRing_t s_indexRing;
+
+static void R_CreateWorldIndexRing( uint32 numIndices )
+{
+	s_indexRing = {};
+	s_indexRing.segmentSize = Max( numIndices, 1u );
+
+	if ( !GLEW_ARB_buffer_storage || !r_persistentIndices.GetBool() ) {
+		return;
+	}
+
+	const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	const GLsizeiptr size = static_cast<GLsizeiptr>( s_indexRing.segmentSize ) * WORLD_INDEX_SEGMENTS * sizeof( worldIndex_t );
+
+	// Don't disturb the element binding of whatever VAO is bound
+	glBindBuffer( GL_COPY_WRITE_BUFFER, g_worldData.ebo );
+	glBufferStorage( GL_COPY_WRITE_BUFFER, size, nullptr, flags );
+	s_indexRing.mapped = (worldIndex_t *)glMapBufferRange( GL_COPY_WRITE_BUFFER, 0, size, flags );
+	glBindBuffer( GL_COPY_WRITE_BUFFER, 0 );
+}
+
+static void R_DestroyWorldIndexRing()
+{
+	for ( GLsync &fence : s_indexRing.fences )
+	{
+		if ( fence )
+		{
+			glDeleteSync( fence );
+			fence = nullptr;
+		}
+	}
+
+	if ( s_indexRing.mapped )
+	{
+		glBindBuffer( GL_COPY_WRITE_BUFFER, g_worldData.ebo );
+		glUnmapBuffer( GL_COPY_WRITE_BUFFER );
+		glBindBuffer( GL_COPY_WRITE_BUFFER, 0 );
+		s_indexRing.mapped = nullptr;
+	}
+}
+
+//
+// Copies the final indices into the bound element buffer, returns the index the lists start at
+//
+static uint32 R_UploadWorldIndices( const worldLists_t &worldLists )
+{
+	ZoneScoped
 
 	const void *indexData = reinterpret_cast<const void *>( worldLists.finalIndices.data() );
 	const GLsizeiptr indexSize = static_cast<GLsizeiptr>( worldLists.finalIndices.size() ) * sizeof( worldIndex_t );
 
-	glBufferData( GL_ELEMENT_ARRAY_BUFFER, indexSize, indexData, GL_DYNAMIC_DRAW );
+	if ( !s_indexRing.mapped )
+	{
+		glBufferData( GL_ELEMENT_ARRAY_BUFFER, indexSize, indexData, GL_DYNAMIC_DRAW );
+		return 0;
+	}
+
+	assert( worldLists.finalIndices.size() <= s_indexRing.segmentSize );
+
+	s_indexRing.segment = ( s_indexRing.segment + 1 ) % WORLD_INDEX_SEGMENTS;
+
+	// Wait for the GPU to finish with the frame that last used this segment
+	GLsync &fence = s_indexRing.fences[s_indexRing.segment];
+	if ( fence )
+	{
+		glClientWaitSync( fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED );
+		glDeleteSync( fence );
+		fence = nullptr;
+	}
+
+	const uint32 baseIndex = s_indexRing.segment * s_indexRing.segmentSize;
+	memcpy( s_indexRing.mapped + baseIndex, indexData, indexSize );
+
+	return baseIndex;
+}
+
+//
+// Called after the draws that read the current segment have been issued
+//
+static void R_FenceWorldIndices()
+{
+	if ( !s_indexRing.mapped ) {
+		return;
+	}
+
+	GLsync &fence = s_indexRing.fences[s_indexRing.segment];
+	if ( fence ) {
+		glDeleteSync( fence );
+	}
+	fence = glFenceSync( GL_SYNC_GPU_COMMANDS_COMPLETE, 0 );
+}
+
+/*
+===================================================================================================
+
+	World visibility cache
+
+	The surfaces in the PVS of a view cluster pair, filtered by the area bits, are cached and
+	grouped by material. While the key stays the same a frame only has to frustum cull the
+	cached leaves and gather indices, and if the frustum hasn't moved either the previous
+	frame's lists and uploaded indices are drawn as they are.
+
+===================================================================================================
+*/
+
+struct worldVisKey_t
+{
+	int			cluster1, cluster2;		// -1 when everything is visible
+	byte		areabits[MAX_MAP_AREAS / 8];
+
+	bool operator==( const worldVisKey_t &other ) const
+	{
+		return cluster1 == other.cluster1 && cluster2 == other.cluster2 && memcmp( areabits, other.areabits, sizeof( areabits ) ) == 0;
+	}
+};
+
+struct worldVisGroup_t
+{
+	mtexinfo_t *					texinfo;
+	std::vector<const msurface_t *>	surfaces;
+};
+
+struct worldVisEntry_t
+{
+	worldVisKey_t					key;
+	int								lastUsed;		// frame, for LRU replacement
+	int								buildFrame;
+
+	std::vector<const mleaf_t *>	leaves;			// in the PVS and connected areas
+	std::vector<worldVisGroup_t>	groups;			// opaque surfaces by material
+	std::vector<const msurface_t *>	skySurfaces;
+};
+
+struct worldVisCache_t
+{
+	std::vector<worldVisEntry_t>	entries;
+
+	// What the current lists were built from
+	int								lastEntry = -1;
+	bool							listsValid;
+	cplane_t						lastFrustum[4];
+	vec3_t							lastOrigin;
+	std::vector<const mleaf_t *>	visibleLeaves;
+
+	std::vector<byte>				surfaceSeen;	// scratch for building entries
+};
+
+static worldVisCache_t s_visCache;
+
+// The lists drawn last frame, kept around for reuse
+static worldLists_t s_worldLists;
+static uint32 s_worldListsBase;
+
+static void R_ClearWorldVisCache()
+{
+	s_visCache.entries.clear();
+	s_visCache.lastEntry = -1;
+	s_visCache.listsValid = false;
+	s_visCache.visibleLeaves.clear();
+
+	s_worldLists.ClearAllLists();
+	s_worldListsBase = 0;
+
+	s_leavesMarked = false;
+}
+
+static void R_MakeWorldVisKey( worldVisKey_t &key )
+{
+	// lockpvs lets designers walk around to determine the
+	// extent of the current pvs
+	if ( r_lockpvs->GetBool() && s_visCache.lastEntry != -1 )
+	{
+		key = s_visCache.entries[s_visCache.lastEntry].key;
+		return;
+	}
+
+	if ( r_novis->GetBool() || r_viewcluster == -1 || !r_worldmodel->vis )
+	{
+		key.cluster1 = key.cluster2 = -1;
+	}
+	else
+	{
+		key.cluster1 = r_viewcluster;
+		key.cluster2 = r_viewcluster2;
+	}
+
+	memcpy( key.areabits, tr.refdef.areabits, sizeof( key.areabits ) );
+}
+
+static bool R_SurfaceFacesView( const msurface_t *surf )
+{
+	const float dot = DotProduct( modelorg, surf->plane->normal ) - surf->plane->dist;
+	const int sidebit = dot >= 0.0f ? 0 : MSURF_PLANEBACK;
+
+	return ( surf->flags & MSURF_PLANEBACK ) == sidebit;
+}
+
+static void R_MarkLeafSurfaces( const mleaf_t *leaf )
+{
+	msurface_t **firstMarkSurface = r_worldmodel->marksurfaces + leaf->firstmarksurface;
+	msurface_t **lastMarkSurface = firstMarkSurface + leaf->nummarksurfaces;
+
+	for ( msurface_t **mark = firstMarkSurface; mark < lastMarkSurface; ++mark )
+	{
+		( *mark )->frameCount = tr.frameCount;
+	}
+}
+
+//
+// Gathers the leaves and surfaces that can be seen from the key's clusters and areas
+//
+static void R_BuildWorldVisEntry( worldVisEntry_t &entry )
+{
+	ZoneScoped
+
+	entry.leaves.clear();
+	entry.groups.clear();
+	entry.skySurfaces.clear();
+	entry.buildFrame = tr.frameCount;
+
+	const byte *vis = nullptr;
+	byte fatvis[MAX_MAP_LEAFS / 8];
+
+	if ( entry.key.cluster1 != -1 )
+	{
+		vis = Mod_ClusterPVS( entry.key.cluster1, r_worldmodel );
+
+		// may have to combine two clusters because of solid water boundaries
+		if ( entry.key.cluster2 != entry.key.cluster1 )
+		{
+			memcpy( fatvis, vis, ( r_worldmodel->numleafs + 7 ) / 8 );
+			vis = Mod_ClusterPVS( entry.key.cluster2, r_worldmodel );
+			const int c = ( r_worldmodel->numleafs + 31 ) / 32;
+			for ( int i = 0; i < c; i++ )
+			{
+				( (int *)fatvis )[i] |= ( (const int *)vis )[i];
+			}
+			vis = fatvis;
+		}
+	}
+
+	s_visCache.surfaceSeen.assign( r_worldmodel->numsurfaces, 0 );
+
+	const mleaf_t *leaf = r_worldmodel->leafs;
+	for ( int i = 0; i < r_worldmodel->numleafs; ++i, ++leaf )
+	{
+		// No polygons in solid leaves
+		if ( leaf->contents == CONTENTS_SOLID ) {
+			continue;
+		}
+
+		if ( vis )
+		{
+			const int cluster = leaf->cluster;
+			if ( cluster == -1 || !( vis[cluster >> 3] & ( 1 << ( cluster & 7 ) ) ) ) {
+				continue;
+			}
+		}
+
+		// Check for door connected areas
+		if ( !( entry.key.areabits[leaf->area >> 3] & ( 1 << ( leaf->area & 7 ) ) ) ) {
+			continue;
+		}
+
+		entry.leaves.push_back( leaf );
+
+		msurface_t **firstMarkSurface = r_worldmodel->marksurfaces + leaf->firstmarksurface;
+		msurface_t **lastMarkSurface = firstMarkSurface + leaf->nummarksurfaces;
+
+		for ( msurface_t **mark = firstMarkSurface; mark < lastMarkSurface; ++mark )
+		{
+			const msurface_t *surf = *mark;
+			byte &seen = s_visCache.surfaceSeen[surf - r_worldmodel->surfaces];
+			if ( seen ) {
+				continue;
+			}
+			seen = 1;
+
+			if ( surf->texinfoFlags & SURF_SKY )
+			{
+				entry.skySurfaces.push_back( surf );
+				continue;
+			}
+
+			worldVisGroup_t *group = nullptr;
+			for ( worldVisGroup_t &existing : entry.groups )
+			{
+				if ( existing.texinfo->material == surf->texinfo->material )
+				{
+					group = &existing;
+					break;
+				}
+			}
+			if ( !group )
+			{
+				group = &entry.groups.emplace_back();
+				group->texinfo = surf->texinfo;
+			}
+
+			group->surfaces.push_back( surf );
+		}
+	}
+}
+
+//
+// Returns the entry for key, building it over the least recently used one on a miss
+//
+static int R_FindWorldVisEntry( const worldVisKey_t &key )
+{
+	const int cacheSize = Clamp( r_visCacheSize.GetInt(), 1, 64 );
+	if ( (int)s_visCache.entries.size() > cacheSize )
+	{
+		s_visCache.entries.resize( cacheSize );
+		s_visCache.lastEntry = -1;
+	}
+
+	int replace = 0;
+	for ( int i = 0; i < (int)s_visCache.entries.size(); ++i )
+	{
+		const worldVisEntry_t &entry = s_visCache.entries[i];
+		if ( entry.key == key ) {
+			return i;
+		}
+		if ( entry.lastUsed < s_visCache.entries[replace].lastUsed ) {
+			replace = i;
+		}
+	}
+
+	if ( (int)s_visCache.entries.size() < cacheSize )
+	{
+		replace = (int)s_visCache.entries.size();
+		s_visCache.entries.emplace_back();
+	}
+
+	++tr.pc.visCacheMisses;
+
+	worldVisEntry_t &entry = s_visCache.entries[replace];
+	entry.key = key;
+	R_BuildWorldVisEntry( entry );
+
+	return replace;
+}
+
+//
+// Frustum culls the entry's leaves and gathers the indices of the surfaces they mark,
+// doesn't touch any GL state so it can be benchmarked on its own
+//
+static void R_CullWorldVisEntry( const worldVisEntry_t &entry, worldLists_t &worldLists, std::vector<const mleaf_t *> &visibleLeaves )
+{
+	ZoneScoped
+
+	worldLists.ClearAllLists();
+	visibleLeaves.clear();
+
+	for ( const mleaf_t *leaf : entry.leaves )
+	{
+		if ( R_CullBox( leaf->mins, leaf->maxs ) ) {
+			continue;
+		}
+
+		visibleLeaves.push_back( leaf );
+		R_MarkLeafSurfaces( leaf );
+	}
+
+	for ( const worldVisGroup_t &group : entry.groups )
+	{
+		const uint32 firstIndex = static_cast<uint32>( worldLists.finalIndices.size() );
+
+		for ( const msurface_t *surf : group.surfaces )
+		{
+			if ( surf->frameCount != tr.frameCount || !R_SurfaceFacesView( surf ) ) {
+				continue;
+			}
+
+			const auto begin = g_worldData.indices.begin() + surf->firstIndex;
+			worldLists.finalIndices.insert( worldLists.finalIndices.end(), begin, begin + surf->numIndices );
+		}
+
+		const uint32 numIndices = static_cast<uint32>( worldLists.finalIndices.size() ) - firstIndex;
+		if ( numIndices == 0 ) {
+			continue;
+		}
+
+		worldMesh_t &opaqueMesh = worldLists.opaqueMeshes.emplace_back();
+		opaqueMesh.texinfo = group.texinfo;
+		opaqueMesh.firstIndex = firstIndex;
+		opaqueMesh.numIndices = numIndices;
+	}
+
+	for ( const msurface_t *surf : entry.skySurfaces )
+	{
+		if ( surf->frameCount != tr.frameCount || !R_SurfaceFacesView( surf ) ) {
+			continue;
+		}
+
+		worldLists.skySurfaces.push_back( surf );
+	}
+}
+
+//
+// Fills worldLists using the visibility cache, returns true if last frame's lists were kept
+//
+static bool R_BuildCachedWorldLists( worldLists_t &worldLists )
+{
+	ZoneScoped
+
+	// The node marks from R_MarkLeaves are stale from here on
+	s_leavesMarked = false;
+
+	worldVisKey_t key;
+	R_MakeWorldVisKey( key );
+
+	const int index = R_FindWorldVisEntry( key );
+	worldVisEntry_t &entry = s_visCache.entries[index];
+	entry.lastUsed = tr.frameCount;
+
+	const bool sameView = s_visCache.listsValid && s_visCache.lastEntry == index && entry.buildFrame != tr.frameCount
+		&& VectorCompare( modelorg, s_visCache.lastOrigin )
+		&& memcmp( s_visCache.lastFrustum, frustum, sizeof( frustum ) ) == 0;
+
+	if ( sameView )
+	{
+		// Same leaves and surfaces as last frame, just mark them visible again
+		for ( const mleaf_t *leaf : s_visCache.visibleLeaves )
+		{
+			R_MarkLeafSurfaces( leaf );
+		}
+		++tr.pc.worldListsReused;
+	}
+	else
+	{
+		R_CullWorldVisEntry( entry, worldLists, s_visCache.visibleLeaves );
+
+		s_visCache.lastEntry = index;
+		s_visCache.listsValid = true;
+		VectorCopy( modelorg, s_visCache.lastOrigin );
+		memcpy( s_visCache.lastFrustum, frustum, sizeof( frustum ) );
+	}
+
+	for ( const msurface_t *surf : worldLists.skySurfaces )
+	{
+		R_AddSkySurface( surf );
+	}
+
+	return sameView;
+}
+
+CON_COMMAND( r_benchWorldVis, "Benchmarks building the world lists for the current view without drawing. Usage: r_benchWorldVis [iterations]", 0 )
+{
+	if ( !r_worldmodel || !g_worldData.initialised || !tr.refdef.areabits )
+	{
+		Com_Print( "No map loaded\n" );
+		return;
+	}
+
+	const int iterations = Cmd_Argc() > 1 ? Max( Q_atoi( Cmd_Argv( 1 ) ), 1 ) : 100;
+
+	VectorCopy( tr.refdef.vieworg, modelorg );
+
+	worldLists_t lists;
+	std::vector<const mleaf_t *> visibleLeaves;
+	worldVisEntry_t entry{};
+	R_MakeWorldVisKey( entry.key );
+
+	// The old path, mark leaves and walk the tree every frame
+	double start = Time_FloatMilliseconds();
+	for ( int i = 0; i < iterations; ++i )
+	{
+		++tr.frameCount;
+		s_leavesMarked = false;
+
+		worldNodeWork_t work;
+		lists.ClearAllLists();
+		R_MarkLeaves();
+		R_RecursiveWorldNode( work, r_worldmodel->nodes );
+		R_SquashIndices( lists, work );
+	}
+	const double walkMsec = ( Time_FloatMilliseconds() - start ) / iterations;
+	const size_t walkIndices = lists.finalIndices.size();
+
+	// Cache miss, gather the PVS then cull
+	start = Time_FloatMilliseconds();
+	for ( int i = 0; i < iterations; ++i )
+	{
+		++tr.frameCount;
+		R_BuildWorldVisEntry( entry );
+		R_CullWorldVisEntry( entry, lists, visibleLeaves );
+	}
+	const double missMsec = ( Time_FloatMilliseconds() - start ) / iterations;
+
+	// Cache hit, just the cull
+	start = Time_FloatMilliseconds();
+	for ( int i = 0; i < iterations; ++i )
+	{
+		++tr.frameCount;
+		R_CullWorldVisEntry( entry, lists, visibleLeaves );
+	}
+	const double hitMsec = ( Time_FloatMilliseconds() - start ) / iterations;
+	const size_t cachedIndices = lists.finalIndices.size();
+
+	// Everything we touched is stale now
+	s_leavesMarked = false;
+	s_visCache.listsValid = false;
+
+	Com_Printf( "%u leaves, %u materials, %zu / %zu indices (walk / cached)\n",
+		(uint32)entry.leaves.size(), (uint32)entry.groups.size(), walkIndices, cachedIndices );
+	Com_Printf( "walk %.3f ms, cache miss %.3f ms, cache hit %.3f ms\n", walkMsec, missMsec, hitMsec );
 }
 
 //
 // Draws all opaque surfaces in the world list
 //
-static void R_DrawStaticOpaqueWorld( const worldLists_t &worldLists )
+static void R_DrawStaticOpaqueWorld( const worldLists_t &worldLists, uint32 baseIndex )
 {
 	ZoneScoped
 
-	for ( const worldMesh_t &mesh : worldLists.opaqueMeshes )
+	for ( worldMesh_t mesh : worldLists.opaqueMeshes )
 	{
+		mesh.firstIndex += baseIndex;
 		R_DrawWorldMesh( mesh );
 	}
 }
@@ -697,42 +1262,37 @@ void R_DrawWorld()
 
 	// Build the world lists
 
-	worldLists_t worldLists;
+	worldLists_t &worldLists = s_worldLists;
+	bool reused = false;
 
+	if ( r_visCache.GetBool() )
+	{
+		reused = R_BuildCachedWorldLists( worldLists );
+	}
+	else
 	{
 		worldNodeWork_t work;
 
+		s_visCache.listsValid = false;
+		worldLists.ClearAllLists();
+
 		// Determine which leaves are in the PVS / areamask
 		R_MarkLeaves();
 
-#if 0
-		int64 start, end;
-
-		if ( r_fastProfile.GetBool() )
-		{
-			start = Time_Microseconds();
-		}
-#endif
-
 		// This figures out what we need to render and builds the world lists
 		R_RecursiveWorldNode( work, r_worldmodel->nodes );
 
-#if 0
-		if ( r_fastProfile.GetBool() )
-		{
-			end = Time_Microseconds();
-
-			Cvar_SetBool( &r_fastProfile, false );
-
-			int64 timeTaken = end - start;
-
-			Com_Printf( "Spent %llu microseconds inside R_RecursiveWorldNode\n", timeTaken );
-		}
-#endif
+		R_SquashIndices( worldLists, work );
+	}
 
-		R_SquashAndUploadIndices( worldLists, work );
+	if ( !reused && !worldLists.finalIndices.empty() )
+	{
+		s_worldListsBase = R_UploadWorldIndices( worldLists );
 	}
 
+	// Needs the visible surfaces from the world lists
+	R_UpdateLightmaps();
+
 	// Create the model matrix
 	DirectX::XMMATRIX modelMatrix = DirectX::XMMatrixIdentity();
 	DirectX::XMFLOAT4X4A modelMatrixStore;
@@ -767,7 +1327,8 @@ void R_DrawWorld()
 	glUniform1i( indexAfterLights + 3, 3 ); // spec
 
 	// Render stuff!
-	R_DrawStaticOpaqueWorld( worldLists );
+	R_DrawStaticOpaqueWorld( worldLists, s_worldListsBase );
+	R_FenceWorldIndices();
 
 	GL_UseProgram( 0 );
 
@@ -841,6 +1402,13 @@ static void LM_UploadBlock( bool dynamic )
 			GL_UNSIGNED_BYTE,
 			gl_lms.lightmap_buffer );
 
+		// keep a copy around for lightstyle updates
+		if ( !s_lmUpdate.pages[texture] )
+		{
+			s_lmUpdate.pages[texture] = (byte *)Mem_Alloc( sizeof( gl_lms.lightmap_buffer ) );
+		}
+		memcpy( s_lmUpdate.pages[texture], gl_lms.lightmap_buffer, sizeof( gl_lms.lightmap_buffer ) );
+
 		++gl_lms.currentLightmapTexture;
 
 		if ( gl_lms.currentLightmapTexture == MAX_LIGHTMAPS )
@@ -951,6 +1519,19 @@ void GL_BeginBuildingLightmaps( model_t *model )
 	}
 	tr.refdef.lightstyles = lightstyles;
 
+	// everything is about to be built with the base styles
+	for ( int i = 0; i < MAX_LIGHTSTYLES; ++i )
+	{
+		VectorCopy( lightstyles[i].rgb, s_lmUpdate.styleColors[i] );
+		s_lmUpdate.styleSurfaces[i].clear();
+	}
+	for ( int i = 0; i < MAX_LIGHTMAPS; ++i )
+	{
+		s_lmUpdate.dirtyRects[i] = { { BLOCK_WIDTH, BLOCK_HEIGHT }, { 0, 0 } };
+	}
+	s_lmUpdate.pendingSurfaces.clear();
+	++s_lmUpdate.generation;
+
 	gl_lms.currentLightmapTexture = 1;
 
 	/*
@@ -977,6 +1558,226 @@ void GL_EndBuildingLightmaps()
 	LM_UploadBlock( false );
 }
 
+/*
+===================================================================================================
+
+	Lightstyle Animation
+
+===================================================================================================
+*/
+
+static bool R_SurfaceHasStyles( const msurface_t *surf )
+{
+	return !( surf->texinfo->flags & SURFMASK_UNLIT ) && surf->samples && surf->lightmaptexturenum > 0;
+}
+
+static void R_BuildLightstyleLists()
+{
+	ZoneScoped
+
+	const mmodel_t &world = r_worldmodel->submodels[0];
+	s_lmUpdate.firstWorldSurface = world.firstface;
+	s_lmUpdate.numWorldSurfaces = world.numfaces;
+
+	for ( int i = 0; i < MAX_LIGHTSTYLES; ++i )
+	{
+		s_lmUpdate.styleSurfaces[i].clear();
+	}
+
+	for ( int i = 0; i < r_worldmodel->numsurfaces; ++i )
+	{
+		msurface_t *surf = r_worldmodel->surfaces + i;
+		surf->flags &= ~MSURF_LIGHTDIRTY;
+
+		if ( !R_SurfaceHasStyles( surf ) ) {
+			continue;
+		}
+
+		for ( int maps = 0; maps < MAXLIGHTMAPS && surf->styles[maps] != 255; ++maps )
+		{
+			s_lmUpdate.styleSurfaces[surf->styles[maps]].push_back( i );
+		}
+	}
+
+	s_lmUpdate.builtGeneration = s_lmUpdate.generation;
+}
+
+static void R_RebuildSurfaceLightmap( msurface_t *surf )
+{
+	byte *page = s_lmUpdate.pages[surf->lightmaptexturenum];
+	if ( !page ) {
+		return;
+	}
+
+	const int smax = ( surf->extents[0] >> 4 ) + 1;
+	const int tmax = ( surf->extents[1] >> 4 ) + 1;
+
+	// dynamic lights are added by the world shader, baking them here would light the surface twice
+	// and leave a stale stamp behind once the light moves on
+	surf->dlightframe = 0;
+
+	byte *base = page + ( surf->light_t * BLOCK_WIDTH + surf->light_s ) * LIGHTMAP_BYTES;
+
+	R_SetCacheState( surf );
+	R_BuildLightMap( surf, base, BLOCK_WIDTH * LIGHTMAP_BYTES );
+
+	lightmapRect_t &rect = s_lmUpdate.dirtyRects[surf->lightmaptexturenum];
+	rect.mins[0] = Min( rect.mins[0], surf->light_s );
+	rect.mins[1] = Min( rect.mins[1], surf->light_t );
+	rect.maxs[0] = Max( rect.maxs[0], surf->light_s + smax );
+	rect.maxs[1] = Max( rect.maxs[1], surf->light_t + tmax );
+
+	++tr.pc.lightmapSurfaces;
+	tr.pc.lightmapLuxels += smax * tmax;
+}
+
+static void R_UploadDirtyLightmaps()
+{
+	bool uploaded = false;
+
+	for ( int i = 1; i < MAX_LIGHTMAPS; ++i )
+	{
+		lightmapRect_t &rect = s_lmUpdate.dirtyRects[i];
+		if ( rect.IsEmpty() || !gl_lms.lightmapTextures[i] ) {
+			continue;
+		}
+
+		if ( !uploaded )
+		{
+			GL_ActiveTexture( GL_TEXTURE1 );
+			glPixelStorei( GL_UNPACK_ROW_LENGTH, BLOCK_WIDTH );
+			uploaded = true;
+		}
+
+		const byte *pixels = s_lmUpdate.pages[i] + ( rect.mins[1] * BLOCK_WIDTH + rect.mins[0] ) * LIGHTMAP_BYTES;
+
+		GL_BindTexture( gl_lms.lightmapTextures[i] );
+		glTexSubImage2D( GL_TEXTURE_2D,
+			0,
+			rect.mins[0], rect.mins[1],
+			rect.maxs[0] - rect.mins[0], rect.maxs[1] - rect.mins[1],
+			GL_LIGHTMAP_FORMAT,
+			GL_UNSIGNED_BYTE,
+			pixels );
+
+		++tr.pc.lightmapUploads;
+
+		rect = { { BLOCK_WIDTH, BLOCK_HEIGHT }, { 0, 0 } };
+	}
+
+	if ( uploaded )
+	{
+		glPixelStorei( GL_UNPACK_ROW_LENGTH, 0 );
+	}
+}
+
+//
+// Rebuilds the lightmaps of visible surfaces whose lightstyles changed since they were last built,
+// surfaces out of view stay dirty until they're seen again
+//
+static void R_UpdateLightmaps()
+{
+	ZoneScoped
+
+	// the external lightmap doesn't have any styles
+	if ( !r_animateLightmaps.GetBool() || g_worldData.lightmapTexnum || !tr.refdef.lightstyles ) {
+		return;
+	}
+
+	if ( s_lmUpdate.builtGeneration != s_lmUpdate.generation ) {
+		R_BuildLightstyleLists();
+	}
+
+	for ( int i = 0; i < MAX_LIGHTSTYLES; ++i )
+	{
+		const lightstyle_t &style = tr.refdef.lightstyles[i];
+		float *color = s_lmUpdate.styleColors[i];
+
+		if ( VectorCompare( style.rgb, color ) ) {
+			continue;
+		}
+
+		VectorCopy( style.rgb, color );
+
+		for ( uint32 index : s_lmUpdate.styleSurfaces[i] )
+		{
+			msurface_t *surf = r_worldmodel->surfaces + index;
+			if ( !( surf->flags & MSURF_LIGHTDIRTY ) )
+			{
+				surf->flags |= MSURF_LIGHTDIRTY;
+				s_lmUpdate.pendingSurfaces.push_back( index );
+			}
+		}
+	}
+
+	// submodel surfaces aren't marked by the world walk, so they're always rebuilt
+	const uint32 worldBegin = s_lmUpdate.firstWorldSurface;
+	const uint32 worldEnd = worldBegin + s_lmUpdate.numWorldSurfaces;
+
+	size_t numKept = 0;
+	for ( uint32 index : s_lmUpdate.pendingSurfaces )
+	{
+		msurface_t *surf = r_worldmodel->surfaces + index;
+
+		if ( index >= worldBegin && index < worldEnd && surf->frameCount != tr.frameCount )
+		{
+			s_lmUpdate.pendingSurfaces[numKept++] = index;
+			continue;
+		}
+
+		surf->flags &= ~MSURF_LIGHTDIRTY;
+		R_RebuildSurfaceLightmap( surf );
+	}
+	s_lmUpdate.pendingSurfaces.resize( numKept );
+
+	R_UploadDirtyLightmaps();
+}
+
+CON_COMMAND( r_benchLightmaps, "Benchmarks rebuilding every styled lightmap on the CPU. Usage: r_benchLightmaps [iterations]", 0 )
+{
+	if ( !r_worldmodel || !tr.refdef.lightstyles )
+	{
+		Com_Print( "No map loaded\n" );
+		return;
+	}
+
+	const int iterations = Cmd_Argc() > 1 ? Max( Q_atoi( Cmd_Argv( 1 ) ), 1 ) : 10;
+
+	std::vector<byte> scratch( BLOCK_WIDTH * BLOCK_HEIGHT * LIGHTMAP_BYTES );
+	uint64 numLuxels = 0;
+	uint32 numSurfaces = 0;
+
+	const double start = Time_FloatMilliseconds();
+
+	for ( int iter = 0; iter < iterations; ++iter )
+	{
+		for ( int i = 0; i < r_worldmodel->numsurfaces; ++i )
+		{
+			msurface_t *surf = r_worldmodel->surfaces + i;
+			if ( !R_SurfaceHasStyles( surf ) ) {
+				continue;
+			}
+
+			const int dlightframe = surf->dlightframe;
+			surf->dlightframe = 0;
+
+			byte *base = scratch.data() + ( surf->light_t * BLOCK_WIDTH + surf->light_s ) * LIGHTMAP_BYTES;
+			R_BuildLightMap( surf, base, BLOCK_WIDTH * LIGHTMAP_BYTES );
+
+			surf->dlightframe = dlightframe;
+
+			numLuxels += ( ( surf->extents[0] >> 4 ) + 1 ) * ( ( surf->extents[1] >> 4 ) + 1 );
+			++numSurfaces;
+		}
+	}
+
+	const double msec = Time_FloatMilliseconds() - start;
+
+	Com_Printf( "%u surfaces, %llu luxels in %.2f ms, %.3f ms per rebuild, %.1f Mluxels/s\n",
+		numSurfaces / iterations, (unsigned long long)numLuxels, msec, msec / iterations,
+		msec > 0.0 ? numLuxels / ( msec * 1000.0 ) : 0.0 );
+}
+
 // Kept here for reference
 #if 0
 static void R_BuildVertexNormals( worldVertex_t &v1, worldVertex_t &v2, worldVertex_t &v3 )
@@ -1391,6 +2192,10 @@ static void R_UploadBuffers( model_t *worldModel )
 		glBufferData( GL_ELEMENT_ARRAY_BUFFER, indexSize, indexData, GL_STATIC_DRAW );
 	}
 
+	// The visible world indices are streamed in every frame
+	R_CreateWorldIndexRing( ignoreIndices );
+	R_ClearWorldVisCache();
+
 	g_worldData.initialised = true;
 }
 
@@ -1523,6 +2328,9 @@ void R_EraseWorldLists()
 {
 	if ( g_worldData.initialised )
 	{
+		R_DestroyWorldIndexRing();
+		R_ClearWorldVisCache();
+
 		glDeleteVertexArrays( 1, &g_worldData.vao );
 		glDeleteBuffers( 2, &g_worldData.ebo );
 
@@ -14,6 +14,7 @@ material_t	*R_RegisterSkin( const char *name );
 material_t	*R_RegisterPic( const char *name );
 void		R_SetSky( const char *name, float rotate, vec3_t axis );
 void		R_EndRegistration();
+void		R_AbortRegistration();	// an error cut the registration short
 
 			// Render entry points
 void		R_BeginFrame( bool imgui = false, int frameBuffer = 0 );	// should only be called by SCR_Update
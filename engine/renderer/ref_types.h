@@ -6,7 +6,7 @@
 
 #define	MAX_DLIGHTS			32
 #define	MAX_ENTITIES		1024
-#define	MAX_PARTICLES		4096
+#define	MAX_PARTICLES		40960
 #define	MAX_LIGHTSTYLES		256
 
 struct model_t;
@@ -134,6 +134,11 @@ Delete save/<XXX>/
 */
 static void SV_WipeSavegame( const char *savename )
 {
+	// the game might still be writing into it
+	if ( ge ) {
+		ge->FlushSaves();
+	}
+
 #if 0
 	char name[MAX_OSPATH];
 	char *s;
@@ -171,6 +176,10 @@ SV_CopySaveGame
 */
 static void SV_CopySaveGame( const char *src, const char *dst )
 {
+	if ( ge ) {
+		ge->FlushSaves();
+	}
+
 #if 0
 	char name[MAX_OSPATH], name2[MAX_OSPATH];
 	strlen_t l, len;
@@ -802,7 +811,6 @@ static void SV_ServerRecord_f()
 	char	name[MAX_QPATH];
 	byte	buf_data[32768];
 	sizebuf_t	buf;
-	int		len;
 	int		i;
 
 	if ( Cmd_Argc() != 2 )
@@ -811,7 +819,7 @@ static void SV_ServerRecord_f()
 		return;
 	}
 
-	if ( svs.demofile )
+	if ( SV_DemoRecording() )
 	{
 		Com_Print( "Already recording.\n" );
 		return;
@@ -829,12 +837,6 @@ static void SV_ServerRecord_f()
 	Q_sprintf_s( name, "demos/%s.dm2", Cmd_Argv( 1 ) );
 
 	Com_Printf( "recording to %s.\n", name );
-	svs.demofile = FileSystem::OpenFileWrite( name );
-	if ( !svs.demofile )
-	{
-		Com_Print( S_COLOR_RED "ERROR: couldn't open.\n" );
-		return;
-	}
 
 	// setup a buffer to catch all multicasts
 	SZ_Init( &svs.demo_multicast, svs.demo_multicast_buf, sizeof( svs.demo_multicast_buf ) );
@@ -872,9 +874,11 @@ static void SV_ServerRecord_f()
 
 	// write it to the demo file
 	Com_DPrintf( "signon message length: %i\n", buf.cursize );
-	len = LittleLong( buf.cursize );
-	FileSystem::WriteFile( &len, sizeof( len ), svs.demofile );
-	FileSystem::WriteFile( buf.data, buf.cursize, svs.demofile );
+	if ( !SV_BeginDemoRecording( name, &buf ) )
+	{
+		Com_Print( S_COLOR_RED "ERROR: couldn't open.\n" );
+		return;
+	}
 
 	// the rest of the demo file will be individual frames
 }
@@ -888,16 +892,63 @@ Ends server demo recording
 */
 static void SV_ServerStop_f()
 {
-	if ( !svs.demofile ) {
+	if ( !SV_DemoRecording() ) {
 		Com_Print( "Not doing a serverrecord.\n" );
 		return;
 	}
 
-	FileSystem::CloseFile( svs.demofile );
-	svs.demofile = nullptr;
+	SV_EndDemoRecording();
 	Com_Print( "Recording completed.\n" );
 }
 
+/*
+========================
+SV_DemoSeek_f
+
+Jumps a playing server demo to a time from the start of the recording,
+or by a time with + or -. Lands on the keyframe before it.
+========================
+*/
+static void SV_DemoSeek_f()
+{
+	if ( Cmd_Argc() != 2 )
+	{
+		Com_Print( "demoseek <seconds>, +<seconds> or -<seconds>\n" );
+		return;
+	}
+
+	if ( sv.state != ss_demo || !SV_DemoPlaying() )
+	{
+		Com_Print( "Not playing a server demo.\n" );
+		return;
+	}
+
+	const int current = SV_DemoFrame();
+	if ( current < 0 )
+	{
+		Com_Print( "This demo has no seek index.\n" );
+		return;
+	}
+
+	const char *arg = Cmd_Argv( 1 );
+	const int frames = static_cast<int>( Q_atof( arg ) * 10.0f );
+
+	int frame;
+	if ( arg[0] == '+' || arg[0] == '-' ) {
+		frame = current + frames;
+	} else {
+		frame = frames;
+	}
+
+	if ( !SV_SeekDemo( frame ) )
+	{
+		Com_Print( "Couldn't seek.\n" );
+		return;
+	}
+
+	Com_Printf( "Jumped to %.1f seconds.\n", SV_DemoFrame() / 10.0 );
+}
+
 /*
 ========================
 SV_KillServer_f
@@ -958,6 +1009,7 @@ void SV_InitOperatorCommands()
 
 	Cmd_AddCommand( "serverrecord", SV_ServerRecord_f );
 	Cmd_AddCommand( "serverstop", SV_ServerStop_f );
+	Cmd_AddCommand( "demoseek", SV_DemoSeek_f );
 
 	Cmd_AddCommand( "save", SV_Savegame_f );
 	Cmd_AddCommand( "load", SV_Loadgame_f );
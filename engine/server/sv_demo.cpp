@@ -0,0 +1,645 @@
+/*
+===================================================================================================
+
+	Server demos
+
+	serverrecord writes a container instead of the old raw stream of length prefixed messages.
+	The messages are grouped in blocks that are compressed with zlib, every block starts with a
+	keyframe that sends all entities from nothing, the frames after it only send what changed
+	since the frame before. The first block is the signon. An index of where each block starts
+	and which frame it starts with goes at the end of the file, followed by a trailer pointing
+	at it, so playback can jump straight to the keyframe before any frame. Frames in the index
+	count from the start of the recording rather than being server frame numbers, those start
+	over on a map change.
+
+	Inside a block the messages are laid out like an old demo, keyframes use svc_packetentities
+	as before and the frames in between use svc_deltapacketentities. Demos without the magic
+	are played back the old way.
+
+===================================================================================================
+*/
+
+#include "sv_local.h"
+
+#include "zlib.h"
+
+inline constexpr uint32 DEMO_MAGIC = MakeFourCC( 'J', 'Q', 'D', 'M' );
+inline constexpr int32 DEMO_VERSION = 2;
+
+#define DEMO_BLOCK_SIZE		( 512 * 1024 )		// uncompressed, a block is cut before it gets bigger
+#define DEMO_FRAME_SIZE		32768				// largest single frame message
+#define DEMO_SIGNON_FRAME	-1
+
+struct demoHeader_t
+{
+	uint32		magic;
+	int32		version;
+};
+
+struct demoBlockHeader_t
+{
+	int32		compressedSize;
+	int32		rawSize;
+	int32		firstFrame;
+	int32		numMessages;
+};
+
+struct demoIndexEntry_t
+{
+	int32		offset;				// of the block header
+	int32		firstFrame;
+};
+
+struct demoTrailer_t
+{
+	int32		indexOffset;
+	int32		numBlocks;
+	uint32		magic;
+};
+
+extern cvar_t *sv_demoKeyframe;
+
+/*
+===================================================================================================
+
+	Recording
+
+===================================================================================================
+*/
+
+struct demoRecord_t
+{
+	fsHandle_t			file;
+
+	byte *				raw;				// the block being built
+	int					rawSize;
+	int					numMessages;
+	int					firstFrame;			// of the block being built
+
+	int					frames;				// written so far, what the index counts in
+	int					lastServerFrame;
+
+	byte *				compressed;
+	uLong				compressedMax;
+
+	demoIndexEntry_t *	index;
+	int					numBlocks;
+	int					maxBlocks;
+
+	entity_state_t *	lastEntities;		// what the previous frame sent, sorted by number
+	int					numLastEntities;
+
+	int64				rawTotal;			// for the summary
+	int64				compressedTotal;
+};
+
+static demoRecord_t s_record;
+
+static void SV_AddDemoIndex( int offset, int firstFrame )
+{
+	if ( s_record.numBlocks == s_record.maxBlocks )
+	{
+		const int maxBlocks = Max( 64, s_record.maxBlocks * 2 );
+		demoIndexEntry_t *index = (demoIndexEntry_t *)Mem_Alloc( maxBlocks * sizeof( demoIndexEntry_t ) );
+		if ( s_record.index )
+		{
+			memcpy( index, s_record.index, s_record.numBlocks * sizeof( demoIndexEntry_t ) );
+			Mem_Free( s_record.index );
+		}
+		s_record.index = index;
+		s_record.maxBlocks = maxBlocks;
+	}
+
+	demoIndexEntry_t &entry = s_record.index[s_record.numBlocks++];
+	entry.offset = LittleLong( offset );
+	entry.firstFrame = LittleLong( firstFrame );
+}
+
+/*
+========================
+SV_FlushDemoBlock
+
+Compresses the pending block and writes it out
+========================
+*/
+static void SV_FlushDemoBlock()
+{
+	if ( s_record.numMessages == 0 ) {
+		return;
+	}
+
+	uLongf compressedSize = s_record.compressedMax;
+	if ( compress2( s_record.compressed, &compressedSize, s_record.raw, s_record.rawSize, Z_BEST_SPEED ) != Z_OK )
+	{
+		Com_Print( S_COLOR_RED "ERROR: couldn't compress demo block, dropped.\n" );
+		s_record.rawSize = 0;
+		s_record.numMessages = 0;
+		return;
+	}
+
+	const int offset = static_cast<int>( FileSystem::Tell( s_record.file ) );
+	SV_AddDemoIndex( offset, s_record.firstFrame );
+
+	demoBlockHeader_t header;
+	header.compressedSize = LittleLong( static_cast<int32>( compressedSize ) );
+	header.rawSize = LittleLong( s_record.rawSize );
+	header.firstFrame = LittleLong( s_record.firstFrame );
+	header.numMessages = LittleLong( s_record.numMessages );
+
+	FileSystem::WriteFile( &header, sizeof( header ), s_record.file );
+	FileSystem::WriteFile( s_record.compressed, static_cast<fsSize_t>( compressedSize ), s_record.file );
+
+	s_record.rawTotal += s_record.rawSize;
+	s_record.compressedTotal += sizeof( header ) + compressedSize;
+
+	s_record.rawSize = 0;
+	s_record.numMessages = 0;
+}
+
+static void SV_AddDemoMessage( const sizebuf_t *msg )
+{
+	assert( s_record.rawSize + msg->cursize + 4 <= DEMO_BLOCK_SIZE );
+
+	const int32 len = LittleLong( msg->cursize );
+	memcpy( s_record.raw + s_record.rawSize, &len, sizeof( len ) );
+	memcpy( s_record.raw + s_record.rawSize + sizeof( len ), msg->data, msg->cursize );
+
+	s_record.rawSize += sizeof( len ) + msg->cursize;
+	s_record.numMessages++;
+}
+
+/*
+========================
+SV_DemoRecording
+========================
+*/
+bool SV_DemoRecording()
+{
+	return s_record.file != nullptr;
+}
+
+/*
+========================
+SV_BeginDemoRecording
+
+Opens the file and writes the signon as the first block
+========================
+*/
+bool SV_BeginDemoRecording( const char *name, const sizebuf_t *signon )
+{
+	assert( !s_record.file );
+
+	s_record.file = FileSystem::OpenFileWrite( name );
+	if ( !s_record.file ) {
+		return false;
+	}
+
+	s_record.raw = (byte *)Mem_Alloc( DEMO_BLOCK_SIZE );
+	s_record.compressedMax = compressBound( DEMO_BLOCK_SIZE );
+	s_record.compressed = (byte *)Mem_Alloc( s_record.compressedMax );
+	s_record.lastEntities = (entity_state_t *)Mem_Alloc( MAX_EDICTS * sizeof( entity_state_t ) );
+	s_record.numLastEntities = 0;
+	s_record.rawTotal = 0;
+	s_record.compressedTotal = sizeof( demoHeader_t ) + sizeof( demoTrailer_t );
+
+	demoHeader_t header;
+	header.magic = LittleLong( DEMO_MAGIC );
+	header.version = LittleLong( DEMO_VERSION );
+	FileSystem::WriteFile( &header, sizeof( header ), s_record.file );
+
+	s_record.firstFrame = DEMO_SIGNON_FRAME;
+	SV_AddDemoMessage( signon );
+	SV_FlushDemoBlock();
+
+	return true;
+}
+
+/*
+========================
+SV_EndDemoRecording
+
+Writes the last block, the index and the trailer
+========================
+*/
+void SV_EndDemoRecording()
+{
+	if ( !s_record.file ) {
+		return;
+	}
+
+	SV_FlushDemoBlock();
+
+	demoTrailer_t trailer;
+	trailer.indexOffset = LittleLong( static_cast<int32>( FileSystem::Tell( s_record.file ) ) );
+	trailer.numBlocks = LittleLong( s_record.numBlocks );
+	trailer.magic = LittleLong( DEMO_MAGIC );
+
+	FileSystem::WriteFile( s_record.index, s_record.numBlocks * sizeof( demoIndexEntry_t ), s_record.file );
+	FileSystem::WriteFile( &trailer, sizeof( trailer ), s_record.file );
+	FileSystem::CloseFile( s_record.file );
+
+	s_record.compressedTotal += s_record.numBlocks * sizeof( demoIndexEntry_t );
+
+	Com_Printf( "%d blocks, %lld KB of frames in %lld KB (%.1f:1)\n", s_record.numBlocks,
+		s_record.rawTotal / 1024, s_record.compressedTotal / 1024,
+		s_record.compressedTotal ? (double)s_record.rawTotal / s_record.compressedTotal : 0.0 );
+
+	Mem_Free( s_record.raw );
+	Mem_Free( s_record.compressed );
+	Mem_Free( s_record.lastEntities );
+	if ( s_record.index ) {
+		Mem_Free( s_record.index );
+	}
+
+	memset( &s_record, 0, sizeof( s_record ) );
+}
+
+/*
+========================
+SV_WriteDemoFrame
+
+entities must be sorted by number. Starts a new block with a keyframe
+every sv_demoKeyframe seconds or when the block is full, otherwise only
+sends the differences from the last frame.
+========================
+*/
+void SV_WriteDemoFrame( const entity_state_t *entities, int numEntities, const sizebuf_t *multicast )
+{
+	static byte		buf_data[DEMO_FRAME_SIZE];
+	sizebuf_t		buf;
+	entity_state_t	nostate;
+
+	if ( !s_record.file ) {
+		return;
+	}
+
+	// the server frame number going back means a new map
+	const int keyframeFrames = Max( 1, sv_demoKeyframe->GetInt() * 10 );
+	const bool keyframe = s_record.numMessages == 0
+		|| s_record.frames - s_record.firstFrame >= keyframeFrames
+		|| sv.framenum < s_record.lastServerFrame
+		|| s_record.rawSize + DEMO_FRAME_SIZE + 4 > DEMO_BLOCK_SIZE;
+
+	if ( keyframe )
+	{
+		SV_FlushDemoBlock();
+		s_record.firstFrame = s_record.frames;
+	}
+
+	memset( &nostate, 0, sizeof( nostate ) );
+	SZ_Init( &buf, buf_data, sizeof( buf_data ) );
+	buf.allowoverflow = true;
+
+	// write a frame message that doesn't contain a player_state_t
+	MSG_WriteByte( &buf, svc_frame );
+	MSG_WriteLong( &buf, sv.framenum );
+
+	if ( keyframe )
+	{
+		MSG_WriteByte( &buf, svc_packetentities );
+
+		for ( int i = 0; i < numEntities; ++i )
+		{
+			MSG_WriteDeltaEntity( &nostate, const_cast<entity_state_t *>( &entities[i] ), &buf, false, true );
+		}
+	}
+	else
+	{
+		MSG_WriteByte( &buf, svc_deltapacketentities );
+
+		int oldindex = 0;
+		int newindex = 0;
+		while ( newindex < numEntities || oldindex < s_record.numLastEntities )
+		{
+			entity_state_t *oldent = oldindex < s_record.numLastEntities ? &s_record.lastEntities[oldindex] : nullptr;
+			entity_state_t *newent = newindex < numEntities ? const_cast<entity_state_t *>( &entities[newindex] ) : nullptr;
+			const int oldnum = oldent ? oldent->number : 9999;
+			const int newnum = newent ? newent->number : 9999;
+
+			if ( newnum == oldnum )
+			{
+				MSG_WriteDeltaEntity( oldent, newent, &buf, false, false );
+				oldindex++;
+				newindex++;
+			}
+			else if ( newnum < oldnum )
+			{
+				MSG_WriteDeltaEntity( &nostate, newent, &buf, false, true );
+				newindex++;
+			}
+			else
+			{
+				SV_WriteRemoveEntity( &buf, oldnum );
+				oldindex++;
+			}
+		}
+	}
+
+	MSG_WriteShort( &buf, 0 );		// end of packetentities
+
+	// now add the accumulated multicast information
+	SZ_Write( &buf, multicast->data, multicast->cursize );
+
+	if ( buf.overflowed )
+	{
+		Com_Print( S_COLOR_RED "ERROR: demo frame overflowed, dropped.\n" );
+		return;
+	}
+
+	SV_AddDemoMessage( &buf );
+
+	memcpy( s_record.lastEntities, entities, numEntities * sizeof( entity_state_t ) );
+	s_record.numLastEntities = numEntities;
+
+	s_record.frames++;
+	s_record.lastServerFrame = sv.framenum;
+}
+
+/*
+===================================================================================================
+
+	Playback
+
+===================================================================================================
+*/
+
+struct demoPlayback_t
+{
+	fsHandle_t			file;
+	bool				legacy;				// old style, no blocks
+
+	demoIndexEntry_t *	index;
+	int					numBlocks;
+	int					nextBlock;
+
+	byte *				raw;
+	int					rawSize;
+	int					rawPos;
+	byte *				compressed;
+	int					compressedMax;
+
+	int					frame;				// the next one to be read, from the start of the recording
+};
+
+static demoPlayback_t s_playback;
+
+static bool SV_ReadDemoTrailer()
+{
+	const fsSize_t fileSize = FileSystem::GetFileSize( s_playback.file );
+	if ( fileSize < static_cast<fsSize_t>( sizeof( demoHeader_t ) + sizeof( demoTrailer_t ) ) ) {
+		return false;
+	}
+
+	demoTrailer_t trailer;
+	FileSystem::Seek( s_playback.file, fileSize - sizeof( trailer ), FS_SEEK_SET );
+	if ( FileSystem::ReadFile( &trailer, sizeof( trailer ), s_playback.file ) != sizeof( trailer ) ) {
+		return false;
+	}
+
+	const int indexOffset = LittleLong( trailer.indexOffset );
+	const int numBlocks = LittleLong( trailer.numBlocks );
+	if ( LittleLong( trailer.magic ) != DEMO_MAGIC || numBlocks <= 0 || indexOffset < static_cast<int>( sizeof( demoHeader_t ) )
+		|| indexOffset + numBlocks * sizeof( demoIndexEntry_t ) + sizeof( trailer ) != static_cast<size_t>( fileSize ) ) {
+		return false;
+	}
+
+	s_playback.index = (demoIndexEntry_t *)Mem_Alloc( numBlocks * sizeof( demoIndexEntry_t ) );
+	s_playback.numBlocks = numBlocks;
+
+	FileSystem::Seek( s_playback.file, indexOffset, FS_SEEK_SET );
+	FileSystem::ReadFile( s_playback.index, numBlocks * sizeof( demoIndexEntry_t ), s_playback.file );
+
+	for ( int i = 0; i < numBlocks; ++i )
+	{
+		s_playback.index[i].offset = LittleLong( s_playback.index[i].offset );
+		s_playback.index[i].firstFrame = LittleLong( s_playback.index[i].firstFrame );
+	}
+
+	return true;
+}
+
+/*
+========================
+SV_LoadDemoBlock
+========================
+*/
+static bool SV_LoadDemoBlock( int block )
+{
+	if ( block < 0 || block >= s_playback.numBlocks ) {
+		return false;
+	}
+
+	demoBlockHeader_t header;
+	FileSystem::Seek( s_playback.file, s_playback.index[block].offset, FS_SEEK_SET );
+	if ( FileSystem::ReadFile( &header, sizeof( header ), s_playback.file ) != sizeof( header ) ) {
+		return false;
+	}
+
+	const int compressedSize = LittleLong( header.compressedSize );
+	const int rawSize = LittleLong( header.rawSize );
+	if ( compressedSize <= 0 || rawSize <= 0 || rawSize > DEMO_BLOCK_SIZE || compressedSize > s_playback.compressedMax ) {
+		return false;
+	}
+
+	if ( FileSystem::ReadFile( s_playback.compressed, compressedSize, s_playback.file ) != compressedSize ) {
+		return false;
+	}
+
+	uLongf size = DEMO_BLOCK_SIZE;
+	if ( uncompress( s_playback.raw, &size, s_playback.compressed, compressedSize ) != Z_OK || size != static_cast<uLongf>( rawSize ) ) {
+		return false;
+	}
+
+	s_playback.rawSize = rawSize;
+	s_playback.rawPos = 0;
+	s_playback.nextBlock = block + 1;
+
+	// every message after the signon is one frame
+	s_playback.frame = Max( 0, s_playback.index[block].firstFrame );
+
+	return true;
+}
+
+/*
+========================
+SV_BeginDemoPlayback
+========================
+*/
+bool SV_BeginDemoPlayback( const char *name )
+{
+	SV_EndDemoPlayback();
+
+	s_playback.file = FileSystem::OpenFileRead( name );
+	if ( !s_playback.file ) {
+		return false;
+	}
+
+	demoHeader_t header;
+	if ( FileSystem::ReadFile( &header, sizeof( header ), s_playback.file ) == sizeof( header )
+		&& LittleLong( header.magic ) == DEMO_MAGIC )
+	{
+		if ( LittleLong( header.version ) != DEMO_VERSION || !SV_ReadDemoTrailer() )
+		{
+			Com_Printf( S_COLOR_RED "%s is damaged or from a different version\n", name );
+			SV_EndDemoPlayback();
+			return false;
+		}
+
+		s_playback.raw = (byte *)Mem_Alloc( DEMO_BLOCK_SIZE );
+		s_playback.compressedMax = static_cast<int>( compressBound( DEMO_BLOCK_SIZE ) );
+		s_playback.compressed = (byte *)Mem_Alloc( s_playback.compressedMax );
+		s_playback.nextBlock = 0;
+	}
+	else
+	{
+		s_playback.legacy = true;
+		FileSystem::Seek( s_playback.file, 0, FS_SEEK_SET );
+	}
+
+	return true;
+}
+
+/*
+========================
+SV_EndDemoPlayback
+========================
+*/
+void SV_EndDemoPlayback()
+{
+	if ( s_playback.file ) {
+		FileSystem::CloseFile( s_playback.file );
+	}
+	if ( s_playback.index ) {
+		Mem_Free( s_playback.index );
+	}
+	if ( s_playback.raw ) {
+		Mem_Free( s_playback.raw );
+	}
+	if ( s_playback.compressed ) {
+		Mem_Free( s_playback.compressed );
+	}
+
+	memset( &s_playback, 0, sizeof( s_playback ) );
+}
+
+/*
+========================
+SV_DemoPlaying
+========================
+*/
+bool SV_DemoPlaying()
+{
+	return s_playback.file != nullptr;
+}
+
+/*
+========================
+SV_ReadDemoMessage
+
+Returns the length of the next message, or -1 at the end of the demo
+========================
+*/
+int SV_ReadDemoMessage( byte *buffer, int bufferSize )
+{
+	int32 msglen;
+
+	if ( !s_playback.file ) {
+		return -1;
+	}
+
+	if ( s_playback.legacy )
+	{
+		if ( FileSystem::ReadFile( &msglen, sizeof( msglen ), s_playback.file ) != sizeof( msglen ) ) {
+			return -1;
+		}
+		msglen = LittleLong( msglen );
+		if ( msglen == -1 ) {
+			return -1;
+		}
+		if ( msglen < 0 || msglen > bufferSize ) {
+			Com_Error( "SV_ReadDemoMessage: msglen > MAX_MSGLEN" );
+		}
+		if ( FileSystem::ReadFile( buffer, msglen, s_playback.file ) != msglen ) {
+			return -1;
+		}
+		return msglen;
+	}
+
+	if ( s_playback.rawPos >= s_playback.rawSize )
+	{
+		if ( s_playback.nextBlock >= s_playback.numBlocks ) {
+			return -1;
+		}
+		if ( !SV_LoadDemoBlock( s_playback.nextBlock ) )
+		{
+			Com_Print( S_COLOR_RED "Demo block is damaged, stopping.\n" );
+			return -1;
+		}
+	}
+
+	if ( s_playback.rawPos + static_cast<int>( sizeof( msglen ) ) > s_playback.rawSize ) {
+		return -1;
+	}
+	memcpy( &msglen, s_playback.raw + s_playback.rawPos, sizeof( msglen ) );
+	msglen = LittleLong( msglen );
+	s_playback.rawPos += sizeof( msglen );
+
+	if ( msglen < 0 || msglen > bufferSize || s_playback.rawPos + msglen > s_playback.rawSize ) {
+		Com_Error( "SV_ReadDemoMessage: bad message length" );
+	}
+
+	memcpy( buffer, s_playback.raw + s_playback.rawPos, msglen );
+	s_playback.rawPos += msglen;
+
+	// each frame message is one server frame
+	if ( msglen > 0 && buffer[0] == svc_frame ) {
+		s_playback.frame++;
+	}
+
+	return msglen;
+}
+
+/*
+========================
+SV_SeekDemo
+
+Jumps to the keyframe at or before frame, the client picks up from there
+========================
+*/
+bool SV_SeekDemo( int frame )
+{
+	if ( !s_playback.file || s_playback.legacy || s_playback.numBlocks < 2 ) {
+		return false;
+	}
+
+	// block 0 is the signon, which the clients already have
+	int block = 1;
+	int low = 1, high = s_playback.numBlocks - 1;
+	while ( low <= high )
+	{
+		const int mid = ( low + high ) / 2;
+		if ( s_playback.index[mid].firstFrame <= frame )
+		{
+			block = mid;
+			low = mid + 1;
+		}
+		else
+		{
+			high = mid - 1;
+		}
+	}
+
+	return SV_LoadDemoBlock( block );
+}
+
+/*
+========================
+SV_DemoFrame
+
+The frame playback is at counted from the start of the recording, -1 for old demos
+========================
+*/
+int SV_DemoFrame()
+{
+	return s_playback.legacy ? -1 : s_playback.frame;
+}
@@ -9,6 +9,30 @@
 ===================================================================================================
 */
 
+/*
+========================
+SV_WriteRemoveEntity
+========================
+*/
+void SV_WriteRemoveEntity( sizebuf_t *msg, int number )
+{
+	int bits = U_REMOVE;
+	if ( number >= 256 ) {
+		bits |= U_NUMBER16 | U_MOREBITS1;
+	}
+
+	MSG_WriteByte( msg, bits & 255 );
+	if ( bits & 0x0000ff00 ) {
+		MSG_WriteByte( msg, ( bits >> 8 ) & 255 );
+	}
+
+	if ( bits & U_NUMBER16 ) {
+		MSG_WriteShort( msg, number );
+	} else {
+		MSG_WriteByte( msg, number );
+	}
+}
+
 /*
 ========================
 SV_EmitPacketEntities
@@ -22,7 +46,6 @@ static void SV_EmitPacketEntities( clientSnapshot_t *from, clientSnapshot_t *to,
 	int		oldindex, newindex;
 	int		oldnum, newnum;
 	int		from_num_entities;
-	int		bits;
 
 #if 0
 	if ( numprojs )
@@ -81,22 +104,7 @@ static void SV_EmitPacketEntities( clientSnapshot_t *from, clientSnapshot_t *to,
 		if ( newnum > oldnum )
 		{
 			// the old entity isn't present in the new message
-			bits = U_REMOVE;
-			if ( oldnum >= 256 ) {
-				bits |= U_NUMBER16 | U_MOREBITS1;
-			}
-
-			MSG_WriteByte( msg, bits & 255 );
-			if ( bits & 0x0000ff00 ) {
-				MSG_WriteByte( msg, ( bits >> 8 ) & 255 );
-			}
-
-			if ( bits & U_NUMBER16 ) {
-				MSG_WriteShort( msg, oldnum );
-			} else {
-				MSG_WriteByte( msg, oldnum );
-			}
-
+			SV_WriteRemoveEntity( msg, oldnum );
 			oldindex++;
 			continue;
 		}
@@ -619,31 +627,22 @@ void SV_BuildClientFrame( client_t *client )
 ========================
 SV_RecordDemoMessage
 
-Save everything in the world out without deltas.
+Save everything in the world out, the demo code works out the deltas.
 Used for recording footage for merged or assembled demos
 ========================
 */
 void SV_RecordDemoMessage()
 {
+	static entity_state_t	entities[MAX_EDICTS];
+	int			numEntities;
 	int			e;
 	edict_t *	ent;
-	entity_state_t	nostate;
-	sizebuf_t	buf;
-	byte		buf_data[32768];
-	int			len;
 
-	if ( !svs.demofile ) {
+	if ( !SV_DemoRecording() ) {
 		return;
 	}
 
-	memset( &nostate, 0, sizeof( nostate ) );
-	SZ_Init( &buf, buf_data, sizeof( buf_data ) );
-
-	// write a frame message that doesn't contain a player_state_t
-	MSG_WriteByte( &buf, svc_frame );
-	MSG_WriteLong( &buf, sv.framenum );
-
-	MSG_WriteByte( &buf, svc_packetentities );
+	numEntities = 0;
 
 	e = 1;
 	ent = EDICT_NUM( e );
@@ -655,21 +654,13 @@ void SV_RecordDemoMessage()
 			( ent->s.modelindex || ent->s.effects || ent->s.sound || ent->s.event ) &&
 			!( ent->svflags & SVF_NOCLIENT ) )
 		{
-			MSG_WriteDeltaEntity( &nostate, &ent->s, &buf, false, true );
+			entities[numEntities++] = ent->s;
 		}
 
 		e++;
 		ent = EDICT_NUM( e );
 	}
 
-	MSG_WriteShort( &buf, 0 );		// end of packetentities
-
-	// now add the accumulated multicast information
-	SZ_Write( &buf, svs.demo_multicast.data, svs.demo_multicast.cursize );
+	SV_WriteDemoFrame( entities, numEntities, &svs.demo_multicast );
 	SZ_Clear( &svs.demo_multicast );
-
-	// now write the entire message to the file, prefixed by the length
-	len = LittleLong( buf.cursize );
-	FileSystem::WriteFile( &len, sizeof( len ), svs.demofile );
-	FileSystem::WriteFile( buf.data, buf.cursize, svs.demofile );
 }
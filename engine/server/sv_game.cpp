@@ -28,6 +28,8 @@ static void PF_Unicast( edict_t *ent, qboolean reliable )
 	client = svs.clients + ( p - 1 );
 
 	if ( reliable ) {
+		// anything this refers to has to get there first
+		SV_FlushConfigstrings();
 		SZ_Write( &client->netchan.message, sv.multicast.data, sv.multicast.cursize );
 	} else {
 		SZ_Write( &client->datagram, sv.multicast.data, sv.multicast.cursize );
@@ -178,19 +180,7 @@ static void PF_Configstring( int index, const char *val )
 		val = "";
 	}
 
-	// change the string in sv
-	strcpy( sv.configstrings[index], val );
-
-	if ( sv.state != ss_loading )
-	{
-		// send the update to everyone
-		SZ_Clear( &sv.multicast );
-		MSG_WriteChar( &sv.multicast, svc_configstring );
-		MSG_WriteShort( &sv.multicast, index );
-		MSG_WriteString( &sv.multicast, val );
-
-		SV_Multicast( vec3_origin, MULTICAST_ALL_R );
-	}
+	SV_SetConfigstring( index, val );
 }
 
 static void PF_WriteChar( int c )			{ MSG_WriteChar( &sv.multicast, c ); }
@@ -1,9 +1,168 @@
 
 #include "sv_local.h"
 
+#include <bit>
+
 serverStatic_t	svs;		// persistant server info
 server_t		sv;			// local server
 
+/*
+===================================================================================================
+
+	Configstring index
+
+	The model, sound and image configstrings are chained by name so the *Index functions don't
+	compare against every one of them. Changes made while the server is running are marked and
+	sent together once a frame, or before any reliable message that might refer to them.
+
+===================================================================================================
+*/
+
+static bool SV_IsIndexedConfigstring( int index )
+{
+	return index >= CS_MODELS && index < CS_LIGHTS;
+}
+
+static void SV_LinkConfigstring( int index )
+{
+	const uint32 bucket = HashString( sv.configstrings[index] ) & ( CS_HASH_SIZE - 1 );
+
+	sv.configstringNext[index] = sv.configstringHash[bucket];
+	sv.configstringHash[bucket] = static_cast<uint16>( index );
+}
+
+static void SV_UnlinkConfigstring( int index )
+{
+	const uint32 bucket = HashString( sv.configstrings[index] ) & ( CS_HASH_SIZE - 1 );
+
+	for ( uint16 *link = &sv.configstringHash[bucket]; *link; link = &sv.configstringNext[*link] )
+	{
+		if ( *link == index )
+		{
+			*link = sv.configstringNext[index];
+			sv.configstringNext[index] = 0;
+			return;
+		}
+	}
+}
+
+/*
+========================
+SV_RebuildConfigstringIndex
+========================
+*/
+void SV_RebuildConfigstringIndex()
+{
+	memset( sv.configstringHash, 0, sizeof( sv.configstringHash ) );
+	memset( sv.configstringNext, 0, sizeof( sv.configstringNext ) );
+
+	for ( int i = CS_MODELS; i < CS_LIGHTS; ++i )
+	{
+		if ( sv.configstrings[i][0] ) {
+			SV_LinkConfigstring( i );
+		}
+	}
+}
+
+/*
+========================
+SV_SetConfigstring
+========================
+*/
+void SV_SetConfigstring( int index, const char *val )
+{
+	const bool indexed = SV_IsIndexedConfigstring( index );
+
+	if ( indexed && sv.configstrings[index][0] ) {
+		SV_UnlinkConfigstring( index );
+	}
+
+	// change the string in sv, the status bar program is allowed to run on
+	// across the slots after it
+	if ( index >= CS_STATUSBAR && index < CS_MAXCLIENTS ) {
+		Q_strcpy_s( sv.configstrings[index], ( CS_MAXCLIENTS - index ) * MAX_QPATH, val );
+	} else {
+		Q_strcpy_s( sv.configstrings[index], val );
+	}
+
+	if ( indexed && sv.configstrings[index][0] ) {
+		SV_LinkConfigstring( index );
+	}
+
+	if ( sv.state != ss_loading )
+	{
+		sv.configstringsChanged[index >> 5] |= 1u << ( index & 31 );
+		sv.configstringsPending = true;
+	}
+
+	svs.statusSequence++;
+}
+
+static void SV_SendConfigstrings( sizebuf_t *msg )
+{
+	client_t *	client;
+	int			i;
+
+	// if doing a serverrecord, store everything
+	if ( SV_DemoRecording() ) {
+		SZ_Write( &svs.demo_multicast, msg->data, msg->cursize );
+	}
+
+	for ( i = 0, client = svs.clients; i < maxclients->GetInt(); i++, client++ )
+	{
+		if ( client->state == cs_free || client->state == cs_zombie ) {
+			continue;
+		}
+		SZ_Write( &client->netchan.message, msg->data, msg->cursize );
+	}
+
+	SZ_Clear( msg );
+}
+
+/*
+========================
+SV_FlushConfigstrings
+========================
+*/
+void SV_FlushConfigstrings()
+{
+	sizebuf_t	msg;
+	byte		msg_buf[MAX_MSGLEN];
+
+	if ( !sv.configstringsPending ) {
+		return;
+	}
+	sv.configstringsPending = false;
+
+	SZ_Init( &msg, msg_buf, sizeof( msg_buf ) );
+
+	for ( int word = 0; word < countof( sv.configstringsChanged ); ++word )
+	{
+		uint32 bits = sv.configstringsChanged[word];
+		sv.configstringsChanged[word] = 0;
+
+		while ( bits )
+		{
+			const int index = word * 32 + std::countr_zero( bits );
+			bits &= bits - 1;
+
+			// id, index and the string
+			const int length = static_cast<int>( strlen( sv.configstrings[index] ) ) + 1;
+			if ( msg.cursize + 1 + 2 + length > msg.maxsize ) {
+				SV_SendConfigstrings( &msg );
+			}
+
+			MSG_WriteChar( &msg, svc_configstring );
+			MSG_WriteShort( &msg, index );
+			MSG_WriteString( &msg, sv.configstrings[index] );
+		}
+	}
+
+	if ( msg.cursize ) {
+		SV_SendConfigstrings( &msg );
+	}
+}
+
 /*
 ========================
 SV_FindIndex
@@ -17,10 +176,12 @@ static int SV_FindIndex( const char *name, int start, int max, bool create )
 		return 0;
 	}
 
-	for ( i = 1; i < max && sv.configstrings[start + i][0]; i++ )
+	const uint32 bucket = HashString( name ) & ( CS_HASH_SIZE - 1 );
+
+	for ( int index = sv.configstringHash[bucket]; index; index = sv.configstringNext[index] )
 	{
-		if ( Q_strcmp( sv.configstrings[start + i], name ) == 0 ) {
-			return i;
+		if ( index > start && index < start + max && Q_strcmp( sv.configstrings[index], name ) == 0 ) {
+			return index - start;
 		}
 	}
 
@@ -28,21 +189,15 @@ static int SV_FindIndex( const char *name, int start, int max, bool create )
 		return 0;
 	}
 
+	// only reached the first time a name is used
+	for ( i = 1; i < max && sv.configstrings[start + i][0]; i++ )
+		;
+
 	if ( i == max ) {
 		Com_Error( "*Index: overflow" );
 	}
 
-	Q_strcpy_s( sv.configstrings[start + i], name );
-
-	if ( sv.state != ss_loading )
-	{
-		// send the update to everyone
-		SZ_Clear( &sv.multicast );
-		MSG_WriteChar( &sv.multicast, svc_configstring );
-		MSG_WriteShort( &sv.multicast, start + i );
-		MSG_WriteString( &sv.multicast, name );
-		SV_Multicast( vec3_origin, MULTICAST_ALL_R );
-	}
+	SV_SetConfigstring( start + i, name );
 
 	return i;
 }
@@ -121,6 +276,7 @@ static void SV_CheckForSavegame()
 
 	// get configstrings and areaportals
 	SV_ReadLevelFile();
+	SV_RebuildConfigstringIndex();
 
 #if 0
 	if ( !sv.loadgame )
@@ -162,9 +318,7 @@ static void SV_SpawnServer( const char *server, const char *spawnpoint, serverSt
 	Com_Print( "------- Server Initialization -------\n" );
 
 	Com_DPrintf( "SpawnServer: %s\n", server );
-	if ( sv.demofile ) {
-		FileSystem::CloseFile( sv.demofile );
-	}
+	SV_EndDemoPlayback();
 
 	svs.spawncount++;		// any partially connected client will be restarted
 
@@ -222,6 +376,8 @@ static void SV_SpawnServer( const char *server, const char *spawnpoint, serverSt
 		sv.models[i + 1] = CM_InlineModel( sv.configstrings[CS_MODELS + 1 + i] );
 	}
 
+	SV_RebuildConfigstringIndex();
+
 	//
 	// spawn the rest of the entities on the map
 	//
@@ -341,6 +497,94 @@ void SV_InitGame()
 	}
 }
 
+/*
+========================
+SV_BecomeInstance
+
+Moves a forked copy onto its own port
+========================
+*/
+static void SV_BecomeInstance( int instance, const char *baseName )
+{
+	// the same order NET_OpenIP picks the port in
+	int port = Cvar_FindGetInt( "ip_hostport" );
+	if ( !port ) {
+		port = Cvar_FindGetInt( "hostport" );
+		if ( !port ) {
+			port = Cvar_FindGetInt( "port" );
+			if ( !port ) {
+				port = PORT_SERVER;
+			}
+		}
+	}
+
+	Cvar_FullSet( "ip_hostport", va( "%i", port + instance ), CVAR_INIT );
+	Cvar_FullSet( "sv_instance", va( "%i", instance ), CVAR_SERVERINFO | CVAR_INIT );
+	Cvar_Set( "hostname", va( "%s #%i", baseName, instance + 1 ) );
+
+	// drop the socket the original is listening on
+	NET_Config( false );
+	NET_Config( true );
+
+	Com_Printf( "Server instance %d listening on port %d\n", instance + 1, port + instance );
+}
+
+/*
+========================
+SV_StartInstances
+
+With sv_instances above 1 a dedicated server forks into that many independent servers once its
+first map is loaded. The copies share the collision map, the game code and the filesystem with
+the original for as long as nobody writes to them, instead of each process loading its own. A
+copy that changes map loads that one for itself.
+========================
+*/
+static void SV_StartInstances()
+{
+	static bool started;
+
+	if ( started || !dedicated->GetBool() ) {
+		return;
+	}
+	started = true;
+
+	const int count = sv_instances->GetInt();
+	if ( count <= 1 ) {
+		return;
+	}
+
+	char baseName[MAX_QPATH];
+	Q_strcpy_s( baseName, Cvar_FindGetString( "hostname" ) );
+
+	// nothing may be running on another thread when the process is copied
+	ge->FlushSaves();
+	ge->StopJobs();
+	Com_BeforeFork();
+
+	for ( int i = 1; i < count; ++i )
+	{
+		const int instance = Sys_ForkInstance( i );
+		if ( instance < 0 )
+		{
+			Com_AfterFork( 0 );
+			Com_Print( "This platform can't run more than one server instance per process\n" );
+			return;
+		}
+		if ( instance > 0 )
+		{
+			Com_AfterFork( instance );
+			SV_BecomeInstance( instance, baseName );
+			return;
+		}
+	}
+
+	Com_AfterFork( 0 );
+
+	Cvar_Set( "hostname", va( "%s #1", baseName ) );
+
+	Com_Printf( "Started %d server instances\n", count );
+}
+
 /*
 ========================
 SV_Map
@@ -433,4 +677,6 @@ void SV_Map( bool attractloop, const char *levelstring, bool loadgame )
 	}
 
 	SV_BroadcastCommand( "reconnect\n" );
+
+	SV_StartInstances();
 }
@@ -10,6 +10,8 @@ extern game_export_t *ge;
 
 #define	MAX_MASTERS	8				// max recipients for heartbeat packets
 
+#define	CS_HASH_SIZE	1024		// buckets for the model, sound and image configstrings
+
 enum serverState_t
 {
 	ss_dead,			// no map loaded
@@ -34,6 +36,14 @@ struct server_t
 	cmodel_t	*models[MAX_MODELS];
 
 	char		configstrings[MAX_CONFIGSTRINGS][MAX_QPATH];
+
+	// the model, sound and image configstrings chained by name, 0 ends a chain
+	uint16		configstringHash[CS_HASH_SIZE];
+	uint16		configstringNext[MAX_CONFIGSTRINGS];
+
+	// configstrings changed this frame, SV_FlushConfigstrings sends them together
+	uint32		configstringsChanged[( MAX_CONFIGSTRINGS + 31 ) / 32];
+	bool		configstringsPending;
 	entity_state_t	baselines[MAX_EDICTS];
 
 	// the multicast buffer is used to send a message to a set of clients
@@ -42,8 +52,7 @@ struct server_t
 	sizebuf_t	multicast;
 	byte		multicast_buf[MAX_MSGLEN];
 
-	// demo server information
-	fsHandle_t	demofile;
+	// demo server information, the file is in sv_demo.cpp
 	qboolean	timedemo;		// don't time sync
 };
 
@@ -111,9 +120,11 @@ struct client_t
 
 	clientSnapshot_t	frames[UPDATE_BACKUP];	// updates can be delta'd from here
 
-	byte			*download;			// file being downloaded
+	const byte		*download;			// file being downloaded, usually shared with other clients
 	int				downloadsize;		// total bytes (can't use EOF because of paks)
 	int				downloadcount;		// bytes sent
+	bool			downloadBulk;		// sent as bulk fragments instead of svc_download
+	bulkSender_t	bulk;
 
 	int				lastmessage;		// sv.framenum when packet was last received
 	int				lastconnect;
@@ -160,10 +171,12 @@ struct serverStatic_t
 
 	int			last_heartbeat;
 
+	uint32		statusSequence;				// bumped when anything in a status reply changes,
+											// other than frags and pings
+
 	challenge_t	challenges[MAX_CHALLENGES];	// to prevent invalid IPs from connecting
 
-	// serverrecord values
-	fsHandle_t	demofile;
+	// serverrecord values, the file is in sv_demo.cpp
 	sizebuf_t	demo_multicast;
 	byte		demo_multicast_buf[MAX_MSGLEN];
 };
@@ -184,6 +197,7 @@ extern cvar_t *		maxclients;
 extern cvar_t *		sv_noreload;			// don't reload level state when reentering
 											// development tool
 extern cvar_t *		sv_enforcetime;
+extern cvar_t *		sv_instances;
 
 extern client_t *	sv_client;
 extern edict_t *	sv_player;
@@ -210,6 +224,13 @@ void Master_Heartbeat();
 void SV_InitGame();
 void SV_Map( bool attractloop, const char *levelstring, bool loadgame );
 
+// all changes to the configstrings while the server is running go through here
+void SV_SetConfigstring( int index, const char *val );
+// call after writing to sv.configstrings directly
+void SV_RebuildConfigstringIndex();
+// sends the configstrings changed since the last flush to everyone
+void SV_FlushConfigstrings();
+
 
 //
 // sv_phys.c
@@ -241,6 +262,9 @@ void SV_BroadcastCommand( const char *cmd );
 //
 void SV_Nextserver();
 void SV_ExecuteClientMessage( client_t *cl );
+void SV_EndDownload( client_t *cl );
+void SV_BulkPacket();
+void SV_SendDownloads();
 
 //
 // sv_ccmds.c
@@ -254,6 +278,32 @@ void SV_InitOperatorCommands();
 void SV_WriteFrameToClient (client_t *client, sizebuf_t *msg);
 void SV_RecordDemoMessage (void);
 void SV_BuildClientFrame (client_t *client);
+void SV_WriteRemoveEntity( sizebuf_t *msg, int number );
+
+//
+// sv_demo.cpp
+//
+bool SV_DemoRecording();
+bool SV_BeginDemoRecording( const char *name, const sizebuf_t *signon );
+void SV_EndDemoRecording();
+void SV_WriteDemoFrame( const entity_state_t *entities, int numEntities, const sizebuf_t *multicast );
+
+bool SV_DemoPlaying();
+bool SV_BeginDemoPlayback( const char *name );
+void SV_EndDemoPlayback();
+int SV_ReadDemoMessage( byte *buffer, int bufferSize );
+bool SV_SeekDemo( int frame );
+int SV_DemoFrame();
+
+//
+// sv_query.cpp
+//
+void SV_InitQueries();
+bool SV_QueryPacket( const char *command );
+bool SV_QueryAllowed( const netadr_t &adr );
+void SV_UpdateQueryPackets();
+char *SV_StatusString();
+const challenge_t *SV_FindChallenge( const netadr_t &adr );
 
 //
 // sv_game.c
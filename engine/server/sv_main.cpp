@@ -20,6 +20,10 @@ cvar_t	*allow_download_players;
 cvar_t	*allow_download_models;
 cvar_t	*allow_download_sounds;
 cvar_t	*allow_download_maps;
+cvar_t	*sv_downloadRate;
+cvar_t	*sv_downloadWindow;
+cvar_t	*sv_demoKeyframe;
+cvar_t	*sv_instances;
 
 cvar_t	*sv_noreload;			// don't reload level state when reentering
 
@@ -54,14 +58,12 @@ void SV_DropClient( client_t *drop )
 		ge->ClientDisconnect( drop->edict );
 	}
 
-	if ( drop->download )
-	{
-		FileSystem::FreeFile( drop->download );
-		drop->download = NULL;
-	}
+	SV_EndDownload( drop );
 
 	drop->state = cs_zombie;		// become free in a few seconds
 	drop->name[0] = 0;
+
+	svs.statusSequence++;
 }
 
 /*
@@ -72,60 +74,6 @@ void SV_DropClient( client_t *drop )
 ===================================================================================================
 */
 
-/*
-========================
-SV_StatusString
-
-Builds the string that is sent as heartbeats and status replies
-========================
-*/
-static char *SV_StatusString()
-{
-	char			player[1024];
-	static char		status[MAX_MSGLEN - 16];
-	int				i;
-	client_t *		cl;
-	strlen_t		statusLength;
-	strlen_t		playerLength;
-
-	statusLength = Q_sprintf_s( status, "%s\n", Cvar_Serverinfo() );
-
-	for ( i = 0; i < maxclients->GetInt(); i++ )
-	{
-		cl = &svs.clients[i];
-		if ( cl->state == cs_connected || cl->state == cs_spawned )
-		{
-			playerLength = Q_sprintf_s( player, "%i %i \"%s\"\n",
-				cl->edict->client->ps.stats[STAT_FRAGS], cl->ping, cl->name );
-			if ( statusLength + playerLength >= sizeof( status ) ) {
-				// can't hold any more
-				break;
-			}
-			strcpy( status + statusLength, player );
-			statusLength += playerLength;
-		}
-	}
-
-	return status;
-}
-
-/*
-========================
-SVC_Status
-
-Responds with all the info that qplug or qspy can see
-========================
-*/
-static void SVC_Status()
-{
-	Netchan_OutOfBandPrint( NS_SERVER, net_from, "print\n%s", SV_StatusString() );
-#if 0
-	Com_BeginRedirect( RD_PACKET, sv_outputbuf, SV_OUTPUTBUF_LENGTH, SV_FlushRedirect );
-	Com_Printf( SV_StatusString() );
-	Com_EndRedirect();
-#endif
-}
-
 /*
 ========================
 SVC_Ack
@@ -136,105 +84,6 @@ static void SVC_Ack()
 	Com_Printf( "Ping acknowledge from %s\n", NET_NetadrToString( net_from ) );
 }
 
-/*
-========================
-SVC_Info
-
-Responds with short info for broadcast scans
-The second parameter should be the current protocol version number.
-========================
-*/
-static void SVC_Info()
-{
-	char	string[64];
-	int		i, count;
-	int		version;
-
-	if ( maxclients->GetInt() == 1 ) {
-		// ignore in single player
-		return;
-	}
-
-	version = Q_atoi( Cmd_Argv( 1 ) );
-
-	if ( version != PROTOCOL_VERSION )
-	{
-		Q_sprintf_s( string, "%s: wrong version\n", hostname->GetString() );
-	}
-	else
-	{
-		count = 0;
-		for ( i = 0; i < maxclients->GetInt(); i++ )
-		{
-			if ( svs.clients[i].state >= cs_connected ) {
-				count++;
-			}
-		}
-
-		Q_sprintf_s( string, "%16s %8s %2i/%2i\n", hostname->GetString(), sv.name, count, maxclients->GetInt() );
-	}
-
-	Netchan_OutOfBandPrint( NS_SERVER, net_from, "info\n%s", string );
-}
-
-/*
-========================
-SVC_Ping
-
-Just responds with an acknowledgement
-========================
-*/
-static void SVC_Ping()
-{
-	Netchan_OutOfBandPrint( NS_SERVER, net_from, "ack" );
-}
-
-/*
-========================
-SVC_GetChallenge
-
-Returns a challenge number that can be used
-in a subsequent client_connect command.
-We do this to prevent denial of service attacks that
-flood the server with invalid connection IPs.  With a
-challenge, they must give a valid IP address.
-========================
-*/
-static void SVC_GetChallenge()
-{
-	int		i;
-	int		oldest;
-	int		oldestTime;
-
-	oldest = 0;
-	oldestTime = 0x7fffffff;
-
-	// see if we already have a challenge for this ip
-	for ( i = 0; i < MAX_CHALLENGES; i++ )
-	{
-		if ( NET_CompareBaseNetadr( net_from, svs.challenges[i].adr ) ) {
-			break;
-		}
-		if ( svs.challenges[i].time < oldestTime )
-		{
-			oldestTime = svs.challenges[i].time;
-			oldest = i;
-		}
-	}
-
-	if ( i == MAX_CHALLENGES )
-	{
-		// overwrite the oldest
-		svs.challenges[oldest].challenge = rand() & 0x7fff;
-		svs.challenges[oldest].adr = net_from;
-		svs.challenges[oldest].time = curtime;
-		i = oldest;
-	}
-
-	// send it back
-	Netchan_OutOfBandPrint( NS_SERVER, net_from, "challenge %i", svs.challenges[i].challenge );
-}
-
 /*
 ========================
 SVC_DirectConnect
@@ -290,21 +139,15 @@ static void SVC_DirectConnect()
 	// see if the challenge is valid
 	if ( !NET_IsLocalAddress( adr ) )
 	{
-		for ( i = 0; i < MAX_CHALLENGES; i++ )
+		const challenge_t *issued = SV_FindChallenge( net_from );
+		if ( !issued )
 		{
-			if ( NET_CompareBaseNetadr( net_from, svs.challenges[i].adr ) )
-			{
-				if ( challenge == svs.challenges[i].challenge ) {
-					// good
-					break;
-				}
-				Netchan_OutOfBandPrint( NS_SERVER, adr, "print\nBad challenge.\n" );
-				return;
-			}
+			Netchan_OutOfBandPrint( NS_SERVER, adr, "print\nNo challenge for address.\n" );
+			return;
 		}
-		if ( i == MAX_CHALLENGES )
+		if ( challenge != issued->challenge )
 		{
-			Netchan_OutOfBandPrint( NS_SERVER, adr, "print\nNo challenge for address.\n" );
+			Netchan_OutOfBandPrint( NS_SERVER, adr, "print\nBad challenge.\n" );
 			return;
 		}
 	}
@@ -385,6 +228,7 @@ gotnewcl:
 	Netchan_Setup( NS_SERVER, &newcl->netchan, adr, qport );
 
 	newcl->state = cs_connected;
+	svs.statusSequence++;
 
 	SZ_Init( &newcl->datagram, newcl->datagram_buf, sizeof( newcl->datagram_buf ) );
 	newcl->datagram.allowoverflow = true;
@@ -475,32 +319,24 @@ static void SV_ConnectionlessPacket()
 	c = Cmd_Argv( 0 );
 	Com_DPrintf( "Packet %s : %s\n", NET_NetadrToString( net_from ), c );
 
-	if ( Q_strcmp( c, "ping" ) == 0 ) {
-		SVC_Ping();
+	// ping, info, status and getchallenge are answered in sv_query.cpp
+	if ( SV_QueryPacket( c ) ) {
 		return;
 	}
+
 	if ( Q_strcmp( c, "ack" ) == 0 ) {
 		SVC_Ack();
 		return;
 	}
-	if ( Q_strcmp( c, "status" ) == 0 ) {
-		SVC_Status();
-		return;
-	}
-	if ( Q_strcmp( c, "info" ) == 0 ) {
-		SVC_Info();
-		return;
-	}
-	if ( Q_strcmp( c, "getchallenge" ) == 0 ) {
-		SVC_GetChallenge();
-		return;
-	}
 	if ( Q_strcmp( c, "connect" ) == 0 ) {
 		SVC_DirectConnect();
 		return;
 	}
 	if ( Q_strcmp( c, "rcon" ) == 0 ) {
-		SVC_RemoteCommand();
+		// bad passwords are printed, don't let a flood of them through
+		if ( SV_QueryAllowed( net_from ) ) {
+			SVC_RemoteCommand();
+		}
 		return;
 	}
 
@@ -613,6 +449,12 @@ static void SV_ReadPackets()
 			continue;
 		}
 
+		if ( *(int *)net_message.data == BULK_HEADER )
+		{
+			SV_BulkPacket();
+			continue;
+		}
+
 		// read the qport out of the message so we can fix up
 		// stupid address translating routers
 		MSG_BeginReading( &net_message );
@@ -690,6 +532,7 @@ static void SV_CheckTimeouts()
 			&& cl->lastmessage < zombiepoint )
 		{
 			cl->state = cs_free;	// can now be reused
+			svs.statusSequence++;
 			continue;
 		}
 		if ( ( cl->state == cs_connected || cl->state == cs_spawned )
@@ -786,6 +629,9 @@ void SV_Frame( int msec )
 	// get packets from clients
 	SV_ReadPackets();
 
+	// downloads are paced by real time, not the game frame
+	SV_SendDownloads();
+
 	// move autonomous things around if enough time has passed
 	if ( !sv_timedemo->GetBool() && (unsigned)svs.realtime < sv.time )
 	{
@@ -810,6 +656,9 @@ void SV_Frame( int msec )
 	// let everything in the world think and move
 	SV_RunGameFrame();
 
+	// send the configstrings the game changed this frame in one go
+	SV_FlushConfigstrings();
+
 	// send messages back to the clients that had packets read this frame
 	SV_SendClientMessages();
 
@@ -819,6 +668,9 @@ void SV_Frame( int msec )
 	// send a heartbeat to the master if needed
 	Master_Heartbeat();
 
+	// rebuild the query replies from this frame if anyone has been asking
+	SV_UpdateQueryPackets();
+
 	// clear teleport flags, etc for next frame
 	SV_PrepWorldFrame();
 }
@@ -925,16 +777,19 @@ into a more C friendly form.
 */
 void SV_UserinfoChanged( client_t *cl )
 {
-	char *val;
+	const char *val;
 
 	// call prog code to allow overrides
 	ge->ClientUserinfoChanged( cl->edict, cl->userinfo );
 
+	// parse it once for the lookups below
+	const InfoMap info( cl->userinfo );
+
 	// name for C code
-	Q_strcpy_s( cl->name, Info_ValueForKey( cl->userinfo, "name" ) );
+	Q_strcpy_s( cl->name, info.Get( "name" ) );
 
 	// rate command
-	val = Info_ValueForKey( cl->userinfo, "rate" );
+	val = info.Get( "rate" );
 	if ( strlen( val ) != 0 )
 	{
 		cl->rate = Clamp( Q_atoi( val ), 100, 15000 );
@@ -945,11 +800,13 @@ void SV_UserinfoChanged( client_t *cl )
 	}
 
 	// msg command
-	val = Info_ValueForKey( cl->userinfo, "msg" );
+	val = info.Get( "msg" );
 	if ( strlen( val ) != 0 )
 	{
 		cl->messagelevel = Q_atoi( val );
 	}
+
+	svs.statusSequence++;
 }
 
 //=================================================================================================
@@ -988,13 +845,22 @@ void SV_Init()
 	allow_download_models = Cvar_Get( "allow_download_models", "1", CVAR_ARCHIVE );
 	allow_download_sounds = Cvar_Get( "allow_download_sounds", "1", CVAR_ARCHIVE );
 	allow_download_maps = Cvar_Get( "allow_download_maps", "1", CVAR_ARCHIVE );
+	sv_downloadRate = Cvar_Get( "sv_downloadRate", "4096", CVAR_ARCHIVE, "Most KB/s a single client's download is sent at." );
+	sv_downloadWindow = Cvar_Get( "sv_downloadWindow", "64", CVAR_ARCHIVE, "Download fragments in flight per client, 0 = old style downloads through the netchan." );
+
+	sv_demoKeyframe = Cvar_Get( "sv_demoKeyframe", "10", CVAR_ARCHIVE, "Seconds between keyframes in server demos, seeking lands on one." );
 
 	sv_noreload = Cvar_Get( "sv_noreload", "0", 0 );
 
+	sv_instances = Cvar_Get( "sv_instances", "1", CVAR_INIT, "Independent servers a dedicated server runs once its first map is loaded, each on the next port up." );
+	Cvar_Get( "sv_instance", "0", CVAR_SERVERINFO | CVAR_INIT, "Which of the sv_instances this server is." );
+
 	public_server = Cvar_Get( "public", "0", 0 );
 
 	sv_reconnect_limit = Cvar_Get( "sv_reconnect_limit", "3", CVAR_ARCHIVE );
 
+	SV_InitQueries();
+
 	SZ_Init( &net_message, net_message_buffer, sizeof( net_message_buffer ) );
 }
 
@@ -1062,22 +928,23 @@ void SV_Shutdown( const char *finalmsg, bool reconnect )
 	SV_ShutdownGameProgs();
 
 	// free current level
-	if ( sv.demofile ) {
-		FileSystem::CloseFile( sv.demofile );
-	}
+	SV_EndDemoPlayback();
 	memset( &sv, 0, sizeof( sv ) );
 	Com_SetServerState( sv.state );
 
 	// free server static data
-	if ( svs.clients ) {
+	if ( svs.clients )
+	{
+		for ( int i = 0; i < maxclients->GetInt(); ++i )
+		{
+			SV_EndDownload( &svs.clients[i] );
+		}
 		Mem_Free( svs.clients );
 	}
 	if ( svs.client_entities ) {
 		Mem_Free( svs.client_entities );
 	}
-	if ( svs.demofile ) {
-		FileSystem::CloseFile( svs.demofile );
-	}
+	SV_EndDemoRecording();
 	memset( &svs, 0, sizeof( svs ) );
 }
 
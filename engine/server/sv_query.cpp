@@ -0,0 +1,537 @@
+/*
+===================================================================================================
+
+	Connectionless queries
+
+	ping, info, status and getchallenge can come from anyone, a server browser refresh or a
+	flood with spoofed source addresses can send thousands of them a second. Every source
+	address gets a token bucket in a small open addressed table, and there's one more bucket for
+	all of them together, anything over its rate is dropped without an answer.
+
+	The answers are kept as finished packets. They're rebuilt at the end of a server frame when
+	something in them changed and someone has asked for them since the last time, so answering
+	a query is a table lookup and one NET_SendPacket, it doesn't read anything from the game.
+	Only the first query after the server has been left alone for a while builds them itself.
+
+===================================================================================================
+*/
+
+#include "sv_local.h"
+
+#define QUERY_BUCKETS		4096		// power of two
+#define QUERY_PROBES		8			// slots looked at before the stalest one is taken
+#define CHALLENGE_PROBES	8
+
+static_assert( ( MAX_CHALLENGES & ( MAX_CHALLENGES - 1 ) ) == 0 );
+
+extern cvar_t *hostname;
+
+static cvar_t *sv_queryRate;
+static cvar_t *sv_queryBurst;
+static cvar_t *sv_queryGlobalRate;
+
+struct queryBucket_t
+{
+	uint32		ip;					// 0 is a free slot
+	int			time;				// when the tokens were last topped up
+	float		tokens;
+};
+
+struct queryPacket_t
+{
+	byte		data[MAX_MSGLEN];
+	int			length;
+};
+
+struct queryCache_t
+{
+	// what the replies were built from
+	uint32		infoSequence;
+	uint32		statusSequence;
+	int			spawncount;
+	int			framenum;
+	bool		valid;
+	bool		wanted;				// asked for since the last rebuild
+
+	char		status[MAX_MSGLEN - 16];
+	queryPacket_t	statusPacket;
+	queryPacket_t	infoPackets[2];	// wrong protocol version, right version
+};
+
+struct queryStats_t
+{
+	uint64		served;
+	uint64		cached;				// served with a packet built before the query came in
+	uint64		dropped;			// over the rate for the address
+	uint64		droppedGlobal;		// over the rate for everyone
+	uint64		challenges;
+	uint64		rebuilds;
+};
+
+static queryBucket_t	s_buckets[QUERY_BUCKETS];
+static queryBucket_t	s_globalBucket;
+static queryCache_t		s_queryCache;
+static queryStats_t		s_queryStats;
+
+/*
+===================================================================================================
+
+	Rate limits
+
+===================================================================================================
+*/
+
+static uint32 SV_HashAddress( uint32 ip )
+{
+	return ( ip * 2654435769u ) >> 16;
+}
+
+/*
+========================
+SV_TakeToken
+
+Tops the bucket up for the time since it was last used and takes a token if there is one
+========================
+*/
+static bool SV_TakeToken( queryBucket_t &bucket, float rate, float burst, int now )
+{
+	if ( bucket.time != now )
+	{
+		bucket.tokens = Min( burst, bucket.tokens + (float)( now - bucket.time ) * rate * 0.001f );
+		bucket.time = now;
+	}
+
+	if ( bucket.tokens < 1.0f ) {
+		return false;
+	}
+
+	bucket.tokens -= 1.0f;
+	return true;
+}
+
+/*
+========================
+SV_AddressBucket
+
+An address that isn't in the table takes a free slot near its hash, or the one that was used
+longest ago. Whatever was there would have been full again by now, or close to it
+========================
+*/
+static queryBucket_t *SV_AddressBucket( uint32 ip, float burst, int now )
+{
+	const uint32 start = SV_HashAddress( ip );
+
+	queryBucket_t *stalest = nullptr;
+
+	for ( uint32 i = 0; i < QUERY_PROBES; ++i )
+	{
+		queryBucket_t *bucket = &s_buckets[( start + i ) & ( QUERY_BUCKETS - 1 )];
+
+		if ( bucket->ip == ip ) {
+			return bucket;
+		}
+		if ( !stalest || bucket->ip == 0 || ( stalest->ip != 0 && bucket->time < stalest->time ) )
+		{
+			stalest = bucket;
+		}
+	}
+
+	stalest->ip = ip;
+	stalest->time = now;
+	stalest->tokens = burst;
+
+	return stalest;
+}
+
+/*
+========================
+SV_QueryAllowed
+========================
+*/
+bool SV_QueryAllowed( const netadr_t &adr )
+{
+	if ( NET_IsLocalAddress( adr ) || adr.type != NA_IP ) {
+		return true;
+	}
+
+	const int now = curtime;
+
+	const float rate = sv_queryRate->GetFloat();
+	if ( rate > 0.0f )
+	{
+		const float burst = Max( sv_queryBurst->GetFloat(), 1.0f );
+		if ( !SV_TakeToken( *SV_AddressBucket( adr.ip.ui, burst, now ), rate, burst, now ) )
+		{
+			s_queryStats.dropped++;
+			return false;
+		}
+	}
+
+	// the total is what gets reflected at a spoofed address, keep it to a second's worth
+	const float globalRate = sv_queryGlobalRate->GetFloat();
+	if ( globalRate > 0.0f && !SV_TakeToken( s_globalBucket, globalRate, globalRate, now ) )
+	{
+		s_queryStats.droppedGlobal++;
+		return false;
+	}
+
+	return true;
+}
+
+/*
+===================================================================================================
+
+	Replies
+
+===================================================================================================
+*/
+
+static void SV_BuildPacket( queryPacket_t &packet, _Printf_format_string_ const char *format, ... )
+{
+	va_list argptr;
+
+	// -1 sequence means out of band
+	*(int32 *)packet.data = -1;
+
+	va_start( argptr, format );
+	const int length = Q_vsprintf_s( (char *)packet.data + 4, sizeof( packet.data ) - 4, format, argptr );
+	va_end( argptr );
+
+	packet.length = 4 + Min( length, (int)sizeof( packet.data ) - 5 );
+}
+
+/*
+========================
+SV_BuildStatusString
+
+The string sent as heartbeats and status replies
+========================
+*/
+static void SV_BuildStatusString( char *status, strlen_t statusSize )
+{
+	char			player[1024];
+	int				i;
+	client_t *		cl;
+	strlen_t		statusLength;
+	strlen_t		playerLength;
+
+	statusLength = Q_sprintf_s( status, statusSize, "%s\n", Cvar_Serverinfo() );
+
+	for ( i = 0; i < maxclients->GetInt(); i++ )
+	{
+		cl = &svs.clients[i];
+		if ( cl->state == cs_connected || cl->state == cs_spawned )
+		{
+			playerLength = Q_sprintf_s( player, "%i %i \"%s\"\n",
+				cl->edict->client->ps.stats[STAT_FRAGS], cl->ping, cl->name );
+			if ( statusLength + playerLength >= statusSize ) {
+				// can't hold any more
+				break;
+			}
+			strcpy( status + statusLength, player );
+			statusLength += playerLength;
+		}
+	}
+}
+
+/*
+========================
+SV_QueryCacheCurrent
+
+The replies only change when the serverinfo, a configstring, a client's userinfo or the set
+of connected clients changes, or when a frame runs and moves the frags and pings
+========================
+*/
+static bool SV_QueryCacheCurrent()
+{
+	const queryCache_t &cache = s_queryCache;
+
+	return cache.valid
+		&& cache.infoSequence == Cvar_InfoSequence()
+		&& cache.statusSequence == svs.statusSequence
+		&& cache.spawncount == svs.spawncount
+		&& cache.framenum == sv.framenum;
+}
+
+/*
+========================
+SV_BuildQueryCache
+========================
+*/
+static void SV_BuildQueryCache()
+{
+	queryCache_t &cache = s_queryCache;
+
+	SV_BuildStatusString( cache.status, sizeof( cache.status ) );
+	SV_BuildPacket( cache.statusPacket, "print\n%s", cache.status );
+
+	int count = 0;
+	for ( int i = 0; i < maxclients->GetInt(); i++ )
+	{
+		if ( svs.clients[i].state >= cs_connected ) {
+			count++;
+		}
+	}
+
+	SV_BuildPacket( cache.infoPackets[0], "info\n%s: wrong version\n", hostname->GetString() );
+	SV_BuildPacket( cache.infoPackets[1], "info\n%16s %8s %2i/%2i\n", hostname->GetString(), sv.name, count, maxclients->GetInt() );
+
+	cache.infoSequence = Cvar_InfoSequence();
+	cache.statusSequence = svs.statusSequence;
+	cache.spawncount = svs.spawncount;
+	cache.framenum = sv.framenum;
+	cache.valid = true;
+
+	s_queryStats.rebuilds++;
+}
+
+/*
+========================
+SV_StatusString
+
+Builds the string that is sent as heartbeats and status replies
+========================
+*/
+char *SV_StatusString()
+{
+	if ( !SV_QueryCacheCurrent() ) {
+		SV_BuildQueryCache();
+	}
+
+	return s_queryCache.status;
+}
+
+/*
+========================
+SV_UpdateQueryPackets
+
+Called at the end of every server frame
+========================
+*/
+void SV_UpdateQueryPackets()
+{
+	if ( !s_queryCache.wanted ) {
+		return;
+	}
+
+	s_queryCache.wanted = false;
+
+	if ( !SV_QueryCacheCurrent() ) {
+		SV_BuildQueryCache();
+	}
+}
+
+/*
+========================
+SV_SendCachedPacket
+
+Anything built at the end of the last frame is good enough to answer with, older than that and
+it's rebuilt first
+========================
+*/
+static void SV_SendCachedPacket( const queryPacket_t &packet )
+{
+	queryCache_t &cache = s_queryCache;
+
+	if ( cache.valid && cache.spawncount == svs.spawncount && sv.framenum - cache.framenum <= 1 ) {
+		s_queryStats.cached++;
+	}
+	else {
+		SV_BuildQueryCache();
+	}
+
+	cache.wanted = true;
+	s_queryStats.served++;
+
+	NET_SendPacket( NS_SERVER, packet.length, packet.data, net_from );
+}
+
+/*
+===================================================================================================
+
+	Challenges
+
+===================================================================================================
+*/
+
+/*
+========================
+SV_FindChallenge
+
+Challenges are kept near the hash of their address instead of anywhere in the table
+========================
+*/
+const challenge_t *SV_FindChallenge( const netadr_t &adr )
+{
+	const uint32 start = SV_HashAddress( adr.ip.ui );
+
+	for ( uint32 i = 0; i < CHALLENGE_PROBES; ++i )
+	{
+		const challenge_t *challenge = &svs.challenges[( start + i ) & ( MAX_CHALLENGES - 1 )];
+		if ( NET_CompareBaseNetadr( adr, challenge->adr ) ) {
+			return challenge;
+		}
+	}
+
+	return nullptr;
+}
+
+/*
+========================
+SVC_GetChallenge
+
+Returns a challenge number that can be used
+in a subsequent client_connect command.
+We do this to prevent denial of service attacks that
+flood the server with invalid connection IPs.  With a
+challenge, they must give a valid IP address.
+========================
+*/
+static void SVC_GetChallenge()
+{
+	char		string[32];
+	challenge_t	*oldest = nullptr;
+
+	const uint32 start = SV_HashAddress( net_from.ip.ui );
+
+	// see if we already have a challenge for this ip
+	for ( uint32 i = 0; i < CHALLENGE_PROBES; ++i )
+	{
+		challenge_t *challenge = &svs.challenges[( start + i ) & ( MAX_CHALLENGES - 1 )];
+		if ( NET_CompareBaseNetadr( net_from, challenge->adr ) )
+		{
+			oldest = challenge;
+			break;
+		}
+		if ( !oldest || challenge->time < oldest->time ) {
+			oldest = challenge;
+		}
+	}
+
+	if ( !NET_CompareBaseNetadr( net_from, oldest->adr ) )
+	{
+		// overwrite the oldest
+		oldest->challenge = rand() & 0x7fff;
+		oldest->adr = net_from;
+		oldest->time = curtime;
+	}
+
+	s_queryStats.challenges++;
+	s_queryStats.served++;
+
+	// send it back
+	*(int32 *)string = -1;
+	const int length = Q_sprintf_s( string + 4, sizeof( string ) - 4, "challenge %i", oldest->challenge );
+	NET_SendPacket( NS_SERVER, 4 + length, string, net_from );
+}
+
+/*
+===================================================================================================
+
+	Dispatch
+
+===================================================================================================
+*/
+
+/*
+========================
+SV_QueryPacket
+
+Returns true if the command was a query, answered or dropped
+========================
+*/
+bool SV_QueryPacket( const char *command )
+{
+	enum { QUERY_PING, QUERY_INFO, QUERY_STATUS, QUERY_CHALLENGE };
+
+	int query;
+	if ( Q_strcmp( command, "ping" ) == 0 ) {
+		query = QUERY_PING;
+	}
+	else if ( Q_strcmp( command, "info" ) == 0 ) {
+		query = QUERY_INFO;
+	}
+	else if ( Q_strcmp( command, "status" ) == 0 ) {
+		query = QUERY_STATUS;
+	}
+	else if ( Q_strcmp( command, "getchallenge" ) == 0 ) {
+		query = QUERY_CHALLENGE;
+	}
+	else {
+		return false;
+	}
+
+	if ( !SV_QueryAllowed( net_from ) ) {
+		return true;
+	}
+
+	switch ( query )
+	{
+	case QUERY_PING:
+	{
+		// just responds with an acknowledgement
+		static const byte ack[] = { 0xff, 0xff, 0xff, 0xff, 'a', 'c', 'k' };
+		NET_SendPacket( NS_SERVER, sizeof( ack ), ack, net_from );
+		s_queryStats.served++;
+		break;
+	}
+	case QUERY_INFO:
+		// short info for broadcast scans, ignored in single player
+		if ( maxclients->GetInt() != 1 )
+		{
+			const int version = Q_atoi( Cmd_Argv( 1 ) );
+			SV_SendCachedPacket( s_queryCache.infoPackets[version == PROTOCOL_VERSION] );
+		}
+		break;
+	case QUERY_STATUS:
+		// all the info that qplug or qspy can see
+		SV_SendCachedPacket( s_queryCache.statusPacket );
+		break;
+	case QUERY_CHALLENGE:
+		SVC_GetChallenge();
+		break;
+	}
+
+	return true;
+}
+
+/*
+========================
+SV_QueryStats_f
+========================
+*/
+static void SV_QueryStats_f()
+{
+	int buckets = 0;
+	for ( int i = 0; i < QUERY_BUCKETS; ++i )
+	{
+		if ( s_buckets[i].ip ) {
+			++buckets;
+		}
+	}
+
+	Com_Printf( "%llu queries served, %llu from cached replies, %llu replies rebuilt\n",
+		s_queryStats.served, s_queryStats.cached, s_queryStats.rebuilds );
+	Com_Printf( "%llu dropped over the address rate, %llu over the total rate\n",
+		s_queryStats.dropped, s_queryStats.droppedGlobal );
+	Com_Printf( "%llu challenges handed out, %d/%d addresses tracked\n",
+		s_queryStats.challenges, buckets, QUERY_BUCKETS );
+
+	if ( Cmd_Argc() > 1 && Q_strcmp( Cmd_Argv( 1 ), "reset" ) == 0 ) {
+		s_queryStats = {};
+	}
+}
+
+/*
+========================
+SV_InitQueries
+========================
+*/
+void SV_InitQueries()
+{
+	sv_queryRate = Cvar_Get( "sv_queryRate", "4", 0, "Connectionless queries a second answered for one address, 0 = no limit." );
+	sv_queryBurst = Cvar_Get( "sv_queryBurst", "10", 0, "Connectionless queries one address can send at once before sv_queryRate applies." );
+	sv_queryGlobalRate = Cvar_Get( "sv_queryGlobalRate", "500", 0, "Connectionless queries a second answered in total, 0 = no limit." );
+
+	Cmd_AddCommand( "sv_queryStats", SV_QueryStats_f, "Prints connectionless query counters, \"reset\" clears them." );
+}
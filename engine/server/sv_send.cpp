@@ -138,6 +138,11 @@ void SV_Multicast( vec3_t origin, multicast_t to )
 
 	reliable = false;
 
+	// anything a reliable message refers to has to get there first
+	if ( to == MULTICAST_ALL_R || to == MULTICAST_PHS_R || to == MULTICAST_PVS_R ) {
+		SV_FlushConfigstrings();
+	}
+
 	if ( to != MULTICAST_ALL_R && to != MULTICAST_ALL )
 	{
 		leafnum = CM_PointLeafnum( origin );
@@ -150,7 +155,7 @@ void SV_Multicast( vec3_t origin, multicast_t to )
 	}
 
 	// if doing a serverrecord, store everything
-	if ( svs.demofile ) {
+	if ( SV_DemoRecording() ) {
 		SZ_Write( &svs.demo_multicast, sv.multicast.data, sv.multicast.cursize );
 	}
 
@@ -426,11 +431,7 @@ SV_DemoCompleted
 */
 static void SV_DemoCompleted()
 {
-	if ( sv.demofile )
-	{
-		FileSystem::CloseFile( sv.demofile );
-		sv.demofile = nullptr;
-	}
+	SV_EndDemoPlayback();
 	SV_Nextserver();
 }
 
@@ -480,12 +481,11 @@ void SV_SendClientMessages()
 	client_t *	c;
 	int			msglen;
 	byte		msgbuf[MAX_MSGLEN];
-	int			r;
 
 	msglen = 0;
 
 	// read the next demo message if needed
-	if ( sv.state == ss_demo && sv.demofile )
+	if ( sv.state == ss_demo && SV_DemoPlaying() )
 	{
 		if ( sv_paused->GetBool() )
 		{
@@ -494,27 +494,12 @@ void SV_SendClientMessages()
 		else
 		{
 			// get the next message
-			r = FileSystem::ReadFile( &msglen, sizeof( msglen ), sv.demofile );
-			if ( r != 1 )
-			{
-				SV_DemoCompleted();
-				return;
-			}
-			msglen = LittleLong( msglen );
+			msglen = SV_ReadDemoMessage( msgbuf, sizeof( msgbuf ) );
 			if ( msglen == -1 )
 			{
 				SV_DemoCompleted();
 				return;
 			}
-			if ( msglen > MAX_MSGLEN ) {
-				Com_Error( "SV_SendClientMessages: msglen > MAX_MSGLEN" );
-			}
-			r = FileSystem::ReadFile( msgbuf, msglen, sv.demofile );
-			if ( r != 1 )
-			{
-				SV_DemoCompleted();
-				return;
-			}
 		}
 	}
 
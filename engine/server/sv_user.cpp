@@ -24,8 +24,7 @@ static void SV_BeginDemoserver()
 	char name[MAX_OSPATH];
 
 	Q_sprintf_s( name, "demos/%s", sv.name );
-	sv.demofile = FileSystem::OpenFileRead( name );
-	if ( !sv.demofile )
+	if ( !SV_BeginDemoPlayback( name ) )
 	{
 		Com_Errorf( "Couldn't open %s\n", name );
 	}
@@ -241,6 +240,190 @@ static void SV_Begin_f()
 
 //=================================================================================================
 
+/*
+===================================================================================================
+
+	Downloads
+
+	Files are loaded once and shared by every client downloading them, when the table of shared
+	files is full a client gets a copy of its own like it used to. Clients that ask for it
+	get the file as bulk fragments outside the netchan, older ones get svc_download messages a
+	kilobyte at a time.
+
+===================================================================================================
+*/
+
+#define	MAX_SHARED_DOWNLOADS	16
+#define	DOWNLOAD_TIMEOUT		15000		// msec without an ack before a bulk download is dropped
+#define	MAX_FRAGMENTS_PER_FRAME	256
+
+struct sharedDownload_t
+{
+	char	name[MAX_QPATH];
+	byte	*data;
+	int		size;
+	int		refCount;
+};
+
+static sharedDownload_t	s_sharedDownloads[MAX_SHARED_DOWNLOADS];
+static int				s_nextDownloadId;
+
+/*
+========================
+SV_AcquireDownload
+
+Returns the shared copy of a file, loading it if no one else has it, null on failure.
+Copies that don't fit in the table aren't shared, SV_ReleaseDownload frees them.
+========================
+*/
+static const byte *SV_AcquireDownload( const char *name, int *size )
+{
+	sharedDownload_t *free = nullptr;
+
+	for ( sharedDownload_t &download : s_sharedDownloads )
+	{
+		if ( download.refCount && Q_strcmp( download.name, name ) == 0 )
+		{
+			++download.refCount;
+			*size = download.size;
+			return download.data;
+		}
+		if ( !download.refCount && !free ) {
+			free = &download;
+		}
+	}
+
+	byte *data;
+	const fsSize_t length = FileSystem::LoadFile( name, (void **)&data );
+	if ( !data ) {
+		return nullptr;
+	}
+
+	if ( !free || strlen( name ) >= sizeof( free->name ) )
+	{
+		Com_DPrintf( "No room to share %s, sending a private copy\n", name );
+		*size = static_cast<int>( length );
+		return data;
+	}
+
+	Q_strcpy_s( free->name, name );
+	free->data = data;
+	free->size = static_cast<int>( length );
+	free->refCount = 1;
+
+	*size = free->size;
+	return free->data;
+}
+
+static void SV_ReleaseDownload( const byte *data )
+{
+	for ( sharedDownload_t &download : s_sharedDownloads )
+	{
+		if ( download.refCount && download.data == data )
+		{
+			if ( --download.refCount == 0 )
+			{
+				FileSystem::FreeFile( download.data );
+				download.data = nullptr;
+				download.name[0] = '\0';
+			}
+			return;
+		}
+	}
+
+	// a private copy
+	FileSystem::FreeFile( const_cast<byte *>( data ) );
+}
+
+/*
+========================
+SV_EndDownload
+========================
+*/
+void SV_EndDownload( client_t *cl )
+{
+	if ( cl->download ) {
+		SV_ReleaseDownload( cl->download );
+	}
+
+	cl->download = nullptr;
+	cl->downloadBulk = false;
+}
+
+/*
+========================
+SV_BulkPacket
+
+An ack for a bulk download
+========================
+*/
+void SV_BulkPacket()
+{
+	MSG_BeginReading( &net_message );
+	MSG_ReadLong( &net_message );		// BULK_HEADER
+	if ( MSG_ReadByte( &net_message ) != bulk_ack ) {
+		return;
+	}
+	const int qport = MSG_ReadShort( &net_message ) & 0xffff;
+
+	client_t *cl = svs.clients;
+	for ( int i = 0; i < maxclients->GetInt(); i++, cl++ )
+	{
+		if ( cl->state == cs_free || !cl->downloadBulk ) {
+			continue;
+		}
+		if ( !NET_CompareBaseNetadr( net_from, cl->netchan.remote_address ) || cl->netchan.qport != qport ) {
+			continue;
+		}
+
+		Bulk_ReadAck( &cl->bulk, &net_message, svs.realtime );
+		return;
+	}
+}
+
+/*
+========================
+SV_SendDownloads
+
+Sends whatever bulk fragments the clients' windows and rates allow
+========================
+*/
+void SV_SendDownloads()
+{
+	byte		buffer[BULK_FRAGMENT_SIZE + 32];
+	sizebuf_t	msg;
+
+	client_t *cl = svs.clients;
+	for ( int i = 0; i < maxclients->GetInt(); i++, cl++ )
+	{
+		if ( !cl->downloadBulk ) {
+			continue;
+		}
+
+		if ( cl->state < cs_connected || Bulk_SendComplete( &cl->bulk ) )
+		{
+			SV_EndDownload( cl );
+			continue;
+		}
+
+		if ( svs.realtime - cl->bulk.lastAckTime > DOWNLOAD_TIMEOUT )
+		{
+			Com_DPrintf( "Download to %s timed out\n", cl->name );
+			SV_EndDownload( cl );
+			continue;
+		}
+
+		for ( int sent = 0; sent < MAX_FRAGMENTS_PER_FRAME; ++sent )
+		{
+			SZ_Init( &msg, buffer, sizeof( buffer ) );
+			if ( !Bulk_WriteFragment( &cl->bulk, &msg, svs.realtime ) ) {
+				break;
+			}
+			NET_SendPacket( NS_SERVER, msg.cursize, msg.data, cl->netchan.remote_address );
+		}
+	}
+}
+
 /*
 ========================
 SV_NextDownload_f
@@ -252,7 +435,7 @@ static void SV_NextDownload_f()
 	int percent;
 	int size;
 
-	if ( !sv_client->download ) {
+	if ( !sv_client->download || sv_client->downloadBulk ) {
 		return;
 	}
 
@@ -278,13 +461,14 @@ static void SV_NextDownload_f()
 		return;
 	}
 
-	FileSystem::FreeFile( sv_client->download );
-	sv_client->download = NULL;
+	SV_EndDownload( sv_client );
 }
 
 /*
 ==================
 SV_BeginDownload_f
+
+download <name> [offset] [bulk rate in KB/s]
 ==================
 */
 static void SV_BeginDownload_f()
@@ -294,6 +478,8 @@ static void SV_BeginDownload_f()
 	extern cvar_t *allow_download_models;
 	extern cvar_t *allow_download_sounds;
 	extern cvar_t *allow_download_maps;
+	extern cvar_t *sv_downloadRate;
+	extern cvar_t *sv_downloadWindow;
 
 	char *name;
 	int offset = 0;
@@ -329,24 +515,18 @@ static void SV_BeginDownload_f()
 		return;
 	}
 
-	if ( sv_client->download ) {
-		FileSystem::FreeFile( sv_client->download );
-	}
+	SV_EndDownload( sv_client );
 
-	sv_client->downloadsize = FileSystem::LoadFile( name, (void **)&sv_client->download );
+	sv_client->download = SV_AcquireDownload( name, &sv_client->downloadsize );
 	sv_client->downloadcount = offset;
 
-	if ( offset > sv_client->downloadsize ) {
+	if ( offset > sv_client->downloadsize || offset < 0 ) {
 		sv_client->downloadcount = sv_client->downloadsize;
 	}
 
 	if ( !sv_client->download )
 	{
 		Com_DPrintf( "Couldn't download %s to %s\n", name, sv_client->name );
-		if ( sv_client->download ) {
-			FileSystem::FreeFile( sv_client->download );
-			sv_client->download = NULL;
-		}
 
 		MSG_WriteByte( &sv_client->netchan.message, svc_download );
 		MSG_WriteShort( &sv_client->netchan.message, -1 );
@@ -354,6 +534,24 @@ static void SV_BeginDownload_f()
 		return;
 	}
 
+	if ( Cmd_Argc() > 3 && sv_downloadWindow->GetInt() > 0 )
+	{
+		const int rate = Min( Q_atoi( Cmd_Argv( 3 ) ), sv_downloadRate->GetInt() ) * 1024;
+		const int id = ++s_nextDownloadId;
+
+		sv_client->downloadBulk = true;
+		Bulk_BeginSend( &sv_client->bulk, id, sv_client->download, sv_client->downloadsize,
+			sv_client->downloadcount, sv_downloadWindow->GetInt(), rate, svs.realtime );
+
+		MSG_WriteByte( &sv_client->netchan.message, svc_bulkdownload );
+		MSG_WriteLong( &sv_client->netchan.message, id );
+		MSG_WriteLong( &sv_client->netchan.message, sv_client->downloadsize );
+		MSG_WriteLong( &sv_client->netchan.message, sv_client->downloadcount );
+
+		Com_DPrintf( "Downloading %s to %s at up to %d KB/s\n", name, sv_client->name, rate / 1024 );
+		return;
+	}
+
 	SV_NextDownload_f();
 	Com_DPrintf( "Downloading %s to %s\n", name, sv_client->name );
 }
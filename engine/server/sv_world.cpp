@@ -2,6 +2,8 @@
 
 #include "sv_local.h"
 
+#include <mutex>
+
 /*
 ===================================================================================================
 
@@ -34,6 +36,10 @@ struct worldSector_t
 static worldSector_t	sv_worldSectors[AREA_NODES];
 static int				sv_numWorldSectors;
 
+// Traces can come from the game's job workers, they're fine apart from the box hull which is
+// shared, so clipping against a bounding box takes turns
+static std::mutex		sv_boxHullMutex;
+
 //===============================================
 
 // ClearLink is used for new headnodes
@@ -553,6 +559,11 @@ int SV_PointContents( vec3_t p )
 	{
 		hit = touch[i];
 
+		std::unique_lock<std::mutex> boxHullLock( sv_boxHullMutex, std::defer_lock );
+		if ( hit->solid != SOLID_BSP ) {
+			boxHullLock.lock();
+		}
+
 		// might intersect, so do an exact clip
 		headnode = SV_HullForEntity( hit );
 		angles = hit->s.angles;
@@ -621,6 +632,11 @@ static void SV_ClipMoveToEntities( moveclip_t &clip )
 		}
 		else
 		{
+			std::unique_lock<std::mutex> boxHullLock( sv_boxHullMutex, std::defer_lock );
+			if ( touch->solid != SOLID_BSP ) {
+				boxHullLock.lock();
+			}
+
 			// might intersect, so do an exact clip
 			int headnode = SV_HullForEntity( touch );
 			float *angles = touch->s.angles;
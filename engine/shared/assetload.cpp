@@ -0,0 +1,282 @@
+/*
+===================================================================================================
+
+	Asset loading
+
+	Registration used to read and decode every model, image and sound one after another on the
+	main thread, but only the GL uploads and the model setup actually need to be there. The
+	loaders now read and decode on the job pool in batches of ASSET_BATCH_SIZE and hand the
+	results back to the main thread to finish, which keeps the memory held by decoded assets
+	bounded. Model files are prefetched here since their names are known up front.
+
+	Every asset that's loaded records how long it spent being read, decoded and finished, the
+	report afterwards shows where a level load went.
+
+===================================================================================================
+*/
+
+#include "engine.h"
+
+#include "assetload.h"
+
+#include <algorithm>
+
+static cvar_t *com_asyncLoad;
+static cvar_t *com_loadReport;
+
+struct assetTiming_t
+{
+	char			name[MAX_QPATH];
+	assetType_t		type;
+	int64			readTime;
+	int64			decodeTime;
+	int64			finishTime;
+};
+
+struct prefetchedFile_t
+{
+	char			name[MAX_QPATH];
+	void *			buffer;
+	fsSize_t		length;
+	int64			readTime;
+};
+
+static std::vector<assetTiming_t>		s_timings;
+static std::vector<prefetchedFile_t>	s_prefetched;
+static int64							s_loadStart;
+
+static const char *s_typeNames[ASSET_NUM_TYPES]
+{
+	"models",
+	"images",
+	"sounds"
+};
+
+/*
+========================
+Asset_Parallel
+========================
+*/
+bool Asset_Parallel()
+{
+	return com_asyncLoad->GetBool() && Jobs::NumWorkers() > 0;
+}
+
+/*
+===================================================================================================
+
+	Prefetching
+
+===================================================================================================
+*/
+
+static void Asset_PrefetchJob( void *params, uint32 index )
+{
+	prefetchedFile_t &file = static_cast<prefetchedFile_t *>( params )[index];
+
+	const int64 start = Time_Microseconds();
+	file.length = FileSystem::LoadFile( file.name, &file.buffer );
+	file.readTime = Time_Microseconds() - start;
+}
+
+/*
+========================
+Asset_Prefetch
+========================
+*/
+void Asset_Prefetch( const char **names, uint32 count )
+{
+	if ( !Asset_Parallel() || count == 0 ) {
+		return;
+	}
+
+	const size_t first = s_prefetched.size();
+	s_prefetched.resize( first + count );
+
+	for ( uint32 i = 0; i < count; ++i )
+	{
+		prefetchedFile_t &file = s_prefetched[first + i];
+		Q_strcpy_s( file.name, names[i] );
+		file.buffer = nullptr;
+		file.length = 0;
+	}
+
+	Jobs::ParallelFor( count, Asset_PrefetchJob, s_prefetched.data() + first );
+}
+
+/*
+========================
+Asset_LoadFile
+========================
+*/
+fsSize_t Asset_LoadFile( const char *name, void **buffer, int64 *readTime )
+{
+	for ( auto it = s_prefetched.begin(); it != s_prefetched.end(); ++it )
+	{
+		if ( Q_strcmp( it->name, name ) != 0 ) {
+			continue;
+		}
+
+		*buffer = it->buffer;
+		const fsSize_t length = it->length;
+		if ( readTime ) {
+			*readTime = it->readTime;
+		}
+		s_prefetched.erase( it );
+		return length;
+	}
+
+	const int64 start = Time_Microseconds();
+	const fsSize_t length = FileSystem::LoadFile( name, buffer );
+	if ( readTime ) {
+		*readTime = Time_Microseconds() - start;
+	}
+	return length;
+}
+
+static void Asset_ClearPrefetched()
+{
+	for ( prefetchedFile_t &file : s_prefetched )
+	{
+		if ( file.buffer ) {
+			FileSystem::FreeFile( file.buffer );
+		}
+	}
+	s_prefetched.clear();
+}
+
+/*
+===================================================================================================
+
+	Timing
+
+===================================================================================================
+*/
+
+/*
+========================
+Asset_Record
+========================
+*/
+void Asset_Record( assetType_t type, const char *name, int64 readTime, int64 decodeTime, int64 finishTime )
+{
+	assetTiming_t &timing = s_timings.emplace_back();
+
+	Q_strcpy_s( timing.name, name );
+	timing.type = type;
+	timing.readTime = readTime;
+	timing.decodeTime = decodeTime;
+	timing.finishTime = finishTime;
+}
+
+static void Asset_Report()
+{
+	const double wallTime = ( Time_Microseconds() - s_loadStart ) * 0.001;
+
+	Com_Printf( "Loaded %d assets in %.1f ms (%s, %u workers)\n", static_cast<int>( s_timings.size() ), wallTime,
+		Asset_Parallel() ? "parallel" : "serial", Jobs::NumWorkers() );
+
+	Com_Printf( "%-8s %6s %10s %10s %10s\n", "", "count", "read ms", "decode ms", "finish ms" );
+	for ( int type = 0; type < ASSET_NUM_TYPES; ++type )
+	{
+		int count = 0;
+		int64 read = 0, decode = 0, finish = 0;
+		for ( const assetTiming_t &timing : s_timings )
+		{
+			if ( timing.type != type ) {
+				continue;
+			}
+			++count;
+			read += timing.readTime;
+			decode += timing.decodeTime;
+			finish += timing.finishTime;
+		}
+
+		Com_Printf( "%-8s %6d %10.1f %10.1f %10.1f\n", s_typeNames[type], count, read * 0.001, decode * 0.001, finish * 0.001 );
+	}
+
+	// the worst offenders
+	std::vector<const assetTiming_t *> sorted;
+	sorted.reserve( s_timings.size() );
+	for ( const assetTiming_t &timing : s_timings )
+	{
+		sorted.push_back( &timing );
+	}
+
+	const size_t numShown = Min<size_t>( sorted.size(), 10 );
+	std::partial_sort( sorted.begin(), sorted.begin() + numShown, sorted.end(), []( const assetTiming_t *a, const assetTiming_t *b )
+	{
+		return a->readTime + a->decodeTime + a->finishTime > b->readTime + b->decodeTime + b->finishTime;
+	} );
+
+	for ( size_t i = 0; i < numShown; ++i )
+	{
+		const assetTiming_t *timing = sorted[i];
+		Com_Printf( "%8.2f ms  %-6s  %s\n", ( timing->readTime + timing->decodeTime + timing->finishTime ) * 0.001,
+			s_typeNames[timing->type], timing->name );
+	}
+}
+
+/*
+========================
+Asset_BeginLoad
+========================
+*/
+void Asset_BeginLoad()
+{
+	Asset_ClearPrefetched();
+	s_timings.clear();
+	s_loadStart = Time_Microseconds();
+}
+
+/*
+========================
+Asset_EndLoad
+========================
+*/
+void Asset_EndLoad()
+{
+	Asset_ClearPrefetched();
+
+	if ( com_loadReport->GetBool() ) {
+		Asset_Report();
+	}
+}
+
+static void Asset_LoadReport_f()
+{
+	if ( s_timings.empty() )
+	{
+		Com_Print( "Nothing has been loaded\n" );
+		return;
+	}
+
+	Asset_Report();
+}
+
+/*
+========================
+Asset_Init
+========================
+*/
+void Asset_Init()
+{
+	com_asyncLoad = Cvar_Get( "com_asyncLoad", "1", 0, "Read and decode level assets on the job workers." );
+	com_loadReport = Cvar_Get( "com_loadReport", "0", 0, "Print how long each kind of asset took after a level loads." );
+
+	Cmd_AddCommand( "loadreport", Asset_LoadReport_f, "Prints the timings for the last level load." );
+}
+
+/*
+========================
+Asset_Shutdown
+========================
+*/
+void Asset_Shutdown()
+{
+	Asset_ClearPrefetched();
+	s_timings.clear();
+	s_timings.shrink_to_fit();
+
+	Cmd_RemoveCommand( "loadreport" );
+}
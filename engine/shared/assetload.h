@@ -0,0 +1,45 @@
+/*
+===================================================================================================
+
+	Asset loading
+
+	Helpers for loading a level's assets on the job pool, and timing them
+
+===================================================================================================
+*/
+
+#pragma once
+
+#include "../../core/sys_types.h"
+
+enum assetType_t
+{
+	ASSET_MODEL,
+	ASSET_IMAGE,
+	ASSET_SOUND,
+	ASSET_NUM_TYPES
+};
+
+// How many decoded assets are allowed to wait for the main thread at once
+inline constexpr uint32 ASSET_BATCH_SIZE = 64;
+
+void		Asset_Init();
+void		Asset_Shutdown();
+
+// False if everything should load serially on the calling thread
+bool		Asset_Parallel();
+
+// Clears the timings and any leftover prefetches
+void		Asset_BeginLoad();
+// Frees prefetched files that nobody asked for and prints the report if com_loadReport is set
+void		Asset_EndLoad();
+
+// Reads the files on the job pool, Asset_LoadFile hands them out later
+void		Asset_Prefetch( const char **names, uint32 count );
+
+// FileSystem::LoadFile that takes a prefetched copy first, free the buffer with FileSystem::FreeFile.
+// readTime is how long the read took, wherever it happened
+fsSize_t	Asset_LoadFile( const char *name, void **buffer, int64 *readTime = nullptr );
+
+// Main thread only, times are in usec
+void		Asset_Record( assetType_t type, const char *name, int64 readTime, int64 decodeTime, int64 finishTime );
@@ -38,13 +38,17 @@ struct cbrush_t
 	int			contents;
 	int			numsides;
 	int			firstbrushside;
-	int			checkcount;		// to avoid repeated testings
 };
 
 struct carea_t
 {
 	int		numareaportals;
 	int		firstareaportal;
+};
+
+// what changes about an area while the game runs
+struct careaFlood_t
+{
 	int		floodnum;			// if two areas have equal floodnums, they are connected
 	int		floodvalid;
 };
@@ -151,12 +155,17 @@ struct cmMapData_t
 	cmArray_t<carea_t>			areas;
 	cmArray_t<dareaportal_t>	areaportals;
 
+	// Everything above is left alone once the map is loaded, so processes forked from a server
+	// that has loaded it keep sharing those pages. Anything written to while the game runs
+	// lives below.
+
+	cmArray_t<careaFlood_t>		areafloods;
+
 	IPhysicsShape *				pPhysicsShape;
 
 	int			numclusters = 1;
 
 	int			floodvalid;
-	int			checkcount;
 
 	cmArray_t<bool>		portalopen;
 
@@ -178,7 +187,7 @@ struct cmMapData_t
 		areas.Forget();
 		areaportals.Forget();
 
-		checkcount = 0;
+		areafloods.Forget();
 
 		portalopen.Forget();
 	}
@@ -199,6 +208,8 @@ struct cmMapData_t
 		areas.Free();
 		areaportals.Free();
 
+		areafloods.Free();
+
 		portalopen.Free();
 	}
 };
@@ -519,6 +530,7 @@ static void CMod_LoadAreas( byte *cmod_base, lump_t *l )
 	if ( count < 1 )
 	{
 		cm.areas.Forget();
+		cm.areafloods.Forget();
 		return;
 	}
 
@@ -529,9 +541,10 @@ static void CMod_LoadAreas( byte *cmod_base, lump_t *l )
 	{
 		out->numareaportals = LittleLong( in->numareaportals );
 		out->firstareaportal = LittleLong( in->firstareaportal );
-		out->floodvalid = 0;
-		out->floodnum = 0;
 	}
+
+	cm.areafloods.PrepForNewData( count );
+	cm.areafloods.Clear();
 }
 
 /*
@@ -997,10 +1010,10 @@ CM_BoxLeafnums
 Fills in a list of all the leafs touched
 =============
 */
-int		leaf_count, leaf_maxcount;
-int		*leaf_list;
-float	*leaf_mins, *leaf_maxs;
-int		leaf_topnode;
+static thread_local int		leaf_count, leaf_maxcount;
+static thread_local int *	leaf_list;
+static thread_local float *	leaf_mins, *leaf_maxs;
+static thread_local int		leaf_topnode;
 
 void CM_BoxLeafnums_r( int nodenum )
 {
@@ -1131,13 +1144,19 @@ BOX TRACING
 
 #define NEVER_UPDATED	-99999.0f
 
-static vec3_t	trace_start, trace_end;
-static vec3_t	trace_mins, trace_maxs;
-static vec3_t	trace_extents;
+// The game can trace from its job workers, so everything a trace works with is per thread. The
+// brushes a trace has already checked are marked with its checkcount, which only ever goes up, so
+// marks left over from an earlier map can't match.
+static thread_local vec3_t	trace_start, trace_end;
+static thread_local vec3_t	trace_mins, trace_maxs;
+static thread_local vec3_t	trace_extents;
+
+static thread_local trace_t	trace_trace;
+static thread_local int		trace_contents;
+static thread_local bool	trace_ispoint;		// optimized case
 
-static trace_t	trace_trace;
-static int		trace_contents;
-static bool		trace_ispoint;		// optimized case
+static thread_local std::vector<int>	trace_brushchecks;
+static thread_local int					trace_checkcount;
 
 /*
 ================
@@ -1344,10 +1363,10 @@ void CM_TraceToLeaf (int leafnum)
 	for (k=0 ; k<leaf->numleafbrushes ; k++)
 	{
 		brushnum = cm.leafbrushes.Data(leaf->firstleafbrush+k);
-		b = &cm.brushes.Data(brushnum);
-		if (b->checkcount == cm.checkcount)
+		if (trace_brushchecks[brushnum] == trace_checkcount)
 			continue;	// already checked this brush in another leaf
-		b->checkcount = cm.checkcount;
+		trace_brushchecks[brushnum] = trace_checkcount;
+		b = &cm.brushes.Data(brushnum);
 
 		if ( !(b->contents & trace_contents))
 			continue;
@@ -1378,10 +1397,10 @@ void CM_TestInLeaf (int leafnum)
 	for (k=0 ; k<leaf->numleafbrushes ; k++)
 	{
 		brushnum = cm.leafbrushes.Data(leaf->firstleafbrush+k);
-		b = &cm.brushes.Data(brushnum);
-		if (b->checkcount == cm.checkcount)
+		if (trace_brushchecks[brushnum] == trace_checkcount)
 			continue;	// already checked this brush in another leaf
-		b->checkcount = cm.checkcount;
+		trace_brushchecks[brushnum] = trace_checkcount;
+		b = &cm.brushes.Data(brushnum);
 
 		if ( !(b->contents & trace_contents))
 			continue;
@@ -1518,7 +1537,11 @@ trace_t CM_BoxTrace (vec3_t start, vec3_t end,
 					 vec3_t mins, vec3_t maxs,
 					 int headnode, int brushmask)
 {
-	cm.checkcount++;	// for multi-check avoidance
+	// +1 for the box hull
+	if ( trace_brushchecks.size() < static_cast<size_t>( cm.brushes.Count() ) + 1 ) {
+		trace_brushchecks.resize( cm.brushes.Count() + 1, 0 );
+	}
+	trace_checkcount++;	// for multi-check avoidance
 
 	c_traces++;			// for statistics, may be zeroed
 
@@ -1745,25 +1768,30 @@ AREAPORTALS
 ===============================================================================
 */
 
-void FloodArea_r (carea_t *area, int floodnum)
+void FloodArea_r (int areanum, int floodnum)
 {
 	int		i;
 	dareaportal_t	*p;
+	carea_t	*area;
+	careaFlood_t	*flood;
 
-	if (area->floodvalid == cm.floodvalid)
+	area = &cm.areas.Data(areanum);
+	flood = &cm.areafloods.Data(areanum);
+
+	if (flood->floodvalid == cm.floodvalid)
 	{
-		if (area->floodnum == floodnum)
+		if (flood->floodnum == floodnum)
 			return;
 		Com_Error ("FloodArea_r: reflooded");
 	}
 
-	area->floodnum = floodnum;
-	area->floodvalid = cm.floodvalid;
+	flood->floodnum = floodnum;
+	flood->floodvalid = cm.floodvalid;
 	p = &cm.areaportals.Data(area->firstareaportal);
 	for (i=0 ; i<area->numareaportals ; i++, p++)
 	{
 		if (cm.portalopen.Data(p->portalnum))
-			FloodArea_r (&cm.areas.Data(p->otherarea), floodnum);
+			FloodArea_r (p->otherarea, floodnum);
 	}
 }
 
@@ -1777,7 +1805,6 @@ FloodAreaConnections
 void	FloodAreaConnections (void)
 {
 	int		i;
-	carea_t	*area;
 	int		floodnum;
 
 	// nothing to do if we have no areaportals
@@ -1793,11 +1820,10 @@ void	FloodAreaConnections (void)
 	// area 0 is not used
 	for (i=1 ; i<cm.areas.Count() ; i++)
 	{
-		area = &cm.areas.Data(i);
-		if (area->floodvalid == cm.floodvalid)
+		if (cm.areafloods.Data(i).floodvalid == cm.floodvalid)
 			continue;		// already flooded into
 		floodnum++;
-		FloodArea_r (area, floodnum);
+		FloodArea_r (i, floodnum);
 	}
 
 }
@@ -1819,7 +1845,7 @@ qboolean	CM_AreasConnected (int area1, int area2)
 	if (area1 > cm.areas.Count() || area2 > cm.areas.Count())
 		Com_Error ("area > numareas");
 
-	if (cm.areas.Data(area1).floodnum == cm.areas.Data(area2).floodnum)
+	if (cm.areafloods.Data(area1).floodnum == cm.areafloods.Data(area2).floodnum)
 		return true;
 	return false;
 }
@@ -1851,10 +1877,10 @@ int CM_WriteAreaBits (byte *buffer, int area)
 	{
 		memset (buffer, 0, bytes);
 
-		floodnum = cm.areas.Data(area).floodnum;
+		floodnum = cm.areafloods.Data(area).floodnum;
 		for (i=0 ; i<cm.areas.Count() ; i++)
 		{
-			if (cm.areas.Data(i).floodnum == floodnum || !area)
+			if (cm.areafloods.Data(i).floodnum == floodnum || !area)
 				buffer[i>>3] |= 1<<(i&7);
 		}
 	}
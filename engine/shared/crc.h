@@ -11,3 +11,5 @@ namespace crc16
 	uint16 Value( uint16 crcvalue );
 	uint16 Block( byte *start, int count );
 }
+
+byte COM_BlockSequenceCRCByte( byte *base, int length, int sequence );
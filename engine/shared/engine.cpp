@@ -14,12 +14,12 @@ extern void Key_Init();
 extern void Key_Shutdown();
 
 static constexpr auto StatsLogFile_Name = "stats.log";
-static constexpr auto LogFile_Name = "qconsole.log";
 
 static jmp_buf		abortframe;		// an ERR_DROP occured, exit the entire frame
 
 fsHandle_t			log_stats_file;
 static fsHandle_t	logfile;
+static char			logFileName[MAX_QPATH] = "qconsole.log";
 
 cvar_t *	com_speeds;
 cvar_t *	com_logStats;
@@ -28,6 +28,7 @@ cvar_t *	com_timeScale;
 cvar_t *	com_fixedTime;
 cvar_t *	com_logFile;			// 1 = buffer log, 2 = flush after each print
 cvar_t *	com_showTrace;
+cvar_t *	com_jobWorkers;
 cvar_t *	dedicated;
 
 static int		server_state;
@@ -141,11 +142,11 @@ void Com_Print( const char *msg )
 		{
 			if ( com_logFile->GetInt() > 2 )
 			{
-				logfile = FileSystem::OpenFileAppend( LogFile_Name );
+				logfile = FileSystem::OpenFileAppend( logFileName );
 			}
 			else
 			{
-				logfile = FileSystem::OpenFileWrite( LogFile_Name );
+				logfile = FileSystem::OpenFileWrite( logFileName );
 			}
 		}
 		if ( logfile )
@@ -400,125 +401,6 @@ void Info_Print( const char *s )
 
 //=================================================================================================
 
-static const byte chktbl[1024]{
-0x84, 0x47, 0x51, 0xc1, 0x93, 0x22, 0x21, 0x24, 0x2f, 0x66, 0x60, 0x4d, 0xb0, 0x7c, 0xda,
-0x88, 0x54, 0x15, 0x2b, 0xc6, 0x6c, 0x89, 0xc5, 0x9d, 0x48, 0xee, 0xe6, 0x8a, 0xb5, 0xf4,
-0xcb, 0xfb, 0xf1, 0x0c, 0x2e, 0xa0, 0xd7, 0xc9, 0x1f, 0xd6, 0x06, 0x9a, 0x09, 0x41, 0x54,
-0x67, 0x46, 0xc7, 0x74, 0xe3, 0xc8, 0xb6, 0x5d, 0xa6, 0x36, 0xc4, 0xab, 0x2c, 0x7e, 0x85,
-0xa8, 0xa4, 0xa6, 0x4d, 0x96, 0x19, 0x19, 0x9a, 0xcc, 0xd8, 0xac, 0x39, 0x5e, 0x3c, 0xf2,
-0xf5, 0x5a, 0x72, 0xe5, 0xa9, 0xd1, 0xb3, 0x23, 0x82, 0x6f, 0x29, 0xcb, 0xd1, 0xcc, 0x71,
-0xfb, 0xea, 0x92, 0xeb, 0x1c, 0xca, 0x4c, 0x70, 0xfe, 0x4d, 0xc9, 0x67, 0x43, 0x47, 0x94,
-0xb9, 0x47, 0xbc, 0x3f, 0x01, 0xab, 0x7b, 0xa6, 0xe2, 0x76, 0xef, 0x5a, 0x7a, 0x29, 0x0b,
-0x51, 0x54, 0x67, 0xd8, 0x1c, 0x14, 0x3e, 0x29, 0xec, 0xe9, 0x2d, 0x48, 0x67, 0xff, 0xed,
-0x54, 0x4f, 0x48, 0xc0, 0xaa, 0x61, 0xf7, 0x78, 0x12, 0x03, 0x7a, 0x9e, 0x8b, 0xcf, 0x83,
-0x7b, 0xae, 0xca, 0x7b, 0xd9, 0xe9, 0x53, 0x2a, 0xeb, 0xd2, 0xd8, 0xcd, 0xa3, 0x10, 0x25,
-0x78, 0x5a, 0xb5, 0x23, 0x06, 0x93, 0xb7, 0x84, 0xd2, 0xbd, 0x96, 0x75, 0xa5, 0x5e, 0xcf,
-0x4e, 0xe9, 0x50, 0xa1, 0xe6, 0x9d, 0xb1, 0xe3, 0x85, 0x66, 0x28, 0x4e, 0x43, 0xdc, 0x6e,
-0xbb, 0x33, 0x9e, 0xf3, 0x0d, 0x00, 0xc1, 0xcf, 0x67, 0x34, 0x06, 0x7c, 0x71, 0xe3, 0x63,
-0xb7, 0xb7, 0xdf, 0x92, 0xc4, 0xc2, 0x25, 0x5c, 0xff, 0xc3, 0x6e, 0xfc, 0xaa, 0x1e, 0x2a,
-0x48, 0x11, 0x1c, 0x36, 0x68, 0x78, 0x86, 0x79, 0x30, 0xc3, 0xd6, 0xde, 0xbc, 0x3a, 0x2a,
-0x6d, 0x1e, 0x46, 0xdd, 0xe0, 0x80, 0x1e, 0x44, 0x3b, 0x6f, 0xaf, 0x31, 0xda, 0xa2, 0xbd,
-0x77, 0x06, 0x56, 0xc0, 0xb7, 0x92, 0x4b, 0x37, 0xc0, 0xfc, 0xc2, 0xd5, 0xfb, 0xa8, 0xda,
-0xf5, 0x57, 0xa8, 0x18, 0xc0, 0xdf, 0xe7, 0xaa, 0x2a, 0xe0, 0x7c, 0x6f, 0x77, 0xb1, 0x26,
-0xba, 0xf9, 0x2e, 0x1d, 0x16, 0xcb, 0xb8, 0xa2, 0x44, 0xd5, 0x2f, 0x1a, 0x79, 0x74, 0x87,
-0x4b, 0x00, 0xc9, 0x4a, 0x3a, 0x65, 0x8f, 0xe6, 0x5d, 0xe5, 0x0a, 0x77, 0xd8, 0x1a, 0x14,
-0x41, 0x75, 0xb1, 0xe2, 0x50, 0x2c, 0x93, 0x38, 0x2b, 0x6d, 0xf3, 0xf6, 0xdb, 0x1f, 0xcd,
-0xff, 0x14, 0x70, 0xe7, 0x16, 0xe8, 0x3d, 0xf0, 0xe3, 0xbc, 0x5e, 0xb6, 0x3f, 0xcc, 0x81,
-0x24, 0x67, 0xf3, 0x97, 0x3b, 0xfe, 0x3a, 0x96, 0x85, 0xdf, 0xe4, 0x6e, 0x3c, 0x85, 0x05,
-0x0e, 0xa3, 0x2b, 0x07, 0xc8, 0xbf, 0xe5, 0x13, 0x82, 0x62, 0x08, 0x61, 0x69, 0x4b, 0x47,
-0x62, 0x73, 0x44, 0x64, 0x8e, 0xe2, 0x91, 0xa6, 0x9a, 0xb7, 0xe9, 0x04, 0xb6, 0x54, 0x0c,
-0xc5, 0xa9, 0x47, 0xa6, 0xc9, 0x08, 0xfe, 0x4e, 0xa6, 0xcc, 0x8a, 0x5b, 0x90, 0x6f, 0x2b,
-0x3f, 0xb6, 0x0a, 0x96, 0xc0, 0x78, 0x58, 0x3c, 0x76, 0x6d, 0x94, 0x1a, 0xe4, 0x4e, 0xb8,
-0x38, 0xbb, 0xf5, 0xeb, 0x29, 0xd8, 0xb0, 0xf3, 0x15, 0x1e, 0x99, 0x96, 0x3c, 0x5d, 0x63,
-0xd5, 0xb1, 0xad, 0x52, 0xb8, 0x55, 0x70, 0x75, 0x3e, 0x1a, 0xd5, 0xda, 0xf6, 0x7a, 0x48,
-0x7d, 0x44, 0x41, 0xf9, 0x11, 0xce, 0xd7, 0xca, 0xa5, 0x3d, 0x7a, 0x79, 0x7e, 0x7d, 0x25,
-0x1b, 0x77, 0xbc, 0xf7, 0xc7, 0x0f, 0x84, 0x95, 0x10, 0x92, 0x67, 0x15, 0x11, 0x5a, 0x5e,
-0x41, 0x66, 0x0f, 0x38, 0x03, 0xb2, 0xf1, 0x5d, 0xf8, 0xab, 0xc0, 0x02, 0x76, 0x84, 0x28,
-0xf4, 0x9d, 0x56, 0x46, 0x60, 0x20, 0xdb, 0x68, 0xa7, 0xbb, 0xee, 0xac, 0x15, 0x01, 0x2f,
-0x20, 0x09, 0xdb, 0xc0, 0x16, 0xa1, 0x89, 0xf9, 0x94, 0x59, 0x00, 0xc1, 0x76, 0xbf, 0xc1,
-0x4d, 0x5d, 0x2d, 0xa9, 0x85, 0x2c, 0xd6, 0xd3, 0x14, 0xcc, 0x02, 0xc3, 0xc2, 0xfa, 0x6b,
-0xb7, 0xa6, 0xef, 0xdd, 0x12, 0x26, 0xa4, 0x63, 0xe3, 0x62, 0xbd, 0x56, 0x8a, 0x52, 0x2b,
-0xb9, 0xdf, 0x09, 0xbc, 0x0e, 0x97, 0xa9, 0xb0, 0x82, 0x46, 0x08, 0xd5, 0x1a, 0x8e, 0x1b,
-0xa7, 0x90, 0x98, 0xb9, 0xbb, 0x3c, 0x17, 0x9a, 0xf2, 0x82, 0xba, 0x64, 0x0a, 0x7f, 0xca,
-0x5a, 0x8c, 0x7c, 0xd3, 0x79, 0x09, 0x5b, 0x26, 0xbb, 0xbd, 0x25, 0xdf, 0x3d, 0x6f, 0x9a,
-0x8f, 0xee, 0x21, 0x66, 0xb0, 0x8d, 0x84, 0x4c, 0x91, 0x45, 0xd4, 0x77, 0x4f, 0xb3, 0x8c,
-0xbc, 0xa8, 0x99, 0xaa, 0x19, 0x53, 0x7c, 0x02, 0x87, 0xbb, 0x0b, 0x7c, 0x1a, 0x2d, 0xdf,
-0x48, 0x44, 0x06, 0xd6, 0x7d, 0x0c, 0x2d, 0x35, 0x76, 0xae, 0xc4, 0x5f, 0x71, 0x85, 0x97,
-0xc4, 0x3d, 0xef, 0x52, 0xbe, 0x00, 0xe4, 0xcd, 0x49, 0xd1, 0xd1, 0x1c, 0x3c, 0xd0, 0x1c,
-0x42, 0xaf, 0xd4, 0xbd, 0x58, 0x34, 0x07, 0x32, 0xee, 0xb9, 0xb5, 0xea, 0xff, 0xd7, 0x8c,
-0x0d, 0x2e, 0x2f, 0xaf, 0x87, 0xbb, 0xe6, 0x52, 0x71, 0x22, 0xf5, 0x25, 0x17, 0xa1, 0x82,
-0x04, 0xc2, 0x4a, 0xbd, 0x57, 0xc6, 0xab, 0xc8, 0x35, 0x0c, 0x3c, 0xd9, 0xc2, 0x43, 0xdb,
-0x27, 0x92, 0xcf, 0xb8, 0x25, 0x60, 0xfa, 0x21, 0x3b, 0x04, 0x52, 0xc8, 0x96, 0xba, 0x74,
-0xe3, 0x67, 0x3e, 0x8e, 0x8d, 0x61, 0x90, 0x92, 0x59, 0xb6, 0x1a, 0x1c, 0x5e, 0x21, 0xc1,
-0x65, 0xe5, 0xa6, 0x34, 0x05, 0x6f, 0xc5, 0x60, 0xb1, 0x83, 0xc1, 0xd5, 0xd5, 0xed, 0xd9,
-0xc7, 0x11, 0x7b, 0x49, 0x7a, 0xf9, 0xf9, 0x84, 0x47, 0x9b, 0xe2, 0xa5, 0x82, 0xe0, 0xc2,
-0x88, 0xd0, 0xb2, 0x58, 0x88, 0x7f, 0x45, 0x09, 0x67, 0x74, 0x61, 0xbf, 0xe6, 0x40, 0xe2,
-0x9d, 0xc2, 0x47, 0x05, 0x89, 0xed, 0xcb, 0xbb, 0xb7, 0x27, 0xe7, 0xdc, 0x7a, 0xfd, 0xbf,
-0xa8, 0xd0, 0xaa, 0x10, 0x39, 0x3c, 0x20, 0xf0, 0xd3, 0x6e, 0xb1, 0x72, 0xf8, 0xe6, 0x0f,
-0xef, 0x37, 0xe5, 0x09, 0x33, 0x5a, 0x83, 0x43, 0x80, 0x4f, 0x65, 0x2f, 0x7c, 0x8c, 0x6a,
-0xa0, 0x82, 0x0c, 0xd4, 0xd4, 0xfa, 0x81, 0x60, 0x3d, 0xdf, 0x06, 0xf1, 0x5f, 0x08, 0x0d,
-0x6d, 0x43, 0xf2, 0xe3, 0x11, 0x7d, 0x80, 0x32, 0xc5, 0xfb, 0xc5, 0xd9, 0x27, 0xec, 0xc6,
-0x4e, 0x65, 0x27, 0x76, 0x87, 0xa6, 0xee, 0xee, 0xd7, 0x8b, 0xd1, 0xa0, 0x5c, 0xb0, 0x42,
-0x13, 0x0e, 0x95, 0x4a, 0xf2, 0x06, 0xc6, 0x43, 0x33, 0xf4, 0xc7, 0xf8, 0xe7, 0x1f, 0xdd,
-0xe4, 0x46, 0x4a, 0x70, 0x39, 0x6c, 0xd0, 0xed, 0xca, 0xbe, 0x60, 0x3b, 0xd1, 0x7b, 0x57,
-0x48, 0xe5, 0x3a, 0x79, 0xc1, 0x69, 0x33, 0x53, 0x1b, 0x80, 0xb8, 0x91, 0x7d, 0xb4, 0xf6,
-0x17, 0x1a, 0x1d, 0x5a, 0x32, 0xd6, 0xcc, 0x71, 0x29, 0x3f, 0x28, 0xbb, 0xf3, 0x5e, 0x71,
-0xb8, 0x43, 0xaf, 0xf8, 0xb9, 0x64, 0xef, 0xc4, 0xa5, 0x6c, 0x08, 0x53, 0xc7, 0x00, 0x10,
-0x39, 0x4f, 0xdd, 0xe4, 0xb6, 0x19, 0x27, 0xfb, 0xb8, 0xf5, 0x32, 0x73, 0xe5, 0xcb, 0x32
-};
-
-/*
-========================
-COM_BlockSequenceCRCByte
-
-For proxy protecting
-========================
-*/
-byte COM_BlockSequenceCRCByte( byte *base, int length, int sequence )
-{
-	if ( sequence < 0 ) {
-		Com_FatalError( "sequence < 0, this shouldn't happen\n" );
-	}
-
-	const byte *p = chktbl + ( sequence % ( sizeof( chktbl ) - 4 ) );
-
-	if ( length > 60 ) {
-		length = 60;
-	}
-
-	byte chkb[60 + 4];
-	memcpy( chkb, base, length );
-
-	chkb[length] = p[0];
-	chkb[length + 1] = p[1];
-	chkb[length + 2] = p[2];
-	chkb[length + 3] = p[3];
-
-	length += 4;
-
-	uint16 crc = crc16::Block( chkb, length );
-
-	int x, n;
-
-	for ( x = 0, n = 0; n < length; n++ ) {
-		x += chkb[n];
-	}
-
-	crc = ( crc ^ x ) & 0xff;
-
-	return crc;
-}
-
-//=================================================================================================
-
-// Compressed vertex normals
-vec3_t bytedirs[NUMVERTEXNORMALS]
-{
-#include "../renderer/anorms.inl"
-};
-
-//=================================================================================================
-
 /*
 ========================
 Com_Error_f
@@ -594,6 +476,181 @@ static void Com_PerfTest_f()
 	}
 }
 
+/*
+========================
+Com_BenchMath_f
+
+Times the batched math routines against the scalar ones they stand in for,
+and reports how far apart their results are
+========================
+*/
+static void Com_BenchMath_f()
+{
+	const int count = Cmd_Argc() > 1 ? Clamp( Q_atoi( Cmd_Argv( 1 ) ), 1, 1 << 20 ) : 4096;
+	const int passes = Cmd_Argc() > 2 ? Clamp( Q_atoi( Cmd_Argv( 2 ) ), 1, 100000 ) : 200;
+
+	vec3_t *source = (vec3_t *)Mem_Alloc( count * sizeof( vec3_t ) );
+	vec3_t *mins = (vec3_t *)Mem_Alloc( count * sizeof( vec3_t ) );
+	vec3_t *maxs = (vec3_t *)Mem_Alloc( count * sizeof( vec3_t ) );
+	vec3_t *scalar = (vec3_t *)Mem_Alloc( count * sizeof( vec3_t ) );
+	vec3_t *batched = (vec3_t *)Mem_Alloc( count * sizeof( vec3_t ) );
+	int *scalarSides = (int *)Mem_Alloc( count * sizeof( int ) );
+	int *batchedSides = (int *)Mem_Alloc( count * sizeof( int ) );
+
+	uint32 seed = 1;
+	auto random = [&seed]()
+	{
+		seed = seed * 1664525 + 1013904223;
+		return ( ( seed >> 8 ) / 16777216.0f ) * 2.0f - 1.0f;
+	};
+
+	for ( int i = 0; i < count; ++i )
+	{
+		for ( int j = 0; j < 3; ++j )
+		{
+			source[i][j] = random() * 4096.0f;
+			mins[i][j] = source[i][j] - ( random() + 1.0f ) * 64.0f;
+			maxs[i][j] = source[i][j] + ( random() + 1.0f ) * 64.0f;
+		}
+	}
+
+	// one plane down each axis for the axial cases, and one for every combination of signbits
+	cplane_t planes[3 + 8];
+	for ( int i = 0; i < countof( planes ); ++i )
+	{
+		cplane_t &plane = planes[i];
+		if ( i < 3 )
+		{
+			VectorClear( plane.normal );
+			plane.normal[i] = 1.0f;
+			plane.type = i;
+		}
+		else
+		{
+			const int signbits = i - 3;
+			for ( int j = 0; j < 3; ++j ) {
+				plane.normal[j] = ( fabsf( random() ) + 0.1f ) * ( ( signbits & ( 1 << j ) ) ? -1.0f : 1.0f );
+			}
+			VectorNormalize( plane.normal );
+			plane.type = 3;
+		}
+		plane.dist = random() * 1024.0f;
+		plane.signbits = SignbitsForPlane( plane );
+	}
+
+	const vec3_t angles{ 30.0f, 60.0f, 10.0f };
+	float matrix[3][4];
+	AngleVectors( angles, matrix[0], matrix[1], matrix[2] );
+	matrix[0][3] = 100.0f;
+	matrix[1][3] = -200.0f;
+	matrix[2][3] = 300.0f;
+
+	auto maxError = [count]( const vec3_t *a, const vec3_t *b )
+	{
+		float error = 0.0f;
+		for ( int i = 0; i < count; ++i ) {
+			for ( int j = 0; j < 3; ++j ) {
+				error = Max( error, fabsf( a[i][j] - b[i][j] ) );
+			}
+		}
+		return error;
+	};
+
+	auto report = [count, passes]( const char *name, int64 scalarTime, int64 batchedTime, const char *precision )
+	{
+		Com_Printf( "%-18s scalar %7.2f ns, batched %7.2f ns, %5.2fx, %s\n", name,
+			scalarTime * 1000.0 / ( (double)count * passes ), batchedTime * 1000.0 / ( (double)count * passes ),
+			(double)scalarTime / Max<int64>( batchedTime, 1 ), precision );
+	};
+
+	char precision[64];
+	int64 start, scalarTime, batchedTime;
+
+	// normalize
+	start = Time_Microseconds();
+	for ( int pass = 0; pass < passes; ++pass )
+	{
+		memcpy( scalar, source, count * sizeof( vec3_t ) );
+		for ( int i = 0; i < count; ++i ) {
+			VectorNormalize( scalar[i] );
+		}
+	}
+	scalarTime = Time_Microseconds() - start;
+
+	start = Time_Microseconds();
+	for ( int pass = 0; pass < passes; ++pass )
+	{
+		memcpy( batched, source, count * sizeof( vec3_t ) );
+		VectorNormalizeMany( batched, count );
+	}
+	batchedTime = Time_Microseconds() - start;
+
+	Q_sprintf_s( precision, "max error %g", maxError( scalar, batched ) );
+	report( "VectorNormalize", scalarTime, batchedTime, precision );
+
+	// box on plane side, timed over all the planes
+	int mismatches = 0;
+	scalarTime = 0;
+	batchedTime = 0;
+
+	for ( const cplane_t &plane : planes )
+	{
+		start = Time_Microseconds();
+		for ( int pass = 0; pass < passes; ++pass )
+		{
+			for ( int i = 0; i < count; ++i ) {
+				scalarSides[i] = BoxOnPlaneSide( mins[i], maxs[i], &plane );
+			}
+		}
+		scalarTime += Time_Microseconds() - start;
+
+		start = Time_Microseconds();
+		for ( int pass = 0; pass < passes; ++pass ) {
+			BoxesOnPlaneSide( mins, maxs, count, &plane, batchedSides );
+		}
+		batchedTime += Time_Microseconds() - start;
+
+		int planeMismatches = 0;
+		for ( int i = 0; i < count; ++i ) {
+			planeMismatches += scalarSides[i] != batchedSides[i];
+		}
+		if ( planeMismatches ) {
+			Com_Printf( S_COLOR_RED "BoxesOnPlaneSide: %d mismatched for type %d, signbits %d\n", planeMismatches, plane.type, plane.signbits );
+		}
+		mismatches += planeMismatches;
+	}
+
+	Q_sprintf_s( precision, "%d mismatched over %d planes", mismatches, (int)countof( planes ) );
+	report( "BoxOnPlaneSide", scalarTime / countof( planes ), batchedTime / countof( planes ), precision );
+
+	// transform
+	start = Time_Microseconds();
+	for ( int pass = 0; pass < passes; ++pass )
+	{
+		for ( int i = 0; i < count; ++i ) {
+			VectorTransform( source[i], matrix, scalar[i] );
+		}
+	}
+	scalarTime = Time_Microseconds() - start;
+
+	start = Time_Microseconds();
+	for ( int pass = 0; pass < passes; ++pass ) {
+		TransformPoints( source, batched, count, matrix );
+	}
+	batchedTime = Time_Microseconds() - start;
+
+	Q_sprintf_s( precision, "max error %g", maxError( scalar, batched ) );
+	report( "VectorTransform", scalarTime, batchedTime, precision );
+
+	Mem_Free( batchedSides );
+	Mem_Free( scalarSides );
+	Mem_Free( batched );
+	Mem_Free( scalar );
+	Mem_Free( maxs );
+	Mem_Free( mins );
+	Mem_Free( source );
+}
+
 /*
 ========================
 Com_Init
@@ -660,8 +717,14 @@ void Com_Init( int argc, char **argv )
 	com_fixedTime = Cvar_Get( "com_fixedTime", "0", 0, "Force time to this value." );
 	com_logFile = Cvar_Get( "com_logFile", "0", 0, "Directs all logged messages to a file." );
 	com_showTrace = Cvar_Get( "com_showTrace", "0", 0, "Spams the console with trace stats." );
+	com_jobWorkers = Cvar_Get( "com_jobWorkers", "-1", CVAR_INIT, "Number of job worker threads, -1 = one less than the hardware threads, 0 = none." );
+
+	if ( com_jobWorkers->GetInt() != 0 ) {
+		Jobs::Init( com_jobWorkers->GetInt() < 0 ? 0 : com_jobWorkers->GetInt() );
+	}
 
 	Cmd_AddCommand( "com_perfTest", Com_PerfTest_f, "Perftest!" );
+	Cmd_AddCommand( "com_benchMath", Com_BenchMath_f, "Benchmarks the batched math routines against the scalar ones." );
 	Cmd_AddCommand( "com_error", Com_Error_f, "Throws a Com_Error." );
 	Cmd_AddCommand( "com_version", Com_Version_f, "Prints engine version information." );
 	if ( dedicated->GetBool() ) {
@@ -670,6 +733,9 @@ void Com_Init( int argc, char **argv )
 
 	NET_Init();
 	Netchan_Init();
+	Bulk_Init();
+	Asset_Init();
+	TexCache_Init();
 	PhysicsImpl::Init();
 	CM_Init();
 
@@ -767,7 +833,8 @@ void Com_Frame( int frameTime )
 	{
 		s = Sys_ConsoleInput();
 		if ( s ) {
-			Cbuf_AddText( va( "%s\n", s ) );
+			Cbuf_AddText( s );
+			Cbuf_AddText( "\n" );
 		}
 	} while ( s );
 
@@ -806,6 +873,45 @@ void Com_Frame( int frameTime )
 	FrameMark
 }
 
+/*
+========================
+Com_BeforeFork
+
+Threads don't come along through a fork, so the job workers are stopped and the log written
+out before Sys_ForkInstance, and Com_AfterFork starts them again in every process
+========================
+*/
+void Com_BeforeFork()
+{
+	if ( logfile ) {
+		FileSystem::FlushFile( logfile );
+	}
+
+	Jobs::Shutdown();
+}
+
+/*
+========================
+Com_AfterFork
+========================
+*/
+void Com_AfterFork( int instance )
+{
+	if ( instance > 0 )
+	{
+		// copies log to their own file rather than through the original's handle
+		if ( logfile ) {
+			FileSystem::CloseFile( logfile );
+			logfile = nullptr;
+		}
+		Q_sprintf_s( logFileName, "qconsole_%d.log", instance + 1 );
+	}
+
+	if ( com_jobWorkers->GetInt() != 0 ) {
+		Jobs::Init( com_jobWorkers->GetInt() < 0 ? 0 : com_jobWorkers->GetInt() );
+	}
+}
+
 /*
 ========================
 Com_Shutdown
@@ -818,8 +924,11 @@ void Com_Shutdown()
 		logfile = nullptr;
 	}
 
+	Asset_Shutdown();
+	TexCache_Shutdown();
 	CM_Shutdown();
 	PhysicsImpl::Shutdown();
+	Jobs::Shutdown();
 	Sys_Shutdown();
 	FileSystem::Shutdown();
 	Key_Shutdown();
@@ -19,6 +19,7 @@
 // physics
 #include "../../physics/phys_public.h"
 
+#include "assetload.h"
 #include "cmodel.h"
 #include "conproc.h"
 #include "crc.h"
@@ -28,6 +29,7 @@
 #include "protocol.h"
 #include "sizebuf.h"
 #include "sys.h"
+#include "texcache.h"
 
 /*
 ===================================================================================================
@@ -93,13 +95,16 @@ void		Com_Disconnect();
 [[noreturn]]
 void		Com_Quit( int code );
 
+// Call around Sys_ForkInstance, instance is what it returned
+void		Com_BeforeFork();
+void		Com_AfterFork( int instance );
+
 void		Info_Print( const char *s );
 
 int			Com_ServerState();	// this should have just been a cvar...
 void		Com_SetServerState( int state );
 
 unsigned	Com_BlockChecksum( void *buffer, uint length ); // md4.c
-byte		COM_BlockSequenceCRCByte( byte *base, int length, int sequence );
 
 // Compressed vertex normals
 #define NUMVERTEXNORMALS 162
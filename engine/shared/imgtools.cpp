@@ -4,6 +4,8 @@
 
 #include "engine.h"
 
+#include "imgtools.h"
+
 #include "png.h"
 
 namespace img
@@ -189,6 +191,38 @@ namespace img
 		return *( (const int64 *)buf ) == 727905341920923785;
 	}
 
+	bool GetImageSize( const byte *buf, int bufLen, int &width, int &height )
+	{
+		if ( bufLen >= 24 && TestPNG( buf ) )
+		{
+			// IHDR is always the first chunk
+			width = ( buf[16] << 24 ) | ( buf[17] << 16 ) | ( buf[18] << 8 ) | buf[19];
+			height = ( buf[20] << 24 ) | ( buf[21] << 16 ) | ( buf[22] << 8 ) | buf[23];
+			return true;
+		}
+
+		if ( bufLen >= (int)sizeof( DDS_HEADER ) && TestDDS( buf ) )
+		{
+			const DDS_HEADER *pHeader = (const DDS_HEADER *)buf;
+			width = (int)pHeader->width;
+			height = (int)pHeader->height;
+			return true;
+		}
+
+		const tgaHeader_t *pHeader = (const tgaHeader_t *)buf;
+
+		if ( bufLen <= sizeof( tgaHeader_t ) ||
+			( pHeader->bitsperpixel != 24 && pHeader->bitsperpixel != 32 ) ||
+			pHeader->datatypecode != 2 || pHeader->colormaptype != 0 )
+		{
+			return false;
+		}
+
+		width = pHeader->width;
+		height = pHeader->height;
+		return true;
+	}
+
 	struct LoadPNG_UserData_t
 	{
 		byte *buffer;
@@ -30,6 +30,9 @@ namespace img
 	byte *	LoadPNG( byte *buf, int &width, int &height );
 	bool	WritePNG( int width, int height, bool b32bit, byte *buffer, fsHandle_t handle );
 
+	// Reads the size out of a PNG, DDS or TGA header without decoding anything
+	bool	GetImageSize( const byte *buf, int bufLen, int &width, int &height );
+
 	//-------------------------------------------------------------------------------------------------
 	// DirectDraw Surface
 	// https://github.com/microsoft/DirectXTex/blob/master/DirectXTex/DDS.h
@@ -9,6 +9,12 @@
 //#define PARANOID
 //#define TOUGH_COMPRESSION
 
+// Compressed vertex normals
+vec3_t bytedirs[NUMVERTEXNORMALS]
+{
+#include "../renderer/anorms.inl"
+};
+
 //
 // writing functions
 //
@@ -102,3 +102,85 @@ void		Netchan_OutOfBandPrint( netsrc_t net_socket, netadr_t &adr, _Printf_format
 qboolean	Netchan_Process( netchan_t *chan, sizebuf_t *msg );
 
 qboolean	Netchan_CanReliable( netchan_t *chan );
+
+//-------------------------------------------------------------------------------------------------
+// Bulk transfers
+//
+// File downloads travel outside the netchan as unreliable fragments. The sender keeps a sliding
+// window of fragments in flight, the receiver acks the first fragment it's missing plus a mask
+// of the ones after it that did arrive, so only the holes get resent.
+//-------------------------------------------------------------------------------------------------
+
+#define	BULK_HEADER			-2			// first long of every bulk packet, -1 is out of band
+#define	BULK_FRAGMENT_SIZE	1200		// payload bytes, keeps packets under a typical MTU
+#define	BULK_MAX_WINDOW		64			// fragments in flight, one bit each in the ack mask
+
+enum bulkOps_t
+{
+	bulk_fragment = 1,		// [long] id [long] fragment [short] length [length bytes]
+	bulk_ack				// [short] qport [long] id [long] base [long] [long] mask [long] last fragment
+};
+
+struct bulkSender_t
+{
+	const byte *	data;				// the whole file, not owned
+	int				size;
+	int				offset;				// resume point, fragment 0 starts here
+	int				id;
+	int				numFragments;
+
+	int				base;				// first fragment not acked
+	uint64			acked;				// bit n is base + n
+	int				sentTime[BULK_MAX_WINDOW];	// by fragment % BULK_MAX_WINDOW, -1 if never sent
+
+	int				window;
+	int				rate;				// bytes per second, backs off on loss
+	int				maxRate;
+	float			tokens;
+	int				lastTime;
+	int				intervalStart;		// rate is adjusted every couple of round trips
+	int				intervalSent;
+	int				intervalResent;
+	int				lastAckTime;
+	int				srtt;				// smoothed round trip in msec
+
+	int				startTime;
+	int				fragmentsSent;
+	int				fragmentsResent;
+};
+
+struct bulkReceiver_t
+{
+	int				id;
+	int				size;
+	int				offset;
+	int				numFragments;
+
+	int				base;				// first fragment not received
+	uint64			received;			// bit n is base + n
+	int				lastFragment;
+	bool			active;
+	bool			ackPending;
+
+	int				fragmentsReceived;
+	int				duplicates;
+
+	byte			window[BULK_MAX_WINDOW][BULK_FRAGMENT_SIZE];
+};
+
+// called with runs of contiguous file data as the hole at base fills
+using bulkWriteFunc_t = void ( * )( void *params, const byte *data, int length );
+
+void		Bulk_Init();
+
+void		Bulk_BeginSend( bulkSender_t *s, int id, const byte *data, int size, int offset, int window, int rate, int time );
+// writes the next fragment due to msg, returns false if nothing can be sent right now
+bool		Bulk_WriteFragment( bulkSender_t *s, sizebuf_t *msg, int time );
+void		Bulk_ReadAck( bulkSender_t *s, sizebuf_t *msg, int time );
+bool		Bulk_SendComplete( const bulkSender_t *s );
+
+void		Bulk_BeginReceive( bulkReceiver_t *r, int id, int size, int offset );
+// returns false if the fragment isn't for this transfer
+bool		Bulk_ReadFragment( bulkReceiver_t *r, sizebuf_t *msg, bulkWriteFunc_t write, void *params );
+void		Bulk_WriteAck( bulkReceiver_t *r, sizebuf_t *msg, int qport );
+bool		Bulk_ReceiveComplete( const bulkReceiver_t *r );
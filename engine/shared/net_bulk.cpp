@@ -0,0 +1,525 @@
+/*
+===================================================================================================
+
+	Bulk transfers
+
+	A sliding window of unreliable fragments with selective acks, used for downloads so they
+	don't queue up behind game traffic in the netchan's single reliable buffer.
+
+	Both directions start with BULK_HEADER and an op byte. Callers read those (and the qport of
+	an ack) to work out who the packet is for, the functions here pick up after that.
+
+	The sender is paced by a token bucket. Every couple of round trips the rate drops by a quarter
+	if more than a tenth of what was sent had to be resent, otherwise it grows by an eighth up to
+	the negotiated rate. A little random loss doesn't throttle the transfer that way.
+
+===================================================================================================
+*/
+
+#include "engine.h"
+
+#include "net.h"
+
+#include <vector>
+
+#define BULK_MIN_RATE		( 16 * 1024 )
+#define BULK_MIN_RTO		50			// msec
+#define BULK_BURST_MSEC		200			// most the token bucket can save up
+#define BULK_LOSS_PERCENT	10			// resends above this back the rate off
+
+static int Bulk_FragmentLength( int size, int offset, int fragment )
+{
+	return Min( BULK_FRAGMENT_SIZE, size - offset - fragment * BULK_FRAGMENT_SIZE );
+}
+
+static int Bulk_NumFragments( int size, int offset )
+{
+	return ( size - offset + BULK_FRAGMENT_SIZE - 1 ) / BULK_FRAGMENT_SIZE;
+}
+
+/*
+===================================================================================================
+
+	Sending
+
+===================================================================================================
+*/
+
+/*
+========================
+Bulk_BeginSend
+========================
+*/
+void Bulk_BeginSend( bulkSender_t *s, int id, const byte *data, int size, int offset, int window, int rate, int time )
+{
+	memset( s, 0, sizeof( *s ) );
+
+	s->data = data;
+	s->size = size;
+	s->offset = Clamp( offset, 0, size );
+	s->id = id;
+	s->numFragments = Bulk_NumFragments( size, s->offset );
+
+	s->window = Clamp( window, 1, BULK_MAX_WINDOW );
+	s->maxRate = Max( rate, BULK_MIN_RATE );
+	s->rate = s->maxRate;
+	s->tokens = BULK_FRAGMENT_SIZE;
+	s->lastTime = time;
+	s->intervalStart = time;
+	s->lastAckTime = time;
+	s->srtt = 100;
+	s->startTime = time;
+
+	for ( int i = 0; i < BULK_MAX_WINDOW; ++i )
+	{
+		s->sentTime[i] = -1;
+	}
+}
+
+/*
+========================
+Bulk_WriteFragment
+========================
+*/
+bool Bulk_WriteFragment( bulkSender_t *s, sizebuf_t *msg, int time )
+{
+	// refill the bucket
+	if ( time > s->lastTime )
+	{
+		s->tokens += s->rate * ( time - s->lastTime ) * 0.001f;
+		s->tokens = Min( s->tokens, s->rate * ( BULK_BURST_MSEC * 0.001f ) + BULK_FRAGMENT_SIZE );
+		s->lastTime = time;
+	}
+
+	if ( s->tokens < BULK_FRAGMENT_SIZE ) {
+		return false;
+	}
+
+	const int rto = Max( s->srtt * 2 + 20, BULK_MIN_RTO );
+	const int end = Min( s->base + s->window, s->numFragments );
+
+	// lowest first, so holes get filled before new data goes out
+	int fragment = -1;
+	bool resend = false;
+	for ( int i = s->base; i < end; ++i )
+	{
+		if ( s->acked & ( 1ull << ( i - s->base ) ) ) {
+			continue;
+		}
+
+		const int sent = s->sentTime[i % BULK_MAX_WINDOW];
+		if ( sent == -1 )
+		{
+			fragment = i;
+			break;
+		}
+		if ( time - sent >= rto )
+		{
+			fragment = i;
+			resend = true;
+			break;
+		}
+	}
+
+	if ( fragment == -1 ) {
+		return false;
+	}
+
+	if ( resend )
+	{
+		++s->fragmentsResent;
+		++s->intervalResent;
+	}
+	++s->intervalSent;
+
+	if ( time - s->intervalStart >= Max( s->srtt * 2, BULK_MIN_RTO ) )
+	{
+		if ( s->intervalResent * 100 > s->intervalSent * BULK_LOSS_PERCENT ) {
+			s->rate = Max( s->rate - s->rate / 4, BULK_MIN_RATE );
+		} else {
+			s->rate = Min( s->rate + s->rate / 8, s->maxRate );
+		}
+
+		s->intervalStart = time;
+		s->intervalSent = 0;
+		s->intervalResent = 0;
+	}
+
+	const int length = Bulk_FragmentLength( s->size, s->offset, fragment );
+
+	MSG_WriteLong( msg, BULK_HEADER );
+	MSG_WriteByte( msg, bulk_fragment );
+	MSG_WriteLong( msg, s->id );
+	MSG_WriteLong( msg, fragment );
+	MSG_WriteShort( msg, length );
+	SZ_Write( msg, s->data + s->offset + fragment * BULK_FRAGMENT_SIZE, length );
+
+	s->sentTime[fragment % BULK_MAX_WINDOW] = time;
+	s->tokens -= length;
+	++s->fragmentsSent;
+
+	return true;
+}
+
+/*
+========================
+Bulk_ReadAck
+========================
+*/
+void Bulk_ReadAck( bulkSender_t *s, sizebuf_t *msg, int time )
+{
+	const int id = MSG_ReadLong( msg );
+	const int base = MSG_ReadLong( msg );
+	const uint32 maskLow = static_cast<uint32>( MSG_ReadLong( msg ) );
+	const uint32 maskHigh = static_cast<uint32>( MSG_ReadLong( msg ) );
+	const int last = MSG_ReadLong( msg );
+
+	if ( msg->readcount > msg->cursize || id != s->id ) {
+		return;
+	}
+	if ( base < 0 || base > s->numFragments ) {
+		return;
+	}
+
+	uint64 mask = ( static_cast<uint64>( maskHigh ) << 32 ) | maskLow;
+
+	s->lastAckTime = time;
+
+	// round trip from the newest fragment, if it hasn't been resent over since
+	if ( last >= s->base && last < s->base + BULK_MAX_WINDOW )
+	{
+		const int sent = s->sentTime[last % BULK_MAX_WINDOW];
+		if ( sent != -1 && time >= sent ) {
+			s->srtt = ( s->srtt * 7 + ( time - sent ) ) / 8;
+		}
+	}
+
+	if ( base > s->base )
+	{
+		const int advanced = base - s->base;
+
+		// slots that fell off the back now belong to fragments entering the window
+		for ( int i = s->base; i < base && i < s->base + BULK_MAX_WINDOW; ++i )
+		{
+			s->sentTime[i % BULK_MAX_WINDOW] = -1;
+		}
+
+		s->acked = advanced >= BULK_MAX_WINDOW ? 0 : s->acked >> advanced;
+		s->base = base;
+	}
+	else if ( base < s->base )
+	{
+		// an old ack, line it up with our base
+		const int behind = s->base - base;
+		mask = behind >= BULK_MAX_WINDOW ? 0 : mask >> behind;
+	}
+
+	s->acked |= mask;
+}
+
+/*
+========================
+Bulk_SendComplete
+========================
+*/
+bool Bulk_SendComplete( const bulkSender_t *s )
+{
+	return s->base >= s->numFragments;
+}
+
+/*
+===================================================================================================
+
+	Receiving
+
+===================================================================================================
+*/
+
+/*
+========================
+Bulk_BeginReceive
+========================
+*/
+void Bulk_BeginReceive( bulkReceiver_t *r, int id, int size, int offset )
+{
+	r->id = id;
+	r->size = size;
+	r->offset = Clamp( offset, 0, size );
+	r->numFragments = Bulk_NumFragments( size, r->offset );
+	r->base = 0;
+	r->received = 0;
+	r->lastFragment = -1;
+	r->active = true;
+	r->ackPending = false;
+	r->fragmentsReceived = 0;
+	r->duplicates = 0;
+}
+
+/*
+========================
+Bulk_ReadFragment
+========================
+*/
+bool Bulk_ReadFragment( bulkReceiver_t *r, sizebuf_t *msg, bulkWriteFunc_t write, void *params )
+{
+	const int id = MSG_ReadLong( msg );
+	const int fragment = MSG_ReadLong( msg );
+	const int length = MSG_ReadShort( msg );
+
+	if ( msg->readcount > msg->cursize || id != r->id ) {
+		return false;
+	}
+	if ( fragment < 0 || fragment >= r->numFragments || length != Bulk_FragmentLength( r->size, r->offset, fragment ) ) {
+		return false;
+	}
+	if ( msg->readcount + length > msg->cursize ) {
+		return false;
+	}
+
+	// always answer, even duplicates, our last ack might have been lost
+	r->ackPending = true;
+	r->lastFragment = fragment;
+
+	const int bit = fragment - r->base;
+	if ( bit < 0 || ( bit < BULK_MAX_WINDOW && ( r->received & ( 1ull << bit ) ) ) )
+	{
+		++r->duplicates;
+		return true;
+	}
+	if ( bit >= BULK_MAX_WINDOW ) {
+		// the sender never gets this far ahead
+		return true;
+	}
+
+	MSG_ReadData( msg, r->window[fragment % BULK_MAX_WINDOW], length );
+	r->received |= 1ull << bit;
+	++r->fragmentsReceived;
+
+	// hand over everything that's contiguous now
+	while ( r->received & 1 )
+	{
+		write( params, r->window[r->base % BULK_MAX_WINDOW], Bulk_FragmentLength( r->size, r->offset, r->base ) );
+		r->received >>= 1;
+		++r->base;
+	}
+
+	return true;
+}
+
+/*
+========================
+Bulk_WriteAck
+========================
+*/
+void Bulk_WriteAck( bulkReceiver_t *r, sizebuf_t *msg, int qport )
+{
+	MSG_WriteLong( msg, BULK_HEADER );
+	MSG_WriteByte( msg, bulk_ack );
+	MSG_WriteShort( msg, qport );
+	MSG_WriteLong( msg, r->id );
+	MSG_WriteLong( msg, r->base );
+	MSG_WriteLong( msg, static_cast<int>( r->received & 0xFFFFFFFF ) );
+	MSG_WriteLong( msg, static_cast<int>( r->received >> 32 ) );
+	MSG_WriteLong( msg, r->lastFragment );
+
+	r->ackPending = false;
+}
+
+/*
+========================
+Bulk_ReceiveComplete
+========================
+*/
+bool Bulk_ReceiveComplete( const bulkReceiver_t *r )
+{
+	return r->base >= r->numFragments;
+}
+
+/*
+===================================================================================================
+
+	Benchmark
+
+	Runs a transfer between a sender and a receiver through an in memory link with latency and
+	loss, packets go through the same serialisation as on the wire.
+
+===================================================================================================
+*/
+
+struct benchPacket_t
+{
+	int		deliverTime;
+	int		length;
+	byte	data[BULK_FRAGMENT_SIZE + 32];
+};
+
+struct benchLink_t
+{
+	std::vector<benchPacket_t> packets;
+	int		lossPercent;
+	int		latency;
+	uint32	seed;
+	int		dropped;
+};
+
+struct benchVerify_t
+{
+	const byte *	expected;
+	int				position;
+	bool			mismatch;
+};
+
+static void Bulk_BenchWrite( void *params, const byte *data, int length )
+{
+	benchVerify_t *verify = (benchVerify_t *)params;
+
+	if ( memcmp( verify->expected + verify->position, data, length ) != 0 ) {
+		verify->mismatch = true;
+	}
+	verify->position += length;
+}
+
+static void Bulk_BenchSend( benchLink_t &link, const sizebuf_t &msg, int time )
+{
+	link.seed = link.seed * 1664525 + 1013904223;
+	if ( static_cast<int>( ( link.seed >> 16 ) % 100 ) < link.lossPercent )
+	{
+		++link.dropped;
+		return;
+	}
+
+	benchPacket_t &packet = link.packets.emplace_back();
+	packet.deliverTime = time + link.latency;
+	packet.length = msg.cursize;
+	memcpy( packet.data, msg.data, msg.cursize );
+}
+
+static void Bulk_Bench_f()
+{
+	if ( Cmd_Argc() < 2 )
+	{
+		Com_Print( "Usage: net_benchBulk <megabytes> [loss percent] [latency msec] [rate KB/s] [window]\n" );
+		return;
+	}
+
+	const int size = Clamp( Q_atoi( Cmd_Argv( 1 ) ), 1, 256 ) * 1024 * 1024;
+	const int lossPercent = Cmd_Argc() > 2 ? Clamp( Q_atoi( Cmd_Argv( 2 ) ), 0, 90 ) : 0;
+	const int latency = Cmd_Argc() > 3 ? Clamp( Q_atoi( Cmd_Argv( 3 ) ), 0, 1000 ) : 5;
+	const int rate = Cmd_Argc() > 4 ? Max( Q_atoi( Cmd_Argv( 4 ) ), 16 ) * 1024 : 8 * 1024 * 1024;
+	const int window = Cmd_Argc() > 5 ? Q_atoi( Cmd_Argv( 5 ) ) : BULK_MAX_WINDOW;
+
+	byte *data = (byte *)Mem_Alloc( size );
+	uint32 seed = 1;
+	for ( int i = 0; i < size; ++i )
+	{
+		seed = seed * 1664525 + 1013904223;
+		data[i] = static_cast<byte>( seed >> 24 );
+	}
+
+	bulkSender_t *sender = (bulkSender_t *)Mem_Alloc( sizeof( bulkSender_t ) );
+	bulkReceiver_t *receiver = (bulkReceiver_t *)Mem_Alloc( sizeof( bulkReceiver_t ) );
+
+	benchLink_t toReceiver{ {}, lossPercent, latency, 1, 0 };
+	benchLink_t toSender{ {}, lossPercent, latency, 2, 0 };
+	benchVerify_t verify{ data, 0, false };
+
+	byte buffer[BULK_FRAGMENT_SIZE + 32];
+	sizebuf_t msg;
+
+	const int64 startTime = Time_Microseconds();
+
+	Bulk_BeginSend( sender, 1, data, size, 0, window, rate, 0 );
+	Bulk_BeginReceive( receiver, 1, size, 0 );
+
+	// a simulated millisecond per step, each side runs its frame once per step
+	int time = 0;
+	const int timeLimit = 60 * 60 * 1000;
+	while ( !Bulk_SendComplete( sender ) && time < timeLimit )
+	{
+		++time;
+
+		// sender side
+		for ( size_t i = 0; i < toSender.packets.size(); )
+		{
+			benchPacket_t &packet = toSender.packets[i];
+			if ( packet.deliverTime > time )
+			{
+				++i;
+				continue;
+			}
+
+			SZ_Init( &msg, packet.data, sizeof( packet.data ) );
+			msg.cursize = packet.length;
+			MSG_BeginReading( &msg );
+			MSG_ReadLong( &msg );
+			MSG_ReadByte( &msg );
+			MSG_ReadShort( &msg );
+			Bulk_ReadAck( sender, &msg, time );
+
+			toSender.packets[i] = toSender.packets.back();
+			toSender.packets.pop_back();
+		}
+
+		while ( true )
+		{
+			SZ_Init( &msg, buffer, sizeof( buffer ) );
+			if ( !Bulk_WriteFragment( sender, &msg, time ) ) {
+				break;
+			}
+			Bulk_BenchSend( toReceiver, msg, time );
+		}
+
+		// receiver side
+		for ( size_t i = 0; i < toReceiver.packets.size(); )
+		{
+			benchPacket_t &packet = toReceiver.packets[i];
+			if ( packet.deliverTime > time )
+			{
+				++i;
+				continue;
+			}
+
+			SZ_Init( &msg, packet.data, sizeof( packet.data ) );
+			msg.cursize = packet.length;
+			MSG_BeginReading( &msg );
+			MSG_ReadLong( &msg );
+			MSG_ReadByte( &msg );
+			Bulk_ReadFragment( receiver, &msg, Bulk_BenchWrite, &verify );
+
+			toReceiver.packets[i] = toReceiver.packets.back();
+			toReceiver.packets.pop_back();
+		}
+
+		if ( receiver->ackPending )
+		{
+			SZ_Init( &msg, buffer, sizeof( buffer ) );
+			Bulk_WriteAck( receiver, &msg, 0 );
+			Bulk_BenchSend( toSender, msg, time );
+		}
+	}
+
+	const int64 elapsed = Time_Microseconds() - startTime;
+	const float seconds = time * 0.001f;
+
+	Com_Printf( "%d KB in %.2f simulated seconds, %.1f KB/s, %d%% loss, %d msec latency\n",
+		size / 1024, seconds, ( verify.position / 1024.0f ) / Max( seconds, 0.001f ), lossPercent, latency );
+	Com_Printf( "%d fragments sent, %d resent, %d dropped, %d duplicates, %d acks dropped, final rate %d KB/s, srtt %d msec\n",
+		sender->fragmentsSent, sender->fragmentsResent, toReceiver.dropped, receiver->duplicates, toSender.dropped,
+		sender->rate / 1024, sender->srtt );
+	Com_Printf( "%.2f msec of cpu, %s\n", elapsed * 0.001,
+		( verify.position == size && !verify.mismatch ) ? "data verified" : "DATA MISMATCH" );
+
+	Mem_Free( receiver );
+	Mem_Free( sender );
+	Mem_Free( data );
+}
+
+/*
+========================
+Bulk_Init
+========================
+*/
+void Bulk_Init()
+{
+	Cmd_AddCommand( "net_benchBulk", Bulk_Bench_f, "Benchmarks the download transfer protocol over a simulated link." );
+}
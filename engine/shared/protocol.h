@@ -52,7 +52,8 @@ enum svc_ops_e
 	svc_playerinfo,				// variable
 	svc_packetentities,			// [...]
 	svc_deltapacketentities,	// [...]
-	svc_frame
+	svc_frame,
+	svc_bulkdownload			// [long] id [long] size [long] offset, fragments follow outside the netchan
 };
 
 //==============================================
@@ -31,6 +31,10 @@ void	Sys_Error( const pchar_t *mainInstruction, const char *msg );
 
 void	Sys_CopyProtect();
 
+// Starts a copy of this process that shares everything loaded so far until one of them writes
+// to it. Returns instance in the copy and 0 in the original, or -1 if the platform can't.
+int		Sys_ForkInstance( int instance );
+
 // common file dialog interface
 
 struct filterSpec_t
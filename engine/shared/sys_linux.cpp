@@ -4,6 +4,11 @@
 
 #include <vector>
 
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/prctl.h>
+
 #define SDL_MAIN_HANDLED
 #include <SDL2/SDL.h>
 
@@ -58,6 +63,36 @@ void Sys_CopyProtect (void)
 
 }
 
+/*
+================
+Sys_ForkInstance
+
+================
+*/
+int Sys_ForkInstance( int instance )
+{
+	const pid_t pid = fork();
+	if ( pid < 0 ) {
+		return -1;
+	}
+
+	if ( pid == 0 )
+	{
+		// the copies go away with the original
+		prctl( PR_SET_PDEATHSIG, SIGTERM );
+
+		// only the original reads the console
+		const int null = open( "/dev/null", O_RDONLY );
+		if ( null >= 0 ) {
+			dup2( null, STDIN_FILENO );
+			close( null );
+		}
+		return instance;
+	}
+
+	return 0;
+}
+
 //=================================================================================================
 
 /*
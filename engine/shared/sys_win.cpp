@@ -163,6 +163,18 @@ void Sys_CopyProtect()
 
 }
 
+/*
+================
+Sys_ForkInstance
+
+Windows has no fork, run more processes instead
+================
+*/
+int Sys_ForkInstance( int instance )
+{
+	return -1;
+}
+
 //=================================================================================================
 
 // Called by Com_Shutdown
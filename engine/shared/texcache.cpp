@@ -0,0 +1,747 @@
+/*
+===================================================================================================
+
+	Texture cache
+
+	PNGs and TGAs used to be decoded on every load and handed to the driver as 32 bit images to
+	build mips from, which is slow to load and costs four bytes a texel of video memory. The first
+	time a source is seen it's now cooked into a BC1 (opaque) or BC3 (alpha) DDS with the whole
+	mip chain and written to texcache/ in the write directory, named by a hash of the source file.
+	After that the renderer loads the cooked file and uploads the blocks as they are.
+
+	Cooking doesn't touch GL, so "cooktextures" can fill the cache ahead of time on a dedicated
+	server or from the command line with no window, spread over the job workers.
+
+	Entries are written to a temp file and renamed into place, so a reader or a crash never sees
+	half of one. The cache is kept under com_texCacheSize by deleting the least recently used
+	entries, and the workers don't print, their messages wait for TexCache_PrintMessages.
+
+===================================================================================================
+*/
+
+#include "engine.h"
+
+#include "imgtools.h"
+#include "texcache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdarg>
+#include <ctime>
+
+#define STB_DXT_STATIC
+#define STB_DXT_IMPLEMENTATION
+#include "../../thirdparty/stb/stb_dxt.h"
+
+// Bump this when the cooked output changes, old entries are then never found again
+static constexpr uint32 TEXCACHE_VERSION = 1;
+
+static constexpr size_t DDS_HEADERS_SIZE = sizeof( img::DDS_HEADER ) + sizeof( img::DDS_HEADER_DXT10 );
+
+// Nothing we load is near this, it stops a damaged entry from asking for a huge upload
+static constexpr int TEXCACHE_MAX_SIZE = 16384;
+
+static cvar_t *com_texCache;
+static cvar_t *com_texCacheSize;
+
+struct texCacheStats_t
+{
+	std::atomic<int>	loaded;
+	std::atomic<int64>	loadTime;
+	std::atomic<int>	cooked;
+	std::atomic<int64>	cookTime;
+	std::atomic<int64>	uncompressedBytes;	// what the same images would take as 32 bit with mips
+	std::atomic<int64>	compressedBytes;
+};
+
+struct texCacheEntry_t
+{
+	uint64		hash;
+	int64		size;
+	int64		lastUsed;		// seconds since 1970, the file time until it's used
+};
+
+struct texCacheMessage_t
+{
+	char		text[MAX_QPATH + 64];
+};
+
+static texCacheStats_t					s_stats;
+static std::vector<texCacheEntry_t>		s_entries;			// sorted by hash
+static int64							s_totalSize;
+static std::vector<texCacheMessage_t>	s_messages;
+static mutex_t							s_storeMutex;		// guards the above, two images can share a source
+
+/*
+========================
+TexCache_Enabled
+========================
+*/
+bool TexCache_Enabled()
+{
+	return com_texCache->GetBool();
+}
+
+/*
+===================================================================================================
+
+	Cooking
+
+===================================================================================================
+*/
+
+static int TexCache_MipCount( int width, int height )
+{
+	int count = 1;
+	for ( int size = Max( width, height ); size > 1; size /= 2 ) {
+		++count;
+	}
+	return count;
+}
+
+static fsSize_t TexCache_LevelSize( int width, int height, int blockSize )
+{
+	return static_cast<fsSize_t>( Max( 1, ( width + 3 ) / 4 ) * Max( 1, ( height + 3 ) / 4 ) * blockSize );
+}
+
+// Box filters a level into the next one down, odd edges repeat their last texel
+static void TexCache_HalveImage( const byte *in, int width, int height, byte *out, int outWidth, int outHeight )
+{
+	for ( int y = 0; y < outHeight; ++y )
+	{
+		const byte *row0 = in + Min( y * 2, height - 1 ) * width * 4;
+		const byte *row1 = in + Min( y * 2 + 1, height - 1 ) * width * 4;
+
+		for ( int x = 0; x < outWidth; ++x )
+		{
+			const int x0 = Min( x * 2, width - 1 ) * 4;
+			const int x1 = Min( x * 2 + 1, width - 1 ) * 4;
+
+			for ( int c = 0; c < 4; ++c ) {
+				*out++ = static_cast<byte>( ( row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2 ) >> 2 );
+			}
+		}
+	}
+}
+
+// Compresses one level, blocks that hang off the edge repeat the last row and column
+static byte *TexCache_CompressLevel( const byte *pic, int width, int height, bool alpha, byte *out )
+{
+	byte block[4 * 4 * 4];
+
+	for ( int by = 0; by < height; by += 4 )
+	{
+		for ( int bx = 0; bx < width; bx += 4 )
+		{
+			for ( int y = 0; y < 4; ++y )
+			{
+				const byte *row = pic + Min( by + y, height - 1 ) * width * 4;
+				for ( int x = 0; x < 4; ++x ) {
+					memcpy( block + ( y * 4 + x ) * 4, row + Min( bx + x, width - 1 ) * 4, 4 );
+				}
+			}
+
+			stb_compress_dxt_block( out, block, alpha ? 1 : 0, STB_DXT_HIGHQUAL );
+			out += alpha ? 16 : 8;
+		}
+	}
+
+	return out;
+}
+
+/*
+========================
+TexCache_Cook
+========================
+*/
+byte *TexCache_Cook( const byte *pic, int width, int height, fsSize_t &length )
+{
+	bool alpha = false;
+	for ( size_t i = 0, count = static_cast<size_t>( width ) * height; i < count; ++i )
+	{
+		if ( pic[i * 4 + 3] != 255 )
+		{
+			alpha = true;
+			break;
+		}
+	}
+
+	const int blockSize = alpha ? 16 : 8;
+	const int mipCount = TexCache_MipCount( width, height );
+
+	length = DDS_HEADERS_SIZE;
+	for ( int level = 0, w = width, h = height; level < mipCount; ++level, w = Max( 1, w / 2 ), h = Max( 1, h / 2 ) ) {
+		length += TexCache_LevelSize( w, h, blockSize );
+	}
+
+	byte *buffer = static_cast<byte *>( Mem_Alloc( length ) );
+	memset( buffer, 0, DDS_HEADERS_SIZE );
+
+	img::DDS_HEADER *header = reinterpret_cast<img::DDS_HEADER *>( buffer );
+	header->fourCC = img::DDS_MAGIC;
+	header->size = sizeof( img::DDS_HEADER ) - sizeof( header->fourCC );
+	header->flags = DDS_HEADER_FLAGS_TEXTURE | DDS_HEADER_FLAGS_MIPMAP | DDS_HEADER_FLAGS_LINEARSIZE;
+	header->height = static_cast<uint32>( height );
+	header->width = static_cast<uint32>( width );
+	header->pitchOrLinearSize = static_cast<uint32>( TexCache_LevelSize( width, height, blockSize ) );
+	header->mipMapCount = static_cast<uint32>( mipCount );
+	header->ddspf.size = sizeof( img::DDS_PIXELFORMAT );
+	header->ddspf.flags = DDS_FOURCC;
+	header->ddspf.fourCC = MakeFourCC( 'D', 'X', '1', '0' );
+	header->caps = DDS_SURFACE_FLAGS_TEXTURE | DDS_SURFACE_FLAGS_MIPMAP;
+
+	img::DDS_HEADER_DXT10 *header2 = reinterpret_cast<img::DDS_HEADER_DXT10 *>( buffer + sizeof( img::DDS_HEADER ) );
+	header2->dxgiFormat = alpha ? DXGI_FORMAT_BC3_UNORM : DXGI_FORMAT_BC1_UNORM;
+	header2->resourceDimension = img::DDS_DIMENSION_TEXTURE2D;
+	header2->arraySize = 1;
+	header2->miscFlags2 = alpha ? img::DDS_ALPHA_MODE_STRAIGHT : img::DDS_ALPHA_MODE_OPAQUE;
+
+	// the levels below the top ping-pong between two halves of one allocation
+	const int halfWidth = Max( 1, width / 2 ), halfHeight = Max( 1, height / 2 );
+	const size_t scratchSize = static_cast<size_t>( halfWidth ) * halfHeight * 4;
+	byte *scratch = mipCount > 1 ? static_cast<byte *>( Mem_Alloc( scratchSize * 2 ) ) : nullptr;
+
+	byte *out = buffer + DDS_HEADERS_SIZE;
+	const byte *level = pic;
+	int w = width, h = height;
+
+	for ( int i = 0; ; ++i )
+	{
+		out = TexCache_CompressLevel( level, w, h, alpha, out );
+
+		if ( i == mipCount - 1 ) {
+			break;
+		}
+
+		byte *next = scratch + ( i & 1 ) * scratchSize;
+		const int nextWidth = Max( 1, w / 2 ), nextHeight = Max( 1, h / 2 );
+		TexCache_HalveImage( level, w, h, next, nextWidth, nextHeight );
+
+		level = next;
+		w = nextWidth;
+		h = nextHeight;
+	}
+
+	assert( out == buffer + length );
+
+	if ( scratch ) {
+		Mem_Free( scratch );
+	}
+
+	return buffer;
+}
+
+/*
+===================================================================================================
+
+	Cache entries
+
+===================================================================================================
+*/
+
+/*
+========================
+TexCache_HashSource
+
+64 bit FNV-1a, seeded with the version
+========================
+*/
+uint64 TexCache_HashSource( const byte *buffer, fsSize_t length )
+{
+	uint64 hash = 14695981039346656037ull ^ TEXCACHE_VERSION;
+	for ( fsSize_t i = 0; i < length; ++i )
+	{
+		hash = ( hash ^ buffer[i] ) * 1099511628211ull;
+	}
+	return hash;
+}
+
+static void TexCache_EntryName( uint64 hash, char *name, strlen_t nameSize )
+{
+	Q_sprintf_s( name, nameSize, "texcache/%08x%08x.dds", static_cast<uint32>( hash >> 32 ), static_cast<uint32>( hash ) );
+}
+
+// Queues a message for the main thread, call with s_storeMutex held
+static void TexCache_Message( _Printf_format_string_ const char *fmt, ... )
+{
+	texCacheMessage_t &message = s_messages.emplace_back();
+
+	va_list argptr;
+	va_start( argptr, fmt );
+	Q_vsprintf_s( message.text, fmt, argptr );
+	va_end( argptr );
+}
+
+static texCacheEntry_t *TexCache_FindEntry( uint64 hash )
+{
+	auto it = std::lower_bound( s_entries.begin(), s_entries.end(), hash,
+		[]( const texCacheEntry_t &entry, uint64 value ) { return entry.hash < value; } );
+
+	return ( it != s_entries.end() && it->hash == hash ) ? &*it : nullptr;
+}
+
+static void TexCache_AddEntry( uint64 hash, int64 size, int64 lastUsed )
+{
+	texCacheEntry_t *existing = TexCache_FindEntry( hash );
+	if ( existing )
+	{
+		// cooked again with -force
+		s_totalSize += size - existing->size;
+		existing->size = size;
+		existing->lastUsed = lastUsed;
+		return;
+	}
+
+	auto it = std::lower_bound( s_entries.begin(), s_entries.end(), hash,
+		[]( const texCacheEntry_t &entry, uint64 value ) { return entry.hash < value; } );
+
+	s_entries.insert( it, texCacheEntry_t{ hash, size, lastUsed } );
+	s_totalSize += size;
+}
+
+// Deletes the least recently used entries until the cache fits in com_texCacheSize, never keep.
+// Call with s_storeMutex held
+static void TexCache_Evict( uint64 keep )
+{
+	const int64 budget = static_cast<int64>( com_texCacheSize->GetInt() ) * 1024 * 1024;
+	if ( budget <= 0 || s_totalSize <= budget ) {
+		return;
+	}
+
+	// go an eighth under so the next few stores don't each have to sort the cache
+	const int64 target = budget - budget / 8;
+
+	std::vector<texCacheEntry_t> byAge( s_entries );
+	std::sort( byAge.begin(), byAge.end(), []( const texCacheEntry_t &a, const texCacheEntry_t &b ) { return a.lastUsed < b.lastUsed; } );
+
+	std::vector<uint64> evicted;
+	char name[MAX_QPATH];
+
+	for ( const texCacheEntry_t &entry : byAge )
+	{
+		if ( s_totalSize <= target ) {
+			break;
+		}
+		if ( entry.hash == keep ) {
+			continue;
+		}
+
+		TexCache_EntryName( entry.hash, name, sizeof( name ) );
+		FileSystem::RemoveFile( name );
+
+		s_totalSize -= entry.size;
+		evicted.push_back( entry.hash );
+	}
+
+	std::sort( evicted.begin(), evicted.end() );
+	s_entries.erase( std::remove_if( s_entries.begin(), s_entries.end(),
+		[&evicted]( const texCacheEntry_t &entry ) { return std::binary_search( evicted.begin(), evicted.end(), entry.hash ); } ),
+		s_entries.end() );
+
+	TexCache_Message( "Evicted %d texture cache entries, %.1f MB left\n", static_cast<int>( evicted.size() ), s_totalSize / ( 1024.0 * 1024.0 ) );
+}
+
+// Builds the entry list from what's in the write directory
+static void TexCache_ScanEntries()
+{
+	char wildcard[MAX_OSPATH];
+	const char *path = FileSystem::RelativePathToAbsolutePath( "texcache", FS_WRITEDIR );
+	if ( !path[0] ) {
+		return;
+	}
+
+	Q_sprintf_s( wildcard, "%s/*", path );
+
+	for ( const char *found = Sys_FindFirst( wildcard, 0, SFF_SUBDIR ); found; found = Sys_FindNext( 0, SFF_SUBDIR ) )
+	{
+		const char *fileName = strrchr( found, '/' );
+		fileName = fileName ? fileName + 1 : found;
+
+		const char *extension = strrchr( fileName, '.' );
+		if ( !extension ) {
+			continue;
+		}
+
+		// a store that never got renamed into place
+		if ( Q_stricmp( extension, ".tmp" ) == 0 )
+		{
+			Sys_DeleteFile( found );
+			continue;
+		}
+
+		if ( Q_stricmp( extension, ".dds" ) != 0 || extension - fileName != 16 ) {
+			continue;
+		}
+
+		char *end;
+		const uint64 hash = strtoull( fileName, &end, 16 );
+		if ( end != extension ) {
+			continue;
+		}
+
+		int64 size, modified;
+		if ( Sys_FileInfo( found, size, modified ) ) {
+			TexCache_AddEntry( hash, size, modified );
+		}
+	}
+
+	Sys_FindClose();
+}
+
+// Only accepts what TexCache_Cook writes
+static bool TexCache_ValidEntry( const byte *buffer, fsSize_t length )
+{
+	if ( length <= static_cast<fsSize_t>( DDS_HEADERS_SIZE ) || !img::TestDDS( buffer ) ) {
+		return false;
+	}
+
+	const img::DDS_HEADER *header = reinterpret_cast<const img::DDS_HEADER *>( buffer );
+	const img::DDS_HEADER_DXT10 *header2 = reinterpret_cast<const img::DDS_HEADER_DXT10 *>( buffer + sizeof( img::DDS_HEADER ) );
+
+	if ( header->ddspf.fourCC != MakeFourCC( 'D', 'X', '1', '0' ) ) {
+		return false;
+	}
+
+	int blockSize;
+	switch ( header2->dxgiFormat )
+	{
+	case DXGI_FORMAT_BC1_UNORM:
+		blockSize = 8;
+		break;
+	case DXGI_FORMAT_BC3_UNORM:
+		blockSize = 16;
+		break;
+	default:
+		return false;
+	}
+
+	const int width = static_cast<int>( header->width );
+	const int height = static_cast<int>( header->height );
+	if ( width < 1 || height < 1 || width > TEXCACHE_MAX_SIZE || height > TEXCACHE_MAX_SIZE ) {
+		return false;
+	}
+
+	const int mipCount = TexCache_MipCount( width, height );
+	if ( header->mipMapCount != static_cast<uint32>( mipCount ) ) {
+		return false;
+	}
+
+	fsSize_t expected = DDS_HEADERS_SIZE;
+	for ( int level = 0, w = width, h = height; level < mipCount; ++level, w = Max( 1, w / 2 ), h = Max( 1, h / 2 ) ) {
+		expected += TexCache_LevelSize( w, h, blockSize );
+	}
+
+	return length == expected;
+}
+
+/*
+========================
+TexCache_Find
+========================
+*/
+byte *TexCache_Find( uint64 hash, fsSize_t &length )
+{
+	char name[MAX_QPATH];
+	TexCache_EntryName( hash, name, sizeof( name ) );
+
+	byte *buffer;
+	length = FileSystem::LoadFile( name, (void **)&buffer );
+	if ( !buffer ) {
+		return nullptr;
+	}
+
+	if ( !TexCache_ValidEntry( buffer, length ) )
+	{
+		// it'll be cooked again and replaced
+		Sys_MutexLock( s_storeMutex );
+		TexCache_Message( "Ignoring damaged texture cache entry %s\n", name );
+		Sys_MutexUnlock( s_storeMutex );
+
+		FileSystem::FreeFile( buffer );
+		return nullptr;
+	}
+
+	Sys_MutexLock( s_storeMutex );
+	texCacheEntry_t *entry = TexCache_FindEntry( hash );
+	if ( entry ) {
+		entry->lastUsed = static_cast<int64>( time( nullptr ) );
+	}
+	Sys_MutexUnlock( s_storeMutex );
+
+	return buffer;
+}
+
+/*
+========================
+TexCache_Store
+========================
+*/
+void TexCache_Store( uint64 hash, const byte *buffer, fsSize_t length )
+{
+	char name[MAX_QPATH];
+	char tempName[MAX_QPATH];
+	TexCache_EntryName( hash, name, sizeof( name ) );
+	Q_sprintf_s( tempName, "%s.tmp", name );
+
+	Sys_MutexLock( s_storeMutex );
+
+	bool stored = false;
+
+	fsHandle_t handle = FileSystem::OpenFileWrite( tempName );
+	if ( handle != FS_INVALID_HANDLE )
+	{
+		stored = FileSystem::WriteFile( buffer, length, handle ) == length;
+		FileSystem::CloseFile( handle );
+
+		stored = stored && FileSystem::RenameFile( tempName, name );
+		if ( !stored ) {
+			FileSystem::RemoveFile( tempName );
+		}
+	}
+
+	if ( stored )
+	{
+		TexCache_AddEntry( hash, length, static_cast<int64>( time( nullptr ) ) );
+		TexCache_Evict( hash );
+	}
+	else
+	{
+		TexCache_Message( "Couldn't write texture cache entry %s\n", name );
+	}
+
+	Sys_MutexUnlock( s_storeMutex );
+}
+
+/*
+========================
+TexCache_PrintMessages
+========================
+*/
+void TexCache_PrintMessages()
+{
+	Sys_MutexLock( s_storeMutex );
+
+	for ( const texCacheMessage_t &message : s_messages ) {
+		Com_Print( message.text );
+	}
+	s_messages.clear();
+
+	Sys_MutexUnlock( s_storeMutex );
+}
+
+/*
+========================
+TexCache_RecordLoad
+========================
+*/
+void TexCache_RecordLoad( bool cooked, int64 time, int width, int height, fsSize_t cookedLength )
+{
+	if ( cooked )
+	{
+		++s_stats.cooked;
+		s_stats.cookTime += time;
+	}
+	else
+	{
+		++s_stats.loaded;
+		s_stats.loadTime += time;
+	}
+
+	// a full mip chain adds a third
+	s_stats.uncompressedBytes += static_cast<int64>( width ) * height * 4 * 4 / 3;
+	s_stats.compressedBytes += cookedLength - static_cast<int64>( DDS_HEADERS_SIZE );
+}
+
+/*
+===================================================================================================
+
+	Commands
+
+===================================================================================================
+*/
+
+struct cookJob_t
+{
+	char		name[MAX_QPATH];
+	bool		cooked;
+};
+
+static bool	s_cookForce;
+
+static void TexCache_CookJob( void *params, uint32 index )
+{
+	cookJob_t &job = static_cast<cookJob_t *>( params )[index];
+	job.cooked = false;
+
+	byte *source;
+	const fsSize_t sourceLength = FileSystem::LoadFile( job.name, (void **)&source );
+	if ( !source ) {
+		return;
+	}
+
+	const uint64 hash = TexCache_HashSource( source, sourceLength );
+
+	fsSize_t length;
+	if ( !s_cookForce )
+	{
+		byte *existing = TexCache_Find( hash, length );
+		if ( existing )
+		{
+			Mem_Free( existing );
+			FileSystem::FreeFile( source );
+			return;
+		}
+	}
+
+	const int64 start = Time_Microseconds();
+
+	int width, height;
+	byte *pic = img::TestPNG( source ) ? img::LoadPNG( source, width, height ) : img::LoadTGA( source, sourceLength, width, height );
+	FileSystem::FreeFile( source );
+	if ( !pic ) {
+		return;
+	}
+
+	byte *cooked = TexCache_Cook( pic, width, height, length );
+	Mem_Free( pic );
+
+	TexCache_Store( hash, cooked, length );
+	TexCache_RecordLoad( true, Time_Microseconds() - start, width, height, length );
+	Mem_Free( cooked );
+
+	job.cooked = true;
+}
+
+// Adds the PNGs and TGAs in a game folder, not its subfolders
+static void TexCache_AddFolder( const char *folder, std::vector<cookJob_t> &jobs )
+{
+	char wildcard[MAX_OSPATH];
+	const char *path = FileSystem::RelativePathToAbsolutePath( folder );
+	if ( !path[0] )
+	{
+		Com_Printf( "Couldn't find %s\n", folder );
+		return;
+	}
+
+	Q_sprintf_s( wildcard, "%s/*", path );
+
+	for ( const char *found = Sys_FindFirst( wildcard, 0, SFF_SUBDIR ); found; found = Sys_FindNext( 0, SFF_SUBDIR ) )
+	{
+		const char *fileName = strrchr( found, '/' );
+		fileName = fileName ? fileName + 1 : found;
+
+		const char *extension = strrchr( fileName, '.' );
+		if ( !extension || ( Q_stricmp( extension, ".png" ) != 0 && Q_stricmp( extension, ".tga" ) != 0 ) ) {
+			continue;
+		}
+
+		cookJob_t &job = jobs.emplace_back();
+		Q_sprintf_s( job.name, "%s/%s", folder, fileName );
+	}
+
+	Sys_FindClose();
+}
+
+static void TexCache_Cook_f()
+{
+	if ( Cmd_Argc() < 2 )
+	{
+		Com_Print( "Usage: cooktextures [-force] <folder> [folder...]\n" );
+		return;
+	}
+
+	std::vector<cookJob_t> jobs;
+	s_cookForce = false;
+
+	for ( int i = 1; i < Cmd_Argc(); ++i )
+	{
+		if ( Q_stricmp( Cmd_Argv( i ), "-force" ) == 0 )
+		{
+			s_cookForce = true;
+			continue;
+		}
+		TexCache_AddFolder( Cmd_Argv( i ), jobs );
+	}
+
+	if ( jobs.empty() )
+	{
+		Com_Print( "No images to cook\n" );
+		return;
+	}
+
+	const int64 start = Time_Microseconds();
+
+	Jobs::ParallelFor( static_cast<uint32>( jobs.size() ), TexCache_CookJob, jobs.data() );
+
+	TexCache_PrintMessages();
+
+	int cooked = 0;
+	for ( const cookJob_t &job : jobs ) {
+		cooked += job.cooked ? 1 : 0;
+	}
+
+	Com_Printf( "Cooked %d of %d images in %.1f ms (%u workers)\n", cooked, static_cast<int>( jobs.size() ),
+		( Time_Microseconds() - start ) * 0.001, Jobs::NumWorkers() );
+}
+
+static void TexCache_Report_f()
+{
+	const int loaded = s_stats.loaded;
+	const int cooked = s_stats.cooked;
+
+	if ( loaded + cooked == 0 )
+	{
+		Com_Print( "No textures have gone through the cache\n" );
+		return;
+	}
+
+	Com_Printf( "%d loaded from the cache in %.1f ms (%.2f ms each)\n", loaded, s_stats.loadTime * 0.001,
+		loaded ? s_stats.loadTime * 0.001 / loaded : 0.0 );
+	Com_Printf( "%d cooked in %.1f ms (%.2f ms each)\n", cooked, s_stats.cookTime * 0.001,
+		cooked ? s_stats.cookTime * 0.001 / cooked : 0.0 );
+
+	const double uncompressed = s_stats.uncompressedBytes / ( 1024.0 * 1024.0 );
+	const double compressed = s_stats.compressedBytes / ( 1024.0 * 1024.0 );
+	Com_Printf( "%.1f MB of video memory instead of %.1f MB, %.1f MB saved\n", compressed, uncompressed, uncompressed - compressed );
+
+	Sys_MutexLock( s_storeMutex );
+	Com_Printf( "%d entries taking %.1f MB on disk, the limit is %d MB\n", static_cast<int>( s_entries.size() ),
+		s_totalSize / ( 1024.0 * 1024.0 ), com_texCacheSize->GetInt() );
+	Sys_MutexUnlock( s_storeMutex );
+}
+
+/*
+========================
+TexCache_Init
+========================
+*/
+void TexCache_Init()
+{
+	com_texCache = Cvar_Get( "com_texCache", "1", 0, "Load images as block compressed textures from texcache/, cooking any that aren't there yet." );
+	com_texCacheSize = Cvar_Get( "com_texCacheSize", "1024", 0, "Size in MB texcache/ is kept under by deleting the least recently used entries, 0 = no limit." );
+
+	Sys_MutexCreate( s_storeMutex );
+
+	TexCache_ScanEntries();
+
+	Cmd_AddCommand( "cooktextures", TexCache_Cook_f, "Cooks the images in the given folders into the texture cache." );
+	Cmd_AddCommand( "texcachereport", TexCache_Report_f, "Prints what the texture cache has loaded and saved." );
+}
+
+/*
+========================
+TexCache_Shutdown
+========================
+*/
+void TexCache_Shutdown()
+{
+	Cmd_RemoveCommand( "cooktextures" );
+	Cmd_RemoveCommand( "texcachereport" );
+
+	TexCache_PrintMessages();
+
+	s_entries.clear();
+	s_totalSize = 0;
+
+	Sys_MutexDestroy( s_storeMutex );
+}
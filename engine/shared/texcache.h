@@ -0,0 +1,40 @@
+/*
+===================================================================================================
+
+	Texture cache
+
+	Cooks source images into block compressed mip chains and keeps them in the write directory
+
+===================================================================================================
+*/
+
+#pragma once
+
+#include "../../core/sys_types.h"
+
+void		TexCache_Init();
+void		TexCache_Shutdown();
+
+// False if images should be uploaded the way they're stored
+bool		TexCache_Enabled();
+
+// Identifies a source file by its contents, so an edited image gets a new entry
+uint64		TexCache_HashSource( const byte *buffer, fsSize_t length );
+
+// Loads the cooked DDS for a source, returns null if it hasn't been cooked or the entry is bad.
+// Free the buffer with Mem_Free. Safe to call from the job workers.
+byte *		TexCache_Find( uint64 hash, fsSize_t &length );
+
+// Cooks a 32 bit image into a DX10 DDS with a full mip chain, BC3 if anything has alpha and BC1
+// otherwise. Free the buffer with Mem_Free. Safe to call from the job workers.
+byte *		TexCache_Cook( const byte *pic, int width, int height, fsSize_t &length );
+
+// Writes a cooked DDS into the cache, evicting old entries if it's over com_texCacheSize. Safe to
+// call from the job workers.
+void		TexCache_Store( uint64 hash, const byte *buffer, fsSize_t length );
+
+// Prints the messages the functions above queued instead of printing from a worker. Main thread only
+void		TexCache_PrintMessages();
+
+// For the report, times are in usec
+void		TexCache_RecordLoad( bool cooked, int64 time, int width, int height, fsSize_t cookedLength );
@@ -13,35 +13,52 @@
 
 #include "cmdsystem.h"
 
-#define	MAX_CMD_BUFFER	16384
-#define	MAX_CMD_LINE	1024
+#define	MAX_CMD_BUFFER			16384					// starting size, grows as needed
+#define	MAX_CMD_BUFFER_LIMIT	( 64 * 1024 * 1024 )
+#define	MAX_CMD_LINE			1024
 
 #define	MAX_STRING_CHARS	1024	// max length of a string passed to Cmd_TokenizeString
 #define	MAX_STRING_TOKENS	80		// max tokens resulting from Cmd_TokenizeString
 
 #define	MAX_ALIAS_NAME		32
 
+// A tokenized command kept for reuse, cmd_args then the tokens follow it in the same block
+struct cmdTokenCache_t
+{
+	int		argc;
+	int		argsLength;		// including the terminator
+	int		tokensLength;
+};
+
 struct cmdAlias_t
 {
-	char			name[MAX_ALIAS_NAME];
-	char *			pValue;
-	cmdAlias_t *	pNext;
+	char				name[MAX_ALIAS_NAME];
+	char *				pValue;
+	cmdTokenCache_t *	pTokens;	// parsed the first time it runs
+	bool				single;		// the value is one command without macros
+	cmdAlias_t *		pNext;
 };
 
 // singly linked list of command aliases
 static cmdAlias_t *cmd_alias;
 
-struct cmd_t
+// The command text is a ring. Lines are taken off the front as they're executed and text is
+// inserted in front of them or added at the back, nothing that's already there has to move.
+// It starts out in a static buffer and grows into an allocated one for big exec files
+struct cmdQueue_t
 {
 	byte *	data;
-	int		maxsize;
-	int		cursize;
+	int		capacity;		// power of two
+	int		head;			// first unexecuted byte
+	int		size;
+	byte *	initial;		// the static buffer
 };
 
-static int		cmd_wait;
-static cmd_t	cmd_text;
-static byte		cmd_text_buf[MAX_CMD_BUFFER];
-static byte		defer_text_buf[MAX_CMD_BUFFER];
+static int			cmd_wait;
+static cmdQueue_t	cmd_text;
+static cmdQueue_t	cmd_defer;
+static byte			cmd_text_buf[MAX_CMD_BUFFER];
+static byte			defer_text_buf[MAX_CMD_BUFFER];
 
 #define	ALIAS_LOOP_COUNT	16
 static int alias_count;		// for detecting runaway loops
@@ -76,6 +93,95 @@ static void Cmd_Wait_f()
 ===================================================================================================
 */
 
+static void Cbuf_Reset( cmdQueue_t &queue, byte *initial )
+{
+	queue.data = initial;
+	queue.capacity = initial ? MAX_CMD_BUFFER : 0;
+	queue.head = 0;
+	queue.size = 0;
+	queue.initial = initial;
+}
+
+// Copies out length bytes starting offset bytes past the head
+static void Cbuf_Read( const cmdQueue_t &queue, int offset, byte *dest, int length )
+{
+	if ( length <= 0 ) {
+		return;
+	}
+
+	const int start = ( queue.head + offset ) & ( queue.capacity - 1 );
+	const int first = Min( length, queue.capacity - start );
+
+	memcpy( dest, queue.data + start, first );
+	memcpy( dest + first, queue.data, length - first );
+}
+
+static void Cbuf_Write( cmdQueue_t &queue, int position, const byte *src, int length )
+{
+	if ( length <= 0 ) {
+		return;
+	}
+
+	const int first = Min( length, queue.capacity - position );
+
+	memcpy( queue.data + position, src, first );
+	memcpy( queue.data, src + first, length - first );
+}
+
+// Makes room for length more bytes
+static bool Cbuf_Reserve( cmdQueue_t &queue, int length )
+{
+	if ( queue.size + length <= queue.capacity ) {
+		return true;
+	}
+
+	int capacity = Max( queue.capacity, MAX_CMD_BUFFER );
+	while ( capacity < queue.size + length && capacity <= MAX_CMD_BUFFER_LIMIT ) {
+		capacity *= 2;
+	}
+	if ( capacity > MAX_CMD_BUFFER_LIMIT ) {
+		return false;
+	}
+
+	byte *data = (byte *)Mem_Alloc( capacity );
+	Cbuf_Read( queue, 0, data, queue.size );
+
+	if ( queue.data != queue.initial ) {
+		Mem_Free( queue.data );
+	}
+
+	queue.data = data;
+	queue.capacity = capacity;
+	queue.head = 0;
+
+	return true;
+}
+
+// Goes back to the static buffer once a big exec has run through
+static void Cbuf_Release( cmdQueue_t &queue )
+{
+	assert( queue.size == 0 );
+
+	if ( queue.data != queue.initial ) {
+		Mem_Free( queue.data );
+	}
+
+	Cbuf_Reset( queue, queue.initial );
+}
+
+static void Cbuf_Append( cmdQueue_t &queue, const byte *data, int length )
+{
+	Cbuf_Write( queue, ( queue.head + queue.size ) & ( queue.capacity - 1 ), data, length );
+	queue.size += length;
+}
+
+static void Cbuf_Prepend( cmdQueue_t &queue, const byte *data, int length )
+{
+	queue.head = ( queue.head - length ) & ( queue.capacity - 1 );
+	Cbuf_Write( queue, queue.head, data, length );
+	queue.size += length;
+}
+
 /*
 ========================
 Cbuf_Init
@@ -83,9 +189,8 @@ Cbuf_Init
 */
 void Cbuf_Init()
 {
-	cmd_text.data = cmd_text_buf;
-	cmd_text.maxsize = MAX_CMD_BUFFER;
-	cmd_text.cursize = 0;
+	Cbuf_Reset( cmd_text, cmd_text_buf );
+	Cbuf_Reset( cmd_defer, defer_text_buf );
 }
 
 /*
@@ -95,6 +200,10 @@ Cbuf_Shutdown
 */
 void Cbuf_Shutdown()
 {
+	cmd_text.size = 0;
+	Cbuf_Release( cmd_text );
+	cmd_defer.size = 0;
+	Cbuf_Release( cmd_defer );
 }
 
 /*
@@ -106,16 +215,15 @@ Adds command text at the end of the buffer
 */
 void Cbuf_AddText( const char *text )
 {
-	int l = static_cast<int>( strlen( text ) );
+	const int l = static_cast<int>( strlen( text ) );
 
-	if ( cmd_text.cursize + l >= cmd_text.maxsize )
+	if ( !Cbuf_Reserve( cmd_text, l ) )
 	{
 		Com_Print( "Cbuf_AddText: overflow\n" );
 		return;
 	}
 
-	memcpy( &cmd_text.data[cmd_text.cursize], text, l );
-	cmd_text.cursize += l;
+	Cbuf_Append( cmd_text, (const byte *)text, l );
 }
 
 /*
@@ -128,31 +236,17 @@ Adds a \n to the text
 */
 void Cbuf_InsertText( const char *text )
 {
-	int len = static_cast<int>( strlen( text ) + 1 );
-	if ( len + cmd_text.cursize > cmd_text.maxsize )
+	const int len = static_cast<int>( strlen( text ) );
+
+	if ( !Cbuf_Reserve( cmd_text, len + 1 ) )
 	{
 		Com_Print( "Cbuf_InsertText overflowed\n" );
 		return;
 	}
 
-	// move the existing command text
-	// TODO: How can this be translated to memmove or something intrinsic?
-#if 1
-	for ( int i = cmd_text.cursize - 1; i >= 0; i-- )
-	{
-		cmd_text.data[i + len] = cmd_text.data[i];
-	}
-#else
-	memmove( cmd_text.data + len, cmd_text.data, cmd_text.cursize - 1 );
-#endif
-
-	// copy the new text in
-	memcpy( cmd_text.data, text, len - 1 );
-
-	// add a \n
-	cmd_text.data[len - 1] = '\n';
-
-	cmd_text.cursize += len;
+	// goes in front of the head, the \n first so the text ends up before it
+	Cbuf_Prepend( cmd_text, (const byte *)"\n", 1 );
+	Cbuf_Prepend( cmd_text, (const byte *)text, len );
 }
 
 /*
@@ -162,9 +256,13 @@ Cbuf_CopyToDefer
 */
 void Cbuf_CopyToDefer()
 {
-	memcpy( defer_text_buf, cmd_text_buf, cmd_text.cursize );
-	defer_text_buf[cmd_text.cursize] = '\0';
-	cmd_text.cursize = '\0';
+	// the pending text keeps its buffer, new text starts over in the other one
+	const cmdQueue_t pending = cmd_text;
+	cmd_text = cmd_defer;
+	cmd_defer = pending;
+
+	cmd_text.head = 0;
+	cmd_text.size = 0;
 }
 
 /*
@@ -174,8 +272,23 @@ Cbuf_InsertFromDefer
 */
 void Cbuf_InsertFromDefer()
 {
-	Cbuf_InsertText( (char*)defer_text_buf );
-	defer_text_buf[0] = '\0';
+	if ( !Cbuf_Reserve( cmd_text, cmd_defer.size + 1 ) )
+	{
+		Com_Print( "Cbuf_InsertText overflowed\n" );
+	}
+	else
+	{
+		// the deferred text can wrap around the end of its ring, the back part goes in first
+		const int start = cmd_defer.head;
+		const int first = Min( cmd_defer.size, cmd_defer.capacity - start );
+
+		Cbuf_Prepend( cmd_text, (const byte *)"\n", 1 );
+		Cbuf_Prepend( cmd_text, cmd_defer.data, cmd_defer.size - first );
+		Cbuf_Prepend( cmd_text, cmd_defer.data + start, first );
+	}
+
+	cmd_defer.size = 0;
+	Cbuf_Release( cmd_defer );
 }
 
 /*
@@ -186,13 +299,12 @@ Cbuf_Execute
 void Cbuf_Execute()
 {
 	int		i;
-	char	*text;
 	char	line[MAX_CMD_LINE];
 	int		quotes;
 
 	alias_count = 0;		// don't allow infinite alias loops
 
-	while ( cmd_text.cursize )
+	while ( cmd_text.size )
 	{
 		if ( cmd_wait ) {
 			// skip out while text still remains in buffer, leaving it
@@ -202,48 +314,42 @@ void Cbuf_Execute()
 		}
 
 		// find a \n or ; line break
-		text = (char *)cmd_text.data;
+		const byte *text = cmd_text.data;
+		const int mask = cmd_text.capacity - 1;
 
 		quotes = 0;
-		for ( i = 0; i < cmd_text.cursize; i++ )
+		for ( i = 0; i < cmd_text.size; i++ )
 		{
-			if ( text[i] == '"' ) {
+			const byte c = text[( cmd_text.head + i ) & mask];
+			if ( c == '"' ) {
 				quotes++;
 			}
-			if ( !( quotes & 1 ) && text[i] == ';' ) {
+			if ( !( quotes & 1 ) && c == ';' ) {
 				// don't break if inside a quoted string
 				break;
 			}
-			if ( text[i] == '\n' ) {
+			if ( c == '\n' ) {
 				break;
 			}
 		}
 
-		if ( i >= ( MAX_CMD_LINE - 1 ) ) {
-			i = MAX_CMD_LINE - 1;
-		}
-
-		memcpy( line, text, i );
-		line[i] = '\0';
-
-		// delete the text from the command buffer and move remaining commands down
-		// this is necessary because commands (exec, alias) can insert data at the
-		// beginning of the text buffer
+		const int length = Min( i, MAX_CMD_LINE - 1 );
+		Cbuf_Read( cmd_text, 0, (byte *)line, length );
+		line[length] = '\0';
 
-		if ( i == cmd_text.cursize )
-		{
-			cmd_text.cursize = 0;
-		}
-		else
-		{
-			i++;
-			cmd_text.cursize -= i;
-			memmove( text, text + i, cmd_text.cursize );
-		}
+		// take the line off the front before running it, commands (exec, alias)
+		// can insert text in front of whatever is left
+		const int consumed = Min( i + 1, cmd_text.size );
+		cmd_text.head = ( cmd_text.head + consumed ) & mask;
+		cmd_text.size -= consumed;
 
 		// execute the command line
 		Cmd_ExecuteString( line );
 	}
+
+	if ( !cmd_text.size ) {
+		Cbuf_Release( cmd_text );
+	}
 }
 
 /*
@@ -398,6 +504,37 @@ static void Cmd_Echo_f()
 	Com_Print( "\n" );
 }
 
+/*
+========================
+Cmd_IsSingleCommand
+
+True if the text would come out of the command buffer as one line that doesn't need
+macro expanding, so it can be tokenized once and kept
+========================
+*/
+static bool Cmd_IsSingleCommand( const char *text )
+{
+	bool inquote = false;
+
+	for ( const char *s = text; *s; ++s )
+	{
+		if ( *s == '"' ) {
+			inquote ^= true;
+		}
+		else if ( *s == '$' ) {
+			return false;
+		}
+		else if ( *s == ';' && !inquote ) {
+			return false;
+		}
+		else if ( *s == '\n' && s[1] ) {
+			return false;
+		}
+	}
+
+	return !inquote;
+}
+
 /*
 ========================
 Cmd_Alias_f
@@ -433,6 +570,11 @@ static void Cmd_Alias_f()
 		if ( Q_stricmp( aliasName, pAlias->name ) == 0 )
 		{
 			Mem_Free( pAlias->pValue );
+			if ( pAlias->pTokens )
+			{
+				Mem_Free( pAlias->pTokens );
+				pAlias->pTokens = nullptr;
+			}
 			break;
 		}
 	}
@@ -459,6 +601,7 @@ static void Cmd_Alias_f()
 	strcat( cmd, "\n" );
 
 	pAlias->pValue = Mem_CopyString( cmd );
+	pAlias->single = Cmd_IsSingleCommand( cmd );
 }
 
 /*
@@ -473,13 +616,66 @@ static int		cmd_argc;
 static char *	cmd_argv[MAX_STRING_TOKENS];
 static char		cmd_args[MAX_STRING_CHARS];
 
+// the tokens of the current command back to back, cmd_argv points in here
+static char		cmd_tokens[MAX_STRING_TOKENS * ( MAX_TOKEN_CHARS + 1 )];
+static int		cmd_tokensLength;
+
 // possible commands to execute
 cmdFunction_t *cmd_functions;
 
+// cmd_functions by name, every executed line looks itself up here before
+// trying aliases and cvars. Removed commands leave cmd_hashRemoved behind
+#define	CMD_HASH_SIZE	2048		// power of two
+
+static cmdFunction_t *	cmd_hashTable[CMD_HASH_SIZE];
+static cmdFunction_t	cmd_hashRemoved;
+static bool				cmd_hashFull;	// look through the list instead
+
 static void Cmd_Add( cmdFunction_t *pCmd )
 {
 	pCmd->pNext = cmd_functions;
 	cmd_functions = pCmd;
+
+	uint32 slot = HashStringInsensitive( pCmd->pName );
+	for ( int i = 0; i < CMD_HASH_SIZE; ++i, ++slot )
+	{
+		cmdFunction_t *&entry = cmd_hashTable[slot & ( CMD_HASH_SIZE - 1 )];
+		if ( !entry || entry == &cmd_hashRemoved )
+		{
+			entry = pCmd;
+			return;
+		}
+	}
+
+	cmd_hashFull = true;
+}
+
+static cmdFunction_t *Cmd_Find( const char *cmd_name )
+{
+	if ( cmd_hashFull )
+	{
+		for ( cmdFunction_t *pCmd = cmd_functions; pCmd; pCmd = pCmd->pNext )
+		{
+			if ( Q_stricmp( cmd_name, pCmd->pName ) == 0 ) {
+				return pCmd;
+			}
+		}
+		return nullptr;
+	}
+
+	uint32 slot = HashStringInsensitive( cmd_name );
+	for ( int i = 0; i < CMD_HASH_SIZE; ++i, ++slot )
+	{
+		cmdFunction_t *pCmd = cmd_hashTable[slot & ( CMD_HASH_SIZE - 1 )];
+		if ( !pCmd ) {
+			break;
+		}
+		if ( pCmd != &cmd_hashRemoved && Q_stricmp( cmd_name, pCmd->pName ) == 0 ) {
+			return pCmd;
+		}
+	}
+
+	return nullptr;
 }
 
 /*
@@ -605,12 +801,9 @@ $Cvars will be expanded unless they are in a quoted token
 void Cmd_TokenizeString( char *text, bool macroExpand )
 {
 	// clear the args from the last string
-	for ( int i = 0; i < cmd_argc; i++ ) {
-		Mem_Free( cmd_argv[i] );
-	}
-
 	cmd_argc = 0;
 	cmd_args[0] = 0;
+	cmd_tokensLength = 0;
 
 	// macro expand the text
 	if ( macroExpand ) {
@@ -642,7 +835,7 @@ void Cmd_TokenizeString( char *text, bool macroExpand )
 		// set cmd_args to everything after the first arg
 		if ( cmd_argc == 1 )
 		{
-			strcpy( cmd_args, text );
+			Q_strcpy_s( cmd_args, text );
 
 			// strip off any trailing whitespace
 			int l = static_cast<int>( strlen( cmd_args ) - 1 );
@@ -656,19 +849,73 @@ void Cmd_TokenizeString( char *text, bool macroExpand )
 			}
 		}
 
-		const char *com_token = COM_Parse( &text );
+		// parse straight into the token buffer, anything past the last
+		// argument still has to be read over but isn't kept
+		char discard[MAX_TOKEN_CHARS + 1];
+		char *token = cmd_argc < MAX_STRING_TOKENS ? cmd_tokens + cmd_tokensLength : discard;
+
+		COM_Parse2( &text, &token, MAX_TOKEN_CHARS );
 		if ( !text ) {
 			return;
 		}
 
 		if ( cmd_argc < MAX_STRING_TOKENS )
 		{
-			cmd_argv[cmd_argc] = Mem_CopyString( com_token );
+			cmd_argv[cmd_argc] = token;
 			cmd_argc++;
+			cmd_tokensLength += static_cast<int>( strlen( token ) + 1 );
 		}
 	}
 }
 
+/*
+========================
+Cmd_SaveTokens
+
+Copies the current arguments into one block that Cmd_LoadTokens can bring back
+========================
+*/
+static cmdTokenCache_t *Cmd_SaveTokens()
+{
+	const int argsLength = static_cast<int>( strlen( cmd_args ) + 1 );
+
+	cmdTokenCache_t *cache = (cmdTokenCache_t *)Mem_Alloc( sizeof( cmdTokenCache_t ) + argsLength + cmd_tokensLength );
+	cache->argc = cmd_argc;
+	cache->argsLength = argsLength;
+	cache->tokensLength = cmd_tokensLength;
+
+	char *text = (char *)( cache + 1 );
+	memcpy( text, cmd_args, argsLength );
+	memcpy( text + argsLength, cmd_tokens, cmd_tokensLength );
+
+	return cache;
+}
+
+/*
+========================
+Cmd_LoadTokens
+
+The tokens are copied out rather than pointed at, the command
+they're for is free to redefine the alias they came from
+========================
+*/
+static void Cmd_LoadTokens( const cmdTokenCache_t *cache )
+{
+	const char *text = (const char *)( cache + 1 );
+	memcpy( cmd_args, text, cache->argsLength );
+	memcpy( cmd_tokens, text + cache->argsLength, cache->tokensLength );
+
+	cmd_argc = cache->argc;
+	cmd_tokensLength = cache->tokensLength;
+
+	char *token = cmd_tokens;
+	for ( int i = 0; i < cmd_argc; ++i )
+	{
+		cmd_argv[i] = token;
+		token += strlen( token ) + 1;
+	}
+}
+
 /*
 ========================
 Cmd_AddCommand
@@ -683,16 +930,12 @@ void Cmd_AddCommand( const char *cmd_name, xcommand_t function, const char *help
 		return;
 	}
 
-	cmdFunction_t *pCmd;
-
 	// fail if the command already exists
-	for ( pCmd = cmd_functions; pCmd; pCmd = pCmd->pNext )
+	cmdFunction_t *pCmd = Cmd_Find( cmd_name );
+	if ( pCmd )
 	{
-		if ( Q_stricmp( cmd_name, pCmd->pName ) == 0 )
-		{
-			Com_Printf( "Cmd_AddCommand: %s already defined as %s\n", cmd_name, pCmd->pName );
-			return;
-		}
+		Com_Printf( "Cmd_AddCommand: %s already defined as %s\n", cmd_name, pCmd->pName );
+		return;
 	}
 
 	pCmd = (cmdFunction_t *)Mem_Alloc( sizeof( cmdFunction_t ) );
@@ -726,6 +969,12 @@ void Cmd_RemoveCommand( const char *cmd_name )
 		if ( Q_stricmp( cmd_name, pCmd->pName ) == 0 )
 		{
 			*ppBack = pCmd->pNext;
+			for ( cmdFunction_t *&entry : cmd_hashTable )
+			{
+				if ( entry == pCmd ) {
+					entry = &cmd_hashRemoved;
+				}
+			}
 			Mem_Free( pCmd );
 			return;
 		}
@@ -740,14 +989,7 @@ Cmd_Exists
 */
 bool Cmd_Exists( const char *cmd_name )
 {
-	for ( cmdFunction_t *cmd = cmd_functions; cmd; cmd = cmd->pNext )
-	{
-		if ( Q_stricmp( cmd_name, cmd->pName ) == 0 ) {
-			return true;
-		}
-	}
-
-	return false;
+	return Cmd_Find( cmd_name ) != nullptr;
 }
 
 /*
@@ -833,15 +1075,13 @@ static bool Cmd_ExecuteCvar()
 
 /*
 ========================
-Cmd_ExecuteString
+Cmd_Dispatch
 
-A complete command line has been parsed, so try to execute it
+Runs the command that has been tokenized from text
 ========================
 */
-void Cmd_ExecuteString( char *text )
+static void Cmd_Dispatch( const char *text )
 {
-	Cmd_TokenizeString( text, true );
-
 	// execute the command line
 	if ( !Cmd_Argc() ) {
 		// no tokens
@@ -849,23 +1089,21 @@ void Cmd_ExecuteString( char *text )
 	}
 
 	// check functions
-	for ( cmdFunction_t *pCmd = cmd_functions; pCmd; pCmd = pCmd->pNext )
+	cmdFunction_t *pCmd = Cmd_Find( cmd_argv[0] );
+	if ( pCmd )
 	{
-		if ( !Q_stricmp( cmd_argv[0], pCmd->pName ) )
+		if ( !pCmd->pFunction )
 		{
-			if ( !pCmd->pFunction )
-			{
-				// forward to server command
+			// forward to server command
 #ifdef Q_ENGINE
-				Cmd_ExecuteString( va( "cmd %s", text ) );
+			Cmd_ExecuteString( va( "cmd %s", text ) );
 #endif
-			}
-			else
-			{
-				pCmd->pFunction();
-			}
-			return;
 		}
+		else
+		{
+			pCmd->pFunction();
+		}
+		return;
 	}
 
 	// check alias
@@ -878,6 +1116,27 @@ void Cmd_ExecuteString( char *text )
 				Com_Print( "ALIAS_LOOP_COUNT\n" );
 				return;
 			}
+			if ( pAlias->single )
+			{
+				// run it from its tokens instead of putting the text back
+				// in the buffer to be split up and parsed again, the line is
+				// what the buffer would have handed over, without the newline
+				char line[MAX_CMD_LINE];
+				Q_strcpy_s( line, pAlias->pValue );
+				line[strcspn( line, "\n" )] = '\0';
+
+				if ( pAlias->pTokens )
+				{
+					Cmd_LoadTokens( pAlias->pTokens );
+				}
+				else
+				{
+					Cmd_TokenizeString( line, false );
+					pAlias->pTokens = Cmd_SaveTokens();
+				}
+				Cmd_Dispatch( line );
+				return;
+			}
 			Cbuf_InsertText( pAlias->pValue );
 			return;
 		}
@@ -896,6 +1155,20 @@ void Cmd_ExecuteString( char *text )
 #endif
 }
 
+/*
+========================
+Cmd_ExecuteString
+
+A complete command line has been parsed, so try to execute it
+========================
+*/
+void Cmd_ExecuteString( char *text )
+{
+	Cmd_TokenizeString( text, true );
+
+	Cmd_Dispatch( text );
+}
+
 /*
 ========================
 Cmd_List_f
@@ -911,6 +1184,99 @@ static void Cmd_List_f()
 	Com_Printf( "%d commands\n", i );
 }
 
+static void Cmd_BenchNop_f()
+{
+}
+
+/*
+========================
+Cmd_BenchExec_f
+
+Times a generated config going through the command buffer, and a single command
+alias being run over and over
+========================
+*/
+static void Cmd_BenchExec_f()
+{
+	const int lines = Cmd_Argc() > 1 ? Clamp( Q_atoi( Cmd_Argv( 1 ) ), 1, 1000000 ) : 100000;
+
+	// a mix of what configs are made of
+	static const char *const templates[] =
+	{
+		"set cmd_benchVar %d\n",
+		"cmd_benchNop \"quoted argument\" %d // a comment\n",
+		"cmd_benchVar %d\n",
+		"cmd_benchNop $cmd_benchVar ; cmd_benchNop %d three\n",
+		"alias cmd_benchAlias%d \"cmd_benchNop a b c\"\n",
+	};
+
+	const int textSize = lines * 64 + 64;
+	char *text = (char *)Mem_Alloc( textSize );
+	int textLength = Q_sprintf_s( text, textSize, "alias cmd_benchAlias \"cmd_benchNop a b c\"\n" );
+	for ( int i = 0; i < lines; ++i )
+	{
+		const int value = ( i * 7919 ) & 7;
+		textLength += Q_sprintf_s( text + textLength, textSize - textLength, templates[i % countof( templates )], value );
+	}
+
+	// run it in a queue of its own, this is called from inside Cbuf_Execute
+	const cmdQueue_t saved = cmd_text;
+	const int savedWait = cmd_wait;
+	const int savedAliasCount = alias_count;
+	Cbuf_Reset( cmd_text, nullptr );
+	cmd_wait = 0;
+
+	Cmd_AddCommand( "cmd_benchNop", Cmd_BenchNop_f );
+
+	int64 start = Time_Microseconds();
+	Cbuf_AddText( text );
+	Cbuf_Execute();
+	const int64 execTime = Time_Microseconds() - start;
+
+	const int aliasRuns = lines;
+	char aliasLine[] = "cmd_benchAlias";
+
+	start = Time_Microseconds();
+	for ( int i = 0; i < aliasRuns; ++i )
+	{
+		alias_count = 0;
+		Cmd_ExecuteString( aliasLine );
+		Cbuf_Execute();
+	}
+	const int64 aliasTime = Time_Microseconds() - start;
+
+	Com_Printf( "%d lines (%d KB) in %.2f ms, %.0f lines/s\n", lines, textLength / 1024,
+		execTime * 0.001, lines / Max( execTime * 0.000001, 0.000001 ) );
+	Com_Printf( "%d alias runs in %.2f ms, %.0f ns each\n", aliasRuns, aliasTime * 0.001,
+		aliasTime * 1000.0 / aliasRuns );
+
+	// clean up after ourselves
+	Cmd_RemoveCommand( "cmd_benchNop" );
+	for ( cmdAlias_t **ppAlias = &cmd_alias; *ppAlias; )
+	{
+		cmdAlias_t *pAlias = *ppAlias;
+		if ( Q_strnicmp( pAlias->name, "cmd_benchAlias", 14 ) != 0 )
+		{
+			ppAlias = &pAlias->pNext;
+			continue;
+		}
+		*ppAlias = pAlias->pNext;
+		Mem_Free( pAlias->pValue );
+		if ( pAlias->pTokens ) {
+			Mem_Free( pAlias->pTokens );
+		}
+		Mem_Free( pAlias );
+	}
+
+	cmd_text.size = 0;
+	Cbuf_Release( cmd_text );
+	cmd_text = saved;
+	cmd_wait = savedWait;
+	alias_count = savedAliasCount;
+
+	Mem_Free( text );
+}
+
 /*
 ========================
 Cmd_Init
@@ -923,6 +1289,7 @@ void Cmd_Init()
 	Cmd_AddCommand( "echo", Cmd_Echo_f, "Prints arguments to the console." );
 	Cmd_AddCommand( "alias", Cmd_Alias_f, "Creates a command alias." );
 	Cmd_AddCommand( "wait", Cmd_Wait_f, "Defers script execution until the next frame." );
+	Cmd_AddCommand( "cmd_benchExec", Cmd_BenchExec_f, "Times a generated config of [lines] going through the command buffer." );
 }
 
 /*
@@ -942,23 +1309,25 @@ void Cmd_Shutdown()
 		}
 		cmd_functions = pNext;
 	}
+	memset( cmd_hashTable, 0, sizeof( cmd_hashTable ) );
+	cmd_hashFull = false;
 
 	// Clean up aliases
 	while ( cmd_alias )
 	{
 		cmdAlias_t *pNext = cmd_alias->pNext;
 		Mem_Free( cmd_alias->pValue );
+		if ( cmd_alias->pTokens ) {
+			Mem_Free( cmd_alias->pTokens );
+		}
 		Mem_Free( cmd_alias );
 		cmd_alias = pNext;
 	}
 
 	// Clean up the argc
-	for ( int i = 0; i < cmd_argc; ++i ) {
-		Mem_Free( cmd_argv[i] );
-		cmd_argv[i] = nullptr;
-	}
 	cmd_argc = 0;
 	cmd_args[0] = 0;
+	cmd_tokensLength = 0;
 }
 
 /*
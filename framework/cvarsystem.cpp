@@ -23,6 +23,16 @@ cvar_t *cvar_vars;
 
 bool userinfo_modified;
 
+// bumped whenever an info cvar changes, so the info strings are only rebuilt when they need to be
+static uint32 cvar_infoSequence = 1;
+
+static void Cvar_InfoModified( const cvar_t *var )
+{
+	if ( var->flags & ( CVAR_USERINFO | CVAR_SERVERINFO ) ) {
+		++cvar_infoSequence;
+	}
+}
+
 static bool Cvar_InfoValidate( const char *s )
 {
 	if ( strstr( s, "\\" ) ) {
@@ -50,12 +60,14 @@ static void Cvar_SetValueWork( cvar_t *var, const char *newValue )
 		var->value.assign( var->minVal );
 		var->fltValue = min;
 		var->intValue = static_cast<int>( min );
+		Cvar_InfoModified( var );
 		return;
 	}
 	else if ( newFltValue > max ) {
 		var->value.assign( var->maxVal );
 		var->fltValue = max;
 		var->intValue = static_cast<int>( max );
+		Cvar_InfoModified( var );
 		return;
 	}
 
@@ -63,6 +75,8 @@ static void Cvar_SetValueWork( cvar_t *var, const char *newValue )
 	var->value.assign( newValue );
 	var->fltValue = newFltValue;
 	var->intValue = newIntValue;
+
+	Cvar_InfoModified( var );
 }
 
 static void Cvar_Add( cvar_t *var )
@@ -159,6 +173,7 @@ cvar_t *Cvar_Get( const char *name, const char *value, uint32 flags, const char
 			}
 		}
 		var->flags |= flags;
+		Cvar_InfoModified( var );
 		return var;
 	}
 
@@ -194,6 +209,7 @@ cvar_t *Cvar_Get( const char *name, const char *value, uint32 flags, const char
 	Cvar_Add( var );
 
 	var->flags = flags;
+	Cvar_InfoModified( var );
 
 	// all newly created vars are "modified"
 	var->SetModified();
@@ -361,7 +377,10 @@ void Cvar_FullSet( const char *name, const char *value, uint32 flags )
 		return;
 	}
 
+	// dropping the info flags changes the info strings too
+	Cvar_InfoModified( var );
 	var->flags = flags;
+	Cvar_InfoModified( var );
 
 	Cvar_Set_Internal( var, value, true );
 }
@@ -475,6 +494,8 @@ void Cvar_GetLatchedVars()
 		// HACK HACK HACK: LATCHED VARS HAVE GOT TO GO!!!!
 		var->fltValue = Q_atof( var->value.c_str() );
 		var->intValue = Q_atoi( var->value.c_str() );
+
+		Cvar_InfoModified( var );
 	}
 }
 
@@ -579,30 +600,53 @@ void Cvar_AddEarlyCommands( int argc, char **argv )
 
 #ifdef Q_ENGINE
 
-static char *Cvar_BitInfo( uint32 bit )
+struct cvarInfoCache_t
+{
+	InfoMap		info;
+	char		string[MAX_INFO_STRING + 1];
+	uint32		sequence;
+};
+
+static cvarInfoCache_t cvar_userinfo;
+static cvarInfoCache_t cvar_serverinfo;
+
+// The info strings are asked for every time a client connects or a server is queried,
+// only walk the cvar list when an info cvar has changed since the last time
+static char *Cvar_BitInfo( cvarInfoCache_t &cache, uint32 bit )
 {
-	static char info[MAX_INFO_STRING];
+	if ( cache.sequence == cvar_infoSequence ) {
+		return cache.string;
+	}
 
-	info[0] = 0;
+	cache.info.Clear();
 
 	for ( cvar_t *var = cvar_vars; var; var = var->pNext )
 	{
 		if ( var->flags & bit ) {
-			Info_SetValueForKey( info, var->name.c_str(), var->value.c_str() );
+			cache.info.Set( var->name.c_str(), var->value.c_str() );
 		}
 	}
 
-	return info;
+	// callers get a writable copy like they always have
+	Q_strcpy_s( cache.string, cache.info.String() );
+	cache.sequence = cvar_infoSequence;
+
+	return cache.string;
 }
 
 char *Cvar_Userinfo()
 {
-	return Cvar_BitInfo( CVAR_USERINFO );
+	return Cvar_BitInfo( cvar_userinfo, CVAR_USERINFO );
 }
 
 char *Cvar_Serverinfo()
 {
-	return Cvar_BitInfo( CVAR_SERVERINFO );
+	return Cvar_BitInfo( cvar_serverinfo, CVAR_SERVERINFO );
+}
+
+uint32 Cvar_InfoSequence()
+{
+	return cvar_infoSequence;
 }
 
 #endif
@@ -873,6 +917,8 @@ void Cvar_Init()
 
 void Cvar_Shutdown()
 {
+	++cvar_infoSequence;
+
 	while ( cvar_vars )
 	{
 		cvar_t *pNext = cvar_vars->pNext;
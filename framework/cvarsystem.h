@@ -100,6 +100,8 @@ void		Cvar_AddEarlyCommands( int argc, char **argv );
 char *		Cvar_Userinfo();
 			// returns an info string containing all the CVAR_SERVERINFO cvars
 char *		Cvar_Serverinfo();
+			// changes whenever either of the strings above would, for caching things built from them
+uint32		Cvar_InfoSequence();
 #endif
 
 void		Cvar_Init();
@@ -513,6 +513,16 @@ void RemoveFile( const char *filename )
 	Sys_DeleteFile( fullPath );
 }
 
+bool RenameFile( const char *oldName, const char *newName )
+{
+	char oldPath[MAX_OSPATH];
+	char newPath[MAX_OSPATH];
+	Q_sprintf_s( oldPath, "%s/%s/%s", fs.writeDir, fs.modDir, oldName );
+	Q_sprintf_s( newPath, "%s/%s/%s", fs.writeDir, fs.modDir, newName );
+
+	return Sys_RenameFile( oldPath, newPath );
+}
+
 //=============================================================================
 
 const char *FindFirst( const char *wildcard, fsPath_t fsPath /*= FS_GAMEDIR*/ )
@@ -71,6 +71,8 @@ namespace FileSystem
 	bool			FileExists( const char *filename, fsPath_t fsPath = FS_GAMEDIR );
 					// Deletes a file from the write directory. Only named Remove because win32 steals DeleteFile.
 	void			RemoveFile( const char *filename );
+					// Renames a file in the write directory, replacing newName if it exists.
+	bool			RenameFile( const char *oldName, const char *newName );
 
 	const char *	FindFirst( const char *wildcard, fsPath_t fsPath = FS_GAMEDIR );
 	const char *	FindNext();
@@ -133,6 +135,9 @@ public:
 	fsSize_t WriteFile( const void *buffer, fsSize_t length, fsHandle_t handle ) override
 	{ return FileSystem::WriteFile( buffer, length, handle ); }
 
+	fsSize_t GetFileSize( fsHandle_t handle ) override
+	{ return FileSystem::GetFileSize( handle ); }
+
 	void PrintFile( const char *string, fsHandle_t handle ) override
 	{ FileSystem::PrintFile( string, handle ); }
 
@@ -8,6 +8,11 @@
 
 #include "cg_local.h"
 
+#if defined __SSE2__ || defined _M_X64
+#define CG_PARTICLE_SIMD
+#include <immintrin.h>
+#endif
+
 #define	BEAMLENGTH	16
 
 void CL_LogoutEffect (vec3_t org, int type);
@@ -843,31 +848,130 @@ void CL_AddDLights()
 
 	Particle management
 
+	Live particles are kept as a structure of arrays so CL_AddParticles can
+	update eight of them at a time, and a dead one is removed by moving the
+	last one into its place. The effects fill in a cparticle_t as before,
+	those are collected in s_newParticles and moved into the arrays in
+	batches. The particles that survive the update are handed to the
+	renderer in one go.
+
 ===============================================================================
 */
 
-cparticle_t		*active_particles, *free_particles;
+#define MAX_NEW_PARTICLES	1024
 
-// SlartTodo: Make this cl_particles
-cparticle_t		particles[MAX_PARTICLES];
+struct particleStore_t
+{
+	alignas( 32 ) float	time[MAX_PARTICLES];
+	alignas( 32 ) float	orgX[MAX_PARTICLES];
+	alignas( 32 ) float	orgY[MAX_PARTICLES];
+	alignas( 32 ) float	orgZ[MAX_PARTICLES];
+	alignas( 32 ) float	velX[MAX_PARTICLES];
+	alignas( 32 ) float	velY[MAX_PARTICLES];
+	alignas( 32 ) float	velZ[MAX_PARTICLES];
+	alignas( 32 ) float	accelX[MAX_PARTICLES];
+	alignas( 32 ) float	accelY[MAX_PARTICLES];
+	alignas( 32 ) float	accelZ[MAX_PARTICLES];
+	alignas( 32 ) float	color[MAX_PARTICLES];
+	alignas( 32 ) float	alpha[MAX_PARTICLES];
+	alignas( 32 ) float	alphavel[MAX_PARTICLES];
+
+	int					count;
+};
+
+// Where each particle is this frame, worked out by the update
+struct particleWork_t
+{
+	alignas( 32 ) float	x[MAX_PARTICLES];
+	alignas( 32 ) float	y[MAX_PARTICLES];
+	alignas( 32 ) float	z[MAX_PARTICLES];
+	alignas( 32 ) float	alpha[MAX_PARTICLES];
+};
+
+static particleStore_t	s_particles;
+static particleWork_t	s_particleWork;
+static particle_t		s_renderParticles[MAX_PARTICLES];
+
+static cparticle_t		s_newParticles[MAX_NEW_PARTICLES];
+static int				s_numNewParticles;
+static cparticle_t		s_discardParticle;		// handed out when there's no room
 
 /*
 ===================
-CL_ClearParticles
+CL_FlushNewParticles
+
+Moves the particles the effects have made into the store
 ===================
 */
-static void CL_ClearParticles()
+static void CL_FlushNewParticles()
 {
-	int i;
-
-	free_particles = &particles[0];
-	active_particles = NULL;
+	particleStore_t &s = s_particles;
 
-	for ( i = 0; i < MAX_PARTICLES; i++ )
+	for ( int i = 0; i < s_numNewParticles; i++ )
 	{
-		particles[i].next = &particles[i + 1];
+		const cparticle_t &p = s_newParticles[i];
+		const int n = s.count++;
+
+		s.time[n] = p.time;
+		s.orgX[n] = p.org[0];
+		s.orgY[n] = p.org[1];
+		s.orgZ[n] = p.org[2];
+		s.velX[n] = p.vel[0];
+		s.velY[n] = p.vel[1];
+		s.velZ[n] = p.vel[2];
+		s.accelX[n] = p.accel[0];
+		s.accelY[n] = p.accel[1];
+		s.accelZ[n] = p.accel[2];
+		s.color[n] = p.color;
+		s.alpha[n] = p.alpha;
+		s.alphavel[n] = p.alphavel;
+	}
+
+	s_numNewParticles = 0;
+}
+
+/*
+===================
+CL_ParticlesFull
+===================
+*/
+bool CL_ParticlesFull()
+{
+	return s_particles.count + s_numNewParticles >= MAX_PARTICLES;
+}
+
+/*
+===================
+CL_AllocParticle
+
+Never returns null, if there's no room the particle is thrown away. Only
+the last particle returned is valid.
+===================
+*/
+cparticle_t *CL_AllocParticle()
+{
+	if ( CL_ParticlesFull() ) {
+		return &s_discardParticle;
 	}
-	particles[MAX_PARTICLES - 1].next = NULL;
+
+	if ( s_numNewParticles == MAX_NEW_PARTICLES ) {
+		CL_FlushNewParticles();
+	}
+
+	cparticle_t *p = &s_newParticles[s_numNewParticles++];
+	memset( p, 0, sizeof( *p ) );
+	return p;
+}
+
+/*
+===================
+CL_ClearParticles
+===================
+*/
+static void CL_ClearParticles()
+{
+	s_particles.count = 0;
+	s_numNewParticles = 0;
 }
 
 /*
@@ -885,14 +989,11 @@ void CL_ParticleEffect( vec3_t org, vec3_t dir, int color, int count )
 
 	for ( i = 0; i < count; i++ )
 	{
-		if ( !free_particles )
+		if ( CL_ParticlesFull() )
 		{
 			return;
 		}
-		p = free_particles;
-		free_particles = p->next;
-		p->next = active_particles;
-		active_particles = p;
+		p = CL_AllocParticle();
 
 		p->time = (float)cgi.time();
 		p->color = (float)( color + ( rand() & 7 ) );
@@ -925,14 +1026,11 @@ void CL_ParticleEffect2( vec3_t org, vec3_t dir, int color, int count )
 
 	for ( i = 0; i < count; i++ )
 	{
-		if ( !free_particles )
+		if ( CL_ParticlesFull() )
 		{
 			return;
 		}
-		p = free_particles;
-		free_particles = p->next;
-		p->next = active_particles;
-		active_particles = p;
+		p = CL_AllocParticle();
 
 		p->time = (float)cgi.time();
 		p->color = (float)color;
@@ -966,12 +1064,9 @@ void CL_ParticleEffect3( vec3_t org, vec3_t dir, int color, int count )
 
 	for ( i = 0; i < count; i++ )
 	{
-		if ( !free_particles )
+		if ( CL_ParticlesFull() )
 			return;
-		p = free_particles;
-		free_particles = p->next;
-		p->next = active_particles;
-		active_particles = p;
+		p = CL_AllocParticle();
 
 		p->time = (float)cgi.time();
 		p->color = (float)color;
@@ -1003,12 +1098,9 @@ void CL_TeleporterParticles( entity_state_t *ent )
 
 	for ( i = 0; i < 8; i++ )
 	{
-		if ( !free_particles )
+		if ( CL_ParticlesFull() )
 			return;
-		p = free_particles;
-		free_particles = p->next;
-		p->next = active_particles;
-		active_particles = p;
+		p = CL_AllocParticle();
 
 		p->time = (float)cgi.time();
 		p->color = 0xdb;
@@ -1042,12 +1134,9 @@ void CL_LogoutEffect( vec3_t org, int type )
 
 	for ( i = 0; i < 500; i++ )
 	{
-		if ( !free_particles )
+		if ( CL_ParticlesFull() )
 			return;
-		p = free_particles;
-		free_particles = p->next;
-		p->next = active_particles;
-		active_particles = p;
+		p = CL_AllocParticle();
 
 		p->time = (float)cgi.time();
 
@@ -1085,12 +1174,9 @@ void CL_ItemRespawnParticles( vec3_t org )
 
 	for ( i = 0; i < 64; i++ )
 	{
-		if ( !free_particles )
+		if ( CL_ParticlesFull() )
 			return;
-		p = free_particles;
-		free_particles = p->next;
-		p->next = active_particles;
-		active_particles = p;
+		p = CL_AllocParticle();
 
 		p->time = (float)cgi.time();
 
@@ -1123,12 +1209,9 @@ void CL_ExplosionParticles( vec3_t org )
 
 	for ( i = 0; i < 256; i++ )
 	{
-		if ( !free_particles )
+		if ( CL_ParticlesFull() )
 			return;
-		p = free_particles;
-		free_particles = p->next;
-		p->next = active_particles;
-		active_particles = p;
+		p = CL_AllocParticle();
 
 		p->time = (float)cgi.time();
 		p->color = (float)( 0xe0 + ( rand() & 7 ) );
@@ -1161,12 +1244,9 @@ void CL_BigTeleportParticles( vec3_t org )
 
 	for ( i = 0; i < 4096; i++ )
 	{
-		if ( !free_particles )
+		if ( CL_ParticlesFull() )
 			return;
-		p = free_particles;
-		free_particles = p->next;
-		p->next = active_particles;
-		active_particles = p;
+		p = CL_AllocParticle();
 
 		p->time = (float)cgi.time();
 
@@ -1208,12 +1288,9 @@ void CL_BlasterParticles( vec3_t org, vec3_t dir )
 	count = 40;
 	for ( i = 0; i < count; i++ )
 	{
-		if ( !free_particles )
+		if ( CL_ParticlesFull() )
 			return;
-		p = free_particles;
-		free_particles = p->next;
-		p->next = active_particles;
-		active_particles = p;
+		p = CL_AllocParticle();
 
 		p->time = (float)cgi.time();
 		p->color = 0xe0 + ( rand() & 7 );
@@ -1259,12 +1336,9 @@ void CL_BlasterTrail( vec3_t start, vec3_t end )
 	{
 		len -= dec;
 
-		if ( !free_particles )
+		if ( CL_ParticlesFull() )
 			return;
-		p = free_particles;
-		free_particles = p->next;
-		p->next = active_particles;
-		active_particles = p;
+		p = CL_AllocParticle();
 		VectorClear( p->accel );
 
 		p->time = (float)cgi.time();
@@ -1309,12 +1383,9 @@ void CL_QuadTrail( vec3_t start, vec3_t end )
 	{
 		len -= dec;
 
-		if ( !free_particles )
+		if ( CL_ParticlesFull() )
 			return;
-		p = free_particles;
-		free_particles = p->next;
-		p->next = active_particles;
-		active_particles = p;
+		p = CL_AllocParticle();
 		VectorClear( p->accel );
 
 		p->time = (float)cgi.time();
@@ -1358,12 +1429,9 @@ void CL_FlagTrail( vec3_t start, vec3_t end, float color )
 	{
 		len -= dec;
 
-		if ( !free_particles )
+		if ( CL_ParticlesFull() )
 			return;
-		p = free_particles;
-		free_particles = p->next;
-		p->next = active_particles;
-		active_particles = p;
+		p = CL_AllocParticle();
 		VectorClear( p->accel );
 
 		p->time = (float)cgi.time();
@@ -1425,16 +1493,13 @@ void CL_DiminishingTrail( vec3_t start, vec3_t end, centity_t *old, int flags )
 	{
 		len -= dec;
 
-		if ( !free_particles )
+		if ( CL_ParticlesFull() )
 			return;
 
 		// drop less particles as it flies
 		if ( ( rand() & 1023 ) < old->trailcount )
 		{
-			p = free_particles;
-			free_particles = p->next;
-			p->next = active_particles;
-			active_particles = p;
+			p = CL_AllocParticle();
 			VectorClear( p->accel );
 
 			p->time = (float)cgi.time();
@@ -1536,15 +1601,12 @@ void CL_RocketTrail( vec3_t start, vec3_t end, centity_t *old )
 	{
 		len -= dec;
 
-		if ( !free_particles )
+		if ( CL_ParticlesFull() )
 			return;
 
 		if ( ( rand() & 7 ) == 0 )
 		{
-			p = free_particles;
-			free_particles = p->next;
-			p->next = active_particles;
-			active_particles = p;
+			p = CL_AllocParticle();
 
 			VectorClear( p->accel );
 			p->time = (float)cgi.time();
@@ -1590,13 +1652,10 @@ void CL_RailTrail( vec3_t start, vec3_t end )
 
 	for ( i = 0; i < len; i++ )
 	{
-		if ( !free_particles )
+		if ( CL_ParticlesFull() )
 			return;
 
-		p = free_particles;
-		free_particles = p->next;
-		p->next = active_particles;
-		active_particles = p;
+		p = CL_AllocParticle();
 
 		p->time = (float)cgi.time();
 		VectorClear( p->accel );
@@ -1628,12 +1687,9 @@ void CL_RailTrail( vec3_t start, vec3_t end )
 	{
 		len -= dec;
 
-		if ( !free_particles )
+		if ( CL_ParticlesFull() )
 			return;
-		p = free_particles;
-		free_particles = p->next;
-		p->next = active_particles;
-		active_particles = p;
+		p = CL_AllocParticle();
 
 		p->time = (float)cgi.time();
 		VectorClear( p->accel );
@@ -1680,12 +1736,9 @@ void CL_IonripperTrail( vec3_t start, vec3_t ent )
 	{
 		len -= dec;
 
-		if ( !free_particles )
+		if ( CL_ParticlesFull() )
 			return;
-		p = free_particles;
-		free_particles = p->next;
-		p->next = active_particles;
-		active_particles = p;
+		p = CL_AllocParticle();
 		VectorClear( p->accel );
 
 		p->time = (float)cgi.time();
@@ -1739,13 +1792,10 @@ void CL_BubbleTrail( vec3_t start, vec3_t end )
 
 	for ( i = 0; i < len; i += dec )
 	{
-		if ( !free_particles )
+		if ( CL_ParticlesFull() )
 			return;
 
-		p = free_particles;
-		free_particles = p->next;
-		p->next = active_particles;
-		active_particles = p;
+		p = CL_AllocParticle();
 
 		VectorClear( p->accel );
 		p->time = (float)cgi.time();
@@ -1806,12 +1856,9 @@ void CL_FlyParticles( vec3_t origin, int count )
 		forward[1] = cp * sy;
 		forward[2] = -sp;
 
-		if ( !free_particles )
+		if ( CL_ParticlesFull() )
 			return;
-		p = free_particles;
-		free_particles = p->next;
-		p->next = active_particles;
-		active_particles = p;
+		p = CL_AllocParticle();
 
 		p->time = (float)cgi.time();
 
@@ -1906,12 +1953,9 @@ void CL_BfgParticles( entity_t *ent )
 		forward[1] = cp * sy;
 		forward[2] = -sp;
 
-		if ( !free_particles )
+		if ( CL_ParticlesFull() )
 			return;
-		p = free_particles;
-		free_particles = p->next;
-		p->next = active_particles;
-		active_particles = p;
+		p = CL_AllocParticle();
 
 		p->time = (float)cgi.time();
 
@@ -1968,12 +2012,9 @@ void CL_TrapParticles( entity_t *ent )
 	{
 		len -= dec;
 
-		if ( !free_particles )
+		if ( CL_ParticlesFull() )
 			return;
-		p = free_particles;
-		free_particles = p->next;
-		p->next = active_particles;
-		active_particles = p;
+		p = CL_AllocParticle();
 		VectorClear( p->accel );
 
 		p->time = (float)cgi.time();
@@ -2008,12 +2049,9 @@ void CL_TrapParticles( entity_t *ent )
 			{
 				for ( k = -2; k <= 4; k += 4 )
 				{
-					if ( !free_particles )
+					if ( CL_ParticlesFull() )
 						return;
-					p = free_particles;
-					free_particles = p->next;
-					p->next = active_particles;
-					active_particles = p;
+					p = CL_AllocParticle();
 
 					p->time = (float)cgi.time();
 					p->color = 0xe0 + ( rand() & 3 );
@@ -2055,12 +2093,9 @@ void CL_BFGExplosionParticles( vec3_t org )
 
 	for ( i = 0; i < 256; i++ )
 	{
-		if ( !free_particles )
+		if ( CL_ParticlesFull() )
 			return;
-		p = free_particles;
-		free_particles = p->next;
-		p->next = active_particles;
-		active_particles = p;
+		p = CL_AllocParticle();
 
 		p->time = (float)cgi.time();
 		p->color = (float)( 0xd0 + ( rand() & 7 ) );
@@ -2097,12 +2132,9 @@ void CL_TeleportParticles( vec3_t org )
 		{
 			for ( k = -16; k <= 32; k += 4 )
 			{
-				if ( !free_particles )
+				if ( CL_ParticlesFull() )
 					return;
-				p = free_particles;
-				free_particles = p->next;
-				p->next = active_particles;
-				active_particles = p;
+				p = CL_AllocParticle();
 
 				p->time = (float)cgi.time();
 				p->color = (float)( 7 + ( rand() & 7 ) );
@@ -2131,72 +2163,148 @@ void CL_TeleportParticles( vec3_t org )
 
 /*
 ===================
-CL_AddParticles
+CL_UpdateParticles
+
+Works out where the particles are at time and how faded they are, anything
+at or below zero alpha has faded out. Instant particles don't move or fade.
 ===================
 */
-void CL_AddParticles()
+static void CL_UpdateParticles( float time )
 {
-	cparticle_t		*p, *next;
-	float			alpha;
-	float			time, time2;
-	vec3_t			org;
-	int				color;
-	cparticle_t		*active, *tail;
-
-	active = NULL;
-	tail = NULL;
+	const particleStore_t &s = s_particles;
+	particleWork_t &w = s_particleWork;
+	int i = 0;
 
-	for ( p = active_particles; p; p = next )
+#ifdef CG_PARTICLE_SIMD
+#ifdef __AVX2__
 	{
-		next = p->next;
+		const __m256 now = _mm256_set1_ps( time );
+		const __m256 msec = _mm256_set1_ps( 0.001f );
+		const __m256 instant = _mm256_set1_ps( INSTANT_PARTICLE );
+		const __m256 one = _mm256_set1_ps( 1.0f );
 
-		// PMM - added INSTANT_PARTICLE handling for heat beam
-		if ( p->alphavel != INSTANT_PARTICLE )
+		for ( ; i + 8 <= s.count; i += 8 )
 		{
-			time = ( cgi.time() - p->time ) * 0.001f;
-			alpha = p->alpha + time * p->alphavel;
-			if ( alpha <= 0 )
-			{	// faded out
-				p->next = free_particles;
-				free_particles = p;
-				continue;
-			}
-		}
-		else
-		{
-			time = 0;
-			alpha = p->alpha;
+			const __m256 alphavel = _mm256_load_ps( s.alphavel + i );
+
+			__m256 t = _mm256_mul_ps( _mm256_sub_ps( now, _mm256_load_ps( s.time + i ) ), msec );
+			t = _mm256_andnot_ps( _mm256_cmp_ps( alphavel, instant, _CMP_EQ_OQ ), t );
+			const __m256 t2 = _mm256_mul_ps( t, t );
+
+			const __m256 alpha = _mm256_add_ps( _mm256_load_ps( s.alpha + i ), _mm256_mul_ps( t, alphavel ) );
+			_mm256_store_ps( w.alpha + i, _mm256_min_ps( alpha, one ) );
+
+			_mm256_store_ps( w.x + i, _mm256_add_ps( _mm256_add_ps( _mm256_load_ps( s.orgX + i ), _mm256_mul_ps( _mm256_load_ps( s.velX + i ), t ) ), _mm256_mul_ps( _mm256_load_ps( s.accelX + i ), t2 ) ) );
+			_mm256_store_ps( w.y + i, _mm256_add_ps( _mm256_add_ps( _mm256_load_ps( s.orgY + i ), _mm256_mul_ps( _mm256_load_ps( s.velY + i ), t ) ), _mm256_mul_ps( _mm256_load_ps( s.accelY + i ), t2 ) ) );
+			_mm256_store_ps( w.z + i, _mm256_add_ps( _mm256_add_ps( _mm256_load_ps( s.orgZ + i ), _mm256_mul_ps( _mm256_load_ps( s.velZ + i ), t ) ), _mm256_mul_ps( _mm256_load_ps( s.accelZ + i ), t2 ) ) );
 		}
+	}
+#endif
 
-		p->next = NULL;
-		if ( !tail )
-			active = tail = p;
-		else
+	{
+		const __m128 now = _mm_set1_ps( time );
+		const __m128 msec = _mm_set1_ps( 0.001f );
+		const __m128 instant = _mm_set1_ps( INSTANT_PARTICLE );
+		const __m128 one = _mm_set1_ps( 1.0f );
+
+		for ( ; i + 4 <= s.count; i += 4 )
 		{
-			tail->next = p;
-			tail = p;
+			const __m128 alphavel = _mm_load_ps( s.alphavel + i );
+
+			__m128 t = _mm_mul_ps( _mm_sub_ps( now, _mm_load_ps( s.time + i ) ), msec );
+			t = _mm_andnot_ps( _mm_cmpeq_ps( alphavel, instant ), t );
+			const __m128 t2 = _mm_mul_ps( t, t );
+
+			const __m128 alpha = _mm_add_ps( _mm_load_ps( s.alpha + i ), _mm_mul_ps( t, alphavel ) );
+			_mm_store_ps( w.alpha + i, _mm_min_ps( alpha, one ) );
+
+			_mm_store_ps( w.x + i, _mm_add_ps( _mm_add_ps( _mm_load_ps( s.orgX + i ), _mm_mul_ps( _mm_load_ps( s.velX + i ), t ) ), _mm_mul_ps( _mm_load_ps( s.accelX + i ), t2 ) ) );
+			_mm_store_ps( w.y + i, _mm_add_ps( _mm_add_ps( _mm_load_ps( s.orgY + i ), _mm_mul_ps( _mm_load_ps( s.velY + i ), t ) ), _mm_mul_ps( _mm_load_ps( s.accelY + i ), t2 ) ) );
+			_mm_store_ps( w.z + i, _mm_add_ps( _mm_add_ps( _mm_load_ps( s.orgZ + i ), _mm_mul_ps( _mm_load_ps( s.velZ + i ), t ) ), _mm_mul_ps( _mm_load_ps( s.accelZ + i ), t2 ) ) );
 		}
+	}
+#endif
 
-		if ( alpha > 1.0f )
-			alpha = 1.0f;
-		color = (float)p->color;
+	for ( ; i < s.count; i++ )
+	{
+		const float t = ( s.alphavel[i] != INSTANT_PARTICLE ) ? ( time - s.time[i] ) * 0.001f : 0.0f;
+		const float t2 = t * t;
 
-		time2 = time * time;
+		w.alpha[i] = Min( s.alpha[i] + t * s.alphavel[i], 1.0f );
+		w.x[i] = s.orgX[i] + s.velX[i] * t + s.accelX[i] * t2;
+		w.y[i] = s.orgY[i] + s.velY[i] * t + s.accelY[i] * t2;
+		w.z[i] = s.orgZ[i] + s.velZ[i] * t + s.accelZ[i] * t2;
+	}
+}
+
+// moves the last particle into i
+static void CL_RemoveParticle( int i )
+{
+	particleStore_t &s = s_particles;
+	particleWork_t &w = s_particleWork;
+	const int last = --s.count;
+
+	s.time[i] = s.time[last];
+	s.orgX[i] = s.orgX[last];
+	s.orgY[i] = s.orgY[last];
+	s.orgZ[i] = s.orgZ[last];
+	s.velX[i] = s.velX[last];
+	s.velY[i] = s.velY[last];
+	s.velZ[i] = s.velZ[last];
+	s.accelX[i] = s.accelX[last];
+	s.accelY[i] = s.accelY[last];
+	s.accelZ[i] = s.accelZ[last];
+	s.color[i] = s.color[last];
+	s.alpha[i] = s.alpha[last];
+	s.alphavel[i] = s.alphavel[last];
+
+	w.x[i] = w.x[last];
+	w.y[i] = w.y[last];
+	w.z[i] = w.z[last];
+	w.alpha[i] = w.alpha[last];
+}
+
+/*
+===================
+CL_AddParticles
+===================
+*/
+void CL_AddParticles()
+{
+	particleStore_t &s = s_particles;
+	const particleWork_t &w = s_particleWork;
+
+	CL_FlushNewParticles();
+	CL_UpdateParticles( (float)cgi.time() );
+
+	int numRender = 0;
 
-		org[0] = p->org[0] + p->vel[0] * time + p->accel[0] * time2;
-		org[1] = p->org[1] + p->vel[1] * time + p->accel[1] * time2;
-		org[2] = p->org[2] + p->vel[2] * time + p->accel[2] * time2;
+	for ( int i = 0; i < s.count; )
+	{
+		if ( w.alpha[i] <= 0.0f )
+		{	// faded out
+			CL_RemoveParticle( i );
+			continue;
+		}
+
+		particle_t &out = s_renderParticles[numRender++];
+		out.origin[0] = w.x[i];
+		out.origin[1] = w.y[i];
+		out.origin[2] = w.z[i];
+		out.color = (int)s.color[i];
+		out.alpha = w.alpha[i];
 
-		cgi.AddParticle( org, color, alpha );
 		// PMM
-		if ( p->alphavel == INSTANT_PARTICLE )
+		if ( s.alphavel[i] == INSTANT_PARTICLE )
 		{
-			p->alphavel = 0.0;
-			p->alpha = 0.0;
+			s.alphavel[i] = 0.0f;
+			s.alpha[i] = 0.0f;
 		}
+
+		i++;
 	}
 
-	active_particles = active;
+	cgi.AddParticles( s_renderParticles, numRender );
 }
 
 /*
@@ -72,10 +72,9 @@ struct cl_sustain_t
 
 // ========
 // PGM
+// What the effects fill in, CL_AddParticles keeps them in its own arrays
 struct cparticle_t
 {
-	cparticle_t	*next;
-
 	float		time;
 
 	vec3_t		org;
@@ -87,8 +86,9 @@ struct cparticle_t
 	float		alphavel;
 };
 
-extern cparticle_t	*active_particles, *free_particles;
-extern cparticle_t	particles[MAX_PARTICLES];
+// Returns a cleared particle, if the store is full it gets thrown away
+cparticle_t *CL_AllocParticle();
+bool CL_ParticlesFull();
 
 #define	PARTICLE_GRAVITY			40
 // PMM
@@ -148,12 +148,9 @@ void CL_DebugTrail( vec3_t start, vec3_t end )
 	{
 		len -= dec;
 
-		if ( !free_particles )
+		if ( CL_ParticlesFull() )
 			return;
-		p = free_particles;
-		free_particles = p->next;
-		p->next = active_particles;
-		active_particles = p;
+		p = CL_AllocParticle();
 
 		p->time = (float)cgi.time();
 		VectorClear( p->accel );
@@ -200,12 +197,9 @@ void CL_SmokeTrail( vec3_t start, vec3_t end, int colorStart, int colorRun, int
 	{
 		len -= spacing;
 
-		if ( !free_particles )
+		if ( CL_ParticlesFull() )
 			return;
-		p = free_particles;
-		free_particles = p->next;
-		p->next = active_particles;
-		active_particles = p;
+		p = CL_AllocParticle();
 		VectorClear( p->accel );
 
 		p->time = (float)cgi.time();
@@ -248,15 +242,12 @@ void CL_ForceWall( vec3_t start, vec3_t end, int color )
 	{
 		len -= 4;
 
-		if ( !free_particles )
+		if ( CL_ParticlesFull() )
 			return;
 
 		if ( frand() > 0.3f )
 		{
-			p = free_particles;
-			free_particles = p->next;
-			p->next = active_particles;
-			active_particles = p;
+			p = CL_AllocParticle();
 			VectorClear( p->accel );
 
 			p->time = (float)cgi.time();
@@ -293,13 +284,10 @@ void CL_FlameEffects( centity_t *ent, vec3_t origin )
 
 	for ( n = 0; n < count; n++ )
 	{
-		if ( !free_particles )
+		if ( CL_ParticlesFull() )
 			return;
 
-		p = free_particles;
-		free_particles = p->next;
-		p->next = active_particles;
-		active_particles = p;
+		p = CL_AllocParticle();
 
 		VectorClear( p->accel );
 		p->time = (float)cgi.time();
@@ -320,12 +308,9 @@ void CL_FlameEffects( centity_t *ent, vec3_t origin )
 
 	for ( n = 0; n < count; n++ )
 	{
-		if ( !free_particles )
+		if ( CL_ParticlesFull() )
 			return;
-		p = free_particles;
-		free_particles = p->next;
-		p->next = active_particles;
-		active_particles = p;
+		p = CL_AllocParticle();
 		VectorClear( p->accel );
 
 		p->time = (float)cgi.time();
@@ -355,12 +340,9 @@ void CL_GenericParticleEffect( vec3_t org, vec3_t dir, int color, int count, int
 
 	for ( i = 0; i < count; i++ )
 	{
-		if ( !free_particles )
+		if ( CL_ParticlesFull() )
 			return;
-		p = free_particles;
-		free_particles = p->next;
-		p->next = active_particles;
-		active_particles = p;
+		p = CL_AllocParticle();
 
 		p->time = (float)cgi.time();
 		if ( numcolors > 1 )
@@ -410,13 +392,10 @@ void CL_BubbleTrail2( vec3_t start, vec3_t end, int dist )
 
 	for ( i = 0; i < len; i += dec )
 	{
-		if ( !free_particles )
+		if ( CL_ParticlesFull() )
 			return;
 
-		p = free_particles;
-		free_particles = p->next;
-		p->next = active_particles;
-		active_particles = p;
+		p = CL_AllocParticle();
 
 		VectorClear( p->accel );
 		p->time = (float)cgi.time();
@@ -497,13 +476,10 @@ void CL_Heatbeam( vec3_t start, vec3_t forward )
 		for ( rot = 0; rot < ( mconst::pi * 2.0f ); rot += rstep )
 		{
 
-			if ( !free_particles )
+			if ( CL_ParticlesFull() )
 				return;
 
-			p = free_particles;
-			free_particles = p->next;
-			p->next = active_particles;
-			active_particles = p;
+			p = CL_AllocParticle();
 
 			p->time = (float)cgi.time();
 			VectorClear( p->accel );
@@ -564,12 +540,9 @@ void CL_ParticleSteamEffect( vec3_t org, vec3_t dir, int color, int count, int m
 
 	for ( i = 0; i < count; i++ )
 	{
-		if ( !free_particles )
+		if ( CL_ParticlesFull() )
 			return;
-		p = free_particles;
-		free_particles = p->next;
-		p->next = active_particles;
-		active_particles = p;
+		p = CL_AllocParticle();
 
 		p->time = (float)cgi.time();
 		p->color = (float)( color + ( rand() & 7 ) );
@@ -615,12 +588,9 @@ void CL_ParticleSteamEffect2( cl_sustain_t *self )
 
 	for ( i = 0; i < self->count; i++ )
 	{
-		if ( !free_particles )
+		if ( CL_ParticlesFull() )
 			return;
-		p = free_particles;
-		free_particles = p->next;
-		p->next = active_particles;
-		active_particles = p;
+		p = CL_AllocParticle();
 
 		p->time = (float)cgi.time();
 		p->color = self->color + ( rand() & 7 );
@@ -677,12 +647,9 @@ void CL_TrackerTrail( vec3_t start, vec3_t end, int particleColor )
 	{
 		len -= dec;
 
-		if ( !free_particles )
+		if ( CL_ParticlesFull() )
 			return;
-		p = free_particles;
-		free_particles = p->next;
-		p->next = active_particles;
-		active_particles = p;
+		p = CL_AllocParticle();
 		VectorClear( p->accel );
 
 		p->time = (float)cgi.time();
@@ -717,12 +684,9 @@ void CL_Tracker_Shell( vec3_t origin )
 
 	for ( i = 0; i < 300; i++ )
 	{
-		if ( !free_particles )
+		if ( CL_ParticlesFull() )
 			return;
-		p = free_particles;
-		free_particles = p->next;
-		p->next = active_particles;
-		active_particles = p;
+		p = CL_AllocParticle();
 		VectorClear( p->accel );
 
 		p->time = (float)cgi.time();
@@ -753,12 +717,9 @@ void CL_MonsterPlasma_Shell( vec3_t origin )
 
 	for ( i = 0; i < 40; i++ )
 	{
-		if ( !free_particles )
+		if ( CL_ParticlesFull() )
 			return;
-		p = free_particles;
-		free_particles = p->next;
-		p->next = active_particles;
-		active_particles = p;
+		p = CL_AllocParticle();
 		VectorClear( p->accel );
 
 		p->time = (float)cgi.time();
@@ -794,12 +755,9 @@ void CL_Widowbeamout( cl_sustain_t *self )
 
 	for ( i = 0; i < 300; i++ )
 	{
-		if ( !free_particles )
+		if ( CL_ParticlesFull() )
 			return;
-		p = free_particles;
-		free_particles = p->next;
-		p->next = active_particles;
-		active_particles = p;
+		p = CL_AllocParticle();
 		VectorClear( p->accel );
 
 		p->time = (float)cgi.time();
@@ -835,12 +793,9 @@ void CL_Nukeblast( cl_sustain_t *self )
 
 	for ( i = 0; i < 700; i++ )
 	{
-		if ( !free_particles )
+		if ( CL_ParticlesFull() )
 			return;
-		p = free_particles;
-		free_particles = p->next;
-		p->next = active_particles;
-		active_particles = p;
+		p = CL_AllocParticle();
 		VectorClear( p->accel );
 
 		p->time = (float)cgi.time();
@@ -873,12 +828,9 @@ void CL_WidowSplash( vec3_t org )
 
 	for ( i = 0; i < 256; i++ )
 	{
-		if ( !free_particles )
+		if ( CL_ParticlesFull() )
 			return;
-		p = free_particles;
-		free_particles = p->next;
-		p->next = active_particles;
-		active_particles = p;
+		p = CL_AllocParticle();
 
 		p->time = (float)cgi.time();
 		p->color = colortable[rand() & 3];
@@ -911,12 +863,9 @@ void CL_Tracker_Explode( vec3_t	origin )
 
 	for ( i = 0; i < 300; i++ )
 	{
-		if ( !free_particles )
+		if ( CL_ParticlesFull() )
 			return;
-		p = free_particles;
-		free_particles = p->next;
-		p->next = active_particles;
-		active_particles = p;
+		p = CL_AllocParticle();
 		VectorClear( p->accel );
 
 		p->time = (float)cgi.time();
@@ -962,12 +911,9 @@ void CL_TagTrail( vec3_t start, vec3_t end, float color )
 	{
 		len -= dec;
 
-		if ( !free_particles )
+		if ( CL_ParticlesFull() )
 			return;
-		p = free_particles;
-		free_particles = p->next;
-		p->next = active_particles;
-		active_particles = p;
+		p = CL_AllocParticle();
 		VectorClear( p->accel );
 
 		p->time = (float)cgi.time();
@@ -998,12 +944,9 @@ void CL_ColorExplosionParticles( vec3_t org, int color, int run )
 
 	for ( i = 0; i < 128; i++ )
 	{
-		if ( !free_particles )
+		if ( CL_ParticlesFull() )
 			return;
-		p = free_particles;
-		free_particles = p->next;
-		p->next = active_particles;
-		active_particles = p;
+		p = CL_AllocParticle();
 
 		p->time = (float)cgi.time();
 		p->color = (float)( color + ( rand() % run ) );
@@ -1040,12 +983,9 @@ void CL_ParticleSmokeEffect( vec3_t org, vec3_t dir, int color, int count, int m
 
 	for ( i = 0; i < count; i++ )
 	{
-		if ( !free_particles )
+		if ( CL_ParticlesFull() )
 			return;
-		p = free_particles;
-		free_particles = p->next;
-		p->next = active_particles;
-		active_particles = p;
+		p = CL_AllocParticle();
 
 		p->time = (float)cgi.time();
 		p->color = (float)( color + ( rand() & 7 ) );
@@ -1085,12 +1025,9 @@ void CL_BlasterParticles2( vec3_t org, vec3_t dir, unsigned int color )
 	count = 40;
 	for ( i = 0; i < count; i++ )
 	{
-		if ( !free_particles )
+		if ( CL_ParticlesFull() )
 			return;
-		p = free_particles;
-		free_particles = p->next;
-		p->next = active_particles;
-		active_particles = p;
+		p = CL_AllocParticle();
 
 		p->time = (float)cgi.time();
 		p->color = (float)( color + ( rand() & 7 ) );
@@ -1138,12 +1075,9 @@ void CL_BlasterTrail2( vec3_t start, vec3_t end )
 	{
 		len -= dec;
 
-		if ( !free_particles )
+		if ( CL_ParticlesFull() )
 			return;
-		p = free_particles;
-		free_particles = p->next;
-		p->next = active_particles;
-		active_particles = p;
+		p = CL_AllocParticle();
 		VectorClear( p->accel );
 
 		p->time = (float)cgi.time();
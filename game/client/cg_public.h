@@ -9,7 +9,7 @@ struct sfx_t;
 
 struct sizebuf_t;
 
-#define	CGAME_API_VERSION	1
+#define	CGAME_API_VERSION	2
 
 #define	CMD_BACKUP		64	// allow a lot of command backups for very fast systems
 
@@ -47,6 +47,7 @@ struct cgame_import_t
 
 	void	( *AddEntity ) ( entity_t *ent );
 	void	( *AddParticle ) ( vec3_t org, int color, float alpha );
+	void	( *AddParticles ) ( const particle_t *particles, int count );
 	void	( *AddLight ) ( vec3_t org, float intensity, float r, float g, float b );
 	void	( *AddLightStyle ) ( int style, float r, float g, float b );
 
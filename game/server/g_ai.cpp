@@ -2,6 +2,8 @@
 
 #include "g_local.h"
 
+#include <vector>
+
 qboolean FindTarget (edict_t *self);
 extern cvar_t	*maxclients;
 
@@ -307,6 +309,361 @@ qboolean infront (edict_t *self, edict_t *other)
 }
 
 
+//============================================================================
+
+/*
+==============================================================================
+
+PERCEPTION
+
+FindTarget used to trace to level.sight_client from every idle monster on
+every think, and only one client a frame was ever looked for, so in coop
+each player was only noticed every few frames. Now the line of sight for
+all the monsters looking around is worked out together at the start of the
+frame, before anything thinks. Each monster looks for every client, but
+only once in g_aiSlices frames, and no more than g_aiTraceBudget traces are
+made a frame. A monster that runs out of budget is owed and goes first next
+frame, whatever the budget.
+
+Answers are kept for g_aiVisFrames frames while both ends stay in the same
+PVS cluster, and a pair that isn't in each other's PVS is never traced.
+The PVS answer for a pair of clusters is only worked out once a frame.
+
+==============================================================================
+*/
+
+#define AI_VIS_CACHE		4096	// power of two
+#define AI_PVS_CACHE		1024	// power of two
+
+struct aiVisEntry_t
+{
+	int			self, other;
+	int			framenum;
+	int			selfCluster, otherCluster;
+	qboolean	visible;
+};
+
+struct aiPvsEntry_t
+{
+	int			cluster1, cluster2;
+	int			framenum;
+	qboolean	inPVS;
+};
+
+struct aiPerception_t
+{
+	edict_t		*sightClient;	// seen this frame
+	int			framenum;
+	qboolean	owed;			// ran out of budget last frame
+};
+
+static aiVisEntry_t					ai_visCache[AI_VIS_CACHE];
+static aiPvsEntry_t					ai_pvsCache[AI_PVS_CACHE];
+static std::vector<aiPerception_t>	ai_perception;
+static int							ai_lastFramenum;
+static int							ai_budget;
+
+// for g_aiStats
+static int	ai_queries, ai_traces, ai_cacheHits, ai_pvsRejects, ai_deferred;
+static float	ai_statTime;
+
+// the one cluster an entity is in, or -1 if it spans more than one
+static int AI_Cluster (edict_t *ent)
+{
+	return ent->num_clusters == 1 ? ent->clusternums[0] : -1;
+}
+
+static int AI_VisSlot (edict_t *self, edict_t *other)
+{
+	return G_HashSlot ((uint32)(self - g_edicts), (uint32)(other - g_edicts), AI_VIS_CACHE);
+}
+
+static qboolean AI_InPVS (edict_t *self, edict_t *other)
+{
+	vec3_t	spot1, spot2;
+	const int cluster1 = AI_Cluster (self);
+	const int cluster2 = AI_Cluster (other);
+
+	aiPvsEntry_t *entry = NULL;
+	if (cluster1 >= 0 && cluster2 >= 0)
+	{
+		// doors change which areas are connected, so only for this frame
+		entry = &ai_pvsCache[((uint32)cluster1 * 31337u ^ (uint32)cluster2) & (AI_PVS_CACHE - 1)];
+		if (entry->framenum == level.framenum && entry->cluster1 == cluster1 && entry->cluster2 == cluster2)
+			return entry->inPVS;
+	}
+
+	VectorCopy (self->s.origin, spot1);
+	spot1[2] += self->viewheight;
+	VectorCopy (other->s.origin, spot2);
+	spot2[2] += other->viewheight;
+	const qboolean inPVS = gi.inPVS (spot1, spot2);
+
+	if (entry)
+	{
+		entry->cluster1 = cluster1;
+		entry->cluster2 = cluster2;
+		entry->framenum = level.framenum;
+		entry->inPVS = inPVS;
+	}
+
+	return inPVS;
+}
+
+/*
+=============
+AI_KnownVisible
+
+Returns 1 or 0 if it's known whether other can be seen by self without
+a trace, -1 if it needs one
+=============
+*/
+static int AI_KnownVisible (edict_t *self, edict_t *other, int maxAge)
+{
+	const aiVisEntry_t &entry = ai_visCache[AI_VisSlot (self, other)];
+
+	if (entry.self == self - g_edicts && entry.other == other - g_edicts && entry.framenum <= level.framenum)
+	{
+		if (entry.framenum == level.framenum)
+		{
+			ai_cacheHits++;
+			return entry.visible;
+		}
+
+		const int selfCluster = AI_Cluster (self);
+		const int otherCluster = AI_Cluster (other);
+		if (level.framenum - entry.framenum <= maxAge && selfCluster >= 0 && otherCluster >= 0
+			&& entry.selfCluster == selfCluster && entry.otherCluster == otherCluster)
+		{
+			ai_cacheHits++;
+			return entry.visible;
+		}
+	}
+
+	if (!AI_InPVS (self, other))
+	{
+		ai_pvsRejects++;
+		return 0;
+	}
+
+	return -1;
+}
+
+static qboolean AI_TraceVisible (edict_t *self, edict_t *other)
+{
+	ai_traces++;
+	ai_budget--;
+
+	aiVisEntry_t &entry = ai_visCache[AI_VisSlot (self, other)];
+	entry.self = (int)(self - g_edicts);
+	entry.other = (int)(other - g_edicts);
+	entry.framenum = level.framenum;
+	entry.selfCluster = AI_Cluster (self);
+	entry.otherCluster = AI_Cluster (other);
+	entry.visible = visible (self, other);
+
+	return entry.visible;
+}
+
+/*
+=============
+AI_Visible
+
+visible () for monsters, the answer can be up to maxAge frames old
+=============
+*/
+qboolean AI_Visible (edict_t *self, edict_t *other, int maxAge)
+{
+	if (!g_aiSchedule->GetBool())
+		return visible (self, other);
+
+	ai_queries++;
+
+	const int known = AI_KnownVisible (self, other, maxAge);
+	if (known >= 0)
+		return (qboolean)known;
+
+	return AI_TraceVisible (self, other);
+}
+
+// the same tests FindTarget makes before it looks
+static qboolean AI_CouldNotice (edict_t *self, edict_t *client)
+{
+	const int r = range (self, client);
+
+	if (r == RANGE_FAR)
+		return false;
+	if (client->light_level <= 5)
+		return false;
+	if (r == RANGE_NEAR && client->show_hostile < level.time && !infront (self, client))
+		return false;
+	if (r == RANGE_MID && !infront (self, client))
+		return false;
+
+	return true;
+}
+
+/*
+=============
+AI_Perceive
+
+Finds a client self can see this frame. Returns false if the budget ran
+out before every client was looked at.
+=============
+*/
+static qboolean AI_Perceive (edict_t *self, edict_t **clients, int numClients, qboolean owed)
+{
+	aiPerception_t &perception = ai_perception[self - g_edicts];
+
+	perception.sightClient = NULL;
+	perception.framenum = level.framenum;
+
+	// start somewhere different each time, so nobody is always looked at last
+	const int first = (int)((self - g_edicts) + level.framenum / Max (g_aiSlices->GetInt(), 1));
+
+	for (int i = 0; i < numClients; i++)
+	{
+		edict_t *client = clients[(first + i) % numClients];
+
+		if (!AI_CouldNotice (self, client))
+			continue;
+
+		ai_queries++;
+
+		int known = AI_KnownVisible (self, client, g_aiVisFrames->GetInt());
+		if (known < 0)
+		{
+			if (ai_budget <= 0 && !owed)
+				return false;
+
+			known = AI_TraceVisible (self, client);
+		}
+
+		if (known)
+		{
+			perception.sightClient = client;
+			break;
+		}
+	}
+
+	return true;
+}
+
+// monsters that will call FindTarget for someone to see
+static qboolean AI_LooksAround (edict_t *ent)
+{
+	if (!ent->inuse || !(ent->svflags & SVF_MONSTER) || ent->health <= 0 || ent->deadflag)
+		return false;
+	if (ent->monsterinfo.aiflags & (AI_GOOD_GUY | AI_COMBAT_POINT))
+		return false;
+
+	// only coop monsters look for someone else once they're angry
+	if (ent->enemy && !coop->GetBool())
+		return false;
+
+	return true;
+}
+
+/*
+=============
+AI_RunPerception
+
+Called once each frame before anything thinks
+=============
+*/
+void AI_RunPerception (void)
+{
+	edict_t		*clients[MAX_CLIENTS];
+	int			numClients;
+	int			i;
+
+	// a new level, nothing from the last one is any good
+	if (level.framenum < ai_lastFramenum || ai_perception.size() != (size_t)game.maxentities)
+	{
+		memset (ai_visCache, 0, sizeof(ai_visCache));
+		memset (ai_pvsCache, 0, sizeof(ai_pvsCache));
+		ai_perception.assign (game.maxentities, aiPerception_t{});
+	}
+	ai_lastFramenum = level.framenum;
+
+	if (G_StatsDue (g_aiStats, ai_statTime))
+	{
+		gi.dprintf ("ai: %d queries, %d traces, %d cache hits, %d pvs rejects, %d deferred\n",
+			ai_queries, ai_traces, ai_cacheHits, ai_pvsRejects, ai_deferred);
+		ai_queries = ai_traces = ai_cacheHits = ai_pvsRejects = ai_deferred = 0;
+	}
+
+	if (!g_aiSchedule->GetBool())
+		return;
+
+	ai_budget = g_aiTraceBudget->GetInt();
+
+	numClients = 0;
+	for (i=1 ; i<=game.maxclients && numClients < MAX_CLIENTS ; i++)
+	{
+		edict_t *ent = &g_edicts[i];
+		if (ent->inuse && ent->health > 0 && !(ent->flags & FL_NOTARGET))
+			clients[numClients++] = ent;
+	}
+
+	const int slices = Max (g_aiSlices->GetInt(), 1);
+
+	// the monsters that were owed go first, then whoever's turn it is
+	for (int pass = 0; pass < 2; pass++)
+	{
+		for (i=game.maxclients+1 ; i<globals.num_edicts ; i++)
+		{
+			edict_t *ent = &g_edicts[i];
+			aiPerception_t &perception = ai_perception[i];
+
+			if (perception.owed != (pass == 0))
+				continue;
+			if (!AI_LooksAround (ent))
+			{
+				perception.owed = false;
+				continue;
+			}
+			if (pass == 1 && (i + level.framenum) % slices != 0)
+				continue;
+
+			if (!numClients)
+			{
+				perception.sightClient = NULL;
+				perception.framenum = level.framenum;
+				perception.owed = false;
+				continue;
+			}
+
+			perception.owed = !AI_Perceive (ent, clients, numClients, pass == 0);
+			if (perception.owed)
+				ai_deferred++;
+		}
+	}
+}
+
+/*
+=============
+AI_SightClient
+
+The client FindTarget should look at for self this frame
+=============
+*/
+edict_t *AI_SightClient (edict_t *self)
+{
+	if (!g_aiSchedule->GetBool())
+		return level.sight_client;
+
+	if ((size_t)(self - g_edicts) >= ai_perception.size())
+		return NULL;
+
+	const aiPerception_t &perception = ai_perception[self - g_edicts];
+	if (perception.framenum != level.framenum)
+		return NULL;	// not this monster's turn
+
+	return perception.sightClient;
+}
+
+
 //============================================================================
 
 void HuntTarget (edict_t *self)
@@ -436,7 +793,7 @@ qboolean FindTarget (edict_t *self)
 	}
 	else
 	{
-		client = level.sight_client;
+		client = AI_SightClient (self);
 		if (!client)
 			return false;	// no clients to get mad at
 	}
@@ -481,7 +838,7 @@ qboolean FindTarget (edict_t *self)
 		if (client->light_level <= 5)
 			return false;
 
-		if (!visible (self, client))
+		if (!AI_Visible (self, client, g_aiVisFrames->GetInt()))
 		{
 			return false;
 		}
@@ -524,7 +881,7 @@ qboolean FindTarget (edict_t *self)
 
 		if (self->spawnflags & 1)
 		{
-			if (!visible (self, client))
+			if (!AI_Visible (self, client, 0))
 				return false;
 		}
 		else
@@ -848,7 +1205,7 @@ qboolean ai_checkattack (edict_t *self, float dist)
 	self->show_hostile = (qboolean)(level.time + 1);		// wake up other monsters
 
 // check knowledge of enemy
-	enemy_vis = visible(self, self->enemy);
+	enemy_vis = AI_Visible(self, self->enemy, 0);
 	if (enemy_vis)
 	{
 		self->monsterinfo.search_time = level.time + 5;
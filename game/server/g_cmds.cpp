@@ -947,6 +947,8 @@ void ClientCommand (edict_t *ent)
 {
 	char	*cmd;
 
+	G_RunQueuedMoves ();
+
 	if (!ent->client)
 		return;		// not fully in game yet
 
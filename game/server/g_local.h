@@ -436,6 +436,11 @@ struct monsterinfo_t
 
 	int			power_armor_type;
 	int			power_armor_power;
+
+	int			nav_node;		// node the hop to nav_next was taken from
+	int			nav_next;		// node being walked to
+	int			nav_goal;		// node nav_next leads to
+	qboolean	nav_following;
 };
 
 
@@ -555,6 +560,22 @@ extern cvar_t	*sv_rollangle;
 extern cvar_t	*g_viewthing;
 extern cvar_t	*g_frametime;
 extern cvar_t	*g_playersOnly;
+extern cvar_t	*g_saveCompress;
+
+extern cvar_t	*g_nav;
+extern cvar_t	*g_navBudget;
+extern cvar_t	*g_navStats;
+
+extern cvar_t	*g_aiSchedule;
+extern cvar_t	*g_aiTraceBudget;
+extern cvar_t	*g_aiSlices;
+extern cvar_t	*g_aiVisFrames;
+extern cvar_t	*g_aiStats;
+
+extern cvar_t	*g_parallelThink;
+extern cvar_t	*g_parallelCheck;
+extern cvar_t	*g_parallelStats;
+extern cvar_t	*g_parallelPlayers;
 
 extern cvar_t	*run_pitch;
 extern cvar_t	*run_roll;
@@ -675,6 +696,10 @@ char *		vtos (vec3_t v);
 float		vectoyaw( const vec3_t vec );
 void		vectoangles( const vec3_t vec, vec3_t angles );
 
+int			G_HashSlot (uint32 a, uint32 b, uint32 size);
+uint64		G_CellKey (int x, int y, int z);
+int			G_StatsDue (cvar_t *stats, float &since);
+
 //
 // g_combat.c
 //
@@ -733,6 +758,9 @@ void BecomeExplosion1(edict_t *self);
 // g_ai.c
 //
 void AI_SetSightClient (void);
+void AI_RunPerception (void);
+edict_t *AI_SightClient (edict_t *self);
+qboolean AI_Visible (edict_t *self, edict_t *other, int maxAge);
 
 void ai_stand (edict_t *self, float dist);
 void ai_move (edict_t *self, float dist);
@@ -781,6 +809,9 @@ void InitClientPersistant (gclient_t *client);
 void InitClientResp (gclient_t *client);
 void InitBodyQue (void);
 void ClientBeginServerFrame (edict_t *ent);
+pmType_t ClientPmoveType (edict_t *ent);
+void ClientRunThink (edict_t *ent, usercmd_t *ucmd);
+void ClientPmove (edict_t *ent, usercmd_t *ucmd, pmove_t *pm);
 
 //
 // g_player.c
@@ -841,6 +872,41 @@ void ChaseNext(edict_t *ent);
 void ChasePrev(edict_t *ent);
 void GetChaseTarget(edict_t *ent);
 
+//
+// g_save.cpp
+//
+void G_FlushSaves (const char *filename);
+
+//
+// g_nav.cpp
+//
+#define NAV_NO_NODE		-1
+#define NAV_NO_PATH		-2
+
+void Nav_LoadGraph (const char *mapname);
+void Nav_FreeGraph (void);
+void Nav_RunFrame (void);
+int Nav_NumNodes (void);
+int Nav_NearestNode (const vec3_t floor);
+int Nav_NextHop (int node, int goal);
+void Nav_ForgetHop (int node, int goal);
+void Nav_NodeOrigin (int node, vec3_t origin);
+void Nav_CountMoveTraces (int count);
+
+//
+// g_parallel.cpp
+//
+void G_PredictMoves (void);
+qboolean G_PredictedTrace (edict_t *ent, const vec3_t start, const vec3_t end, int mask, trace_t &trace);
+void G_ShutdownParallel (void);
+void G_StopJobs (void);
+qboolean G_QueueClientThink (edict_t *ent, usercmd_t *ucmd);
+void G_RunQueuedMoves (void);	// call before anything that could see the players
+void G_BatchedPmove (edict_t *ent, pmove_t *pm);
+void G_RecordClientThink (edict_t *ent, usercmd_t *ucmd);
+void G_RecordMoves_f (void);
+void G_ReplayMoves_f (void);
+
 //
 // g_joltphysics.cpp
 //
@@ -42,6 +42,22 @@ cvar_t	*gun_z;
 cvar_t	*g_viewthing;
 cvar_t	*g_frametime;
 cvar_t	*g_playersOnly;
+cvar_t	*g_saveCompress;
+
+cvar_t	*g_nav;
+cvar_t	*g_navBudget;
+cvar_t	*g_navStats;
+
+cvar_t	*g_aiSchedule;
+cvar_t	*g_aiTraceBudget;
+cvar_t	*g_aiSlices;
+cvar_t	*g_aiVisFrames;
+cvar_t	*g_aiStats;
+
+cvar_t	*g_parallelThink;
+cvar_t	*g_parallelCheck;
+cvar_t	*g_parallelStats;
+cvar_t	*g_parallelPlayers;
 
 cvar_t	*run_pitch;
 cvar_t	*run_roll;
@@ -69,6 +85,7 @@ void WriteGame (char *filename, qboolean autosave);
 void ReadGame (char *filename);
 void WriteLevel (char *filename);
 void ReadLevel (char *filename);
+void FlushSaves (void);
 void InitGame (void);
 void G_RunFrame (void);
 
@@ -78,6 +95,12 @@ void ShutdownGame (void)
 {
 	gi.dprintf ("==== ShutdownGame ====\n");
 
+	G_FlushSaves (NULL);
+
+	Nav_FreeGraph ();
+
+	G_ShutdownParallel ();
+
 	Phys_DeleteCachedShapes();
 
 	gi.FreeTags (TAG_LEVEL);
@@ -105,6 +128,8 @@ extern "C" DLLEXPORT game_export_t *GetGameAPI (game_import_t *import)
 	globals.ReadGame = ReadGame;
 	globals.WriteLevel = WriteLevel;
 	globals.ReadLevel = ReadLevel;
+	globals.FlushSaves = FlushSaves;
+	globals.StopJobs = G_StopJobs;
 
 	globals.ClientThink = ClientThink;
 	globals.ClientConnect = ClientConnect;
@@ -420,12 +445,21 @@ void G_RunFrame (void)
 	int		i;
 	edict_t	*ent;
 
+	// the moves that came in since the last frame
+	G_RunQueuedMoves ();
+
 	level.framenum++;
 	level.time = level.framenum*FRAMETIME;
 
 	// choose a client for monsters to target this frame
 	AI_SetSightClient ();
 
+	// line of sight for every monster looking around this frame, before any of them think
+	AI_RunPerception ();
+
+	// carry on with the path searches monsters asked for
+	Nav_RunFrame ();
+
 	// exit intermissions
 
 	if (level.exitintermission)
@@ -434,6 +468,9 @@ void G_RunFrame (void)
 		return;
 	}
 
+	// trace the moves that can be done on the job workers
+	G_PredictMoves ();
+
 	//
 	// treat each object in turn
 	// even the world gets a chance to think
@@ -0,0 +1,981 @@
+// g_nav.cpp -- navigation graph and path planning for walking monsters
+
+#include "g_local.h"
+
+#include "../../common/q_formats.h"
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+/*
+=============================================================================
+
+NAVIGATION GRAPH
+
+Walking monsters used to find their way by stepping in a direction and
+probing others when it failed, which costs several traces a step and gets
+them stuck on anything that isn't a straight line. The world's floors are
+now sampled into a graph when a level loads, the level's BSP is read for
+its upward facing faces and each gets nodes on a grid plus one at its
+middle. Nodes a monster can stand at are linked to the ones it can walk
+to. The result is kept in maps/<name>.nav and used again while the BSP is
+unchanged.
+
+Paths are found with A* on the graph, a search runs for at most
+g_navBudget node expansions a frame and carries on next frame. A found
+path is remembered as the next node to take from each node on it towards
+the goal, so every monster that ends up on a known path shares it.
+
+=============================================================================
+*/
+
+#define NAV_MAGIC		MakeFourCC('J','Q','N','V')
+#define NAV_VERSION		2
+
+#define	STEPSIZE		18
+
+#define NAV_GRID		48		// spacing of the nodes put on a floor
+#define NAV_MERGE		24		// nodes that land in the same cube this size are one node
+#define NAV_LINK_DIST	80		// furthest apart linked nodes can be
+#define NAV_MAX_RISE	STEPSIZE	// highest a link can climb, SV_movestep lifts no further
+#define NAV_STEP		16		// links are walked this far at a time, like a monster would
+#define NAV_CELL		96		// lookup cell size, at least NAV_LINK_DIST and NAV_FIND_DIST
+#define NAV_FIND_DIST	96		// how far from a node something can be and still be on it
+
+#define NAV_MAX_QUEUED	64
+#define NAV_HOP_CACHE	16384	// power of two
+#define NAV_HOP_TIME	10		// seconds a known hop is trusted before it's searched for again
+
+// the hull nodes are tested with, a soldier is the common size
+static vec3_t	nav_mins = {-16, -16, -24};
+static vec3_t	nav_maxs = {16, 16, 32};
+
+struct navHeader_t
+{
+	int32	magic;
+	int32	version;
+	uint32	bspHash;
+	int32	numNodes;
+	int32	numLinks;
+};
+
+struct navNode_t
+{
+	vec3_t	origin;			// on the floor
+	int32	firstLink;
+	int32	numLinks;
+};
+
+struct navLink_t
+{
+	int32	node;
+	float	cost;
+};
+
+struct navCell_t
+{
+	uint32	key;
+	int32	node;
+};
+
+struct navHop_t
+{
+	int32	node;			// -1 if the slot is empty
+	int32	goal;
+	int32	next;			// NAV_NO_PATH if the goal can't be reached
+	float	expires;		// level.time
+};
+
+struct navQuery_t
+{
+	int		start;
+	int		goal;
+};
+
+struct navSearch_t
+{
+	qboolean			active;
+	int					start;
+	int					goal;
+	uint32				generation;
+
+	std::vector<float>	cost;
+	std::vector<int>	parent;
+	std::vector<uint32>	visited;	// == generation if cost and parent are set
+	std::vector<uint32>	closed;		// == generation once expanded
+
+	std::vector<std::pair<float, int>>	open;	// a heap, smallest estimate first
+};
+
+static std::vector<navNode_t>	nav_nodes;
+static std::vector<navLink_t>	nav_links;
+static std::vector<navCell_t>	nav_cells;		// sorted by key
+
+static navHop_t					nav_hops[NAV_HOP_CACHE];
+static std::vector<navQuery_t>	nav_queue;
+static navSearch_t				nav_search;
+
+// for g_navStats
+static int		nav_searches, nav_expansions, nav_hits, nav_misses;
+static int		nav_moveTraces;
+static float	nav_statTime;
+
+static int64 NavTime (void)
+{
+	using namespace std::chrono;
+	return duration_cast<microseconds> (steady_clock::now().time_since_epoch()).count();
+}
+
+/*
+=============================================================================
+
+LOOKUP
+
+=============================================================================
+*/
+
+static uint32 Nav_CellKey (int cx, int cy)
+{
+	return ((uint32)(cx + 32768) & 0xffff) << 16 | ((uint32)(cy + 32768) & 0xffff);
+}
+
+static int Nav_CellCoord (float v)
+{
+	return (int)floorf (v / NAV_CELL);
+}
+
+static void Nav_BuildCells (void)
+{
+	nav_cells.resize (nav_nodes.size());
+
+	for (size_t i = 0; i < nav_nodes.size(); i++)
+	{
+		nav_cells[i].key = Nav_CellKey (Nav_CellCoord (nav_nodes[i].origin[0]), Nav_CellCoord (nav_nodes[i].origin[1]));
+		nav_cells[i].node = (int32)i;
+	}
+
+	std::stable_sort (nav_cells.begin(), nav_cells.end(), [](const navCell_t &a, const navCell_t &b) { return a.key < b.key; });
+}
+
+// calls func with each node in the cells around point
+template< typename Func >
+static void Nav_ForNodesNear (const vec3_t point, Func &&func)
+{
+	const int cx = Nav_CellCoord (point[0]);
+	const int cy = Nav_CellCoord (point[1]);
+
+	for (int x = cx - 1; x <= cx + 1; x++)
+	{
+		for (int y = cy - 1; y <= cy + 1; y++)
+		{
+			const uint32 key = Nav_CellKey (x, y);
+			auto it = std::lower_bound (nav_cells.begin(), nav_cells.end(), key, [](const navCell_t &cell, uint32 k) { return cell.key < k; });
+
+			for ( ; it != nav_cells.end() && it->key == key; ++it)
+				func (it->node);
+		}
+	}
+}
+
+/*
+=============
+Nav_NearestNode
+
+The closest node to a point on the floor, or NAV_NO_NODE. Walls aren't
+checked, following the path sorts that out.
+=============
+*/
+int Nav_NearestNode (const vec3_t floor)
+{
+	int		best = NAV_NO_NODE;
+	float	bestDist = NAV_FIND_DIST * NAV_FIND_DIST;
+
+	Nav_ForNodesNear (floor, [&](int node)
+	{
+		const float *origin = nav_nodes[node].origin;
+		const float dz = origin[2] - floor[2];
+
+		if (fabsf (dz) > NAV_MAX_RISE)
+			return;
+
+		const float dx = origin[0] - floor[0];
+		const float dy = origin[1] - floor[1];
+
+		// height counts for more, so the floor below doesn't win over this one
+		const float dist = dx*dx + dy*dy + dz*dz*4;
+		if (dist < bestDist)
+		{
+			bestDist = dist;
+			best = node;
+		}
+	});
+
+	return best;
+}
+
+int Nav_NumNodes (void)
+{
+	return (int)nav_nodes.size();
+}
+
+void Nav_NodeOrigin (int node, vec3_t origin)
+{
+	VectorCopy (nav_nodes[node].origin, origin);
+}
+
+/*
+=============================================================================
+
+BUILDING
+
+=============================================================================
+*/
+
+// returns the origin the test hull has when standing on a floor point
+static void Nav_StandingOrigin (const vec3_t floor, vec3_t origin)
+{
+	VectorCopy (floor, origin);
+	origin[2] += 1 - nav_mins[2];
+}
+
+static qboolean Nav_CanStand (const vec3_t floor)
+{
+	vec3_t	origin, test;
+
+	Nav_StandingOrigin (floor, origin);
+
+	trace_t trace = gi.trace (origin, nav_mins, nav_maxs, origin, NULL, MASK_MONSTERSOLID);
+	if (trace.startsolid || trace.allsolid)
+		return false;
+
+	// monsters don't go in to water
+	VectorCopy (floor, test);
+	test[2] += 1;
+	if (gi.pointcontents (test) & MASK_WATER)
+		return false;
+
+	return true;
+}
+
+/*
+=============
+Nav_CheckBottom
+
+M_CheckBottom for the test hull standing at origin, false if a corner is
+over a drop a monster wouldn't step off
+=============
+*/
+static qboolean Nav_CheckBottom (const vec3_t origin)
+{
+	vec3_t	start, stop;
+	trace_t	trace;
+	int		x, y;
+
+	// if all of the points under the corners are solid world, don't bother
+	// with the tougher checks
+	start[2] = origin[2] + nav_mins[2] - 1;
+	for (x=0 ; x<=1 ; x++)
+		for (y=0 ; y<=1 ; y++)
+		{
+			start[0] = origin[0] + (x ? nav_maxs[0] : nav_mins[0]);
+			start[1] = origin[1] + (y ? nav_maxs[1] : nav_mins[1]);
+			if (gi.pointcontents (start) != CONTENTS_SOLID)
+				goto realcheck;
+		}
+
+	return true;
+
+realcheck:
+	// the midpoint must be within 2 steps of the bottom
+	start[0] = stop[0] = origin[0];
+	start[1] = stop[1] = origin[1];
+	start[2] = origin[2] + nav_mins[2];
+	stop[2] = start[2] - 2*STEPSIZE;
+	trace = gi.trace (start, vec3_origin, vec3_origin, stop, NULL, MASK_MONSTERSOLID);
+	if (trace.fraction == 1.0f)
+		return false;
+
+	const float mid = trace.endpos[2];
+
+	// the corners must be within a step of the midpoint
+	for (x=0 ; x<=1 ; x++)
+		for (y=0 ; y<=1 ; y++)
+		{
+			start[0] = stop[0] = origin[0] + (x ? nav_maxs[0] : nav_mins[0]);
+			start[1] = stop[1] = origin[1] + (y ? nav_maxs[1] : nav_mins[1]);
+
+			trace = gi.trace (start, vec3_origin, vec3_origin, stop, NULL, MASK_MONSTERSOLID);
+			if (trace.fraction == 1.0f || mid - trace.endpos[2] > STEPSIZE)
+				return false;
+		}
+
+	return true;
+}
+
+/*
+=============
+Nav_CanStep
+
+Walks the hull from a to b NAV_STEP at a time the way SV_movestep does,
+up a step, over and down as far as two steps. Fails if it has to climb
+more than a step, would walk off a ledge, M_CheckBottom would refuse
+where it ends up or it doesn't end up on b.
+=============
+*/
+static qboolean Nav_CanStep (const navNode_t &a, const navNode_t &b)
+{
+	vec3_t	origin, end, delta, neworg, below;
+	trace_t	trace;
+
+	Nav_StandingOrigin (a.origin, origin);
+	Nav_StandingOrigin (b.origin, end);
+
+	VectorSubtract (end, origin, delta);
+	delta[2] = 0;
+
+	const int steps = Max ((int)ceilf (VectorLength (delta) / NAV_STEP), 1);
+
+	for (int i = 1; i <= steps; i++)
+	{
+		neworg[0] = a.origin[0] + delta[0] * i / steps;
+		neworg[1] = a.origin[1] + delta[1] * i / steps;
+		neworg[2] = origin[2] + STEPSIZE;
+
+		VectorCopy (neworg, below);
+		below[2] = origin[2] - STEPSIZE;
+
+		trace = gi.trace (neworg, nav_mins, nav_maxs, below, NULL, MASK_MONSTERSOLID);
+		if (trace.allsolid)
+			return false;
+
+		if (trace.startsolid)
+		{
+			neworg[2] -= STEPSIZE;
+			trace = gi.trace (neworg, nav_mins, nav_maxs, below, NULL, MASK_MONSTERSOLID);
+			if (trace.allsolid || trace.startsolid)
+				return false;
+		}
+
+		// walked off a ledge
+		if (trace.fraction == 1.0f)
+			return false;
+
+		VectorCopy (trace.endpos, origin);
+
+		if (!Nav_CheckBottom (origin))
+			return false;
+	}
+
+	// and not on a floor above or below it
+	return fabsf (origin[2] - end[2]) <= 4;
+}
+
+/*
+=============
+Nav_CanWalk
+
+Links go both ways, so both ways have to be walkable
+=============
+*/
+static qboolean Nav_CanWalk (const navNode_t &a, const navNode_t &b)
+{
+	return Nav_CanStep (a, b) && Nav_CanStep (b, a);
+}
+
+template< typename T >
+static const T *Nav_Lump (const std::vector<byte> &bsp, int lump, int &count)
+{
+	const dheader_t *header = (const dheader_t *)bsp.data();
+	const lump_t *l = &header->lumps[lump];
+
+	if (l->fileofs < 0 || l->filelen < 0 || (size_t)l->fileofs + l->filelen > bsp.size())
+	{
+		count = 0;
+		return NULL;
+	}
+
+	count = l->filelen / (int)sizeof(T);
+	return (const T *)(bsp.data() + l->fileofs);
+}
+
+// only the lumps the graph comes from
+static uint32 Nav_HashBSP (const std::vector<byte> &bsp)
+{
+	static const int lumps[] = { LUMP_PLANES, LUMP_VERTEXES, LUMP_TEXINFO, LUMP_FACES, LUMP_EDGES, LUMP_SURFEDGES, LUMP_MODELS, LUMP_BRUSHES, LUMP_BRUSHSIDES };
+
+	const dheader_t *header = (const dheader_t *)bsp.data();
+	uint32 hash = 2166136261u ^ NAV_VERSION;
+
+	for (int lump : lumps)
+	{
+		const lump_t *l = &header->lumps[lump];
+		if (l->fileofs < 0 || l->filelen < 0 || (size_t)l->fileofs + l->filelen > bsp.size())
+			continue;
+
+		const byte *data = bsp.data() + l->fileofs;
+		for (int i = 0; i < l->filelen; i++)
+			hash = (hash ^ data[i]) * 16777619u;
+	}
+
+	return hash;
+}
+
+/*
+=============
+Nav_SampleFloors
+
+Puts candidate nodes on every floor of the world model
+=============
+*/
+static void Nav_SampleFloors (const std::vector<byte> &bsp, std::vector<navNode_t> &candidates)
+{
+	int numModels, numFaces, numPlanes, numTexinfo, numEdges, numSurfEdges, numVerts;
+
+	const dmodel_t *models = Nav_Lump<dmodel_t> (bsp, LUMP_MODELS, numModels);
+	const dface_t *faces = Nav_Lump<dface_t> (bsp, LUMP_FACES, numFaces);
+	const dplane_t *planes = Nav_Lump<dplane_t> (bsp, LUMP_PLANES, numPlanes);
+	const texinfo_t *texinfo = Nav_Lump<texinfo_t> (bsp, LUMP_TEXINFO, numTexinfo);
+	const dedge_t *edges = Nav_Lump<dedge_t> (bsp, LUMP_EDGES, numEdges);
+	const int32 *surfEdges = Nav_Lump<int32> (bsp, LUMP_SURFEDGES, numSurfEdges);
+	const dvertex_t *verts = Nav_Lump<dvertex_t> (bsp, LUMP_VERTEXES, numVerts);
+
+	if (numModels < 1)
+		return;
+
+	const int lastFace = Min (models[0].firstface + models[0].numfaces, numFaces);
+
+	for (int f = Max (models[0].firstface, 0); f < lastFace; f++)
+	{
+		const dface_t *face = &faces[f];
+
+		if (face->planenum >= numPlanes || face->texinfo < 0 || face->texinfo >= numTexinfo)
+			continue;
+		if (texinfo[face->texinfo].flags & (SURF_SKY | SURF_WARP | SURF_NODRAW))
+			continue;
+
+		vec3_t normal;
+		VectorCopy (planes[face->planenum].normal, normal);
+		float dist = planes[face->planenum].dist;
+		if (face->side)
+		{
+			VectorNegate (normal, normal);
+			dist = -dist;
+		}
+
+		// too steep to walk on
+		if (normal[2] < 0.7f)
+			continue;
+
+		vec3_t points[64];
+		int numPoints = 0;
+		vec3_t mins = { 99999, 99999, 99999 }, maxs = { -99999, -99999, -99999 };
+
+		for (int e = 0; e < face->numedges && numPoints < 64; e++)
+		{
+			const int index = face->firstedge + e;
+			if (index < 0 || index >= numSurfEdges)
+				break;
+
+			const int surfEdge = surfEdges[index];
+			if (abs (surfEdge) >= numEdges)
+				break;
+
+			const int v = surfEdge >= 0 ? edges[surfEdge].v[0] : edges[-surfEdge].v[1];
+			if (v >= numVerts)
+				break;
+
+			VectorCopy (verts[v].point, points[numPoints]);
+			AddPointToBounds (points[numPoints], mins, maxs);
+			numPoints++;
+		}
+
+		if (numPoints < 3)
+			continue;
+
+		// the XY projection is fine for anything walkable
+		auto inside = [&](float x, float y)
+		{
+			qboolean in = false;
+			for (int i = 0, j = numPoints - 1; i < numPoints; j = i++)
+			{
+				if ((points[i][1] > y) != (points[j][1] > y)
+					&& x < (points[j][0] - points[i][0]) * (y - points[i][1]) / (points[j][1] - points[i][1]) + points[i][0])
+					in = !in;
+			}
+			return in;
+		};
+
+		auto add = [&](float x, float y)
+		{
+			navNode_t &node = candidates.emplace_back();
+			node.origin[0] = x;
+			node.origin[1] = y;
+			node.origin[2] = (dist - normal[0] * x - normal[1] * y) / normal[2];
+			node.firstLink = 0;
+			node.numLinks = 0;
+		};
+
+		// world aligned, so floors that meet keep the spacing
+		const size_t before = candidates.size();
+		for (float x = ceilf (mins[0] / NAV_GRID) * NAV_GRID; x <= maxs[0]; x += NAV_GRID)
+		{
+			for (float y = ceilf (mins[1] / NAV_GRID) * NAV_GRID; y <= maxs[1]; y += NAV_GRID)
+			{
+				if (inside (x, y))
+					add (x, y);
+			}
+		}
+
+		// stair steps and the like are too small for the grid
+		if (candidates.size() == before)
+		{
+			vec3_t centre = { 0, 0, 0 };
+			for (int i = 0; i < numPoints; i++)
+				VectorAdd (centre, points[i], centre);
+			add (centre[0] / numPoints, centre[1] / numPoints);
+		}
+	}
+}
+
+/*
+=============
+Nav_BuildGraph
+=============
+*/
+static void Nav_BuildGraph (const std::vector<byte> &bsp)
+{
+	std::vector<navNode_t> candidates;
+	Nav_SampleFloors (bsp, candidates);
+
+	// one node per merge cube, the first one sampled wins
+	auto mergeKey = [](const navNode_t &node)
+	{
+		return G_CellKey ((int)floorf (node.origin[0] / NAV_MERGE), (int)floorf (node.origin[1] / NAV_MERGE), (int)floorf (node.origin[2] / NAV_MERGE));
+	};
+
+	std::stable_sort (candidates.begin(), candidates.end(), [&](const navNode_t &a, const navNode_t &b) { return mergeKey (a) < mergeKey (b); });
+	candidates.erase (std::unique (candidates.begin(), candidates.end(), [&](const navNode_t &a, const navNode_t &b) { return mergeKey (a) == mergeKey (b); }), candidates.end());
+
+	nav_nodes.clear();
+	for (const navNode_t &node : candidates)
+	{
+		if (Nav_CanStand (node.origin))
+			nav_nodes.push_back (node);
+	}
+
+	Nav_BuildCells ();
+
+	// links go both ways, so each pair is only walked once
+	std::vector<std::vector<navLink_t>> adjacency (nav_nodes.size());
+
+	for (int i = 0; i < (int)nav_nodes.size(); i++)
+	{
+		const navNode_t &a = nav_nodes[i];
+
+		Nav_ForNodesNear (a.origin, [&](int j)
+		{
+			if (j <= i)
+				return;
+
+			const navNode_t &b = nav_nodes[j];
+			vec3_t delta;
+			VectorSubtract (b.origin, a.origin, delta);
+
+			if (fabsf (delta[2]) > NAV_MAX_RISE || delta[0]*delta[0] + delta[1]*delta[1] > NAV_LINK_DIST * NAV_LINK_DIST)
+				return;
+
+			if (!Nav_CanWalk (a, b))
+				return;
+
+			const float cost = VectorLength (delta);
+			adjacency[i].push_back ({ j, cost });
+			adjacency[j].push_back ({ i, cost });
+		});
+	}
+
+	nav_links.clear();
+	for (size_t i = 0; i < nav_nodes.size(); i++)
+	{
+		nav_nodes[i].firstLink = (int32)nav_links.size();
+		nav_nodes[i].numLinks = (int32)adjacency[i].size();
+		nav_links.insert (nav_links.end(), adjacency[i].begin(), adjacency[i].end());
+	}
+}
+
+static qboolean Nav_ReadCache (const char *name, uint32 bspHash)
+{
+	navHeader_t header;
+
+	fsHandle_t f = gi.fileSystem->OpenFileRead (name);
+	if (!f)
+		return false;
+
+	const fsSize_t fileSize = gi.fileSystem->GetFileSize (f);
+	if (fileSize < sizeof(header) || gi.fileSystem->ReadFile (&header, sizeof(header), f) != sizeof(header)
+		|| header.magic != NAV_MAGIC || header.version != NAV_VERSION || header.bspHash != bspHash
+		|| header.numNodes < 0 || header.numLinks < 0
+		|| (fsSize_t)(sizeof(header) + header.numNodes * sizeof(navNode_t) + header.numLinks * sizeof(navLink_t)) != fileSize)
+	{
+		gi.fileSystem->CloseFile (f);
+		return false;
+	}
+
+	nav_nodes.resize (header.numNodes);
+	nav_links.resize (header.numLinks);
+	gi.fileSystem->ReadFile (nav_nodes.data(), (fsSize_t)(nav_nodes.size() * sizeof(navNode_t)), f);
+	gi.fileSystem->ReadFile (nav_links.data(), (fsSize_t)(nav_links.size() * sizeof(navLink_t)), f);
+	gi.fileSystem->CloseFile (f);
+
+	// don't trust anything that points outside the graph
+	for (const navNode_t &node : nav_nodes)
+	{
+		if (node.firstLink < 0 || node.numLinks < 0 || node.firstLink + node.numLinks > header.numLinks)
+			return false;
+	}
+	for (const navLink_t &link : nav_links)
+	{
+		if (link.node < 0 || link.node >= header.numNodes)
+			return false;
+	}
+
+	Nav_BuildCells ();
+	return true;
+}
+
+static void Nav_WriteCache (const char *name, uint32 bspHash)
+{
+	navHeader_t header;
+
+	header.magic = NAV_MAGIC;
+	header.version = NAV_VERSION;
+	header.bspHash = bspHash;
+	header.numNodes = (int32)nav_nodes.size();
+	header.numLinks = (int32)nav_links.size();
+
+	fsHandle_t f = gi.fileSystem->OpenFileWrite (name);
+	if (!f)
+	{
+		gi.dprintf ("Couldn't write %s\n", name);
+		return;
+	}
+
+	gi.fileSystem->WriteFile (&header, sizeof(header), f);
+	gi.fileSystem->WriteFile (nav_nodes.data(), (fsSize_t)(nav_nodes.size() * sizeof(navNode_t)), f);
+	gi.fileSystem->WriteFile (nav_links.data(), (fsSize_t)(nav_links.size() * sizeof(navLink_t)), f);
+	gi.fileSystem->CloseFile (f);
+}
+
+/*
+=============
+Nav_FreeGraph
+=============
+*/
+void Nav_FreeGraph (void)
+{
+	nav_nodes.clear();
+	nav_links.clear();
+	nav_cells.clear();
+	nav_queue.clear();
+
+	nav_search.active = false;
+	nav_search.cost.clear();
+	nav_search.parent.clear();
+	nav_search.visited.clear();
+	nav_search.closed.clear();
+	nav_search.open.clear();
+
+	for (navHop_t &hop : nav_hops)
+		hop.node = -1;
+}
+
+/*
+=============
+Nav_LoadGraph
+
+Called before the level's entities spawn, so only the world is in the way
+of the traces that build the graph
+=============
+*/
+void Nav_LoadGraph (const char *mapname)
+{
+	char	bspName[MAX_QPATH], navName[MAX_QPATH];
+
+	Nav_FreeGraph ();
+
+	if (!g_nav->GetBool())
+		return;
+
+	Q_sprintf_s (bspName, "maps/%s.bsp", mapname);
+	Q_sprintf_s (navName, "maps/%s.nav", mapname);
+
+	fsHandle_t f = gi.fileSystem->OpenFileRead (bspName);
+	if (!f)
+		return;		// a cinematic or something
+
+	std::vector<byte> bsp (gi.fileSystem->GetFileSize (f));
+	gi.fileSystem->ReadFile (bsp.data(), (fsSize_t)bsp.size(), f);
+	gi.fileSystem->CloseFile (f);
+
+	const dheader_t *header = (const dheader_t *)bsp.data();
+	if (bsp.size() < sizeof(dheader_t) || header->ident != IDBSPHEADER || header->version != BSPVERSION)
+		return;
+
+	const uint32 bspHash = Nav_HashBSP (bsp);
+
+	if (Nav_ReadCache (navName, bspHash))
+	{
+		gi.dprintf ("Loaded %s, %d nodes, %d links\n", navName, (int)nav_nodes.size(), (int)nav_links.size());
+		return;
+	}
+
+	const int64 start = NavTime ();
+
+	Nav_BuildGraph (bsp);
+	Nav_WriteCache (navName, bspHash);
+
+	gi.dprintf ("Built %s in %.1f ms, %d nodes, %d links\n", navName, (NavTime () - start) * 0.001, (int)nav_nodes.size(), (int)nav_links.size());
+}
+
+/*
+=============================================================================
+
+PATH PLANNING
+
+=============================================================================
+*/
+
+static int Nav_HopSlot (int node, int goal)
+{
+	return G_HashSlot ((uint32)node, (uint32)goal, NAV_HOP_CACHE);
+}
+
+static void Nav_CacheHop (int node, int goal, int next)
+{
+	navHop_t &hop = nav_hops[Nav_HopSlot (node, goal)];
+	hop.node = node;
+	hop.goal = goal;
+	hop.next = next;
+	hop.expires = level.time + NAV_HOP_TIME;
+}
+
+// true if the slot holds a hop from node to goal that's still trusted
+static qboolean Nav_HopKnown (const navHop_t &hop, int node, int goal)
+{
+	return hop.node == node && hop.goal == goal && level.time < hop.expires;
+}
+
+static qboolean Nav_Queued (int start, int goal)
+{
+	for (const navQuery_t &query : nav_queue)
+	{
+		if (query.start == start && query.goal == goal)
+			return true;
+	}
+	return nav_search.active && nav_search.start == start && nav_search.goal == goal;
+}
+
+/*
+=============
+Nav_NextHop
+
+The node after node on the way to goal, NAV_NO_PATH if there isn't a way,
+or NAV_NO_NODE if it isn't known yet. Unknown ways are queued up to be
+found, ask again on a later frame.
+=============
+*/
+int Nav_NextHop (int node, int goal)
+{
+	const navHop_t &hop = nav_hops[Nav_HopSlot (node, goal)];
+	if (Nav_HopKnown (hop, node, goal))
+	{
+		nav_hits++;
+		return hop.next;
+	}
+
+	nav_misses++;
+
+	if ((int)nav_queue.size() < NAV_MAX_QUEUED && !Nav_Queued (node, goal))
+		nav_queue.push_back ({ node, goal });
+
+	return NAV_NO_NODE;
+}
+
+/*
+=============
+Nav_ForgetHop
+
+A monster couldn't step along the hop from node, search for it again the
+next time it's asked for
+=============
+*/
+void Nav_ForgetHop (int node, int goal)
+{
+	navHop_t &hop = nav_hops[Nav_HopSlot (node, goal)];
+	if (hop.node == node && hop.goal == goal)
+		hop.node = -1;
+}
+
+static float Nav_Estimate (int node, int goal)
+{
+	vec3_t delta;
+	VectorSubtract (nav_nodes[goal].origin, nav_nodes[node].origin, delta);
+	return VectorLength (delta);
+}
+
+static void Nav_BeginSearch (int start, int goal)
+{
+	navSearch_t &s = nav_search;
+
+	if (s.visited.size() != nav_nodes.size())
+	{
+		s.cost.assign (nav_nodes.size(), 0.0f);
+		s.parent.assign (nav_nodes.size(), NAV_NO_NODE);
+		s.visited.assign (nav_nodes.size(), 0);
+		s.closed.assign (nav_nodes.size(), 0);
+		s.generation = 0;
+	}
+
+	s.active = true;
+	s.start = start;
+	s.goal = goal;
+	s.generation++;
+	s.open.clear();
+
+	s.cost[start] = 0.0f;
+	s.parent[start] = NAV_NO_NODE;
+	s.visited[start] = s.generation;
+	s.open.push_back ({ Nav_Estimate (start, goal), start });
+
+	nav_searches++;
+}
+
+// remembers the way from every node on the path
+static void Nav_FinishSearch (qboolean found)
+{
+	navSearch_t &s = nav_search;
+	s.active = false;
+
+	if (!found)
+	{
+		Nav_CacheHop (s.start, s.goal, NAV_NO_PATH);
+		return;
+	}
+
+	for (int node = s.goal; s.parent[node] != NAV_NO_NODE; node = s.parent[node])
+		Nav_CacheHop (s.parent[node], s.goal, node);
+}
+
+/*
+=============
+Nav_RunSearches
+
+Works through the queued searches until the budget runs out
+=============
+*/
+static void Nav_RunSearches (int budget)
+{
+	navSearch_t &s = nav_search;
+	auto greater = [](const std::pair<float, int> &a, const std::pair<float, int> &b) { return a.first > b.first; };
+
+	while (budget > 0)
+	{
+		if (!s.active)
+		{
+			if (nav_queue.empty())
+				return;
+
+			const navQuery_t query = nav_queue.front();
+			nav_queue.erase (nav_queue.begin());
+
+			// someone else's search might have found it already
+			const navHop_t &hop = nav_hops[Nav_HopSlot (query.start, query.goal)];
+			if (Nav_HopKnown (hop, query.start, query.goal))
+				continue;
+
+			Nav_BeginSearch (query.start, query.goal);
+		}
+
+		if (s.open.empty())
+		{
+			Nav_FinishSearch (false);
+			continue;
+		}
+
+		std::pop_heap (s.open.begin(), s.open.end(), greater);
+		const int node = s.open.back().second;
+		s.open.pop_back();
+
+		if (s.closed[node] == s.generation)
+			continue;
+		s.closed[node] = s.generation;
+
+		budget--;
+		nav_expansions++;
+
+		if (node == s.goal)
+		{
+			Nav_FinishSearch (true);
+			continue;
+		}
+
+		const navNode_t &n = nav_nodes[node];
+		for (int i = 0; i < n.numLinks; i++)
+		{
+			const navLink_t &link = nav_links[n.firstLink + i];
+			const float cost = s.cost[node] + link.cost;
+
+			if (s.closed[link.node] == s.generation)
+				continue;
+			if (s.visited[link.node] == s.generation && cost >= s.cost[link.node])
+				continue;
+
+			s.visited[link.node] = s.generation;
+			s.cost[link.node] = cost;
+			s.parent[link.node] = node;
+
+			s.open.push_back ({ cost + Nav_Estimate (link.node, s.goal), link.node });
+			std::push_heap (s.open.begin(), s.open.end(), greater);
+		}
+	}
+}
+
+/*
+=============
+Nav_CountMoveTraces
+
+m_move.cpp reports the traces it makes, so the effect of the graph can be
+seen with g_navStats
+=============
+*/
+void Nav_CountMoveTraces (int count)
+{
+	nav_moveTraces += count;
+}
+
+/*
+=============
+Nav_RunFrame
+=============
+*/
+void Nav_RunFrame (void)
+{
+	if (!nav_nodes.empty())
+		Nav_RunSearches (Max (g_navBudget->GetInt(), 1));
+
+	const int frames = G_StatsDue (g_navStats, nav_statTime);
+
+	if (!g_navStats->GetBool())
+	{
+		nav_moveTraces = nav_searches = nav_expansions = nav_hits = nav_misses = 0;
+		return;
+	}
+
+	if (!frames)
+		return;
+
+	gi.dprintf ("nav: %.1f move traces/frame, %d searches, %d expansions, %d hits, %d misses, %d queued\n",
+		(float)nav_moveTraces / frames, nav_searches, nav_expansions, nav_hits, nav_misses, (int)nav_queue.size());
+
+	nav_moveTraces = nav_searches = nav_expansions = nav_hits = nav_misses = 0;
+}
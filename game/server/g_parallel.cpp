@@ -0,0 +1,1104 @@
+// g_parallel.cpp -- moves worked out on the job workers before the frame runs
+
+#include "g_local.h"
+
+#include "../../core/jobsystem.h"
+
+#include <algorithm>
+#include <vector>
+
+/*
+=============================================================================
+
+PARALLEL MOVES
+
+Everything in G_RunFrame runs in entity order on the main thread, and most
+of what the game does there can't be moved off it. The trace that moves a
+flying or falling entity can though, it only reads the world. With
+g_parallelThink set the entities that are in the air, won't think this
+frame and have nobody else moving nearby are found before the frame runs.
+Those islands of one have their moves traced together on the job workers.
+
+The frame then runs in order as before. When SV_PushEntity comes to one of
+them it takes the traced move if it asks for the same move and nothing
+solid has been linked, moved or unlinked in its way since. Anything else is
+a conflict and it traces again right there, so the result is always what
+the serial frame would have done. g_parallelCheck traces every move taken
+serially as well and reports any that differ.
+
+=============================================================================
+*/
+
+#define PAR_CELL		128		// size of the cells used to find who's near who
+#define PAR_MARGIN		16		// extra room given to anything that moves
+#define PAR_MAX_TOUCH	16		// more solid entities than this around and it's not worth it
+
+struct parMove_t
+{
+	edict_t		*ent;
+	vec3_t		start, end;
+	vec3_t		mins, maxs;
+	int			mask;
+	edict_t		*owner;
+
+	trace_t		trace;
+	qboolean	valid;
+
+	// what was in the way, and how many times each had been linked
+	int			numTouch;
+	edict_t		*touch[PAR_MAX_TOUCH];
+	int			linkcount[PAR_MAX_TOUCH];
+};
+
+struct parCell_t
+{
+	uint64		key;
+	int			entnum;
+};
+
+static std::vector<parMove_t>	par_moves;
+static std::vector<int>			par_index;		// per entity, into par_moves or -1
+static std::vector<parCell_t>	par_cells;
+static qboolean					par_started;
+
+// for g_parallelStats
+static int	par_candidates, par_predicted, par_used, par_conflicts, par_divergent;
+static float	par_statTime;
+static int	pm_queued, pm_simulated, pm_used, pm_conflicts, pm_divergent;
+
+static void G_ClearQueuedMoves (void);
+
+/*
+=============
+G_StartJobs
+=============
+*/
+static void G_StartJobs (void)
+{
+	if (!par_started)
+	{
+		Jobs::Init ();
+		par_started = true;
+	}
+}
+
+/*
+=============
+G_StopJobs
+=============
+*/
+void G_StopJobs (void)
+{
+	if (par_started)
+	{
+		Jobs::Shutdown ();
+		par_started = false;
+	}
+}
+
+/*
+=============
+G_ShutdownParallel
+=============
+*/
+void G_ShutdownParallel (void)
+{
+	G_StopJobs ();
+
+	par_moves.clear();
+	par_index.clear();
+	par_cells.clear();
+
+	G_ClearQueuedMoves ();
+}
+
+// the box SV_Trace looks for entities in
+static void G_MoveBounds (const vec3_t start, const vec3_t mins, const vec3_t maxs, const vec3_t end, vec3_t boxmins, vec3_t boxmaxs)
+{
+	for (int i = 0; i < 3; i++)
+	{
+		boxmins[i] = Min (start[i], end[i]) + mins[i] - 1.0f;
+		boxmaxs[i] = Max (start[i], end[i]) + maxs[i] + 1.0f;
+	}
+}
+
+template< typename Func >
+static void G_ForCells (const vec3_t mins, const vec3_t maxs, Func &&func)
+{
+	int lo[3], hi[3];
+
+	for (int i = 0; i < 3; i++)
+	{
+		lo[i] = (int)floorf (mins[i] / PAR_CELL);
+		hi[i] = (int)floorf (maxs[i] / PAR_CELL);
+	}
+
+	for (int x = lo[0]; x <= hi[0]; x++)
+		for (int y = lo[1]; y <= hi[1]; y++)
+			for (int z = lo[2]; z <= hi[2]; z++)
+				func (G_CellKey (x, y, z));
+}
+
+static qboolean G_ThinksThisFrame (edict_t *ent)
+{
+	return ent->prethink || (ent->nextthink > 0 && ent->nextthink <= level.time + 0.001f);
+}
+
+/*
+=============
+G_MightMove
+
+False for anything that can't get in the way of a move this frame
+=============
+*/
+static qboolean G_MightMove (edict_t *ent)
+{
+	if (ent->client || (ent->svflags & SVF_MONSTER))
+		return true;
+
+	// only triggers and the like, nothing clips against them
+	if (ent->solid == SOLID_NOT || ent->solid == SOLID_TRIGGER)
+		return false;
+
+	if (G_ThinksThisFrame (ent))
+		return true;
+
+	if (!VectorCompare (ent->velocity, vec3_origin) || !VectorCompare (ent->avelocity, vec3_origin))
+		return true;
+
+	// falling
+	return !ent->groundentity && (ent->movetype == MOVETYPE_TOSS || ent->movetype == MOVETYPE_BOUNCE || ent->movetype == MOVETYPE_STEP);
+}
+
+// everywhere ent could get to this frame
+static void G_ReachBounds (edict_t *ent, vec3_t mins, vec3_t maxs)
+{
+	float reach = VectorLength (ent->velocity) * FRAMETIME + PAR_MARGIN;
+
+	// anything spinning sweeps out its whole size
+	if (!VectorCompare (ent->avelocity, vec3_origin))
+		reach += Max (VectorLength (ent->mins), VectorLength (ent->maxs));
+
+	for (int i = 0; i < 3; i++)
+	{
+		mins[i] = ent->absmin[i] - reach;
+		maxs[i] = ent->absmax[i] + reach;
+	}
+}
+
+/*
+=============
+G_CanPredict
+
+Entities going through SV_Physics_Toss with nothing but their move to do
+=============
+*/
+static qboolean G_CanPredict (edict_t *ent)
+{
+	switch (ent->movetype)
+	{
+	case MOVETYPE_TOSS:
+	case MOVETYPE_BOUNCE:
+	case MOVETYPE_FLY:
+	case MOVETYPE_FLYMISSILE:
+		break;
+	default:
+		return false;
+	}
+
+	if (ent->client || (ent->flags & FL_TEAMSLAVE))
+		return false;
+
+	// a think can change anything
+	if (G_ThinksThisFrame (ent))
+		return false;
+
+	if (ent->groundentity && ent->groundentity->inuse && ent->velocity[2] <= 0)
+		return false;	// on the ground, it won't move
+
+	return true;
+}
+
+// the move SV_Physics_Toss is going to make, the same sums in the same order
+static void G_PredictMove (edict_t *ent, parMove_t &move)
+{
+	vec3_t	velocity, push;
+
+	VectorCopy (ent->velocity, velocity);
+	for (int i = 0; i < 3; i++)
+	{
+		if (velocity[i] > sv_maxvelocity->GetFloat())
+			velocity[i] = sv_maxvelocity->GetFloat();
+		else if (velocity[i] < -sv_maxvelocity->GetFloat())
+			velocity[i] = -sv_maxvelocity->GetFloat();
+	}
+
+	if (ent->movetype != MOVETYPE_FLY && ent->movetype != MOVETYPE_FLYMISSILE)
+		velocity[2] -= ent->gravity * sv_gravity->GetFloat() * FRAMETIME;
+
+	VectorScale (velocity, FRAMETIME, push);
+	VectorCopy (ent->s.origin, move.start);
+	VectorAdd (move.start, push, move.end);
+	VectorCopy (ent->mins, move.mins);
+	VectorCopy (ent->maxs, move.maxs);
+
+	move.ent = ent;
+	move.mask = ent->clipmask ? ent->clipmask : MASK_SOLID;
+	move.owner = ent->owner;
+	move.valid = false;
+}
+
+static qboolean G_TouchSignature (parMove_t &move, int &numTouch, edict_t **touch, int *linkcount)
+{
+	edict_t	*list[MAX_EDICTS];
+	vec3_t	boxmins, boxmaxs;
+
+	G_MoveBounds (move.start, move.mins, move.maxs, move.end, boxmins, boxmaxs);
+
+	numTouch = gi.BoxEdicts (boxmins, boxmaxs, list, MAX_EDICTS, AREA_SOLID);
+	if (numTouch > PAR_MAX_TOUCH)
+		return false;
+
+	for (int i = 0; i < numTouch; i++)
+	{
+		touch[i] = list[i];
+		linkcount[i] = list[i]->linkcount;
+	}
+	return true;
+}
+
+static void G_PredictJob (void *params, uint32 index)
+{
+	parMove_t &move = static_cast<parMove_t *>(params)[index];
+
+	if (!G_TouchSignature (move, move.numTouch, move.touch, move.linkcount))
+		return;
+
+	move.trace = gi.trace (move.start, move.mins, move.maxs, move.end, move.ent, move.mask);
+	move.valid = true;
+}
+
+/*
+=============
+G_PredictMoves
+
+Called before anything in the frame runs
+=============
+*/
+void G_PredictMoves (void)
+{
+	vec3_t	mins, maxs;
+	int		i;
+
+	if (G_StatsDue (g_parallelStats, par_statTime))
+	{
+		gi.dprintf ("parallel: %d candidates, %d predicted, %d used, %d conflicts, %d divergent, %u workers\n",
+			par_candidates, par_predicted, par_used, par_conflicts, par_divergent, Jobs::NumWorkers());
+		gi.dprintf ("parallel players: %d moves, %d simulated, %d used, %d conflicts, %d divergent\n",
+			pm_queued, pm_simulated, pm_used, pm_conflicts, pm_divergent);
+		par_candidates = par_predicted = par_used = par_conflicts = par_divergent = 0;
+		pm_queued = pm_simulated = pm_used = pm_conflicts = pm_divergent = 0;
+	}
+
+	par_moves.clear();
+	par_index.assign (game.maxentities, -1);
+
+	if (!g_parallelThink->GetBool())
+		return;
+
+	G_StartJobs ();
+
+	// everything that could move this frame goes in the cells it could reach
+	par_cells.clear();
+	for (i = 1; i < globals.num_edicts; i++)
+	{
+		edict_t *ent = &g_edicts[i];
+		if (!ent->inuse || !(G_MightMove (ent) || G_CanPredict (ent)))
+			continue;
+
+		G_ReachBounds (ent, mins, maxs);
+		G_ForCells (mins, maxs, [&](uint64 key) { par_cells.push_back ({ key, i }); });
+	}
+	std::sort (par_cells.begin(), par_cells.end(), [](const parCell_t &a, const parCell_t &b) { return a.key < b.key || (a.key == b.key && a.entnum < b.entnum); });
+
+	// only the ones with nobody else moving in their cells are worth it
+	for (i = game.maxclients + 1; i < globals.num_edicts; i++)
+	{
+		edict_t *ent = &g_edicts[i];
+		if (!ent->inuse || !G_CanPredict (ent))
+			continue;
+
+		par_candidates++;
+
+		G_ReachBounds (ent, mins, maxs);
+
+		qboolean alone = true;
+		G_ForCells (mins, maxs, [&](uint64 key)
+		{
+			auto it = std::lower_bound (par_cells.begin(), par_cells.end(), key, [](const parCell_t &cell, uint64 k) { return cell.key < k; });
+			for ( ; alone && it != par_cells.end() && it->key == key; ++it)
+			{
+				if (it->entnum != i)
+					alone = false;
+			}
+		});
+
+		if (!alone)
+			continue;
+
+		par_index[i] = (int)par_moves.size();
+		G_PredictMove (ent, par_moves.emplace_back());
+	}
+
+	if (par_moves.empty())
+		return;
+
+	par_predicted += (int)par_moves.size();
+
+	Jobs::ParallelFor ((uint32)par_moves.size(), G_PredictJob, par_moves.data());
+}
+
+static qboolean G_SameTrace (const trace_t &a, const trace_t &b)
+{
+	return a.allsolid == b.allsolid && a.startsolid == b.startsolid && a.fraction == b.fraction
+		&& VectorCompare (a.endpos, b.endpos) && VectorCompare (a.plane.normal, b.plane.normal)
+		&& a.plane.dist == b.plane.dist && a.surface == b.surface && a.contents == b.contents && a.ent == b.ent;
+}
+
+/*
+=============
+G_PredictedTrace
+
+Fills in trace with the move worked out before the frame, if it's the one
+being asked for and nothing has got in the way since
+=============
+*/
+qboolean G_PredictedTrace (edict_t *ent, const vec3_t start, const vec3_t end, int mask, trace_t &trace)
+{
+	edict_t	*touch[PAR_MAX_TOUCH];
+	int		linkcount[PAR_MAX_TOUCH];
+	int		numTouch;
+
+	const ptrdiff_t entnum = ent - g_edicts;
+	if (entnum < 0 || entnum >= (ptrdiff_t)par_index.size() || par_index[entnum] < 0)
+		return false;
+
+	parMove_t &move = par_moves[par_index[entnum]];
+	par_index[entnum] = -1;		// only good for the first try
+
+	if (!move.valid)
+		return false;
+
+	if (!VectorCompare (start, move.start) || !VectorCompare (end, move.end) || mask != move.mask
+		|| !VectorCompare (ent->mins, move.mins) || !VectorCompare (ent->maxs, move.maxs) || ent->owner != move.owner)
+	{
+		par_conflicts++;
+		return false;
+	}
+
+	if (!G_TouchSignature (move, numTouch, touch, linkcount) || numTouch != move.numTouch)
+	{
+		par_conflicts++;
+		return false;
+	}
+
+	for (int i = 0; i < numTouch; i++)
+	{
+		if (touch[i] != move.touch[i] || linkcount[i] != move.linkcount[i])
+		{
+			par_conflicts++;
+			return false;
+		}
+	}
+
+	trace = move.trace;
+	par_used++;
+
+	if (g_parallelCheck->GetBool())
+	{
+		const trace_t serial = gi.trace (move.start, move.mins, move.maxs, move.end, ent, mask);
+		if (!G_SameTrace (serial, trace))
+		{
+			par_divergent++;
+			gi.dprintf ("G_PredictedTrace: %s at %s moved differently in parallel\n", ent->classname, vtos (ent->s.origin));
+			trace = serial;
+		}
+	}
+
+	return true;
+}
+
+/*
+=============================================================================
+
+PLAYER MOVES
+
+ClientThink used to run each usercmd the moment the server read it. With
+g_parallelPlayers set in a multiplayer game the commands are queued
+instead, and run the next time the server calls into the game for
+anything, so nothing can tell they were held back.
+
+Before the queue is run each player's commands are simulated one after the
+other on the job workers, starting from where the player is now and
+tracing against everything else where it is now. The queue then runs in
+the order the commands arrived, and when a command comes to its pmove it
+takes the simulated one if it starts from the same state and nothing solid
+around the moves has been linked, moved or unlinked since. Players running
+into each other get sorted out there, whoever comes second is simulated
+again on the main thread. g_parallelCheck simulates every move that's
+taken again and reports any that differ.
+
+=============================================================================
+*/
+
+#define PM_MAX_TOUCH	32
+
+struct pmQueued_t
+{
+	edict_t				*ent;
+	usercmd_t			cmd;
+	int					player;		// into pm_players, or -1
+
+	// worked out on the job workers
+	pmove_state_t		start;
+	pmove_t				result;
+	pmDeferredSounds_t	sounds;
+};
+
+struct pmPlayer_t
+{
+	edict_t		*ent;
+	int			first, count;	// into pm_order
+	int			mask;
+
+	// everything the moves went near, and how many times each had been linked
+	vec3_t		mins, maxs;
+	int			numTouch;
+	edict_t		*touch[PM_MAX_TOUCH];
+	int			linkcount[PM_MAX_TOUCH];
+	qboolean	valid;
+};
+
+static std::vector<pmQueued_t>	pm_queue;
+static std::vector<int>			pm_order;		// pm_queue by player, then by when it came in
+static std::vector<pmPlayer_t>	pm_players;
+static pmQueued_t				*pm_running;	// the command G_RunQueuedMoves is running
+static qboolean					pm_flushing;
+static qboolean					pm_replaying;	// sv replaymoves, nothing gets heard
+
+static thread_local pmPlayer_t	*pm_worker;
+
+static void G_ClearQueuedMoves (void)
+{
+	pm_queue.clear();
+	pm_order.clear();
+	pm_players.clear();
+	pm_running = NULL;
+	pm_flushing = false;
+}
+
+/*
+=============
+G_QueueClientThink
+
+Returns false if the command should be run straight away
+=============
+*/
+qboolean G_QueueClientThink (edict_t *ent, usercmd_t *ucmd)
+{
+	if (pm_flushing || game.maxclients < 2 || !g_parallelPlayers->GetBool())
+		return false;
+
+	pmQueued_t &queued = pm_queue.emplace_back();
+	queued.ent = ent;
+	queued.cmd = *ucmd;
+	queued.player = -1;
+
+	pm_queued++;
+	return true;
+}
+
+static void G_AddPlayerBounds (const vec3_t mins, const vec3_t maxs)
+{
+	for (int i = 0; i < 3; i++)
+	{
+		pm_worker->mins[i] = Min (pm_worker->mins[i], mins[i]);
+		pm_worker->maxs[i] = Max (pm_worker->maxs[i], maxs[i]);
+	}
+}
+
+// the pmove callbacks used on the job workers, they keep track of where the moves went
+static trace_t G_WorkerPMTrace (vec3_t start, vec3_t mins, vec3_t maxs, vec3_t end)
+{
+	vec3_t	boxmins, boxmaxs;
+
+	G_MoveBounds (start, mins, maxs, end, boxmins, boxmaxs);
+	G_AddPlayerBounds (boxmins, boxmaxs);
+
+	return gi.trace (start, mins, maxs, end, pm_worker->ent, pm_worker->mask);
+}
+
+static int G_WorkerPMPointContents (vec3_t point)
+{
+	vec3_t	boxmins, boxmaxs;
+
+	G_MoveBounds (point, vec3_origin, vec3_origin, point, boxmins, boxmaxs);
+	G_AddPlayerBounds (boxmins, boxmaxs);
+
+	return gi.pointcontents (point);
+}
+
+static void G_WorkerPMSound (const char *sample, float volume)
+{
+	// never called, the sounds are deferred
+	assert (0);
+}
+
+/*
+=============
+G_PlayerSignature
+
+Everything solid around the moves, leaving out the player and what it owns
+since its traces pass through them
+=============
+*/
+static qboolean G_PlayerSignature (const pmPlayer_t &player, int &numTouch, edict_t **touch, int *linkcount)
+{
+	edict_t	*list[MAX_EDICTS];
+
+	const int count = gi.BoxEdicts ((float *)player.mins, (float *)player.maxs, list, MAX_EDICTS, AREA_SOLID);
+
+	numTouch = 0;
+	for (int i = 0; i < count; i++)
+	{
+		if (list[i] == player.ent || list[i]->owner == player.ent)
+			continue;
+
+		if (numTouch == PM_MAX_TOUCH)
+			return false;
+
+		touch[numTouch] = list[i];
+		linkcount[numTouch] = list[i]->linkcount;
+		numTouch++;
+	}
+	return true;
+}
+
+static void G_SimulateJob (void *params, uint32 index)
+{
+	pmPlayer_t &player = static_cast<pmPlayer_t *>(params)[index];
+	edict_t *ent = player.ent;
+
+	// what ClientRunThink will start the first move from
+	pmove_state_t state = ent->client->ps.pmove;
+	state.pm_type = ClientPmoveType (ent);
+	state.gravity = sv_gravity->GetInt();
+	VectorCopy (ent->s.origin, state.origin);
+	VectorCopy (ent->velocity, state.velocity);
+
+	ClearBounds (player.mins, player.maxs);
+	pm_worker = &player;
+
+	for (int i = 0; i < player.count; i++)
+	{
+		pmQueued_t &queued = pm_queue[pm_order[player.first + i]];
+
+		queued.start = state;
+
+		pmove_t &pm = queued.result;
+		memset (&pm, 0, sizeof(pm));
+		pm.s = state;
+		pm.cmd = queued.cmd;
+		pm.trace = G_WorkerPMTrace;
+		pm.pointcontents = G_WorkerPMPointContents;
+		pm.playsound = G_WorkerPMSound;
+
+		queued.sounds.count = 0;
+		PM_DeferSounds (&queued.sounds);
+		PM_Simulate (&pm);
+		PM_DeferSounds (NULL);
+
+		// and the next one carries on from where this one ends up
+		state = pm.s;
+	}
+
+	pm_worker = NULL;
+
+	player.valid = G_PlayerSignature (player, player.numTouch, player.touch, player.linkcount);
+}
+
+/*
+=============
+G_SimulateQueuedMoves
+=============
+*/
+static void G_SimulateQueuedMoves (void)
+{
+	int		i;
+
+	pm_order.resize (pm_queue.size());
+	for (i = 0; i < (int)pm_queue.size(); i++)
+		pm_order[i] = i;
+	std::stable_sort (pm_order.begin(), pm_order.end(), [](int a, int b) { return pm_queue[a].ent < pm_queue[b].ent; });
+
+	pm_players.clear();
+	for (i = 0; i < (int)pm_order.size(); )
+	{
+		edict_t *ent = pm_queue[pm_order[i]].ent;
+
+		int count = 1;
+		while (i + count < (int)pm_order.size() && pm_queue[pm_order[i + count]].ent == ent)
+			count++;
+
+		// only plain moves, anything else ClientRunThink does itself
+		if (ent->inuse && ent->client && !ent->client->chase_target && !level.intermissiontime)
+		{
+			pmPlayer_t &player = pm_players.emplace_back();
+			player.ent = ent;
+			player.first = i;
+			player.count = count;
+			player.mask = ent->health > 0 ? MASK_PLAYERSOLID : MASK_DEADSOLID;
+			player.valid = false;
+
+			for (int j = 0; j < count; j++)
+				pm_queue[pm_order[i + j]].player = (int)pm_players.size() - 1;
+		}
+
+		i += count;
+	}
+
+	// a single player may as well just run
+	if (pm_players.size() < 2)
+	{
+		for (pmQueued_t &queued : pm_queue)
+			queued.player = -1;
+		return;
+	}
+
+	G_StartJobs ();
+
+	Jobs::ParallelFor ((uint32)pm_players.size(), G_SimulateJob, pm_players.data());
+
+	for (const pmPlayer_t &player : pm_players)
+	{
+		if (player.valid)
+			pm_simulated += player.count;
+	}
+}
+
+/*
+=============
+G_RunQueuedMoves
+=============
+*/
+void G_RunQueuedMoves (void)
+{
+	if (pm_queue.empty() || pm_flushing)
+		return;
+
+	pm_flushing = true;
+
+	G_SimulateQueuedMoves ();
+
+	for (pmQueued_t &queued : pm_queue)
+	{
+		pm_running = &queued;
+		ClientRunThink (queued.ent, &queued.cmd);
+	}
+
+	G_ClearQueuedMoves ();
+}
+
+static qboolean G_SamePmove (const pmove_t &a, const pmDeferredSounds_t &aSounds, const pmove_t &b, const pmDeferredSounds_t &bSounds)
+{
+	if (memcmp (&a.s, &b.s, sizeof(a.s)) != 0 || a.numtouch != b.numtouch || memcmp (a.touchents, b.touchents, a.numtouch * sizeof(a.touchents[0])) != 0)
+		return false;
+
+	if (!VectorCompare (a.viewangles, b.viewangles) || a.viewheight != b.viewheight || !VectorCompare (a.mins, b.mins) || !VectorCompare (a.maxs, b.maxs)
+		|| a.groundentity != b.groundentity || a.watertype != b.watertype || a.waterlevel != b.waterlevel)
+		return false;
+
+	if (aSounds.count != bSounds.count)
+		return false;
+
+	for (int i = 0; i < aSounds.count; i++)
+	{
+		if (aSounds.sounds[i].type != bSounds.sounds[i].type || aSounds.sounds[i].volume != bSounds.sounds[i].volume || aSounds.sounds[i].stepLeft != bSounds.sounds[i].stepLeft)
+			return false;
+	}
+	return true;
+}
+
+// the results of a pmove, leaving pm's callbacks alone
+static void G_CopyPmoveResults (pmove_t *pm, const pmove_t &from)
+{
+	pm->s = from.s;
+	pm->cmd = from.cmd;
+	pm->numtouch = from.numtouch;
+	memcpy (pm->touchents, from.touchents, sizeof(pm->touchents));
+	VectorCopy (from.viewangles, pm->viewangles);
+	pm->viewheight = from.viewheight;
+	VectorCopy (from.mins, pm->mins);
+	VectorCopy (from.maxs, pm->maxs);
+	pm->groundentity = from.groundentity;
+	pm->watertype = from.watertype;
+	pm->waterlevel = from.waterlevel;
+}
+
+/*
+=============
+G_BatchedPmove
+
+Does PM_Simulate, taking the move simulated on the job workers when it
+starts from the same place and nothing has got in its way since
+=============
+*/
+void G_BatchedPmove (edict_t *ent, pmove_t *pm)
+{
+	edict_t	*touch[PM_MAX_TOUCH];
+	int		linkcount[PM_MAX_TOUCH];
+	int		numTouch;
+
+	pmQueued_t *queued = pm_running;
+	pm_running = NULL;		// only good for the first pmove of the command
+
+	if (!queued || queued->ent != ent || queued->player < 0 || !pm_players[queued->player].valid)
+	{
+		PM_Simulate (pm);
+		return;
+	}
+
+	const pmPlayer_t &player = pm_players[queued->player];
+	const int mask = ent->health > 0 ? MASK_PLAYERSOLID : MASK_DEADSOLID;
+
+	qboolean same = mask == player.mask && memcmp (&pm->s, &queued->start, sizeof(pm->s)) == 0
+		&& G_PlayerSignature (player, numTouch, touch, linkcount) && numTouch == player.numTouch;
+
+	for (int i = 0; same && i < numTouch; i++)
+	{
+		if (touch[i] != player.touch[i] || linkcount[i] != player.linkcount[i])
+			same = false;
+	}
+
+	if (!same)
+	{
+		pm_conflicts++;
+		PM_Simulate (pm);
+		return;
+	}
+
+	pm_used++;
+
+	if (g_parallelCheck->GetBool())
+	{
+		pmove_t				serial = *pm;
+		pmDeferredSounds_t	sounds;
+
+		sounds.count = 0;
+		PM_DeferSounds (&sounds);
+		PM_Simulate (&serial);
+		PM_DeferSounds (NULL);
+
+		if (!G_SamePmove (serial, sounds, queued->result, queued->sounds))
+		{
+			pm_divergent++;
+			gi.dprintf ("G_BatchedPmove: %s at %s moved differently in parallel\n", ent->client->pers.netname, vtos (ent->s.origin));
+			queued->result = serial;
+			queued->sounds = sounds;
+		}
+	}
+
+	G_CopyPmoveResults (pm, queued->result);
+
+	// the footsteps pick their sounds now, in the order they would have
+	if (!pm_replaying)
+		PM_PlayDeferredSounds (queued->sounds, pm->playsound);
+}
+
+/*
+=============================================================================
+
+RECORDED MOVES
+
+sv recordmoves [frames] keeps every usercmd that comes in over the next
+frames, along with where each player was when it started. sv replaymoves
+puts the players back there and runs the commands again twice, once one
+at a time the way ClientThink does without g_parallelPlayers and once
+batched on the job workers the way it does with it, then compares where
+every player ended up. Only the moves are replayed, nothing is touched,
+picked up or fired, and the players are put back where they were after.
+
+=============================================================================
+*/
+
+struct pmRecorded_t
+{
+	int			frame;
+	int			entnum;
+	usercmd_t	cmd;
+};
+
+struct pmPlayerState_t
+{
+	int				entnum;
+	pmove_state_t	pmove;
+	vec3_t			origin, velocity;
+	vec3_t			mins, maxs;
+	vec3_t			v_angle, viewangles, cmd_angles;
+	int				viewheight, waterlevel, watertype;
+	edict_t			*groundentity;
+	int				groundentity_linkcount;
+};
+
+static std::vector<pmRecorded_t>	pm_recorded;
+static std::vector<pmPlayerState_t>	pm_recordStart;
+static int							pm_recordFrame;		// level.framenum it started on
+static int							pm_recordFrames;	// left to record, 0 when not recording
+
+static void G_SavePlayerState (edict_t *ent, pmPlayerState_t &state)
+{
+	state.entnum = (int)(ent - g_edicts);
+	state.pmove = ent->client->ps.pmove;
+	VectorCopy (ent->s.origin, state.origin);
+	VectorCopy (ent->velocity, state.velocity);
+	VectorCopy (ent->mins, state.mins);
+	VectorCopy (ent->maxs, state.maxs);
+	VectorCopy (ent->client->v_angle, state.v_angle);
+	VectorCopy (ent->client->ps.viewangles, state.viewangles);
+	VectorCopy (ent->client->resp.cmd_angles, state.cmd_angles);
+	state.viewheight = ent->viewheight;
+	state.waterlevel = ent->waterlevel;
+	state.watertype = ent->watertype;
+	state.groundentity = ent->groundentity;
+	state.groundentity_linkcount = ent->groundentity_linkcount;
+}
+
+static void G_RestorePlayerState (const pmPlayerState_t &state)
+{
+	edict_t *ent = g_edicts + state.entnum;
+
+	ent->client->ps.pmove = state.pmove;
+	ent->client->old_pmove = state.pmove;
+	VectorCopy (state.origin, ent->s.origin);
+	VectorCopy (state.velocity, ent->velocity);
+	VectorCopy (state.mins, ent->mins);
+	VectorCopy (state.maxs, ent->maxs);
+	VectorCopy (state.v_angle, ent->client->v_angle);
+	VectorCopy (state.viewangles, ent->client->ps.viewangles);
+	VectorCopy (state.cmd_angles, ent->client->resp.cmd_angles);
+	ent->viewheight = state.viewheight;
+	ent->waterlevel = state.waterlevel;
+	ent->watertype = state.watertype;
+	ent->groundentity = state.groundentity;
+	ent->groundentity_linkcount = state.groundentity_linkcount;
+
+	gi.linkentity (ent);
+}
+
+static qboolean G_SamePlayerState (const pmPlayerState_t &a, const pmPlayerState_t &b)
+{
+	return memcmp (&a.pmove, &b.pmove, sizeof(a.pmove)) == 0
+		&& VectorCompare (a.origin, b.origin) && VectorCompare (a.velocity, b.velocity)
+		&& VectorCompare (a.mins, b.mins) && VectorCompare (a.maxs, b.maxs)
+		&& VectorCompare (a.viewangles, b.viewangles) && a.viewheight == b.viewheight
+		&& a.waterlevel == b.waterlevel && a.watertype == b.watertype && a.groundentity == b.groundentity;
+}
+
+// players that can still be moved, the ones that left or are watching someone are skipped
+static qboolean G_ReplayablePlayer (int entnum)
+{
+	edict_t *ent = g_edicts + entnum;
+
+	return ent->inuse && ent->client && !ent->client->chase_target;
+}
+
+/*
+=============
+G_RecordClientThink
+=============
+*/
+void G_RecordClientThink (edict_t *ent, usercmd_t *ucmd)
+{
+	if (!pm_recordFrames)
+		return;
+
+	// only the players that were there from the start
+	const int entnum = (int)(ent - g_edicts);
+	if (std::none_of (pm_recordStart.begin(), pm_recordStart.end(), [entnum](const pmPlayerState_t &state) { return state.entnum == entnum; }))
+		return;
+
+	// a new map starts counting frames again
+	const int frame = level.framenum - pm_recordFrame;
+	if (frame < 0 || frame >= pm_recordFrames)
+	{
+		pm_recordFrames = 0;
+		gi.cprintf (NULL, PRINT_HIGH, "Recorded %d moves from %d players\n", (int)pm_recorded.size(), (int)pm_recordStart.size());
+		return;
+	}
+
+	pmRecorded_t &recorded = pm_recorded.emplace_back();
+	recorded.frame = frame;
+	recorded.entnum = entnum;
+	recorded.cmd = *ucmd;
+}
+
+/*
+=============
+G_RecordMoves_f
+
+sv recordmoves [frames]
+=============
+*/
+void G_RecordMoves_f (void)
+{
+	pm_recorded.clear();
+	pm_recordStart.clear();
+
+	for (int i = 0; i < game.maxclients; i++)
+	{
+		edict_t *ent = g_edicts + 1 + i;
+		if (G_ReplayablePlayer (1 + i))
+			G_SavePlayerState (ent, pm_recordStart.emplace_back());
+	}
+
+	pm_recordFrame = level.framenum;
+	pm_recordFrames = gi.argc() > 2 ? Max (1, atoi (gi.argv(2))) : 100;
+
+	gi.cprintf (NULL, PRINT_HIGH, "Recording the moves of %d players for %d frames\n", (int)pm_recordStart.size(), pm_recordFrames);
+}
+
+/*
+=============
+G_ReplayRecordedMoves
+
+Runs the recording from the start, batched or one move at a time, and
+leaves every player where it ended up
+=============
+*/
+static void G_ReplayRecordedMoves (qboolean batched, std::vector<pmPlayerState_t> &end)
+{
+	pmDeferredSounds_t	sounds;
+	pmove_t				pm;
+
+	for (const pmPlayerState_t &state : pm_recordStart)
+	{
+		if (G_ReplayablePlayer (state.entnum))
+			G_RestorePlayerState (state);
+	}
+
+	// the sounds are deferred and dropped so nothing is heard and rand isn't touched,
+	// again for every move since simulating on this thread clears it
+	pm_replaying = true;
+
+	for (size_t first = 0; first < pm_recorded.size(); )
+	{
+		// the moves that came in before the same frame
+		size_t last = first;
+		while (last < pm_recorded.size() && pm_recorded[last].frame == pm_recorded[first].frame)
+			last++;
+
+		for (size_t i = first; i < last; i++)
+		{
+			pmRecorded_t &recorded = pm_recorded[i];
+			if (!G_ReplayablePlayer (recorded.entnum))
+				continue;
+
+			if (batched)
+			{
+				pmQueued_t &queued = pm_queue.emplace_back();
+				queued.ent = g_edicts + recorded.entnum;
+				queued.cmd = recorded.cmd;
+				queued.player = -1;
+			}
+			else
+			{
+				level.current_entity = g_edicts + recorded.entnum;
+				sounds.count = 0;
+				PM_DeferSounds (&sounds);
+				ClientPmove (level.current_entity, &recorded.cmd, &pm);
+			}
+		}
+
+		if (batched && !pm_queue.empty())
+		{
+			G_SimulateQueuedMoves ();
+
+			for (pmQueued_t &queued : pm_queue)
+			{
+				pm_running = &queued;
+				level.current_entity = queued.ent;
+				sounds.count = 0;
+				PM_DeferSounds (&sounds);
+				ClientPmove (queued.ent, &queued.cmd, &pm);
+			}
+
+			G_ClearQueuedMoves ();
+		}
+
+		first = last;
+	}
+
+	PM_DeferSounds (NULL);
+	pm_replaying = false;
+
+	end.clear();
+	for (const pmPlayerState_t &state : pm_recordStart)
+	{
+		if (G_ReplayablePlayer (state.entnum))
+			G_SavePlayerState (g_edicts + state.entnum, end.emplace_back());
+	}
+}
+
+/*
+=============
+G_ReplayMoves_f
+
+sv replaymoves
+=============
+*/
+void G_ReplayMoves_f (void)
+{
+	std::vector<pmPlayerState_t>	now, serial, batched;
+
+	if (pm_recordFrames)
+	{
+		gi.cprintf (NULL, PRINT_HIGH, "Still recording\n");
+		return;
+	}
+	if (pm_recorded.empty())
+	{
+		gi.cprintf (NULL, PRINT_HIGH, "Nothing recorded, use sv recordmoves first\n");
+		return;
+	}
+
+	for (const pmPlayerState_t &state : pm_recordStart)
+	{
+		if (G_ReplayablePlayer (state.entnum))
+			G_SavePlayerState (g_edicts + state.entnum, now.emplace_back());
+	}
+
+	edict_t *current_entity = level.current_entity;
+	const int used = pm_used, conflicts = pm_conflicts;
+
+	G_ReplayRecordedMoves (false, serial);
+	G_ReplayRecordedMoves (true, batched);
+
+	level.current_entity = current_entity;
+
+	for (const pmPlayerState_t &state : now)
+		G_RestorePlayerState (state);
+
+	int mismatches = 0;
+	for (size_t i = 0; i < serial.size(); i++)
+	{
+		if (G_SamePlayerState (serial[i], batched[i]))
+			continue;
+
+		mismatches++;
+		gi.cprintf (NULL, PRINT_HIGH, "%s ended up at %s one at a time but %s batched\n",
+			g_edicts[serial[i].entnum].client->pers.netname, vtos (serial[i].origin), vtos (batched[i].origin));
+	}
+
+	gi.cprintf (NULL, PRINT_HIGH, "Replayed %d moves for %d players, %d batched moves used, %d run again, %d players differ\n",
+		(int)pm_recorded.size(), (int)serial.size(), pm_used - used, pm_conflicts - conflicts, mismatches);
+}
@@ -335,7 +335,9 @@ retry:
 	else
 		mask = MASK_SOLID;
 
-	trace = gi.trace( start, ent->mins, ent->maxs, end, ent, mask );
+	// the move might have been traced on the job workers already
+	if ( !G_PredictedTrace( ent, start, end, mask, trace ) )
+		trace = gi.trace( start, ent->mins, ent->maxs, end, ent, mask );
 
 	VectorCopy( trace.endpos, ent->s.origin );
 	gi.linkentity( ent );
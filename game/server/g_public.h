@@ -6,7 +6,7 @@
 #include "../../common/filesystem_interface.h"
 #include "../../physics/phys_public.h"
 
-#define	GAME_API_VERSION	3
+#define	GAME_API_VERSION	5
 
 // edict->svflags
 
@@ -196,6 +196,14 @@ struct game_export_t
 	void		(*WriteLevel) (char *filename);
 	void		(*ReadLevel) (char *filename);
 
+	// the writes above finish on a thread, this waits until
+	// they're on disk
+	void		(*FlushSaves) (void);
+
+	// stops the game's worker threads before the server forks,
+	// they start again the next time they're needed
+	void		(*StopJobs) (void);
+
 	qboolean	(*ClientConnect) (edict_t *ent, char *userinfo);
 	void		(*ClientBegin) (edict_t *ent);
 	void		(*ClientUserinfoChanged) (edict_t *ent, char *userinfo);
@@ -1,6 +1,13 @@
 
 #include "g_local.h"
 
+#include "zlib.h"
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
 #define Function(f) {#f, f}
 
 mmove_t mmove_reloc;
@@ -187,6 +194,22 @@ void InitGame (void)
 	g_viewthing = gi.cvar ("g_viewthing", "models/devtest/barneyhl1.smf", CVAR_ARCHIVE);
 	g_frametime = gi.cvar ("g_frametime", "0.1", 0);
 	g_playersOnly = gi.cvar ("g_playersOnly", "0", 0);
+	g_saveCompress = gi.cvar ("g_saveCompress", "1", CVAR_ARCHIVE);
+
+	g_nav = gi.cvar ("g_nav", "1", 0);
+	g_navBudget = gi.cvar ("g_navBudget", "1024", 0);
+	g_navStats = gi.cvar ("g_navStats", "0", 0);
+
+	g_aiSchedule = gi.cvar ("g_aiSchedule", "1", 0);
+	g_aiTraceBudget = gi.cvar ("g_aiTraceBudget", "32", 0);
+	g_aiSlices = gi.cvar ("g_aiSlices", "2", 0);
+	g_aiVisFrames = gi.cvar ("g_aiVisFrames", "2", 0);
+	g_aiStats = gi.cvar ("g_aiStats", "0", 0);
+
+	g_parallelThink = gi.cvar ("g_parallelThink", "0", 0);
+	g_parallelCheck = gi.cvar ("g_parallelCheck", "0", 0);
+	g_parallelStats = gi.cvar ("g_parallelStats", "0", 0);
+	g_parallelPlayers = gi.cvar ("g_parallelPlayers", "0", 0);
 
 	// items
 	InitItems ();
@@ -206,403 +229,541 @@ void InitGame (void)
 	globals.num_edicts = game.maxclients+1;
 }
 
-//=========================================================
+/*
+=============================================================================
 
-void WriteField1 (fsHandle_t f, field_t *field, byte *base)
-{
-	void		*p;
-	strlen_t	len;
-	int			index;
+SAVE BUFFERS
 
-	if (field->flags & FFL_SPAWNTEMP)
-		return;
+Saves are built in memory in one pass, then compressed and written out on
+a thread of their own so an autosave doesn't hitch the frame. Loads read
+the whole file in one go and fix the pointers up as they copy out of it.
 
-	p = (void *)(base + field->ofs);
-	switch (field->type)
-	{
-	case F_INT:
-	case F_FLOAT:
-	case F_ANGLEHACK:
-	case F_VECTOR:
-	case F_IGNORE:
-		break;
-
-	case F_LSTRING:
-	case F_GSTRING:
-		if ( *(char **)p )
-			len = Q_strlen(*(char **)p) + 1;
-		else
-			len = 0;
-		*(int *)p = len;
-		break;
-	case F_EDICT:
-		if ( *(edict_t **)p == NULL)
-			index = -1;
-		else
-			index = *(edict_t **)p - g_edicts;
-		*(int *)p = index;
-		break;
-	case F_CLIENT:
-		if ( *(gclient_t **)p == NULL)
-			index = -1;
-		else
-			index = *(gclient_t **)p - game.clients;
-		*(int *)p = index;
-		break;
-	case F_ITEM:
-		if ( *(edict_t **)p == NULL)
-			index = -1;
-		else
-			index = *(gitem_t **)p - itemlist;
-		*(int *)p = index;
-		break;
+=============================================================================
+*/
 
-	//relative to code segment
-	case F_FUNCTION:
-		if (*(byte **)p == NULL)
-			index = 0;
-		else
-			index = *(byte **)p - ((byte *)InitGame);
-		*(int *)p = index;
-		break;
+#define SAVE_MAGIC		MakeFourCC('J','Q','S','V')
+#define SAVE_VERSION	1
 
-	//relative to data segment
-	case F_MMOVE:
-		if (*(byte **)p == NULL)
-			index = 0;
-		else
-			index = *(byte **)p - (byte *)&mmove_reloc;
-		*(int *)p = index;
-		break;
+#define SAVE_COMPRESSED	1
 
-	default:
-		gi.error ("WriteEdict: unknown field type");
-	}
-}
+#define	MAX_SAVE_POINTERS	64
 
+struct saveHeader_t
+{
+	int32	magic;
+	int32	version;
+	int32	flags;
+	int32	rawSize;
+	int32	storedSize;
+};
 
-void WriteField2 (fsHandle_t f, field_t *field, byte *base)
+// the fields that need converting, worked out once from a field table
+struct saveLayout_t
 {
-	strlen_t	len;
-	void		*p;
+	field_t		*fields;
+	field_t		*pointers[MAX_SAVE_POINTERS];
+	int			numPointers;
+	bool		built;
+};
 
-	if (field->flags & FFL_SPAWNTEMP)
-		return;
+static saveLayout_t	edictLayout { fields };
+static saveLayout_t	levelLayout { levelfields };
+static saveLayout_t	clientLayout { clientfields };
 
-	p = (void *)(base + field->ofs);
-	switch (field->type)
-	{
-	case F_LSTRING:
-		if ( *(char **)p )
-		{
-			len = Q_strlen(*(char **)p) + 1;
-			gi.fileSystem->WriteFile (*(char **)p, len, f);
-		}
-		break;
-	}
+struct saveJob_t
+{
+	char				filename[MAX_QPATH];
+	fsHandle_t			f;
+	std::vector<byte>	data;		// header followed by the raw save
+	bool				compress;
+
+	int64				buildUsec;
+	int64				writeUsec;
+	int32				storedSize;
+
+	std::thread			thread;
+};
+
+static std::vector<std::unique_ptr<saveJob_t>>	saveJobs;
+
+struct saveReader_t
+{
+	const char			*filename;
+	std::vector<byte>	data;
+	size_t				pos;
+};
+
+static int64 SaveTime (void)
+{
+	using namespace std::chrono;
+	return duration_cast<microseconds> (steady_clock::now().time_since_epoch()).count();
 }
 
-void ReadField (fsHandle_t f, field_t *field, byte *base)
+/*
+==============
+BuildLayout
+
+Only pointers need any work, everything else is saved as it is
+==============
+*/
+static const saveLayout_t *BuildLayout (saveLayout_t *layout)
 {
-	void		*p;
-	int			len;
-	int			index;
+	field_t		*field;
 
-	if (field->flags & FFL_SPAWNTEMP)
-		return;
+	if (layout->built)
+		return layout;
 
-	p = (void *)(base + field->ofs);
-	switch (field->type)
+	layout->numPointers = 0;
+	for (field=layout->fields ; field->name ; field++)
 	{
-	case F_INT:
-	case F_FLOAT:
-	case F_ANGLEHACK:
-	case F_VECTOR:
-	case F_IGNORE:
-		break;
-
-	case F_LSTRING:
-		len = *(int *)p;
-		if (!len)
-			*(char **)p = NULL;
-		else
-		{
-			*(char **)p = (char *)gi.TagMalloc (len, TAG_LEVEL);
-			gi.fileSystem->ReadFile (*(char **)p, len, f);
-		}
-		break;
-	case F_EDICT:
-		index = *(int *)p;
-		if ( index == -1 )
-			*(edict_t **)p = NULL;
-		else
-			*(edict_t **)p = &g_edicts[index];
-		break;
-	case F_CLIENT:
-		index = *(int *)p;
-		if ( index == -1 )
-			*(gclient_t **)p = NULL;
-		else
-			*(gclient_t **)p = &game.clients[index];
-		break;
-	case F_ITEM:
-		index = *(int *)p;
-		if ( index == -1 )
-			*(gitem_t **)p = NULL;
-		else
-			*(gitem_t **)p = &itemlist[index];
-		break;
+		if (field->flags & FFL_SPAWNTEMP)
+			continue;
 
-	//relative to code segment
-	case F_FUNCTION:
-		index = *(int *)p;
-		if ( index == 0 )
-			*(byte **)p = NULL;
-		else
-			*(byte **)p = ((byte *)InitGame) + index;
-		break;
+		switch (field->type)
+		{
+		case F_INT:
+		case F_FLOAT:
+		case F_ANGLEHACK:
+		case F_VECTOR:
+		case F_IGNORE:
+			break;
 
-	//relative to data segment
-	case F_MMOVE:
-		index = *(int *)p;
-		if (index == 0)
-			*(byte **)p = NULL;
-		else
-			*(byte **)p = (byte *)&mmove_reloc + index;
-		break;
+		case F_LSTRING:
+		case F_EDICT:
+		case F_CLIENT:
+		case F_ITEM:
+		case F_FUNCTION:
+		case F_MMOVE:
+			if (layout->numPointers == MAX_SAVE_POINTERS)
+				gi.error ("BuildLayout: MAX_SAVE_POINTERS");
+			layout->pointers[layout->numPointers++] = field;
+			break;
 
-	default:
-		gi.error ("ReadEdict: unknown field type");
+		default:
+			gi.error ("BuildLayout: unknown field type for %s", field->name);
+		}
 	}
+
+	layout->built = true;
+	return layout;
 }
 
-//=========================================================
+static void SaveWrite (std::vector<byte> &buffer, const void *data, size_t length)
+{
+	const byte *bytes = (const byte *)data;
+	buffer.insert (buffer.end(), bytes, bytes + length);
+}
 
 /*
 ==============
-WriteClient
+WriteBlock
 
-All pointer variables (except function pointers) must be handled specially.
+Copies a struct into the save and turns its pointers into lengths or indexes
+in the copy, then adds any strings after it
 ==============
 */
-void WriteClient (fsHandle_t f, gclient_t *client)
+static void WriteBlock (std::vector<byte> &buffer, saveLayout_t *layout, const void *base, size_t size)
 {
-	field_t		*field;
-	gclient_t	temp;
-	
-	// all of the ints, floats, and vectors stay as they are
-	temp = *client;
+	const saveLayout_t	*l = BuildLayout (layout);
+	byte		*block;
+	void		*p;
+	const void	*src;
+	int			index;
+	int			i;
+
+	const size_t start = buffer.size();
+	SaveWrite (buffer, base, size);
+	block = buffer.data() + start;
 
-	// change the pointers to lengths or indexes
-	for (field=clientfields ; field->name ; field++)
+	for (i=0 ; i<l->numPointers ; i++)
 	{
-		WriteField1 (f, field, (byte *)&temp);
-	}
+		const field_t *field = l->pointers[i];
+
+		p = block + field->ofs;
+		src = (const byte *)base + field->ofs;
+		switch (field->type)
+		{
+		case F_LSTRING:
+			if (*(char **)src)
+				index = Q_strlen(*(char **)src) + 1;
+			else
+				index = 0;
+			break;
+		case F_EDICT:
+			if (*(edict_t **)src == NULL)
+				index = -1;
+			else
+				index = *(edict_t **)src - g_edicts;
+			break;
+		case F_CLIENT:
+			if (*(gclient_t **)src == NULL)
+				index = -1;
+			else
+				index = *(gclient_t **)src - game.clients;
+			break;
+		case F_ITEM:
+			if (*(gitem_t **)src == NULL)
+				index = -1;
+			else
+				index = *(gitem_t **)src - itemlist;
+			break;
 
-	// write the block
-	gi.fileSystem->WriteFile (&temp, sizeof(temp), f);
+		//relative to code segment
+		case F_FUNCTION:
+			if (*(byte **)src == NULL)
+				index = 0;
+			else
+				index = *(byte **)src - ((byte *)InitGame);
+			break;
 
-	// now write any allocated data following the edict
-	for (field=clientfields ; field->name ; field++)
+		//relative to data segment
+		case F_MMOVE:
+			if (*(byte **)src == NULL)
+				index = 0;
+			else
+				index = *(byte **)src - (byte *)&mmove_reloc;
+			break;
+
+		default:
+			index = 0;
+			break;
+		}
+		*(int *)p = index;
+	}
+
+	// now write any allocated data following the block
+	for (i=0 ; i<l->numPointers ; i++)
 	{
-		WriteField2 (f, field, (byte *)client);
+		const field_t *field = l->pointers[i];
+
+		src = (const byte *)base + field->ofs;
+		if (field->type == F_LSTRING && *(char **)src)
+			SaveWrite (buffer, *(char **)src, Q_strlen(*(char **)src) + 1);
 	}
 }
 
+static void SaveRead (saveReader_t *r, void *data, size_t length)
+{
+	if (r->pos + length > r->data.size())
+		gi.error ("%s is truncated", r->filename);
+
+	memcpy (data, r->data.data() + r->pos, length);
+	r->pos += length;
+}
+
 /*
 ==============
-ReadClient
+ReadBlock
 
-All pointer variables (except function pointers) must be handled specially.
+Copies a struct out of the save and turns the lengths and indexes back into
+pointers
 ==============
 */
-void ReadClient (fsHandle_t f, gclient_t *client)
+static void ReadBlock (saveReader_t *r, saveLayout_t *layout, void *base, size_t size)
 {
-	field_t		*field;
+	const saveLayout_t	*l = BuildLayout (layout);
+	void		*p;
+	int			index;
+	int			i;
 
-	gi.fileSystem->ReadFile (client, sizeof(*client), f);
+	SaveRead (r, base, size);
 
-	for (field=clientfields ; field->name ; field++)
+	for (i=0 ; i<l->numPointers ; i++)
 	{
-		ReadField (f, field, (byte *)client);
+		const field_t *field = l->pointers[i];
+
+		p = (byte *)base + field->ofs;
+		index = *(int *)p;
+		switch (field->type)
+		{
+		case F_LSTRING:
+			if (!index)
+				*(char **)p = NULL;
+			else
+			{
+				*(char **)p = (char *)gi.TagMalloc (index, TAG_LEVEL);
+				SaveRead (r, *(char **)p, index);
+			}
+			break;
+		case F_EDICT:
+			if ( index == -1 )
+				*(edict_t **)p = NULL;
+			else
+				*(edict_t **)p = &g_edicts[index];
+			break;
+		case F_CLIENT:
+			if ( index == -1 )
+				*(gclient_t **)p = NULL;
+			else
+				*(gclient_t **)p = &game.clients[index];
+			break;
+		case F_ITEM:
+			if ( index == -1 )
+				*(gitem_t **)p = NULL;
+			else
+				*(gitem_t **)p = &itemlist[index];
+			break;
+
+		//relative to code segment
+		case F_FUNCTION:
+			if ( index == 0 )
+				*(byte **)p = NULL;
+			else
+				*(byte **)p = ((byte *)InitGame) + index;
+			break;
+
+		//relative to data segment
+		case F_MMOVE:
+			if (index == 0)
+				*(byte **)p = NULL;
+			else
+				*(byte **)p = (byte *)&mmove_reloc + index;
+			break;
+
+		default:
+			break;
+		}
 	}
 }
 
 /*
-============
-WriteGame
-
-This will be called whenever the game goes to a new level,
-and when the user explicitly saves the game.
-
-Game information include cross level data, like multi level
-triggers, help computer info, and all client states.
+==============
+BeginSave
 
-A single player death will automatically restore from the
-last save position.
-============
+Opens the file here so a failure is reported straight away, the
+writer thread only ever touches its own handle
+==============
 */
-void WriteGame (char *filename, qboolean autosave)
+static saveJob_t *BeginSave (char *filename)
 {
-	fsHandle_t	f;
-	int			i;
-	char		str[16];
+	saveHeader_t	header {};
 
-	if (!autosave)
-		SaveClientData ();
+	// don't truncate a file that's still being written
+	G_FlushSaves (filename);
 
-	f = gi.fileSystem->OpenFileWrite (filename);
-	if (!f)
+	auto job = std::make_unique<saveJob_t> ();
+
+	job->f = gi.fileSystem->OpenFileWrite (filename);
+	if (!job->f)
 		gi.error ("Couldn't open %s", filename);
 
-	memset (str, 0, sizeof(str));
-	strcpy (str, __DATE__);
-	gi.fileSystem->WriteFile (str, sizeof(str), f);
+	Q_strcpy_s (job->filename, filename);
+	job->compress = g_saveCompress->GetBool();
+	job->buildUsec = SaveTime ();
 
-	game.autosaved = autosave;
-	gi.fileSystem->WriteFile (&game, sizeof(game), f);
-	game.autosaved = false;
+	job->data.reserve (256 * 1024);
+	SaveWrite (job->data, &header, sizeof(header));
 
-	for (i=0 ; i<game.maxclients ; i++)
-		WriteClient (f, &game.clients[i]);
-
-	gi.fileSystem->CloseFile (f);
+	saveJobs.push_back (std::move (job));
+	return saveJobs.back().get();
 }
 
-void ReadGame (char *filename)
+static void SaveThread (saveJob_t *job)
 {
-	int		i;
-	char	str[16];
+	const int64 start = SaveTime ();
 
-	gi.FreeTags (TAG_GAME);
+	saveHeader_t *header = (saveHeader_t *)job->data.data();
+	const byte *raw = job->data.data() + sizeof(*header);
+	const uLong rawSize = (uLong)(job->data.size() - sizeof(*header));
 
-	fsHandle_t f = gi.fileSystem->OpenFileRead (filename);
-	if (!f)
-		gi.error ("Couldn't open %s", filename);
+	header->magic = SAVE_MAGIC;
+	header->version = SAVE_VERSION;
+	header->flags = 0;
+	header->rawSize = (int32)rawSize;
+	header->storedSize = (int32)rawSize;
 
-	gi.fileSystem->ReadFile (str, sizeof(str), f);
-	if (Q_strcmp (str, __DATE__))
+	std::vector<byte> compressed;
+	if (job->compress)
 	{
-		gi.fileSystem->CloseFile (f);
-		gi.error ("Savegame from an older version.\n");
-	}
+		uLongf compressedSize = compressBound (rawSize);
+		compressed.resize (sizeof(*header) + compressedSize);
 
-	g_edicts = (edict_t*)gi.TagMalloc (game.maxentities * sizeof(g_edicts[0]), TAG_GAME);
-	globals.edicts = g_edicts;
+		if (compress2 (compressed.data() + sizeof(*header), &compressedSize, raw, rawSize, Z_BEST_SPEED) == Z_OK
+			&& compressedSize < rawSize)
+		{
+			header->flags |= SAVE_COMPRESSED;
+			header->storedSize = (int32)compressedSize;
+			memcpy (compressed.data(), header, sizeof(*header));
+			compressed.resize (sizeof(*header) + compressedSize);
+		}
+		else
+		{
+			compressed.clear();
+		}
+	}
 
-	gi.fileSystem->ReadFile (&game, sizeof(game), f);
-	game.clients = (gclient_t*)gi.TagMalloc (game.maxclients * sizeof(game.clients[0]), TAG_GAME);
-	for (i=0 ; i<game.maxclients ; i++)
-		ReadClient (f, &game.clients[i]);
+	const std::vector<byte> &out = compressed.empty() ? job->data : compressed;
+	gi.fileSystem->WriteFile (out.data(), (fsSize_t)out.size(), job->f);
+	gi.fileSystem->CloseFile (job->f);
+	job->f = FS_INVALID_HANDLE;
 
-	gi.fileSystem->CloseFile (f);
+	job->storedSize = header->storedSize;
+	job->writeUsec = SaveTime () - start;
 }
 
-//==========================================================
-
+static void EndSave (saveJob_t *job)
+{
+	job->buildUsec = SaveTime () - job->buildUsec;
+	job->thread = std::thread (SaveThread, job);
+}
 
 /*
 ==============
-WriteEdict
+G_FlushSaves
 
-All pointer variables (except function pointers) must be handled specially.
+Waits for the writer threads, just the ones for filename if it's given.
+The server calls this before it copies or removes save files.
 ==============
 */
-void WriteEdict (fsHandle_t f, edict_t *ent)
+void G_FlushSaves (const char *filename)
 {
-	field_t		*field;
-	edict_t		temp;
+	for (auto it = saveJobs.begin() ; it != saveJobs.end() ; )
+	{
+		saveJob_t *job = it->get();
 
-	// all of the ints, floats, and vectors stay as they are
-	temp = *ent;
+		if (filename && Q_strcmp (job->filename, filename))
+		{
+			++it;
+			continue;
+		}
 
-	// change the pointers to lengths or indexes
-	for (field=fields ; field->name ; field++)
-	{
-		WriteField1 (f, field, (byte *)&temp);
-	}
+		job->thread.join();
 
-	// write the block
-	gi.fileSystem->WriteFile (&temp, sizeof(temp), f);
+		gi.dprintf ("%s: %d KB, %d KB on disk, built in %.2f ms, written in %.2f ms\n", job->filename,
+			(int)((job->data.size() - sizeof(saveHeader_t)) / 1024), job->storedSize / 1024,
+			job->buildUsec * 0.001, job->writeUsec * 0.001);
 
-	// now write any allocated data following the edict
-	for (field=fields ; field->name ; field++)
-	{
-		WriteField2 (f, field, (byte *)ent);
+		it = saveJobs.erase (it);
 	}
+}
 
+void FlushSaves (void)
+{
+	G_FlushSaves (NULL);
 }
 
 /*
 ==============
-WriteLevelLocals
+LoadSave
 
-All pointer variables (except function pointers) must be handled specially.
+One read for the whole file, which is inflated in memory if it needs to be
 ==============
 */
-void WriteLevelLocals (fsHandle_t f)
+static void LoadSave (const char *filename, saveReader_t *r)
 {
-	field_t		*field;
-	level_locals_t		temp;
+	saveHeader_t	header;
 
-	// all of the ints, floats, and vectors stay as they are
-	temp = level;
+	const int64 start = SaveTime ();
 
-	// change the pointers to lengths or indexes
-	for (field=levelfields ; field->name ; field++)
+	// it might be the one we just wrote
+	G_FlushSaves (filename);
+
+	fsHandle_t f = gi.fileSystem->OpenFileRead (filename);
+	if (!f)
+		gi.error ("Couldn't open %s", filename);
+
+	const fsSize_t fileSize = gi.fileSystem->GetFileSize (f);
+	if (fileSize < sizeof(header) || gi.fileSystem->ReadFile (&header, sizeof(header), f) != sizeof(header)
+		|| header.magic != SAVE_MAGIC || header.version != SAVE_VERSION
+		|| header.storedSize < 0 || (fsSize_t)header.storedSize != fileSize - sizeof(header))
 	{
-		WriteField1 (f, field, (byte *)&temp);
+		gi.fileSystem->CloseFile (f);
+		gi.error ("%s is not a valid save", filename);
 	}
 
-	// write the block
-	gi.fileSystem->WriteFile (&temp, sizeof(temp), f);
+	std::vector<byte> stored (header.storedSize);
+	gi.fileSystem->ReadFile (stored.data(), (fsSize_t)stored.size(), f);
+	gi.fileSystem->CloseFile (f);
+
+	r->filename = filename;
+	r->pos = 0;
 
-	// now write any allocated data following the edict
-	for (field=levelfields ; field->name ; field++)
+	if (header.flags & SAVE_COMPRESSED)
 	{
-		WriteField2 (f, field, (byte *)&level);
+		uLongf rawSize = header.rawSize;
+		r->data.resize (rawSize);
+		if (uncompress (r->data.data(), &rawSize, stored.data(), (uLong)stored.size()) != Z_OK || rawSize != (uLongf)header.rawSize)
+			gi.error ("%s is corrupt", filename);
 	}
+	else
+	{
+		r->data = std::move (stored);
+	}
+
+	gi.dprintf ("%s: %d KB, read in %.2f ms\n", filename, header.rawSize / 1024, (SaveTime () - start) * 0.001);
 }
 
+//=========================================================
 
 /*
-==============
-ReadEdict
+============
+WriteGame
 
-All pointer variables (except function pointers) must be handled specially.
-==============
+This will be called whenever the game goes to a new level,
+and when the user explicitly saves the game.
+
+Game information include cross level data, like multi level
+triggers, help computer info, and all client states.
+
+A single player death will automatically restore from the
+last save position.
+============
 */
-void ReadEdict (fsHandle_t f, edict_t *ent)
+void WriteGame (char *filename, qboolean autosave)
 {
-	field_t		*field;
+	int			i;
+	char		str[16];
 
-	gi.fileSystem->ReadFile (ent, sizeof(*ent), f);
+	G_RunQueuedMoves ();
 
-	for (field=fields ; field->name ; field++)
-	{
-		ReadField (f, field, (byte *)ent);
-	}
-}
+	if (!autosave)
+		SaveClientData ();
 
-/*
-==============
-ReadLevelLocals
+	saveJob_t *job = BeginSave (filename);
 
-All pointer variables (except function pointers) must be handled specially.
-==============
-*/
-void ReadLevelLocals (fsHandle_t f)
+	memset (str, 0, sizeof(str));
+	strcpy (str, __DATE__);
+	SaveWrite (job->data, str, sizeof(str));
+
+	game.autosaved = autosave;
+	SaveWrite (job->data, &game, sizeof(game));
+	game.autosaved = false;
+
+	for (i=0 ; i<game.maxclients ; i++)
+		WriteBlock (job->data, &clientLayout, &game.clients[i], sizeof(gclient_t));
+
+	EndSave (job);
+}
+
+void ReadGame (char *filename)
 {
-	field_t		*field;
+	int				i;
+	char			str[16];
+	saveReader_t	r;
 
-	gi.fileSystem->ReadFile (&level, sizeof(level), f);
+	G_RunQueuedMoves ();
 
-	for (field=levelfields ; field->name ; field++)
-	{
-		ReadField (f, field, (byte *)&level);
-	}
+	LoadSave (filename, &r);
+
+	gi.FreeTags (TAG_GAME);
+
+	SaveRead (&r, str, sizeof(str));
+	str[sizeof(str) - 1] = '\0';
+	if (Q_strcmp (str, __DATE__))
+		gi.error ("Savegame from an older version.\n");
+
+	g_edicts = (edict_t*)gi.TagMalloc (game.maxentities * sizeof(g_edicts[0]), TAG_GAME);
+	globals.edicts = g_edicts;
+
+	SaveRead (&r, &game, sizeof(game));
+	game.clients = (gclient_t*)gi.TagMalloc (game.maxclients * sizeof(game.clients[0]), TAG_GAME);
+	for (i=0 ; i<game.maxclients ; i++)
+		ReadBlock (&r, &clientLayout, &game.clients[i], sizeof(gclient_t));
 }
 
+//==========================================================
+
+
 /*
 =================
 WriteLevel
@@ -613,23 +774,22 @@ void WriteLevel (char *filename)
 {
 	int			i;
 	edict_t		*ent;
-	fsHandle_t	f;
 	void		*base;
 
-	f = gi.fileSystem->OpenFileWrite (filename);
-	if (!f)
-		gi.error ("Couldn't open %s", filename);
+	G_RunQueuedMoves ();
+
+	saveJob_t *job = BeginSave (filename);
 
 	// write out edict size for checking
 	i = sizeof(edict_t);
-	gi.fileSystem->WriteFile (&i, sizeof(i), f);
+	SaveWrite (job->data, &i, sizeof(i));
 
 	// write out a function pointer for checking
 	base = (void *)InitGame;
-	gi.fileSystem->WriteFile (&base, sizeof(base), f);
+	SaveWrite (job->data, &base, sizeof(base));
 
 	// write out level_locals_t
-	WriteLevelLocals (f);
+	WriteBlock (job->data, &levelLayout, &level, sizeof(level));
 
 	// write out all the entities
 	for (i=0 ; i<globals.num_edicts ; i++)
@@ -637,13 +797,13 @@ void WriteLevel (char *filename)
 		ent = &g_edicts[i];
 		if (!ent->inuse)
 			continue;
-		gi.fileSystem->WriteFile (&i, sizeof(i), f);
-		WriteEdict (f, ent);
+		SaveWrite (job->data, &i, sizeof(i));
+		WriteBlock (job->data, &edictLayout, ent, sizeof(*ent));
 	}
 	i = -1;
-	gi.fileSystem->WriteFile (&i, sizeof(i), f);
+	SaveWrite (job->data, &i, sizeof(i));
 
-	gi.fileSystem->CloseFile (f);
+	EndSave (job);
 }
 
 
@@ -665,14 +825,17 @@ No clients are connected yet.
 */
 void ReadLevel (char *filename)
 {
-	int		entnum;
-	int		i;
-	void	*base;
-	edict_t	*ent;
+	int				entnum;
+	int				i;
+	void			*base;
+	edict_t			*ent;
+	saveReader_t	r;
 
-	fsHandle_t f = gi.fileSystem->OpenFileRead (filename);
-	if (!f)
-		gi.error ("Couldn't open %s", filename);
+	G_RunQueuedMoves ();
+
+	LoadSave (filename, &r);
+
+	const int64 start = SaveTime ();
 
 	// free any dynamic memory allocated by loading the level
 	// base state
@@ -683,51 +846,41 @@ void ReadLevel (char *filename)
 	globals.num_edicts = maxclients->GetInt() + 1;
 
 	// check edict size
-	gi.fileSystem->ReadFile (&i, sizeof(i), f);
+	SaveRead (&r, &i, sizeof(i));
 	if (i != sizeof(edict_t))
-	{
-		gi.fileSystem->CloseFile (f);
 		gi.error ("ReadLevel: mismatched edict size");
-	}
 
 	// check function pointer base address
-	gi.fileSystem->ReadFile (&base, sizeof(base), f);
+	SaveRead (&r, &base, sizeof(base));
 #ifdef _WIN32
 	if (base != (void *)InitGame)
-	{
-		gi.fileSystem->CloseFile (f);
 		gi.error ("ReadLevel: function pointers have moved");
-	}
 #else
 	gi.dprintf("Function offsets %d\n", ((byte *)base) - ((byte *)InitGame));
 #endif
 
 	// load the level locals
-	ReadLevelLocals (f);
+	ReadBlock (&r, &levelLayout, &level, sizeof(level));
 
 	// load all the entities
 	while (1)
 	{
-		if (gi.fileSystem->ReadFile (&entnum, sizeof(entnum), f) != sizeof(entnum))
-		{
-			gi.fileSystem->CloseFile (f);
-			gi.error ("ReadLevel: failed to read entnum");
-		}
+		SaveRead (&r, &entnum, sizeof(entnum));
 		if (entnum == -1)
 			break;
+		if (entnum < 0 || entnum >= game.maxentities)
+			gi.error ("ReadLevel: bad entnum %d", entnum);
 		if (entnum >= globals.num_edicts)
 			globals.num_edicts = entnum+1;
 
 		ent = &g_edicts[entnum];
-		ReadEdict (f, ent);
+		ReadBlock (&r, &edictLayout, ent, sizeof(*ent));
 
 		// let the server rebuild world links for this ent
 		memset (&ent->area, 0, sizeof(ent->area));
 		gi.linkentity (ent);
 	}
 
-	gi.fileSystem->CloseFile (f);
-
 	// mark all clients as unconnected
 	for (i=0 ; i<maxclients->GetInt() ; i++)
 	{
@@ -749,4 +902,6 @@ void ReadLevel (char *filename)
 			if (Q_strcmp(ent->classname, "target_crosslevel_target") == 0)
 				ent->nextthink = level.time + ent->delay;
 	}
+
+	gi.dprintf ("ReadLevel: %d entities restored in %.2f ms\n", globals.num_edicts, (SaveTime () - start) * 0.001);
 }
@@ -548,6 +548,8 @@ void SpawnEntities (const char *mapname, char *entities, const char *spawnpoint)
 	int			i;
 	int			skill_level;
 
+	G_RunQueuedMoves ();
+
 	skill_level = Clamp( skill->GetInt(), 0, 3 );
 	if ( skill->GetInt() != skill_level )
 	{
@@ -580,6 +582,10 @@ void SpawnEntities (const char *mapname, char *entities, const char *spawnpoint)
 	Q_strcpy_s (level.mapname, mapname);
 	Q_strcpy_s (game.spawnpoint, spawnpoint);
 
+	// before anything is spawned, only the world should be in the way of the graph,
+	// ReadLevel runs after this for the same map so it doesn't load it again
+	Nav_LoadGraph (mapname);
+
 	// set client fields on player ents
 	for (i=0 ; i<game.maxclients ; i++)
 		g_edicts[i+1].client = game.clients + i;
@@ -256,6 +256,8 @@ void	ServerCommand (void)
 {
 	char	*cmd;
 
+	G_RunQueuedMoves ();
+
 	cmd = gi.argv(1);
 	if (Q_stricmp (cmd, "test") == 0)
 		Svcmd_Test_f ();
@@ -267,6 +269,10 @@ void	ServerCommand (void)
 		SVCmd_ListIP_f ();
 	else if (Q_stricmp (cmd, "writeip") == 0)
 		SVCmd_WriteIP_f ();
+	else if (Q_stricmp (cmd, "recordmoves") == 0)
+		G_RecordMoves_f ();
+	else if (Q_stricmp (cmd, "replaymoves") == 0)
+		G_ReplayMoves_f ();
 	else
 		gi.cprintf (NULL, PRINT_HIGH, "Unknown server command \"%s\"\n", cmd);
 }
@@ -287,6 +287,58 @@ char	*vtos (vec3_t v)
 }
 
 
+/*
+=============
+G_HashSlot
+
+Slot in a power of two sized cache for a pair of indices
+=============
+*/
+int G_HashSlot (uint32 a, uint32 b, uint32 size)
+{
+	return (int)((a * 73856093u ^ b * 19349663u) & (size - 1));
+}
+
+/*
+=============
+G_CellKey
+
+Packs a grid cell into a key that sorts and compares, each coordinate
+has 21 bits either side of zero
+=============
+*/
+uint64 G_CellKey (int x, int y, int z)
+{
+	return ((uint64)(x + 0x100000) & 0x1fffff) << 42 | ((uint64)(y + 0x100000) & 0x1fffff) << 21 | ((uint64)(z + 0x100000) & 0x1fffff);
+}
+
+/*
+=============
+G_StatsDue
+
+For the g_*Stats printers, which print once a second of level time.
+Returns how many frames it's been since the last print when it's time
+for the next one, or 0. since is the level.time of the last print.
+=============
+*/
+int G_StatsDue (cvar_t *stats, float &since)
+{
+	// switched off, or a new level has started
+	if (!stats->GetBool() || level.time < since)
+	{
+		since = level.time;
+		return 0;
+	}
+
+	const int frames = (int)((level.time - since) / FRAMETIME + 0.5f);
+	if (frames < (int)(1.0f / FRAMETIME + 0.5f))
+		return 0;
+
+	since = level.time;
+	return frames;
+}
+
+
 const vec3_t VEC_UP			= {0, -1, 0};
 const vec3_t MOVEDIR_UP		= {0, 0, 1};
 const vec3_t VEC_DOWN		= {0, -2, 0};
@@ -4,6 +4,21 @@
 
 #define	STEPSIZE	18
 
+#define NAV_REACHED	24		// how close to a node before heading for the next one
+
+/*
+=============
+M_Trace
+
+Counted so g_navStats can show what monster movement costs
+=============
+*/
+static trace_t M_Trace (vec3_t start, vec3_t mins, vec3_t maxs, vec3_t end, edict_t *passent, int contentmask)
+{
+	Nav_CountMoveTraces (1);
+	return gi.trace (start, mins, maxs, end, passent, contentmask);
+}
+
 /*
 =============
 M_CheckBottom
@@ -52,7 +67,7 @@ realcheck:
 	start[0] = stop[0] = (mins[0] + maxs[0])*0.5f;
 	start[1] = stop[1] = (mins[1] + maxs[1])*0.5f;
 	stop[2] = start[2] - 2*STEPSIZE;
-	trace = gi.trace (start, vec3_origin, vec3_origin, stop, ent, MASK_MONSTERSOLID);
+	trace = M_Trace (start, vec3_origin, vec3_origin, stop, ent, MASK_MONSTERSOLID);
 
 	if (trace.fraction == 1.0f)
 		return false;
@@ -65,7 +80,7 @@ realcheck:
 			start[0] = stop[0] = x ? maxs[0] : mins[0];
 			start[1] = stop[1] = y ? maxs[1] : mins[1];
 			
-			trace = gi.trace (start, vec3_origin, vec3_origin, stop, ent, MASK_MONSTERSOLID);
+			trace = M_Trace (start, vec3_origin, vec3_origin, stop, ent, MASK_MONSTERSOLID);
 			
 			if (trace.fraction != 1.0f && trace.endpos[2] > bottom)
 				bottom = trace.endpos[2];
@@ -136,7 +151,7 @@ qboolean SV_movestep (edict_t *ent, vec3_t move, qboolean relink)
 						neworg[2] += dz;
 				}
 			}
-			trace = gi.trace (ent->s.origin, ent->mins, ent->maxs, neworg, ent, MASK_MONSTERSOLID);
+			trace = M_Trace (ent->s.origin, ent->mins, ent->maxs, neworg, ent, MASK_MONSTERSOLID);
 	
 			// fly monsters don't enter water voluntarily
 			if (ent->flags & FL_FLY)
@@ -194,7 +209,7 @@ qboolean SV_movestep (edict_t *ent, vec3_t move, qboolean relink)
 	VectorCopy (neworg, end);
 	end[2] -= stepsize*2;
 
-	trace = gi.trace (neworg, ent->mins, ent->maxs, end, ent, MASK_MONSTERSOLID);
+	trace = M_Trace (neworg, ent->mins, ent->maxs, end, ent, MASK_MONSTERSOLID);
 
 	if (trace.allsolid)
 		return false;
@@ -202,7 +217,7 @@ qboolean SV_movestep (edict_t *ent, vec3_t move, qboolean relink)
 	if (trace.startsolid)
 	{
 		neworg[2] -= stepsize;
-		trace = gi.trace (neworg, ent->mins, ent->maxs, end, ent, MASK_MONSTERSOLID);
+		trace = M_Trace (neworg, ent->mins, ent->maxs, end, ent, MASK_MONSTERSOLID);
 		if (trace.allsolid || trace.startsolid)
 			return false;
 	}
@@ -488,6 +503,86 @@ qboolean SV_CloseEnough (edict_t *ent, edict_t *goal, float dist)
 }
 
 
+/*
+======================
+M_NavMoveToGoal
+
+Walks along the navigation graph towards the goal. Returns false if there's
+no path known, or the monster is already on the goal's node, and the old
+way of getting there should be used.
+======================
+*/
+static qboolean M_NavMoveToGoal (edict_t *ent, edict_t *goal, float dist)
+{
+	vec3_t		spot, dir;
+	int			node, goalNode, next;
+	qboolean	following;
+
+	if (!g_nav->GetBool() || !goal || (ent->flags & (FL_FLY|FL_SWIM)) || !Nav_NumNodes ())
+		return false;
+
+	// cleared unless this frame's step follows the path
+	following = ent->monsterinfo.nav_following;
+	ent->monsterinfo.nav_following = false;
+
+	VectorSet (spot, goal->s.origin[0], goal->s.origin[1], goal->absmin[2]);
+	goalNode = Nav_NearestNode (spot);
+	if (goalNode < 0)
+		return false;
+
+	if (following && ent->monsterinfo.nav_goal == goalNode)
+	{
+		// head for the one after once the node is reached
+		Nav_NodeOrigin (ent->monsterinfo.nav_next, spot);
+		VectorSubtract (spot, ent->s.origin, dir);
+		dir[2] = 0;
+
+		if (VectorLength (dir) < NAV_REACHED)
+		{
+			if (ent->monsterinfo.nav_next == goalNode)
+				return false;
+
+			next = Nav_NextHop (ent->monsterinfo.nav_next, goalNode);
+			if (next < 0)
+				return false;
+			ent->monsterinfo.nav_node = ent->monsterinfo.nav_next;
+			ent->monsterinfo.nav_next = next;
+		}
+	}
+	else
+	{
+		VectorSet (spot, ent->s.origin[0], ent->s.origin[1], ent->absmin[2]);
+		node = Nav_NearestNode (spot);
+		if (node < 0 || node == goalNode)
+			return false;
+
+		// not known yet, it will be in a frame or two
+		next = Nav_NextHop (node, goalNode);
+		if (next < 0)
+			return false;
+
+		ent->monsterinfo.nav_node = node;
+		ent->monsterinfo.nav_next = next;
+		ent->monsterinfo.nav_goal = goalNode;
+	}
+
+	ent->monsterinfo.nav_following = true;
+
+	Nav_NodeOrigin (ent->monsterinfo.nav_next, spot);
+	VectorSubtract (spot, ent->s.origin, dir);
+	if (!SV_StepDirection (ent, vectoyaw (dir), dist))
+	{
+		// something's in the way, find the path again from wherever this ends up
+		// and don't hand this hop out again until it's been searched for
+		Nav_ForgetHop (ent->monsterinfo.nav_node, ent->monsterinfo.nav_goal);
+		ent->monsterinfo.nav_following = false;
+		if (ent->inuse)
+			SV_NewChaseDir (ent, goal, dist);
+	}
+
+	return true;
+}
+
 /*
 ======================
 M_MoveToGoal
@@ -506,6 +601,9 @@ void M_MoveToGoal (edict_t *ent, float dist)
 	if (ent->enemy &&  SV_CloseEnough (ent, ent->enemy, dist) )
 		return;
 
+	if (M_NavMoveToGoal (ent, goal, dist))
+		return;
+
 // bump around...
 	if ( (rand()&3)==1 || !SV_StepDirection (ent, ent->ideal_yaw, dist))
 	{
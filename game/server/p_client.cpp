@@ -1291,6 +1291,8 @@ void ClientBegin (edict_t *ent)
 {
 	int		i;
 
+	G_RunQueuedMoves ();
+
 	ent->client = game.clients + (ent - g_edicts - 1);
 
 	if (deathmatch->GetBool())
@@ -1355,9 +1357,11 @@ The game can override any of the settings in place
 */
 void ClientUserinfoChanged (edict_t *ent, char *userinfo)
 {
-	char	*s;
+	const char	*s;
 	int		playernum;
 
+	G_RunQueuedMoves ();
+
 	// check for malformed or illegal info strings
 	if (!Info_Validate(userinfo))
 	{
@@ -1365,12 +1369,15 @@ void ClientUserinfoChanged (edict_t *ent, char *userinfo)
 		strcpy (userinfo, "\\name\\badinfo\\skin\\male/grunt");
 	}
 
+	// split it up once instead of rescanning it for every key
+	const InfoMap info (userinfo);
+
 	// set name
-	s = Info_ValueForKey (userinfo, "name");
+	s = info.Get ("name");
 	Q_strcpy_s (ent->client->pers.netname, s);
 
 	// set spectator
-	s = Info_ValueForKey (userinfo, "spectator");
+	s = info.Get ("spectator");
 	// spectators are only supported in deathmatch
 	if (deathmatch->GetBool() && *s && Q_strcmp(s, "0"))
 		ent->client->pers.spectator = true;
@@ -1378,7 +1385,7 @@ void ClientUserinfoChanged (edict_t *ent, char *userinfo)
 		ent->client->pers.spectator = false;
 
 	// set skin
-	s = Info_ValueForKey (userinfo, "skin");
+	s = info.Get ("skin");
 
 	playernum = ent-g_edicts-1;
 
@@ -1392,7 +1399,7 @@ void ClientUserinfoChanged (edict_t *ent, char *userinfo)
 	}
 	else
 	{
-		ent->client->ps.fov = Q_atoi(Info_ValueForKey(userinfo, "fov"));
+		ent->client->ps.fov = Q_atoi(info.Get("fov"));
 		if (ent->client->ps.fov < 1)
 			ent->client->ps.fov = 90;
 		else if (ent->client->ps.fov > 160)
@@ -1400,7 +1407,7 @@ void ClientUserinfoChanged (edict_t *ent, char *userinfo)
 	}
 
 	// handedness
-	s = Info_ValueForKey (userinfo, "hand");
+	s = info.Get ("hand");
 	if (strlen(s))
 	{
 		ent->client->pers.hand = Q_atoi(s);
@@ -1425,17 +1432,21 @@ loadgames will.
 */
 qboolean ClientConnect (edict_t *ent, char *userinfo)
 {
-	char	*value;
+	const char	*value;
+
+	G_RunQueuedMoves ();
+
+	const InfoMap info (userinfo);
 
 	// check to see if they are on the banned IP list
-	value = Info_ValueForKey (userinfo, "ip");
+	value = info.Get ("ip");
 	if (SV_FilterPacket(value)) {
 		Info_SetValueForKey(userinfo, "rejmsg", "Banned.");
 		return false;
 	}
 
 	// check for a spectator
-	value = Info_ValueForKey (userinfo, "spectator");
+	value = info.Get ("spectator");
 	if (deathmatch->GetBool() && *value && Q_strcmp(value, "0")) {
 		int i, numspec;
 
@@ -1457,7 +1468,7 @@ qboolean ClientConnect (edict_t *ent, char *userinfo)
 		}
 	} else {
 		// check for a password
-		value = Info_ValueForKey (userinfo, "password");
+		value = info.Get ("password");
 		if (*password->GetString() && Q_strcmp(password->GetString(), "none") &&
 			Q_strcmp(password->GetString(), value)) {
 			Info_SetValueForKey(userinfo, "rejmsg", "Password required or incorrect.");
@@ -1501,6 +1512,8 @@ void ClientDisconnect (edict_t *ent)
 {
 	int		playernum;
 
+	G_RunQueuedMoves ();
+
 	if (!ent->client)
 		return;
 
@@ -1560,6 +1573,23 @@ static void PrintPmove( pmove_t *pm )
 	gi.dprintf( "sv %u %u\n", c1, c2 );
 }
 
+/*
+==============
+ClientPmoveType
+==============
+*/
+pmType_t ClientPmoveType (edict_t *ent)
+{
+	if (ent->movetype == MOVETYPE_NOCLIP)
+		return PM_NOCLIP;
+	else if (ent->s.modelindex != 255)
+		return PM_GIB;
+	else if (ent->deadflag)
+		return PM_DEAD;
+	else
+		return PM_NORMAL;
+}
+
 /*
 ==============
 ClientThink
@@ -1569,6 +1599,95 @@ usually be a couple times for each server frame.
 ==============
 */
 void ClientThink (edict_t *ent, usercmd_t *ucmd)
+{
+	G_RecordClientThink (ent, ucmd);
+
+	// in a busy game the moves are held back and run together
+	if (G_QueueClientThink (ent, ucmd))
+		return;
+
+	ClientRunThink (ent, ucmd);
+}
+
+/*
+==============
+ClientPmove
+
+Moves the player for one usercmd and links it where it ends up
+==============
+*/
+void ClientPmove (edict_t *ent, usercmd_t *ucmd, pmove_t *pm)
+{
+	gclient_t	*client = ent->client;
+
+	// set up for pmove
+	memset (pm, 0, sizeof(*pm));
+
+	client->ps.pmove.pm_type = ClientPmoveType (ent);
+
+	client->ps.pmove.gravity = sv_gravity->GetInt(); // TODO: RIP FLOATING POINT
+	pm->s = client->ps.pmove;
+
+	VectorCopy( ent->s.origin, pm->s.origin );
+	VectorCopy( ent->velocity, pm->s.velocity );
+
+	pm->cmd = *ucmd;
+
+	pm->trace = PM_trace;	// adds default parms
+	pm->pointcontents = gi.pointcontents;
+	pm->playsound = PM_PlaySound;
+
+	// perform a pmove, unless it's already been done on the job workers
+	G_BatchedPmove (ent, pm);
+
+	// save results of pmove
+	client->ps.pmove = pm->s;
+	client->old_pmove = pm->s;
+
+	VectorCopy( pm->s.origin, ent->s.origin );
+	VectorCopy( pm->s.velocity, ent->velocity );
+
+	VectorCopy (pm->mins, ent->mins);
+	VectorCopy (pm->maxs, ent->maxs);
+
+	VectorCopy( ucmd->angles, client->resp.cmd_angles );
+
+#if 0
+	if (ent->groundentity && !pm->groundentity && (pm->cmd.upmove >= 10) && (pm->waterlevel == 0))
+	{
+		gi.sound(ent, CHAN_VOICE, gi.soundindex("*jump1.wav"), 1, ATTN_NORM, 0);
+		PlayerNoise(ent, ent->s.origin, PNOISE_SELF);
+	}
+#endif
+
+	ent->viewheight = pm->viewheight;
+	ent->waterlevel = pm->waterlevel;
+	ent->watertype = pm->watertype;
+	ent->groundentity = pm->groundentity;
+	if (pm->groundentity)
+		ent->groundentity_linkcount = pm->groundentity->linkcount;
+
+	if (ent->deadflag)
+	{
+		client->ps.viewangles[ROLL] = 40;
+		client->ps.viewangles[PITCH] = -15;
+		client->ps.viewangles[YAW] = client->killer_yaw;
+	}
+	else
+	{
+		VectorCopy (pm->viewangles, client->v_angle);
+		VectorCopy (pm->viewangles, client->ps.viewangles);
+	}
+
+	gi.linkentity (ent);
+}
+
+/*
+==============
+ClientRunThink
+==============
+*/
+void ClientRunThink (edict_t *ent, usercmd_t *ucmd)
 {
 	gclient_t	*client;
 	edict_t	*other;
@@ -1594,73 +1713,7 @@ void ClientThink (edict_t *ent, usercmd_t *ucmd)
 
 	} else {
 
-		// set up for pmove
-		memset (&pm, 0, sizeof(pm));
-
-		if (ent->movetype == MOVETYPE_NOCLIP)
-			client->ps.pmove.pm_type = PM_NOCLIP;
-		else if (ent->s.modelindex != 255)
-			client->ps.pmove.pm_type = PM_GIB;
-		else if (ent->deadflag)
-			client->ps.pmove.pm_type = PM_DEAD;
-		else
-			client->ps.pmove.pm_type = PM_NORMAL;
-
-		client->ps.pmove.gravity = sv_gravity->GetInt(); // TODO: RIP FLOATING POINT
-		pm.s = client->ps.pmove;
-
-		VectorCopy( ent->s.origin, pm.s.origin );
-		VectorCopy( ent->velocity, pm.s.velocity );
-
-		pm.cmd = *ucmd;
-
-		pm.trace = PM_trace;	// adds default parms
-		pm.pointcontents = gi.pointcontents;
-		pm.playsound = PM_PlaySound;
-
-		// perform a pmove
-		PM_Simulate (&pm);
-
-		// save results of pmove
-		client->ps.pmove = pm.s;
-		client->old_pmove = pm.s;
-
-		VectorCopy( pm.s.origin, ent->s.origin );
-		VectorCopy( pm.s.velocity, ent->velocity );
-
-		VectorCopy (pm.mins, ent->mins);
-		VectorCopy (pm.maxs, ent->maxs);
-
-		VectorCopy( ucmd->angles, client->resp.cmd_angles );
-
-#if 0
-		if (ent->groundentity && !pm.groundentity && (pm.cmd.upmove >= 10) && (pm.waterlevel == 0))
-		{
-			gi.sound(ent, CHAN_VOICE, gi.soundindex("*jump1.wav"), 1, ATTN_NORM, 0);
-			PlayerNoise(ent, ent->s.origin, PNOISE_SELF);
-		}
-#endif
-
-		ent->viewheight = pm.viewheight;
-		ent->waterlevel = pm.waterlevel;
-		ent->watertype = pm.watertype;
-		ent->groundentity = pm.groundentity;
-		if (pm.groundentity)
-			ent->groundentity_linkcount = pm.groundentity->linkcount;
-
-		if (ent->deadflag)
-		{
-			client->ps.viewangles[ROLL] = 40;
-			client->ps.viewangles[PITCH] = -15;
-			client->ps.viewangles[YAW] = client->killer_yaw;
-		}
-		else
-		{
-			VectorCopy (pm.viewangles, client->v_angle);
-			VectorCopy (pm.viewangles, client->ps.viewangles);
-		}
-
-		gi.linkentity (ent);
+		ClientPmove (ent, ucmd, &pm);
 
 		if (ent->movetype != MOVETYPE_NOCLIP)
 			G_TouchTriggers (ent);
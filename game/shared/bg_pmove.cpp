@@ -34,6 +34,7 @@
 #define PM_SURFTYPE_LADDER	1000
 #define PM_SURFTYPE_WADE	1001
 #define PM_SURFTYPE_SLOSH	1002
+#define PM_SURFTYPE_SWIM	1003	// not a surface, the sound of swimming up
 
 // Movement parameters
 static constexpr float	pm_stopspeed = 100;
@@ -67,8 +68,9 @@ struct pml_t
 	bool		walking;
 };
 
-static pmove_t *	pm;
-static pml_t		pml;
+static thread_local pmove_t *				pm;
+static thread_local pml_t					pml;
+static thread_local pmDeferredSounds_t *	pm_deferred;
 
 //=============================================================================
 
@@ -96,17 +98,15 @@ static int HackRandom( int low, int high )
 
 /*
 ===================
-PM_PlayStepSound
+PM_PickStepSound
 ===================
 */
-static void PM_PlayStepSound( int type, float fvol )
+static void PM_PickStepSound( int type, float fvol, int stepLeft, void ( *playsound )( const char *sample, float volume ) )
 {
 	static int iSkipStep;	// SlartTodo: This is the ultimate suck, move to player state
 	int irand;
 
-	pm->s.step_left = !pm->s.step_left;
-
-	irand = HackRandom( 0, 1 ) + ( pm->s.step_left * 2 );
+	irand = HackRandom( 0, 1 ) + ( stepLeft * 2 );
 
 	// irand - 0,1 for right foot, 2,3 for left foot
 	// used to alternate left and right foot
@@ -120,33 +120,33 @@ static void PM_PlayStepSound( int type, float fvol )
 		switch ( irand )
 		{
 		// right foot
-		case 0:	pm->playsound( "player/footsteps/step1.wav", fvol );	break;
-		case 1:	pm->playsound( "player/footsteps/step3.wav", fvol );	break;
+		case 0:	playsound( "player/footsteps/step1.wav", fvol );	break;
+		case 1:	playsound( "player/footsteps/step3.wav", fvol );	break;
 		// left foot
-		case 2:	pm->playsound( "player/footsteps/step2.wav", fvol );	break;
-		case 3:	pm->playsound( "player/footsteps/step4.wav", fvol );	break;
+		case 2:	playsound( "player/footsteps/step2.wav", fvol );	break;
+		case 3:	playsound( "player/footsteps/step4.wav", fvol );	break;
 		}
 		break;
 	case SURFTYPE_METAL:
 		switch ( irand )
 		{
 		// right foot
-		case 0:	pm->playsound( "player/footsteps/metal1.wav", fvol );	break;
-		case 1:	pm->playsound( "player/footsteps/metal3.wav", fvol );	break;
+		case 0:	playsound( "player/footsteps/metal1.wav", fvol );	break;
+		case 1:	playsound( "player/footsteps/metal3.wav", fvol );	break;
 		// left foot
-		case 2:	pm->playsound( "player/footsteps/metal2.wav", fvol );	break;
-		case 3:	pm->playsound( "player/footsteps/metal4.wav", fvol );	break;
+		case 2:	playsound( "player/footsteps/metal2.wav", fvol );	break;
+		case 3:	playsound( "player/footsteps/metal4.wav", fvol );	break;
 		}
 		break;
 	case SURFTYPE_VENT:
 		switch ( irand )
 		{
 		// right foot
-		case 0:	pm->playsound( "player/footsteps/duct1.wav", fvol );	break;
-		case 1:	pm->playsound( "player/footsteps/duct3.wav", fvol );	break;
+		case 0:	playsound( "player/footsteps/duct1.wav", fvol );	break;
+		case 1:	playsound( "player/footsteps/duct3.wav", fvol );	break;
 		// left foot
-		case 2:	pm->playsound( "player/footsteps/duct2.wav", fvol );	break;
-		case 3:	pm->playsound( "player/footsteps/duct4.wav", fvol );	break;
+		case 2:	playsound( "player/footsteps/duct2.wav", fvol );	break;
+		case 3:	playsound( "player/footsteps/duct4.wav", fvol );	break;
 		}
 		break;
 	case SURFTYPE_DIRT:
@@ -156,11 +156,11 @@ static void PM_PlayStepSound( int type, float fvol )
 		switch ( irand )
 		{
 		// right foot
-		case 0:	pm->playsound( "player/footsteps/dirt1.wav", fvol );	break;
-		case 1:	pm->playsound( "player/footsteps/dirt3.wav", fvol );	break;
+		case 0:	playsound( "player/footsteps/dirt1.wav", fvol );	break;
+		case 1:	playsound( "player/footsteps/dirt3.wav", fvol );	break;
 		// left foot
-		case 2:	pm->playsound( "player/footsteps/dirt2.wav", fvol );	break;
-		case 3:	pm->playsound( "player/footsteps/dirt4.wav", fvol );	break;
+		case 2:	playsound( "player/footsteps/dirt2.wav", fvol );	break;
+		case 3:	playsound( "player/footsteps/dirt4.wav", fvol );	break;
 		}
 		break;
 	case SURFTYPE_WOOD:
@@ -169,12 +169,12 @@ static void PM_PlayStepSound( int type, float fvol )
 		switch ( irand )
 		{
 		// right foot
-		case 0:	pm->playsound( "player/footsteps/tile1.wav", fvol );	break;
-		case 1:	pm->playsound( "player/footsteps/tile3.wav", fvol );	break;
+		case 0:	playsound( "player/footsteps/tile1.wav", fvol );	break;
+		case 1:	playsound( "player/footsteps/tile3.wav", fvol );	break;
 		// left foot
-		case 2:	pm->playsound( "player/footsteps/tile2.wav", fvol );	break;
-		case 3:	pm->playsound( "player/footsteps/tile4.wav", fvol );	break;
-		case 4: pm->playsound( "player/footsteps/tile5.wav", fvol );	break;
+		case 2:	playsound( "player/footsteps/tile2.wav", fvol );	break;
+		case 3:	playsound( "player/footsteps/tile4.wav", fvol );	break;
+		case 4: playsound( "player/footsteps/tile5.wav", fvol );	break;
 		}
 		break;
 
@@ -186,11 +186,11 @@ static void PM_PlayStepSound( int type, float fvol )
 		switch ( irand )
 		{
 		// right foot
-		case 0:	pm->playsound( "player/footsteps/ladder1.wav", fvol );	break;
-		case 1:	pm->playsound( "player/footsteps/ladder3.wav", fvol );	break;
+		case 0:	playsound( "player/footsteps/ladder1.wav", fvol );	break;
+		case 1:	playsound( "player/footsteps/ladder3.wav", fvol );	break;
 		// left foot
-		case 2:	pm->playsound( "player/footsteps/ladder2.wav", fvol );	break;
-		case 3:	pm->playsound( "player/footsteps/ladder4.wav", fvol );	break;
+		case 2:	playsound( "player/footsteps/ladder2.wav", fvol );	break;
+		case 3:	playsound( "player/footsteps/ladder4.wav", fvol );	break;
 		}
 		break;
 	case PM_SURFTYPE_WADE:
@@ -208,27 +208,85 @@ static void PM_PlayStepSound( int type, float fvol )
 		switch ( irand )
 		{
 		// right foot
-		case 0:	pm->playsound( "player/footsteps/wade1.wav", fvol );	break;
-		case 1:	pm->playsound( "player/footsteps/wade2.wav", fvol );	break;
+		case 0:	playsound( "player/footsteps/wade1.wav", fvol );	break;
+		case 1:	playsound( "player/footsteps/wade2.wav", fvol );	break;
 		// left foot
-		case 2:	pm->playsound( "player/footsteps/wade3.wav", fvol );	break;
-		case 3:	pm->playsound( "player/footsteps/wade4.wav", fvol );	break;
+		case 2:	playsound( "player/footsteps/wade3.wav", fvol );	break;
+		case 3:	playsound( "player/footsteps/wade4.wav", fvol );	break;
 		}
 		break;
 	case PM_SURFTYPE_SLOSH:
 		switch ( irand )
 		{
 		// right foot
-		case 0:	pm->playsound( "player/footsteps/slosh1.wav", fvol );	break;
-		case 1:	pm->playsound( "player/footsteps/slosh3.wav", fvol );	break;
+		case 0:	playsound( "player/footsteps/slosh1.wav", fvol );	break;
+		case 1:	playsound( "player/footsteps/slosh3.wav", fvol );	break;
 		// left foot
-		case 2:	pm->playsound( "player/footsteps/slosh2.wav", fvol );	break;
-		case 3:	pm->playsound( "player/footsteps/slosh4.wav", fvol );	break;
+		case 2:	playsound( "player/footsteps/slosh2.wav", fvol );	break;
+		case 3:	playsound( "player/footsteps/slosh4.wav", fvol );	break;
 		}
 		break;
 	}
 }
 
+/*
+===================
+PM_PickSwimSound
+===================
+*/
+static void PM_PickSwimSound( void ( *playsound )( const char *sample, float volume ) )
+{
+	switch ( HackRandom( 0, 3 ) )
+	{
+	case 0:
+		playsound( "player/footsteps/wade1.wav", 1.0f );
+		break;
+	case 1:
+		playsound( "player/footsteps/wade2.wav", 1.0f );
+		break;
+	case 2:
+		playsound( "player/footsteps/wade3.wav", 1.0f );
+		break;
+	case 3:
+		playsound( "player/footsteps/wade4.wav", 1.0f );
+		break;
+	}
+}
+
+/*
+===================
+PM_DeferSound
+
+Keeps a sound for PM_PlayDeferredSounds, returns false if they're played straight away
+===================
+*/
+static bool PM_DeferSound( int type, float volume, int stepLeft )
+{
+	if ( !pm_deferred ) {
+		return false;
+	}
+
+	assert( pm_deferred->count < PM_MAX_DEFERRED_SOUNDS );
+	if ( pm_deferred->count < PM_MAX_DEFERRED_SOUNDS ) {
+		pm_deferred->sounds[pm_deferred->count++] = { type, volume, stepLeft };
+	}
+	return true;
+}
+
+/*
+===================
+PM_PlayStepSound
+===================
+*/
+static void PM_PlayStepSound( int type, float fvol )
+{
+	pm->s.step_left = !pm->s.step_left;
+
+	if ( !PM_DeferSound( type, fvol, pm->s.step_left ) ) {
+		PM_PickStepSound( type, fvol, pm->s.step_left, pm->playsound );
+	}
+}
+
 /*
 ===================
 PM_UpdateStepSound
@@ -996,20 +1054,8 @@ static void PM_CheckJump()
 		{
 			// Don't play sound again for 1 second
 			pm->s.swim_time = 1000;
-			switch ( HackRandom( 0, 3 ) )
-			{
-			case 0:
-				pm->playsound( "player/footsteps/wade1.wav", 1.0f );
-				break;
-			case 1:
-				pm->playsound( "player/footsteps/wade2.wav", 1.0f );
-				break;
-			case 2:
-				pm->playsound( "player/footsteps/wade3.wav", 1.0f );
-				break;
-			case 3:
-				pm->playsound( "player/footsteps/wade4.wav", 1.0f );
-				break;
+			if ( !PM_DeferSound( PM_SURFTYPE_SWIM, 1.0f, 0 ) ) {
+				PM_PickSwimSound( pm->playsound );
 			}
 		}
 
@@ -1733,3 +1779,32 @@ void PM_Simulate( pmove_t *pmove )
 
 	PM_SnapPosition();
 }
+
+/*
+===================
+PM_DeferSounds
+===================
+*/
+void PM_DeferSounds( pmDeferredSounds_t *sounds )
+{
+	pm_deferred = sounds;
+}
+
+/*
+===================
+PM_PlayDeferredSounds
+===================
+*/
+void PM_PlayDeferredSounds( const pmDeferredSounds_t &sounds, void ( *playsound )( const char *sample, float volume ) )
+{
+	for ( int i = 0; i < sounds.count; i++ )
+	{
+		const pmDeferredSound_t &sound = sounds.sounds[i];
+
+		if ( sound.type == PM_SURFTYPE_SWIM ) {
+			PM_PickSwimSound( playsound );
+		} else {
+			PM_PickStepSound( sound.type, sound.volume, sound.stepLeft, playsound );
+		}
+	}
+}
@@ -23,6 +23,28 @@
 
 void PM_Simulate( pmove_t *pmove );
 
+// Sounds that pick a variation with rand are left for later when a move is worked out away from
+// the main thread, the game's random numbers have to be drawn there in the order the moves are
+// run. PM_DeferSounds only affects the calling thread, pass null to play them straight away again.
+
+#define PM_MAX_DEFERRED_SOUNDS	4
+
+struct pmDeferredSound_t
+{
+	int		type;
+	float	volume;
+	int		stepLeft;
+};
+
+struct pmDeferredSounds_t
+{
+	int					count;
+	pmDeferredSound_t	sounds[PM_MAX_DEFERRED_SOUNDS];
+};
+
+void PM_DeferSounds( pmDeferredSounds_t *sounds );
+void PM_PlayDeferredSounds( const pmDeferredSounds_t &sounds, void ( *playsound )( const char *sample, float volume ) );
+
 /*
 ===============================================================================
 
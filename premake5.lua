@@ -326,6 +326,9 @@ project "game"
 
 	LinkToCore( false )
 
+	includedirs { "thirdparty/zlib" }
+	links { "zlib" }
+
 	disablewarnings { "4244", "4311", "4302" }
 
 	pchsource( "game/server/g_pch.cpp" )
@@ -555,6 +558,48 @@ if not _OPTIONS["exclude-utils"] then
 			}
 		filter {}
 
+	project "loadbot"
+		kind "ConsoleApp"
+		targetname "loadbot"
+		language "C++"
+		floatingpoint "Default"
+		targetdir( out_dir )
+		debugdir( out_dir )
+		defines { "Q_CONSOLE_APP" }
+		includedirs { "utils/common2" }
+
+		LinkToCore( true )
+
+		filter "system:windows"
+			links { "ws2_32" }
+		filter {}
+
+		files {
+			"resources/windows_default.manifest",
+
+			"framework/*",
+
+			"engine/shared/net_chan.cpp",
+			"engine/shared/msg.cpp",
+			"engine/shared/sizebuf.cpp",
+			"engine/shared/crc.cpp",
+
+			"utils/common2/cmdlib.*",
+
+			"utils/loadbot/*"
+		}
+
+		filter "system:windows"
+			removefiles {
+				"**/*_linux.*"
+			}
+		filter {}
+		filter "system:linux"
+			removefiles {
+				"**/*_win.*"
+			}
+		filter {}
+
 	--[[
 	project "qatlas"
 		kind "ConsoleApp"
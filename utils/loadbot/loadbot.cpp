@@ -0,0 +1,859 @@
+/*
+===================================================================================================
+
+	LoadBot
+
+	Connects lots of fake clients to a server to find out how many players it can take.
+	Each bot has its own UDP socket and goes through the same handshake as a real client,
+	getchallenge, connect, new, configstrings, baselines and begin, then sends usercmds from
+	a script and acknowledges the snapshots it gets so the server delta compresses like it
+	would for a player. Nothing past the frame header is parsed.
+
+	Bots are added one at a time at botRamp per second up to bots, every second a line with
+	the snapshot interval, ping, snapshot size and drops is printed.
+
+	loadbot +set server 127.0.0.1:27910 +set bots 64 +set botMove circle
+
+===================================================================================================
+*/
+
+#include "../../engine/shared/engine.h"
+
+#ifdef _WIN32
+#include <WinSock2.h>
+#include <WS2tcpip.h>
+#else
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+// sys_win.cpp owns this in the engine
+int curtime;
+using botSocket_t = SOCKET;
+#define BAD_SOCKET INVALID_SOCKET
+#else
+using botSocket_t = int;
+#define BAD_SOCKET -1
+#define closesocket close
+#endif
+
+#define BOT_CMD_BACKUP		64
+#define BOT_RESEND_MSEC		3000
+#define BOT_TIMEOUT_MSEC	15000
+
+static cvar_t *server;
+static cvar_t *bots;
+static cvar_t *botRamp;
+static cvar_t *botMove;
+static cvar_t *botCmdRate;
+static cvar_t *botDuration;
+
+enum botState_t
+{
+	BOT_CHALLENGING,		// waiting on a challenge
+	BOT_CONNECTING,			// waiting on client_connect
+	BOT_LOADING,			// running through the signon
+	BOT_ACTIVE,				// getting snapshots
+	BOT_DEAD
+};
+
+struct bot_t
+{
+	int				number;
+	botSocket_t		socket;
+	botState_t		state;
+	int				qport;
+	int				challenge;
+	int				stateTime;
+
+	netchan_t		netchan;
+	int				serverFrame;			// last one received, acknowledged in every move
+	int				lastSnapshotTime;
+
+	usercmd_t		cmds[BOT_CMD_BACKUP];
+	int				cmdTimes[BOT_CMD_BACKUP];
+	int				nextCmdTime;
+};
+
+// reset every report
+struct botStats_t
+{
+	std::vector<int32>	snapshotIntervals;	// msec between snapshots, per bot
+	std::vector<int32>	pings;
+	int64				snapshotBytes;
+	int					snapshots;
+	int					maxSnapshot;
+	int					dropped;
+	int					unparsed;			// messages we gave up on before the frame
+	int64				bytesIn;
+	int64				bytesOut;
+};
+
+static std::vector<bot_t>	s_bots;
+static botStats_t			s_stats;
+static netadr_t				s_serverAdr;
+static botSocket_t			s_sendSocket = BAD_SOCKET;	// the netchan sends through this
+
+/*
+===================================================================================================
+
+	Sockets
+
+	The netchan sends through NET_SendPacket with a netsrc_t, which only knows about the
+	engine's two sockets, so the bot that's sending sets s_sendSocket first.
+
+===================================================================================================
+*/
+
+static void NetadrToSockadr( const netadr_t &a, sockaddr_in &s )
+{
+	memset( &s, 0, sizeof( s ) );
+	s.sin_family = AF_INET;
+	memcpy( &s.sin_addr, a.ip.arr, sizeof( a.ip.arr ) );
+	s.sin_port = a.port;
+}
+
+void NET_SendPacket( netsrc_t sock, int length, const void *data, const netadr_t &to )
+{
+	sockaddr_in addr;
+	NetadrToSockadr( to, addr );
+
+	sendto( s_sendSocket, (const char *)data, length, 0, (const sockaddr *)&addr, sizeof( addr ) );
+	s_stats.bytesOut += length;
+}
+
+char *NET_NetadrToString( const netadr_t &a )
+{
+	static char s[64];
+	Q_sprintf_s( s, "%i.%i.%i.%i:%i", a.ip.arr[0], a.ip.arr[1], a.ip.arr[2], a.ip.arr[3], BigShort( a.port ) );
+	return s;
+}
+
+bool NET_StringToNetadr( const char *s, netadr_t &a )
+{
+	char copy[128];
+	Q_strcpy_s( copy, s );
+
+	int port = PORT_SERVER;
+	char *colon = strchr( copy, ':' );
+	if ( colon )
+	{
+		*colon = '\0';
+		port = Q_atoi( colon + 1 );
+	}
+
+	addrinfo hints{};
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_DGRAM;
+
+	addrinfo *result;
+	if ( getaddrinfo( copy, nullptr, &hints, &result ) != 0 ) {
+		return false;
+	}
+
+	memset( &a, 0, sizeof( a ) );
+	a.type = NA_IP;
+	memcpy( a.ip.arr, &( (sockaddr_in *)result->ai_addr )->sin_addr, sizeof( a.ip.arr ) );
+	a.port = BigShort( static_cast<int16>( port ) );
+
+	freeaddrinfo( result );
+	return true;
+}
+
+static botSocket_t OpenSocket()
+{
+	botSocket_t s = socket( AF_INET, SOCK_DGRAM, IPPROTO_UDP );
+	if ( s == BAD_SOCKET ) {
+		return BAD_SOCKET;
+	}
+
+#ifdef _WIN32
+	u_long nonBlocking = 1;
+	ioctlsocket( s, FIONBIO, &nonBlocking );
+#else
+	fcntl( s, F_SETFL, fcntl( s, F_GETFL, 0 ) | O_NONBLOCK );
+#endif
+
+	// plenty of room for a burst of snapshots while we're busy with the other bots
+	int size = 256 * 1024;
+	setsockopt( s, SOL_SOCKET, SO_RCVBUF, (const char *)&size, sizeof( size ) );
+
+	sockaddr_in addr{};
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = INADDR_ANY;
+	addr.sin_port = 0;
+	if ( bind( s, (const sockaddr *)&addr, sizeof( addr ) ) != 0 )
+	{
+		closesocket( s );
+		return BAD_SOCKET;
+	}
+
+	return s;
+}
+
+static bool GetPacket( botSocket_t s, netadr_t &from, sizebuf_t &msg )
+{
+	sockaddr_in addr;
+	socklen_t addrLen = sizeof( addr );
+
+	const int length = static_cast<int>( recvfrom( s, (char *)msg.data, msg.maxsize, 0, (sockaddr *)&addr, &addrLen ) );
+	if ( length <= 0 ) {
+		return false;
+	}
+
+	from.type = NA_IP;
+	memcpy( from.ip.arr, &addr.sin_addr, sizeof( from.ip.arr ) );
+	from.port = addr.sin_port;
+
+	msg.cursize = length;
+	msg.readcount = 0;
+
+	s_stats.bytesIn += length;
+	return true;
+}
+
+/*
+===================================================================================================
+
+	Bots
+
+===================================================================================================
+*/
+
+static void Bot_SetState( bot_t &bot, botState_t state )
+{
+	bot.state = state;
+	bot.stateTime = curtime;
+}
+
+static void Bot_SendOutOfBand( bot_t &bot, _Printf_format_string_ const char *fmt, ... )
+{
+	char string[MAX_MSGLEN - 4];
+	va_list args;
+
+	va_start( args, fmt );
+	Q_vsprintf_s( string, fmt, args );
+	va_end( args );
+
+	s_sendSocket = bot.socket;
+	Netchan_OutOfBandPrint( NS_CLIENT, s_serverAdr, "%s", string );
+}
+
+static void Bot_Transmit( bot_t &bot, int length, byte *data )
+{
+	s_sendSocket = bot.socket;
+	Netchan_Transmit( &bot.netchan, length, data );
+}
+
+static void Bot_StringCmd( bot_t &bot, const char *cmd )
+{
+	MSG_WriteByte( &bot.netchan.message, clc_stringcmd );
+	MSG_WriteString( &bot.netchan.message, cmd );
+}
+
+/*
+========================
+Bot_BuildCmd
+
+Fills in a usercmd from the botMove script
+========================
+*/
+static void Bot_BuildCmd( const bot_t &bot, usercmd_t &cmd, int msec )
+{
+	memset( &cmd, 0, sizeof( cmd ) );
+	cmd.msec = static_cast<byte>( Clamp( msec, 1, 250 ) );
+
+	const char *script = botMove->GetString();
+	const float t = curtime * 0.001f + bot.number * 0.37f;
+
+	if ( !Q_stricmp( script, "idle" ) ) {
+		return;
+	}
+
+	if ( !Q_stricmp( script, "strafe" ) )
+	{
+		cmd.sidemove = ( static_cast<int>( t ) & 1 ) ? 400.0f : -400.0f;
+		cmd.angles[YAW] = bot.number * 15.0f;
+		return;
+	}
+
+	if ( !Q_stricmp( script, "random" ) )
+	{
+		cmd.forwardmove = static_cast<float>( ( rand() % 3 - 1 ) * 400 );
+		cmd.sidemove = static_cast<float>( ( rand() % 3 - 1 ) * 400 );
+		cmd.upmove = ( rand() % 20 == 0 ) ? 400.0f : 0.0f;
+		cmd.angles[YAW] = anglemod( t * 90.0f );
+		cmd.angles[PITCH] = sinf( t ) * 30.0f;
+		cmd.buttons = ( rand() % 10 == 0 ) ? BUTTON_ATTACK : 0;
+		return;
+	}
+
+	// circle
+	cmd.forwardmove = 400.0f;
+	cmd.angles[YAW] = anglemod( t * 60.0f );
+}
+
+/*
+========================
+Bot_SendMove
+
+Like CL_SendCmd, the last three commands and the frame to delta from
+========================
+*/
+static void Bot_SendMove( bot_t &bot )
+{
+	sizebuf_t	buf;
+	byte		data[128];
+	usercmd_t	nullcmd;
+
+	const int msec = 1000 / Max( 1, botCmdRate->GetInt() );
+
+	const int sequence = bot.netchan.outgoing_sequence;
+	usercmd_t *cmd = &bot.cmds[sequence & ( BOT_CMD_BACKUP - 1 )];
+	Bot_BuildCmd( bot, *cmd, msec );
+	bot.cmdTimes[sequence & ( BOT_CMD_BACKUP - 1 )] = curtime;
+
+	SZ_Init( &buf, data, sizeof( data ) );
+
+	MSG_WriteByte( &buf, clc_move );
+
+	const int checksumIndex = buf.cursize;
+	MSG_WriteByte( &buf, 0 );
+
+	MSG_WriteLong( &buf, bot.serverFrame );
+
+	memset( &nullcmd, 0, sizeof( nullcmd ) );
+	usercmd_t *oldest = &bot.cmds[( sequence - 2 ) & ( BOT_CMD_BACKUP - 1 )];
+	usercmd_t *older = &bot.cmds[( sequence - 1 ) & ( BOT_CMD_BACKUP - 1 )];
+	MSG_WriteDeltaUsercmd( &buf, &nullcmd, oldest );
+	MSG_WriteDeltaUsercmd( &buf, oldest, older );
+	MSG_WriteDeltaUsercmd( &buf, older, cmd );
+
+	buf.data[checksumIndex] = COM_BlockSequenceCRCByte( buf.data + checksumIndex + 1, buf.cursize - checksumIndex - 1, sequence );
+
+	Bot_Transmit( bot, buf.cursize, buf.data );
+}
+
+/*
+========================
+Bot_SkipEntity
+
+Reads past a delta entity, see CL_ParseEntityBits and CL_ParseDelta
+========================
+*/
+static void Bot_SkipEntity( sizebuf_t &msg )
+{
+	vec3_t pos;
+
+	uint bits = MSG_ReadByte( &msg );
+	if ( bits & U_MOREBITS1 ) {
+		bits |= MSG_ReadByte( &msg ) << 8;
+	}
+	if ( bits & U_MOREBITS2 ) {
+		bits |= MSG_ReadByte( &msg ) << 16;
+	}
+	if ( bits & U_MOREBITS3 ) {
+		bits |= MSG_ReadByte( &msg ) << 24;
+	}
+
+	if ( bits & U_NUMBER16 ) {
+		MSG_ReadShort( &msg );
+	} else {
+		MSG_ReadByte( &msg );
+	}
+
+	if ( bits & U_MODEL ) { MSG_ReadByte( &msg ); }
+	if ( bits & U_MODEL2 ) { MSG_ReadByte( &msg ); }
+	if ( bits & U_MODEL3 ) { MSG_ReadByte( &msg ); }
+	if ( bits & U_MODEL4 ) { MSG_ReadByte( &msg ); }
+
+	if ( bits & U_FRAME8 ) { MSG_ReadByte( &msg ); }
+	if ( bits & U_FRAME16 ) { MSG_ReadShort( &msg ); }
+
+	if ( ( bits & U_SKIN8 ) && ( bits & U_SKIN16 ) ) { MSG_ReadLong( &msg ); }
+	else if ( bits & U_SKIN8 ) { MSG_ReadByte( &msg ); }
+	else if ( bits & U_SKIN16 ) { MSG_ReadShort( &msg ); }
+
+	if ( ( bits & ( U_EFFECTS8 | U_EFFECTS16 ) ) == ( U_EFFECTS8 | U_EFFECTS16 ) ) { MSG_ReadLong( &msg ); }
+	else if ( bits & U_EFFECTS8 ) { MSG_ReadByte( &msg ); }
+	else if ( bits & U_EFFECTS16 ) { MSG_ReadShort( &msg ); }
+
+	if ( ( bits & ( U_RENDERFX8 | U_RENDERFX16 ) ) == ( U_RENDERFX8 | U_RENDERFX16 ) ) { MSG_ReadLong( &msg ); }
+	else if ( bits & U_RENDERFX8 ) { MSG_ReadByte( &msg ); }
+	else if ( bits & U_RENDERFX16 ) { MSG_ReadShort( &msg ); }
+
+	if ( bits & U_ORIGIN1 ) { MSG_ReadCoord( &msg ); }
+	if ( bits & U_ORIGIN2 ) { MSG_ReadCoord( &msg ); }
+	if ( bits & U_ORIGIN3 ) { MSG_ReadCoord( &msg ); }
+
+	if ( bits & U_ANGLE1 ) { MSG_ReadAngle( &msg ); }
+	if ( bits & U_ANGLE2 ) { MSG_ReadAngle( &msg ); }
+	if ( bits & U_ANGLE3 ) { MSG_ReadAngle( &msg ); }
+
+	if ( bits & U_OLDORIGIN ) { MSG_ReadPos( &msg, pos ); }
+	if ( bits & U_SOUND ) { MSG_ReadByte( &msg ); }
+	if ( bits & U_EVENT ) { MSG_ReadByte( &msg ); }
+	if ( bits & U_SOLID ) { MSG_ReadShort( &msg ); }
+}
+
+static void Bot_SkipSound( sizebuf_t &msg )
+{
+	vec3_t pos;
+
+	const int flags = MSG_ReadByte( &msg );
+	MSG_ReadByte( &msg );
+
+	if ( flags & SND_VOLUME ) { MSG_ReadByte( &msg ); }
+	if ( flags & SND_ATTENUATION ) { MSG_ReadByte( &msg ); }
+	if ( flags & SND_OFFSET ) { MSG_ReadByte( &msg ); }
+	if ( flags & SND_ENT ) { MSG_ReadShort( &msg ); }
+	if ( flags & SND_POS ) { MSG_ReadPos( &msg, pos ); }
+}
+
+/*
+========================
+Bot_StuffText
+
+The server drives the signon with stuffed commands, answer the ones a client would
+========================
+*/
+static void Bot_StuffText( bot_t &bot, const char *text )
+{
+	char line[MAX_TOKEN_CHARS];
+
+	while ( *text )
+	{
+		const char *end = text;
+		while ( *end && *end != '\n' && *end != ';' ) {
+			++end;
+		}
+
+		const size_t length = Min<size_t>( end - text, sizeof( line ) - 1 );
+		memcpy( line, text, length );
+		line[length] = '\0';
+		text = *end ? end + 1 : end;
+
+		if ( !Q_strncmp( line, "cmd ", 4 ) )
+		{
+			Bot_StringCmd( bot, line + 4 );
+		}
+		else if ( !Q_strncmp( line, "precache ", 9 ) )
+		{
+			// we don't load anything, go straight in
+			Bot_StringCmd( bot, va( "begin %s", line + 9 ) );
+		}
+		else if ( !Q_strcmp( line, "reconnect" ) )
+		{
+			Bot_SetState( bot, BOT_CHALLENGING );
+		}
+	}
+}
+
+/*
+========================
+Bot_ParseServerMessage
+
+Everything a real client gets before the frame is reliable and has to be
+read to get to the next command, the frame header is all we need after that
+========================
+*/
+static void Bot_ParseServerMessage( bot_t &bot, sizebuf_t &msg )
+{
+	const int size = msg.cursize;
+
+	while ( true )
+	{
+		if ( msg.readcount > msg.cursize )
+		{
+			Com_Printf( "bot %d: bad server message\n", bot.number );
+			return;
+		}
+
+		const int cmd = MSG_ReadByte( &msg );
+		if ( cmd == -1 ) {
+			return;
+		}
+
+		switch ( cmd )
+		{
+		case svc_nop:
+			break;
+
+		case svc_disconnect:
+			Com_Printf( "bot %d: disconnected by the server\n", bot.number );
+			Bot_SetState( bot, BOT_DEAD );
+			return;
+
+		case svc_reconnect:
+			Bot_SetState( bot, BOT_CHALLENGING );
+			return;
+
+		case svc_print:
+			MSG_ReadByte( &msg );
+			MSG_ReadString( &msg );
+			break;
+
+		case svc_centerprint:
+		case svc_layout:
+			MSG_ReadString( &msg );
+			break;
+
+		case svc_stufftext:
+			Bot_StuffText( bot, MSG_ReadString( &msg ) );
+			break;
+
+		case svc_serverdata:
+			MSG_ReadLong( &msg );		// protocol
+			MSG_ReadLong( &msg );		// spawncount
+			MSG_ReadByte( &msg );		// attractloop
+			MSG_ReadString( &msg );		// gamedir
+			MSG_ReadShort( &msg );		// playernum
+			MSG_ReadString( &msg );		// levelname
+			bot.serverFrame = -1;
+			break;
+
+		case svc_configstring:
+			MSG_ReadShort( &msg );
+			MSG_ReadString( &msg );
+			break;
+
+		case svc_spawnbaseline:
+			Bot_SkipEntity( msg );
+			break;
+
+		case svc_sound:
+			Bot_SkipSound( msg );
+			break;
+
+		case svc_muzzleflash:
+		case svc_muzzleflash2:
+			MSG_ReadShort( &msg );
+			MSG_ReadByte( &msg );
+			break;
+
+		case svc_inventory:
+			for ( int i = 0; i < MAX_ITEMS; ++i ) {
+				MSG_ReadShort( &msg );
+			}
+			break;
+
+		case svc_frame:
+		{
+			bot.serverFrame = MSG_ReadLong( &msg );
+
+			if ( bot.state != BOT_ACTIVE )
+			{
+				Com_Printf( "bot %d: in game after %d msec\n", bot.number, curtime - bot.stateTime );
+				Bot_SetState( bot, BOT_ACTIVE );
+			}
+			else
+			{
+				s_stats.snapshotIntervals.push_back( curtime - bot.lastSnapshotTime );
+			}
+			bot.lastSnapshotTime = curtime;
+
+			s_stats.snapshots++;
+			s_stats.snapshotBytes += size;
+			s_stats.maxSnapshot = Max( s_stats.maxSnapshot, size );
+			return;
+		}
+
+		default:
+			// temp entities, downloads and anything else we don't care to follow
+			s_stats.unparsed++;
+			return;
+		}
+	}
+}
+
+static void Bot_ConnectionlessPacket( bot_t &bot, sizebuf_t &msg )
+{
+	MSG_BeginReading( &msg );
+	MSG_ReadLong( &msg );		// skip the -1
+
+	char *s = MSG_ReadStringLine( &msg );
+	Cmd_TokenizeString( s, false );
+
+	const char *c = Cmd_Argv( 0 );
+
+	if ( !Q_strcmp( c, "challenge" ) && bot.state == BOT_CHALLENGING )
+	{
+		bot.challenge = Q_atoi( Cmd_Argv( 1 ) );
+		Bot_SetState( bot, BOT_CONNECTING );
+		Bot_SendOutOfBand( bot, "connect %i %i %i \"\\name\\bot%03d\\skin\\male/grunt\\rate\\25000\\msg\\1\\hand\\2\"\n",
+			PROTOCOL_VERSION, bot.qport, bot.challenge, bot.number );
+	}
+	else if ( !Q_strcmp( c, "client_connect" ) && bot.state == BOT_CONNECTING )
+	{
+		Netchan_Setup( NS_CLIENT, &bot.netchan, s_serverAdr, bot.qport );
+		Bot_StringCmd( bot, "new" );
+		Bot_SetState( bot, BOT_LOADING );
+	}
+	else if ( !Q_strcmp( c, "print" ) )
+	{
+		Com_Printf( "bot %d: %s", bot.number, MSG_ReadString( &msg ) );
+	}
+}
+
+static void Bot_ReadPackets( bot_t &bot )
+{
+	netadr_t	from;
+	sizebuf_t	msg;
+	byte		data[MAX_MSGLEN];
+
+	SZ_Init( &msg, data, sizeof( data ) );
+
+	while ( GetPacket( bot.socket, from, msg ) )
+	{
+		if ( bot.state == BOT_DEAD ) {
+			continue;
+		}
+
+		if ( *(int *)msg.data == -1 )
+		{
+			Bot_ConnectionlessPacket( bot, msg );
+			continue;
+		}
+
+		if ( bot.state < BOT_LOADING || msg.cursize < 8 ) {
+			continue;
+		}
+
+		if ( !Netchan_Process( &bot.netchan, &msg ) ) {
+			continue;
+		}
+
+		s_stats.dropped += bot.netchan.dropped;
+
+		const int acknowledged = bot.netchan.incoming_acknowledged & ( BOT_CMD_BACKUP - 1 );
+		if ( bot.state == BOT_ACTIVE ) {
+			s_stats.pings.push_back( curtime - bot.cmdTimes[acknowledged] );
+		}
+
+		Bot_ParseServerMessage( bot, msg );
+	}
+}
+
+static void Bot_Frame( bot_t &bot )
+{
+	switch ( bot.state )
+	{
+	case BOT_CHALLENGING:
+	case BOT_CONNECTING:
+		if ( curtime - bot.stateTime >= BOT_RESEND_MSEC || bot.challenge == -1 )
+		{
+			bot.challenge = 0;
+			Bot_SetState( bot, BOT_CHALLENGING );
+			Bot_SendOutOfBand( bot, "getchallenge\n" );
+		}
+		break;
+
+	case BOT_LOADING:
+		if ( bot.netchan.message.cursize || curtime - bot.netchan.last_sent > 1000 ) {
+			Bot_Transmit( bot, 0, nullptr );
+		}
+		break;
+
+	case BOT_ACTIVE:
+		if ( curtime >= bot.nextCmdTime )
+		{
+			bot.nextCmdTime = curtime + 1000 / Max( 1, botCmdRate->GetInt() );
+			Bot_SendMove( bot );
+		}
+		if ( curtime - bot.netchan.last_received > BOT_TIMEOUT_MSEC )
+		{
+			Com_Printf( "bot %d: timed out\n", bot.number );
+			Bot_SetState( bot, BOT_DEAD );
+		}
+		break;
+
+	case BOT_DEAD:
+		break;
+	}
+}
+
+static bool AddBot()
+{
+	bot_t bot;
+	memset( &bot, 0, sizeof( bot ) );
+
+	bot.number = static_cast<int>( s_bots.size() );
+	bot.socket = OpenSocket();
+	if ( bot.socket == BAD_SOCKET )
+	{
+		Com_Printf( "Couldn't open a socket for bot %d\n", bot.number );
+		return false;
+	}
+
+	bot.qport = ( curtime + bot.number * 7919 ) & 0xffff;
+	bot.challenge = -1;		// send straight away
+	bot.serverFrame = -1;
+	Bot_SetState( bot, BOT_CHALLENGING );
+
+	s_bots.push_back( bot );
+	return true;
+}
+
+/*
+===================================================================================================
+
+	Reporting
+
+===================================================================================================
+*/
+
+static int Percentile( std::vector<int32> &values, double fraction )
+{
+	if ( values.empty() ) {
+		return 0;
+	}
+	const size_t n = Min( values.size() - 1, static_cast<size_t>( fraction * values.size() ) );
+	std::nth_element( values.begin(), values.begin() + n, values.end() );
+	return values[n];
+}
+
+static void Report( int seconds, int msec )
+{
+	int numActive = 0, numDead = 0;
+	for ( const bot_t &bot : s_bots )
+	{
+		numActive += bot.state == BOT_ACTIVE;
+		numDead += bot.state == BOT_DEAD;
+	}
+
+	const int interval50 = Percentile( s_stats.snapshotIntervals, 0.5 );
+	const int interval99 = Percentile( s_stats.snapshotIntervals, 0.99 );
+	const int intervalMax = s_stats.snapshotIntervals.empty() ? 0 : *std::max_element( s_stats.snapshotIntervals.begin(), s_stats.snapshotIntervals.end() );
+
+	Com_Printf( "%4ds  bots %3d/%3d (%d dead)  snap ms p50 %3d p99 %3d max %4d  ping p50 %3d p99 %3d  "
+		"snap bytes avg %5d max %5d  drops %d  skipped %d  in %lld KB/s out %lld KB/s\n",
+		seconds, numActive, static_cast<int>( s_bots.size() ), numDead,
+		interval50, interval99, intervalMax,
+		Percentile( s_stats.pings, 0.5 ), Percentile( s_stats.pings, 0.99 ),
+		s_stats.snapshots ? static_cast<int>( s_stats.snapshotBytes / s_stats.snapshots ) : 0, s_stats.maxSnapshot,
+		s_stats.dropped, s_stats.unparsed,
+		s_stats.bytesIn * 1000 / 1024 / Max( 1, msec ), s_stats.bytesOut * 1000 / 1024 / Max( 1, msec ) );
+
+	s_stats.snapshotIntervals.clear();
+	s_stats.pings.clear();
+	s_stats.snapshotBytes = 0;
+	s_stats.snapshots = 0;
+	s_stats.maxSnapshot = 0;
+	s_stats.dropped = 0;
+	s_stats.unparsed = 0;
+	s_stats.bytesIn = 0;
+	s_stats.bytesOut = 0;
+}
+
+/*
+===================================================================================================
+
+	Main
+
+===================================================================================================
+*/
+
+int main( int argc, char **argv )
+{
+	Com_Print( "---- JaffaQuake Load Bot ----\n\n" );
+
+	Time_Init();
+
+	Cmd_Init();
+	Cvar_Init();
+	Cvar_AddEarlyCommands( argc, argv );
+
+	server = Cvar_Get( "server", "127.0.0.1:27910", 0, "Address of the server to load." );
+	bots = Cvar_Get( "bots", "32", 0, "How many bots to connect." );
+	botRamp = Cvar_Get( "botRamp", "4", 0, "Bots added per second." );
+	botMove = Cvar_Get( "botMove", "circle", 0, "Movement script: idle, circle, strafe or random." );
+	botCmdRate = Cvar_Get( "botCmdRate", "30", 0, "Moves each bot sends per second." );
+	botDuration = Cvar_Get( "botDuration", "0", 0, "Seconds to run for once every bot is added, 0 = forever." );
+
+	Netchan_Init();
+
+#ifdef _WIN32
+	WSADATA wsaData;
+	WSAStartup( MAKEWORD( 2, 2 ), &wsaData );
+#endif
+
+	if ( !NET_StringToNetadr( server->GetString(), s_serverAdr ) )
+	{
+		Com_Printf( "Bad server address %s\n", server->GetString() );
+		return EXIT_FAILURE;
+	}
+
+	const int numBots = Max( 1, bots->GetInt() );
+	s_bots.reserve( numBots );
+
+	Com_Printf( "Connecting %d bots to %s at %d a second\n\n", numBots, NET_NetadrToString( s_serverAdr ), botRamp->GetInt() );
+
+	curtime = Sys_Milliseconds();
+	const int startTime = curtime;
+	int lastReport = curtime;
+	int nextBotTime = curtime;
+	int allAddedTime = 0;
+
+	while ( true )
+	{
+		curtime = Sys_Milliseconds();
+
+		if ( static_cast<int>( s_bots.size() ) < numBots && curtime >= nextBotTime )
+		{
+			nextBotTime = curtime + 1000 / Max( 1, botRamp->GetInt() );
+			if ( !AddBot() ) {
+				break;
+			}
+			if ( static_cast<int>( s_bots.size() ) == numBots ) {
+				allAddedTime = curtime;
+			}
+		}
+
+		for ( bot_t &bot : s_bots )
+		{
+			Bot_ReadPackets( bot );
+			Bot_Frame( bot );
+		}
+
+		if ( curtime - lastReport >= 1000 )
+		{
+			Report( ( curtime - startTime ) / 1000, curtime - lastReport );
+			lastReport = curtime;
+		}
+
+		if ( allAddedTime && botDuration->GetInt() > 0 && curtime - allAddedTime >= botDuration->GetInt() * 1000 ) {
+			break;
+		}
+
+		std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+	}
+
+	// let the server know instead of waiting for the timeouts
+	for ( bot_t &bot : s_bots )
+	{
+		if ( bot.state >= BOT_LOADING && bot.state != BOT_DEAD )
+		{
+			Bot_StringCmd( bot, "disconnect" );
+			Bot_Transmit( bot, 0, nullptr );
+		}
+		closesocket( bot.socket );
+	}
+
+#ifdef _WIN32
+	WSACleanup();
+#endif
+
+	Cvar_Shutdown();
+	Cmd_Shutdown();
+
+	return EXIT_SUCCESS;
+}